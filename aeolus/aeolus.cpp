@@ -126,6 +126,7 @@ double Aeolus::masterTuning() const
 
 //---------------------------------------------------------
 //   play
+//    realtime
 //---------------------------------------------------------
 
 void Aeolus::play(const PlayEvent& event)
@@ -178,6 +179,7 @@ void Aeolus::play(const PlayEvent& event)
 
 //---------------------------------------------------------
 //   allNotesOff
+//    realtime
 //---------------------------------------------------------
 
 void Aeolus::allNotesOff(int)
@@ -142,6 +142,8 @@ void Aeolus::process(unsigned nframes, float* out, float*, float*)
       {
       float gain = 1.0;
 
+      processMessages();
+
       for (int n = 0; n < NNOTES; n++) {
             int m = _keymap[n];
             if (m & 128) {
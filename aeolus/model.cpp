@@ -156,57 +156,117 @@ void Model::init_iface()
       set_mconf (0, _chconf[0]._bits);
       }
 
+//---------------------------------------------------------
+//   RankJob
+//    load the waves of a rank from the cache or generate
+//    them
+//---------------------------------------------------------
+
+class RankJob : public QRunnable {
+      Rankwave* _wave;
+      Addsynth* _sdef;
+      const char* _path;
+      float _fsamp;
+      float _fbase;
+      float* _scale;
+
+   public:
+      RankJob(Rankwave* w, Addsynth* d, const char* path, float fsamp, float fbase, float* scale)
+         : _wave(w), _sdef(d), _path(path), _fsamp(fsamp), _fbase(fbase), _scale(scale) {}
+      virtual void run() {
+            if (_wave->load(_path, _sdef, _fsamp, _fbase, _scale))
+                  _wave->gen_waves(_sdef, _fsamp, _fbase, _scale);
+            }
+      };
+
+//---------------------------------------------------------
+//   init_ranks
+//    the ranks are built on all cores, then handed to
+//    the divisions in order
+//---------------------------------------------------------
+
 void Model::init_ranks (int comm)
       {
       _count++;
       _ready = false;
 //WS      send_event (TO_IFACE, new M_ifc_retune (_fbase, _itemp));
 
+      if (comm == MT_SAVE_RANK) {
+            for (int g = 0; g < _ngroup; g++) {
+                  Group* G = _group + g;
+                  for (int i = 0; i < G->_nifelm; i++)
+                        proc_rank (g, i, comm);
+                  }
+            _ready = true;
+            return;
+            }
+
+      QThreadPool pool;
+      QList<Rank*> ranks;
+      QList<int> divis;
       for (int g = 0; g < _ngroup; g++) {
             Group* G = _group + g;
-            for (int i = 0; i < G->_nifelm; i++)
-                  proc_rank (g, i, comm);
+            for (int i = 0; i < G->_nifelm; i++) {
+                  int d;
+                  Rank* R = new_rank(g, i, &d);
+                  if (!R)
+                        continue;
+                  pool.start(new RankJob(R->_wave, R->_sdef, _waves, _aeolus->_fsamp,
+                     _fbase, scales[_itemp]._data));
+                  ranks.append(R);
+                  divis.append(d);
+                  }
+            }
+      pool.waitForDone();
+
+      for (int k = 0; k < ranks.size(); ++k) {
+            Rank* R = ranks[k];
+            int d   = divis[k];
+            _aeolus->_divisp[d]->set_rank(R - _divis[d]._ranks, R->_wave, R->_sdef->_pan, R->_sdef->_del);
             }
       _ready = true;
       }
 
+//---------------------------------------------------------
+//   new_rank
+//    return the rank of interface element i of group g
+//    with a new empty Rankwave, or 0 if it is not a rank
+//    or was already done in this pass
+//---------------------------------------------------------
 
-void Model::proc_rank (int g, int i, int comm)
+Rank* Model::new_rank(int g, int i, int* divis)
       {
       Ifelm* I = _group [g]._ifelms + i;
-      if ((I->_type == Ifelm::DIVRANK) || (I->_type == Ifelm::KBDRANK)) {
-            int d = (I->_action0 >> 16) & 255;
-            int r = (I->_action0 >>  8) & 255;
-            Rank* R = _divis [d]._ranks + r;
-            if (comm == MT_SAVE_RANK) {
-                  if (R->_wave->modif ()) {
-                        R->_wave->save(_waves, R->_sdef, _aeolus->_fsamp,
-                           _fbase, scales[_itemp]._data);
-                        }
-                  }
-            else if (R->_count != _count) {
-                  R->_count = _count;
-                  M_def_rank M(comm);
-                  M._divis = d;
-                  M._rank  = r;
-                  M._group = g;
-                  M._ifelm = i;
-                  M._fsamp = _aeolus->_fsamp;
-                  M._fbase = _fbase;
-                  M._scale = scales [_itemp]._data;
-                  M._sdef  = R->_sdef;
-                  M._wave  = R->_wave;
-                  M._path  = _waves;
-
-//WS                  send_event(TO_IFACE, new M_ifc_ifelm (MT_IFC_ELATT, M._group, M._ifelm));
-
-                  M._wave = new Rankwave (M._sdef->_n0, M._sdef->_n1);
-                  if (M._wave->load (M._path, M._sdef, M._fsamp, M._fbase, M._scale))
-                        M._wave->gen_waves (M._sdef, M._fsamp, M._fbase, M._scale);
-
-                  _aeolus->_divisp [M._divis]->set_rank (M._rank, M._wave,  M._sdef->_pan, M._sdef->_del);
-                  _divis [M._divis]._ranks [M._rank]._wave = M._wave;
+      if ((I->_type != Ifelm::DIVRANK) && (I->_type != Ifelm::KBDRANK))
+            return 0;
+      int d   = (I->_action0 >> 16) & 255;
+      int r   = (I->_action0 >>  8) & 255;
+      Rank* R = _divis [d]._ranks + r;
+      if (R->_count == _count)
+            return 0;
+      R->_count = _count;
+//WS      send_event(TO_IFACE, new M_ifc_ifelm (MT_IFC_ELATT, g, i));
+      // the old Rankwave is deleted by Division::set_rank()
+      R->_wave = new Rankwave (R->_sdef->_n0, R->_sdef->_n1);
+      *divis   = d;
+      return R;
+      }
+
+void Model::proc_rank (int g, int i, int comm)
+      {
+      if (comm == MT_SAVE_RANK) {
+            Rank* R = find_rank(g, i);
+            if (R && R->_wave->modif ()) {
+                  R->_wave->save(_waves, R->_sdef, _aeolus->_fsamp,
+                     _fbase, scales[_itemp]._data);
                   }
+            return;
+            }
+      int d;
+      Rank* R = new_rank(g, i, &d);
+      if (R) {
+            RankJob(R->_wave, R->_sdef, _waves, _aeolus->_fsamp, _fbase, scales[_itemp]._data).run();
+            _aeolus->_divisp[d]->set_rank(R - _divis[d]._ranks, R->_wave, R->_sdef->_pan, R->_sdef->_del);
             }
       }
 
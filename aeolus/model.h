@@ -170,6 +170,7 @@ class Model
       void init_iface();
       void init_ranks(int comm);
       void proc_rank(int g, int i, int comm);
+      Rank* new_rank(int g, int i, int* divis);
       void set_mconf(int i, uint16_t *d);
       void get_state(uint32_t *bits);
       void set_state(int bank, int pres);
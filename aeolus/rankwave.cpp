@@ -16,6 +16,7 @@
     Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
 */
 
+#include <vector>
 #include "rankwave.h"
 
 #define DEBUG
@@ -23,19 +24,12 @@
 extern float exp2ap (float);
 
 
-Rngen   Pipewave::_rgen;
-float  *Pipewave::_arg = 0;
-float  *Pipewave::_att = 0;
+// Version 2 files are named after the tuning and temperament they
+// were generated for and use a fixed random seed per rank.
 
-void Pipewave::initstatic(float fsamp)
-      {
-      if (_arg)
-            return;
-      int k = (int)(fsamp);
-      _arg  = new float [k];
-      k     = (int)(0.5f * fsamp);
-      _att  = new float [k];
-      }
+static const int WAVE_VERSION = 2;
+
+Rngen   Pipewave::_rgen;
 
 //---------------------------------------------------------
 //   play
@@ -183,7 +177,7 @@ void Pipewave::play()
 }
 
 
-void Pipewave::genwave (Addsynth *D, int n, float fsamp, float fpipe)
+void Pipewave::genwave (Addsynth *D, int n, float fsamp, float fpipe, Rngen *R, float *_arg, float *_att)
 {
     int    h, i, k, nc;
     float  f0, f1, f, m, t, v, v0;
@@ -197,7 +191,7 @@ void Pipewave::genwave (Addsynth *D, int n, float fsamp, float fpipe)
     _l0 = (int)(fsamp * m + 0.5);
     _l0 = (_l0 + PERIOD - 1) & ~(PERIOD - 1);
 
-    f1 = (fpipe + D->_n_off.vi (n) + D->_n_ran.vi (n) * (2 * _rgen.urand () - 1)) / fsamp;
+    f1 = (fpipe + D->_n_off.vi (n) + D->_n_ran.vi (n) * (2 * R->urand () - 1)) / fsamp;
     f0 = f1 * exp2ap (D->_n_atd.vi (n) / 1200.0f);
 
     for (h = N_HARM - 1; h >= 0; h--)
@@ -251,9 +245,9 @@ void Pipewave::genwave (Addsynth *D, int n, float fsamp, float fpipe)
         v = D->_h_lev.vi (h, n);
         if (v < -80.0) continue;
 
-        v = v0 * exp2ap (0.1661 * (v + D->_h_ran.vi (h, n) * (2 * _rgen.urand () - 1)));
+        v = v0 * exp2ap (0.1661 * (v + D->_h_ran.vi (h, n) * (2 * R->urand () - 1)));
         k = (int)(fsamp * D->_h_att.vi (h, n) + 0.5);
-        attgain (k, D->_h_atp.vi (h, n));
+        attgain (k, D->_h_atp.vi (h, n), _att);
 
         for (i = 0; i < _l0 + _l1; i++)
         {
@@ -311,7 +305,7 @@ void Pipewave::looplen (float f, float fsamp, int lmax, int *aa, int *bb)
 }
 
 
-void Pipewave::attgain (int n, float p)
+void Pipewave::attgain (int n, float p, float *_att)
 {
     int    i, j, k;
     float  d, m, w, x, y, z;
@@ -363,7 +357,14 @@ void Pipewave::save (FILE *F)
 }
 
 
-void Pipewave::load (FILE *F)
+//---------------------------------------------------------
+//   map
+//    point the pipe to its data in a mapped wave file;
+//    returns the start of the next pipe or 0 if the file
+//    is truncated
+//---------------------------------------------------------
+
+const char *Pipewave::map (const char *p, const char *e)
 {
     int  k;
     union
@@ -373,24 +374,48 @@ void Pipewave::load (FILE *F)
 	float   flt [8];
     } d;
 
-    fread (&d, 1, 32, F);
+    if (e - p < 32) return 0;
+    memcpy (&d, p, 32);
+    p += 32;
     _l0  = d.i32 [0];
     _l1  = d.i32 [1];
     _k_s = d.i16 [4];
     _k_r = d.i16 [5];
     _m_r = d.flt [3];
     k = _l0 +_l1 + _k_s * (PERIOD + 4);
-    delete[] _p0;
-    _p0 = new float [k];
+    if (_l0 < 0 || _l1 <= 0 || _k_s <= 0 || (e - p) / (int) sizeof (float) < k) return 0;
+    _p0 = (float *) p;
     _p1 = _p0 + _l0;
     _p2 = _p1 + _l1;
-    fread (_p0, k, sizeof (float), F);
+    return p + k * sizeof (float);
 }
 
 
+//---------------------------------------------------------
+//   cache_name
+//    the wave file of a rank is keyed by tuning and
+//    temperament, so retuning does not overwrite it
+//---------------------------------------------------------
 
+static void cache_name (char *name, const char *path, Addsynth *D, float fsamp, float fbase, float *scale)
+{
+    uint32_t h = 2166136261u;     // FNV-1a
+    float    k [14];
+    char    *p;
 
-Rankwave::Rankwave (int n0, int n1) : _n0 (n0), _n1 (n1), _list (0), _modif (false)
+    k [0] = fsamp;
+    k [1] = fbase;
+    memcpy (k + 2, scale, 12 * sizeof (float));
+    const unsigned char *q = (const unsigned char *) k;
+    for (unsigned i = 0; i < sizeof (k); i++) h = (h ^ q [i]) * 16777619u;
+
+    sprintf (name, "%s/%s", path, D->_filename);
+    if ((p = strrchr (name, '.'))) *p = 0;
+    sprintf (name + strlen (name), "-%08x.ae1", h);
+}
+
+
+Rankwave::Rankwave (int n0, int n1) : _n0 (n0), _n1 (n1), _list (0), _modif (false), _file (0)
 {
     _pipes = new Pipewave [n1 - n0 + 1];
 }
@@ -398,18 +423,37 @@ Rankwave::Rankwave (int n0, int n1) : _n0 (n0), _n1 (n1), _list (0), _modif (fal
 
 Rankwave::~Rankwave (void)
 {
+    if (_file)
+    {
+        for (int i = _n0; i <= _n1; i++) _pipes [i - _n0]._p0 = 0;
+    }
     delete[] _pipes;
+    delete _file;
 }
 
 
+//---------------------------------------------------------
+//   gen_waves
+//    the work space and random generator are local so that
+//    ranks can be generated in parallel; the seed depends
+//    on the rank only, which makes the result reproducible
+//---------------------------------------------------------
+
 void Rankwave::gen_waves (Addsynth *D, float fsamp, float fbase, float *scale)
 {
-    Pipewave::initstatic (fsamp);
+    std::vector<float> arg ((int)(fsamp));
+    std::vector<float> att ((int)(0.5f * fsamp));
+    Rngen R;
+
+    uint32_t seed = 2166136261u;
+    for (const char *p = D->_filename; *p; p++) seed = (seed ^ (unsigned char) *p) * 16777619u;
+    R.init ((seed ^ (_n0 << 8) ^ _n1) | 1);
 
     fbase *=  D->_fn / (D->_fd * scale [9]);
     for (int i = _n0; i <= _n1; i++)
     {
-	_pipes [i - _n0].genwave (D, i - _n0, fsamp, ldexpf (fbase * scale [i % 12], i / 12 - 5));
+	_pipes [i - _n0].genwave (D, i - _n0, fsamp, ldexpf (fbase * scale [i % 12], i / 12 - 5),
+                                  &R, arg.data (), att.data ());
     }
     _modif = true;
 }
@@ -456,23 +500,24 @@ int Rankwave::save (const char *path, Addsynth *D, float fsamp, float fbase, flo
     Pipewave  *P;
     int        i;
     char       name [1024];
+    char       temp [1040];
     char       data [64];
-    char      *p;
 
-    sprintf (name, "%s/%s", path, D->_filename);
-    if ((p = strrchr (name, '.'))) strcpy (p, ".ae1");
-    else strcat (name, ".ae1");
+    // written to a temporary file first, a wave file is mapped
+    // by load() and must never be seen half written
+    cache_name (name, path, D, fsamp, fbase, scale);
+    sprintf (temp, "%s.tmp", name);
 
-    F = fopen (name, "wb");
+    F = fopen (temp, "wb");
     if (F == NULL)
     {
-	fprintf (stderr, "Can't open waveform file '%s' for writing\n", name);
+	fprintf (stderr, "Can't open waveform file '%s' for writing\n", temp);
         return 1;
     }
 
     memset (data, 0, 16);
     strcpy (data, "ae1");
-    data [4] = 1;
+    data [4] = WAVE_VERSION;
     fwrite (data, 1, 16, F);
 
     memset (data, 0, 64);
@@ -491,7 +536,15 @@ int Rankwave::save (const char *path, Addsynth *D, float fsamp, float fbase, flo
 
     for (i = _n0, P = _pipes; i <= _n1; i++, P++) P->save (F);
 
-    fclose (F);
+    int err = ferror (F);
+    err |= fclose (F);
+    QFile::remove (name);
+    if (err || !QFile::rename (temp, name))
+    {
+	fprintf (stderr, "Can't write waveform file '%s'\n", name);
+        remove (temp);
+        return 1;
+    }
 
     _modif = false;
     return 0;
@@ -505,12 +558,9 @@ int Rankwave::load (const char *path, Addsynth *D, float fsamp, float fbase, flo
     int        i;
     char       name [1024];
     char       data [64];
-    char      *p;
     float      f;
 
-    sprintf (name, "%s/%s", path, D->_filename);
-    if ((p = strrchr (name, '.'))) strcpy (p, ".ae1");
-    else strcat (name, ".ae1");
+    cache_name (name, path, D, fsamp, fbase, scale);
 
     F = fopen (name, "rb");
     if (F == NULL)
@@ -531,7 +581,7 @@ int Rankwave::load (const char *path, Addsynth *D, float fsamp, float fbase, flo
         return 1;
     }
 
-    if (data [4] != 1)
+    if (data [4] != WAVE_VERSION)
     {
 #ifdef DEBUG
 	fprintf (stderr, "File '%s' has an incompatible version tag (%d)\n", name, data [4]);
@@ -583,10 +633,26 @@ int Rankwave::load (const char *path, Addsynth *D, float fsamp, float fbase, flo
         }
     }
 
-    for (i = _n0, P = _pipes; i <= _n1; i++, P++) P->load (F);
-
     fclose (F);
 
+    // the pipes use the wave data in place
+    QFile *file = new QFile (name);
+    const char *b = 0;
+    if (file->open (QIODevice::ReadOnly)) b = (const char *) file->map (0, file->size ());
+    const char *e = b ? b + file->size () : 0;
+    const char *q = b ? b + 80 : 0;
+    for (i = _n0, P = _pipes; q && i <= _n1; i++, P++) q = P->map (q, e);
+    if (q == 0)
+    {
+#ifdef DEBUG
+	fprintf (stderr, "File '%s' cannot be mapped or is truncated\n", name);
+#endif
+        for (i = _n0, P = _pipes; i <= _n1; i++, P++) P->_p0 = 0;
+        delete file;
+        return 1;
+    }
+    _file = file;
+
     _modif = false;
     return 0;
 }
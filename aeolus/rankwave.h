@@ -42,13 +42,13 @@ private:
 
     friend class Rankwave;
 
-    void genwave (Addsynth *D, int n, float fsamp, float fpipe);
+    void genwave (Addsynth *D, int n, float fsamp, float fpipe, Rngen *R, float *arg, float *att);
     void save (FILE *F);
-    void load (FILE *F);
+    const char *map (const char *p, const char *e);
     void play (void);
 
     static void looplen (float f, float fsamp, int lmax, int *aa, int *bb);
-    static void attgain (int n, float p);
+    static void attgain (int n, float p, float *att);
 
     float     *_p0;    // attack start
     float     *_p1;    // loop start
@@ -73,12 +73,7 @@ private:
     float      _g_r;   // release gain
     int16_t    _i_r;   // release count
 
-
-    static void initstatic (float fsamp);
-
     static   Rngen   _rgen;
-    static   float  *_arg;
-    static   float  *_att;
 };
 
 //---------------------------------------------------------
@@ -96,6 +91,7 @@ class Rankwave
       Pipewave   *_list;
       Pipewave   *_pipes;
       bool        _modif;
+      QFile      *_file;     // mapped wave cache file the pipes point into, or 0
 
 public:
 
@@ -134,6 +130,7 @@ public:
     int  n1 (void) const { return _n1; }
     void play (int shift);
     void set_param (float *out, int del, int pan);
+    // gen_waves() and load() of different ranks may run in parallel
     void gen_waves (Addsynth *D, float fsamp, float fbase, float *scale);
     int  save (const char *path, Addsynth *D, float fsamp, float fbase, float *scale);
     int  load (const char *path, Addsynth *D, float fsamp, float fbase, float *scale);
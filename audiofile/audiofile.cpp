@@ -64,6 +64,18 @@ bool AudioFile::open(const QByteArray& b)
       return sf != 0;
       }
 
+//---------------------------------------------------------
+//   open
+//    read directly from the file instead of a memory
+//    buffer; used to stream large samples
+//---------------------------------------------------------
+
+bool AudioFile::open(const QString& path)
+      {
+      sf = sf_open(QFile::encodeName(path).constData(), SFM_READ, &info);
+      return sf != 0;
+      }
+
 //---------------------------------------------------------
 //   read
 //---------------------------------------------------------
@@ -30,6 +30,8 @@ class AudioFile {
       ~AudioFile();
 
       bool open(const QByteArray&);
+      bool open(const QString& path);
+      bool seekFrame(sf_count_t frame) { return sf_seek(sf, frame, SEEK_SET) == frame; }
       const char* error() const     { return sf_strerror(sf); }
       int read(short*, int);
 
@@ -12,8 +12,13 @@
 
 #include <math.h>
 
+#include "config.h"
 #include "compressor.h"
 
+#if defined(USE_SSE) && defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 namespace Ms {
 
 #define f_round(f) lrintf(f)
@@ -220,40 +225,52 @@ void Compressor::process(int frames, float* ip, float *op)
       const float ef_a     = ga * 0.25f;
       const float ef_ai    = 1.0f - ef_a;
 
-      for (int pos = 0; pos < frames; pos++) {
-            const float la = fabs(ip[pos * 2]);
-            const float ra = fabs(ip[pos * 2 + 1]);
-            const float lev_in = f_max(la, ra);
-
-            sum += lev_in * lev_in;
-            if (amp > env_rms)
-                  env_rms = env_rms * ga + amp * (1.0f - ga);
-            else
-                  env_rms = env_rms * gr + amp * (1.0f - gr);
-            round_to_zero(&env_rms);
-            if (lev_in > env_peak)
-                  env_peak = env_peak * ga + lev_in * (1.0f - ga);
-            else
-                  env_peak = env_peak * gr + lev_in * (1.0f - gr);
-            round_to_zero(&env_peak);
-            if ((count++ & 3) == 3) {
-                  amp = rms.process(sum * 0.25f);
-                  sum = 0.0f;
-                  if (qIsNaN(env_rms))     // This can happen sometimes, but I don't know why
-                        env_rms = 0.0f;
-                  env = LIN_INTERP(rms_peak, env_rms, env_peak);
-                  if (env <= knee_min)
-                        gain_t = 1.0f;
-                  else if (env < knee_max) {
-                        const float x = -(_threshold - _knee - lin2db(env)) / _knee;
-                        gain_t = db2lin(-_knee * rs * x * x * 0.25f);
-                        }
+      alignas(16) float lev[BLOCK];
+      alignas(16) float g[BLOCK];
+
+      for (int n = 0; n < frames; n += BLOCK) {
+            const int m = qMin(frames - n, BLOCK);
+            const float* in = ip + n * 2;
+            float* out      = op + n * 2;
+
+            levels(m, in, lev);
+
+            // the envelope followers and the gain computer are
+            // recursive and stay scalar
+            for (int pos = 0; pos < m; pos++) {
+                  const float lev_in = lev[pos];
+
+                  sum += lev_in * lev_in;
+                  if (amp > env_rms)
+                        env_rms = env_rms * ga + amp * (1.0f - ga);
                   else
-                        gain_t = db2lin((_threshold - lin2db(env)) * rs);
+                        env_rms = env_rms * gr + amp * (1.0f - gr);
+                  round_to_zero(&env_rms);
+                  if (lev_in > env_peak)
+                        env_peak = env_peak * ga + lev_in * (1.0f - ga);
+                  else
+                        env_peak = env_peak * gr + lev_in * (1.0f - gr);
+                  round_to_zero(&env_peak);
+                  if ((count++ & 3) == 3) {
+                        amp = rms.process(sum * 0.25f);
+                        sum = 0.0f;
+                        if (qIsNaN(env_rms))     // This can happen sometimes, but I don't know why
+                              env_rms = 0.0f;
+                        env = LIN_INTERP(rms_peak, env_rms, env_peak);
+                        if (env <= knee_min)
+                              gain_t = 1.0f;
+                        else if (env < knee_max) {
+                              const float x = -(_threshold - _knee - lin2db(env)) / _knee;
+                              gain_t = db2lin(-_knee * rs * x * x * 0.25f);
+                              }
+                        else
+                              gain_t = db2lin((_threshold - lin2db(env)) * rs);
+                        }
+                  gain   = gain * ef_a + gain_t * ef_ai;
+                  g[pos] = gain;
                   }
-            gain          = gain * ef_a + gain_t * ef_ai;
-            op[pos * 2]   = ip[pos * 2] * gain * mug;
-            op[pos * 2+1] = ip[pos * 2 + 1] * gain * mug;
+
+            applyGain(m, in, out, g, mug);
             }
 
 //      printf("gain %f\n", gain);
@@ -262,6 +279,56 @@ void Compressor::process(int frames, float* ip, float *op)
 //      gain_red  = lin2db(gain);
       }
 
+//---------------------------------------------------------
+//   levels
+//    the input level of every frame, max(|left|, |right|)
+//---------------------------------------------------------
+
+void Compressor::levels(int frames, const float* ip, float* lev)
+      {
+      int pos = 0;
+#if defined(USE_SSE) && defined(__SSE2__)
+      const __m128 mask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+      const __m128 half = _mm_set1_ps(0.5f);
+      for (; pos + 4 <= frames; pos += 4) {
+            __m128 a = _mm_loadu_ps(ip + pos * 2);          // l0 r0 l1 r1
+            __m128 b = _mm_loadu_ps(ip + pos * 2 + 4);      // l2 r2 l3 r3
+            __m128 l = _mm_and_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)), mask);
+            __m128 r = _mm_and_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)), mask);
+            // f_max(l, r)
+            __m128 x = _mm_sub_ps(l, r);
+            x = _mm_add_ps(x, _mm_and_ps(x, mask));
+            x = _mm_mul_ps(x, half);
+            _mm_store_ps(lev + pos, _mm_add_ps(x, r));
+            }
+#endif
+      for (; pos < frames; pos++)
+            lev[pos] = f_max(fabs(ip[pos * 2]), fabs(ip[pos * 2 + 1]));
+      }
+
+//---------------------------------------------------------
+//   applyGain
+//---------------------------------------------------------
+
+void Compressor::applyGain(int frames, const float* ip, float* op, const float* g, float mug)
+      {
+      int pos = 0;
+#if defined(USE_SSE) && defined(__SSE2__)
+      const __m128 vmug = _mm_set1_ps(mug);
+      for (; pos + 4 <= frames; pos += 4) {
+            __m128 v  = _mm_load_ps(g + pos);
+            __m128 lo = _mm_unpacklo_ps(v, v);              // g0 g0 g1 g1
+            __m128 hi = _mm_unpackhi_ps(v, v);              // g2 g2 g3 g3
+            _mm_storeu_ps(op + pos * 2,     _mm_mul_ps(_mm_mul_ps(_mm_loadu_ps(ip + pos * 2), lo), vmug));
+            _mm_storeu_ps(op + pos * 2 + 4, _mm_mul_ps(_mm_mul_ps(_mm_loadu_ps(ip + pos * 2 + 4), hi), vmug));
+            }
+#endif
+      for (; pos < frames; pos++) {
+            op[pos * 2]     = ip[pos * 2] * g[pos] * mug;
+            op[pos * 2 + 1] = ip[pos * 2 + 1] * g[pos] * mug;
+            }
+      }
+
 //---------------------------------------------------------
 //   setNValue
 //---------------------------------------------------------
@@ -55,6 +55,8 @@ class Compressor : public Effect
       {
       Q_OBJECT
 
+      static const int BLOCK = 64;        // frames per pass of the SIMD stages
+
       float sampleRate;
       RmsEnv rms;
       float sum;
@@ -121,6 +123,9 @@ class Compressor : public Effect
       void setKnee(float v)       { _knee = v;          }
       void setMakeupGain(float v) { _makeupGain = v;    }
 
+      static void levels(int frames, const float* ip, float* lev);
+      static void applyGain(int frames, const float* ip, float* op, const float* g, float mug);
+
       float rmsPeak() const       { return rms_peak;    }
       float attack() const        { return _attack;     }
       float release() const       { return _release;    }
@@ -9,8 +9,15 @@
 */
 
 #include "stdio.h"
+#include "config.h"
 #include "freeverb.h"
 
+#if defined(USE_SSE) && defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace Ms {
+
 #define DC_OFFSET 1e-8
 
 
@@ -101,6 +108,94 @@ void Comb::setdamp(float val)
       damp2 = 1 - val;
       }
 
+//---------------------------------------------------------
+//   process
+//    run n samples of x through the allpass, in place.
+//    The buffer is processed in contiguous runs up to the
+//    wrap around; a sample read from the buffer was written
+//    bufsize samples earlier, so there is no dependency
+//    between the samples of a run.
+//---------------------------------------------------------
+
+void Allpass::process(int n, float* x)
+      {
+      while (n > 0) {
+            int m     = qMin(n, bufsize - bufidx);
+            float* b  = buffer + bufidx;
+            int i     = 0;
+#if defined(USE_SSE) && defined(__SSE2__)
+            const __m128 fb = _mm_set1_ps(feedback);
+            for (; i + 4 <= m; i += 4) {
+                  __m128 in  = _mm_loadu_ps(x + i);
+                  __m128 out = _mm_loadu_ps(b + i);
+                  _mm_storeu_ps(x + i, _mm_sub_ps(out, in));
+                  _mm_storeu_ps(b + i, _mm_add_ps(in, _mm_mul_ps(out, fb)));
+                  }
+#endif
+            for (; i < m; ++i) {
+                  float bufout = b[i];
+                  float input  = x[i];
+                  x[i]         = bufout - input;
+                  b[i]         = input + (bufout * feedback);
+                  }
+            x      += m;
+            n      -= m;
+            bufidx += m;
+            if (bufidx == bufsize)
+                  bufidx = 0;
+            }
+      }
+
+//---------------------------------------------------------
+//   process
+//    add the comb output for n samples of in to out.
+//    The damping lowpass is evaluated four samples at a
+//    time as a prefix sum over the powers of damp1.
+//---------------------------------------------------------
+
+void Comb::process(int n, const float* in, float* out)
+      {
+      while (n > 0) {
+            int m     = qMin(n, bufsize - bufidx);
+            float* b  = buffer + bufidx;
+            int i     = 0;
+#if defined(USE_SSE) && defined(__SSE2__)
+            if (m >= 4) {
+                  const float d1 = damp1;
+                  const __m128 vd1  = _mm_set1_ps(d1);
+                  const __m128 vd2  = _mm_set1_ps(d1 * d1);
+                  const __m128 pw   = _mm_setr_ps(d1, d1 * d1, d1 * d1 * d1, d1 * d1 * d1 * d1);
+                  const __m128 vdp2 = _mm_set1_ps(damp2);
+                  const __m128 fb   = _mm_set1_ps(feedback);
+                  __m128 fs         = _mm_set1_ps(filterstore);
+                  for (; i + 4 <= m; i += 4) {
+                        __m128 tmp = _mm_loadu_ps(b + i);
+                        __m128 u   = _mm_mul_ps(tmp, vdp2);
+                        u = _mm_add_ps(u, _mm_mul_ps(_mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(u), 4)), vd1));
+                        u = _mm_add_ps(u, _mm_mul_ps(_mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(u), 8)), vd2));
+                        fs = _mm_add_ps(u, _mm_mul_ps(fs, pw));
+                        _mm_storeu_ps(b + i, _mm_add_ps(_mm_loadu_ps(in + i), _mm_mul_ps(fs, fb)));
+                        _mm_storeu_ps(out + i, _mm_add_ps(_mm_loadu_ps(out + i), tmp));
+                        fs = _mm_shuffle_ps(fs, fs, _MM_SHUFFLE(3, 3, 3, 3));
+                        }
+                  filterstore = _mm_cvtss_f32(fs);
+                  }
+#endif
+            for (; i < m; ++i) {
+                  float tmp   = b[i];
+                  filterstore = (tmp * damp2) + (filterstore * damp1);
+                  b[i]        = in[i] + (filterstore * feedback);
+                  out[i]     += tmp;
+                  }
+            in     += m;
+            out    += m;
+            n      -= m;
+            bufidx += m;
+            if (bufidx == bufsize)
+                  bufidx = 0;
+            }
+      }
+
 static const int stereospread = 23;
 
 /*
@@ -152,38 +247,37 @@ void Freeverb::process(int n, float* in, float* out)
             update();
             parameterChanged = false;
             }
-      float* lp = in;
-      float* rp = in+1;
-      float* lo = out;
-      float* ro = out+1;
-
       float dry = 1.0 - wet;
 
-      for (int k = 0; k < n; k++) {
-            float outL = 0.0;
-            float outR = 0.0;
-
-            float input = ((*lp + *rp) * sendLevel) + DC_OFFSET;
+      float input[blocksize];
+      float outL[blocksize];
+      float outR[blocksize];
 
+      while (n > 0) {
+            int m = qMin(n, int(blocksize));
+            for (int k = 0; k < m; k++) {
+                  input[k] = ((in[k * 2] + in[k * 2 + 1]) * sendLevel) + DC_OFFSET;
+                  outL[k]  = 0.0;
+                  outR[k]  = 0.0;
+                  }
             for (int i = 0; i < numcombs; i++) {      // Accumulate comb filters in parallel
-                  outL += combL[i].process(input);
-                  outR += combR[i].process(input);
+                  combL[i].process(m, input, outL);
+                  combR[i].process(m, input, outR);
                   }
             for (int i = 0; i < numallpasses; i++) {  // Feed through allpasses in series
-                  outL = allpassL[i].process(outL);
-                  outR = allpassR[i].process(outR);
+                  allpassL[i].process(m, outL);
+                  allpassR[i].process(m, outR);
                   }
-
-            // Remove the DC offset
-            outL -= DC_OFFSET;
-            outR -= DC_OFFSET;
-
-            *lo = *lp * dry + (outL * wet1 + outR * wet2) * wet;
-            *ro = *rp * dry + (outR * wet1 + outL * wet2) * wet;
-            lp += 2;
-            rp += 2;
-            lo += 2;
-            ro += 2;
+            for (int k = 0; k < m; k++) {
+                  // Remove the DC offset
+                  float l = outL[k] - DC_OFFSET;
+                  float r = outR[k] - DC_OFFSET;
+                  out[k * 2]     = in[k * 2] * dry + (l * wet1 + r * wet2) * wet;
+                  out[k * 2 + 1] = in[k * 2 + 1] * dry + (r * wet1 + l * wet2) * wet;
+                  }
+            in  += m * 2;
+            out += m * 2;
+            n   -= m;
             }
       }
 
@@ -274,3 +368,4 @@ const std::vector<ParDescr>& Freeverb::parDescr() const
       return freeverbPd;
       }
 
+}
@@ -13,8 +13,7 @@
 
 #include "effects/effect.h"
 
-static const int numcombs = 8;
-static const int numallpasses = 4;
+namespace Ms {
 
 //---------------------------------------------------------
 //   Allpass
@@ -31,13 +30,7 @@ class Allpass {
       void setfeedback(float val) { feedback = val;  }
       float getfeedback() const   { return feedback; }
 
-      float process(float _input) {
-            float bufout   = buffer[bufidx];
-            float output   = bufout - _input;
-            buffer[bufidx] = _input + (bufout * feedback);
-            ++bufidx      %= bufsize;
-            return output;
-            }
+      void process(int n, float* x);
       };
 
 //---------------------------------------------------------
@@ -60,13 +53,7 @@ class Comb {
       void setfeedback(float val) { feedback = val;  }
       float getfeedback() const   { return feedback; }
 
-      float process(float input) {
-            float tmp      = buffer[bufidx];
-            filterstore    = (tmp * damp2) + (filterstore * damp1);
-            buffer[bufidx] = input + (filterstore * feedback);
-            ++bufidx      %= bufsize;
-            return tmp;
-            }
+      void process(int n, const float* in, float* out);
       };
 
 //---------------------------------------------------------
@@ -76,6 +63,10 @@ class Comb {
 class Freeverb : public Effect {
       //Q_OBJECT
 
+      static const int numcombs     = 8;
+      static const int numallpasses = 4;
+      static const int blocksize    = 128;    // frames processed by one pass of the filters
+
       float roomsize, damp, width, sendLevel, wet;
       float newRoomsize, newDamp, newWidth, newSendLevel, newWet;
       float wet1, wet2;
@@ -102,4 +93,5 @@ class Freeverb : public Effect {
       virtual const std::vector<ParDescr>& parDescr() const;
       };
 
+}
 #endif
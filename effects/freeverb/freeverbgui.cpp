@@ -13,15 +13,76 @@
 #include "freeverb.h"
 #include "effects/effectgui.h"
 
+namespace Ms {
+
+//---------------------------------------------------------
+//   FreeverbGui
+//    one slider for every parameter, 0 - 100 for the
+//    range of the parameter
+//---------------------------------------------------------
+
+class FreeverbGui : public EffectGui {
+      Q_OBJECT
+
+      std::vector<QSlider*> sliders;
+
+      virtual void updateValues();
+
+   public:
+      FreeverbGui(Freeverb*, QWidget* parent = 0);
+      };
+
 //---------------------------------------------------------
 //   gui
 //---------------------------------------------------------
 
 EffectGui* Freeverb::gui()
       {
-      EffectGui* eg = new EffectGui(this);
-      QUrl url("qrc:/freeverb/freeverb.qml");
-      eg->init(url);
-      return eg;
+      if (!_gui) {
+            _gui = new FreeverbGui(this);
+            _gui->setGeometry(0, 0, 644, 79);
+            }
+      return _gui;
+      }
+
+//---------------------------------------------------------
+//   FreeverbGui
+//---------------------------------------------------------
+
+FreeverbGui::FreeverbGui(Freeverb* effect, QWidget* parent)
+   : EffectGui(effect, parent)
+      {
+      QGridLayout* la = new QGridLayout;
+      for (const ParDescr& pd : effect->parDescr()) {
+            QSlider* s = new QSlider(Qt::Horizontal);
+            s->setRange(0, 100);
+            la->addWidget(new QLabel(tr(pd.name)), pd.id % 3, (pd.id / 3) * 2);
+            la->addWidget(s, pd.id % 3, (pd.id / 3) * 2 + 1);
+            connect(s, &QSlider::valueChanged, [this, pd](int val) {
+                  valueChanged(pd.min + (pd.max - pd.min) * val / 100.0, pd.id);
+                  });
+            sliders.push_back(s);
+            }
+      setLayout(la);
+      updateValues();
       }
 
+//---------------------------------------------------------
+//   updateValues
+//---------------------------------------------------------
+
+void FreeverbGui::updateValues()
+      {
+      const std::vector<ParDescr>& pd = effect()->parDescr();
+      for (unsigned i = 0; i < pd.size(); ++i) {
+            qreal val = (effect()->nvalue(pd[i].id) - pd[i].min) / (pd[i].max - pd[i].min);
+            sliders[i]->blockSignals(true);
+            sliders[i]->setValue(lrint(val * 100.0));
+            sliders[i]->blockSignals(false);
+            }
+      }
+
+#include "freeverbgui.moc"
+
+}
+
@@ -17,8 +17,13 @@
 // -----------------------------------------------------------------------
 
 #include <math.h>
+#include "config.h"
 #include "zita.h"
 
+#if defined(USE_SSE) && defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 namespace Ms {
 
 enum {
@@ -233,6 +238,41 @@ void Diff1::fini()
       _line = 0;
       }
 
+//---------------------------------------------------------
+//   process
+//    n must not exceed the line size, every sample read
+//    was written before this block
+//---------------------------------------------------------
+
+void Diff1::process(int n, float* x)
+      {
+      while (n > 0) {
+            int m    = qMin(n, _size - _i);
+            float* l = _line + _i;
+            int k    = 0;
+#if defined(USE_SSE) && defined(__SSE2__)
+            const __m128 c = _mm_set1_ps(_c);
+            for (; k + 4 <= m; k += 4) {
+                  __m128 z = _mm_loadu_ps(l + k);
+                  __m128 v = _mm_sub_ps(_mm_loadu_ps(x + k), _mm_mul_ps(c, z));
+                  _mm_storeu_ps(l + k, v);
+                  _mm_storeu_ps(x + k, _mm_add_ps(z, _mm_mul_ps(c, v)));
+                  }
+#endif
+            for (; k < m; ++k) {
+                  float z = l[k];
+                  float v = x[k] - _c * z;
+                  l[k]    = v;
+                  x[k]    = z + _c * v;
+                  }
+            x  += m;
+            n  -= m;
+            _i += m;
+            if (_i == _size)
+                  _i = 0;
+            }
+      }
+
 Delay::Delay()
    : _size (0), _line (0)
       {
@@ -258,6 +298,28 @@ void Delay::fini ()
       _line = 0;
       }
 
+//---------------------------------------------------------
+//   read
+//    the next n samples; they are replaced by write()
+//---------------------------------------------------------
+
+void Delay::read (int n, float* y) const
+      {
+      int m = qMin(n, _size - _i);
+      memcpy (y, _line + _i, m * sizeof (float));
+      memcpy (y + m, _line, (n - m) * sizeof (float));
+      }
+
+void Delay::write (int n, const float* x)
+      {
+      int m = qMin(n, _size - _i);
+      memcpy (_line + _i, x, m * sizeof (float));
+      memcpy (_line, x + m, (n - m) * sizeof (float));
+      _i += n;
+      if (_i >= _size)
+            _i -= _size;
+      }
+
 Vdelay::Vdelay ()
    : _size (0), _line (0)
       {
@@ -284,6 +346,34 @@ void Vdelay::fini ()
       _line = 0;
       }
 
+//---------------------------------------------------------
+//   read
+//---------------------------------------------------------
+
+void Vdelay::read (int n, float* y)
+      {
+      int m = qMin(n, _size - _ir);
+      memcpy (y, _line + _ir, m * sizeof (float));
+      memcpy (y + m, _line, (n - m) * sizeof (float));
+      _ir += n;
+      if (_ir >= _size)
+            _ir -= _size;
+      }
+
+//---------------------------------------------------------
+//   write
+//    every step'th sample of x
+//---------------------------------------------------------
+
+void Vdelay::write (int n, const float* x, int step)
+      {
+      for (int k = 0; k < n; ++k) {
+            _line [_iw++] = x [k * step];
+            if (_iw == _size)
+                  _iw = 0;
+            }
+      }
+
 void Vdelay::set_delay (int del)
       {
       _ir = _iw - del;
@@ -422,29 +512,95 @@ void ZitaReverb::process (int nfram, float* inp, float* out)
       {
       prepare(2048);
 
-      float t, g, x0, x1, x2, x3, x4, x5, x6, x7;
-      g = sqrtf (0.125f);
-
-      float* p0 = inp;
-      float* p1 = inp + 1;
-      float* q0 = out;
-      float* q1 = out + 1;
-
-      for (int i = 0; i < nfram * 2; i += 2) {
-            _vdelay0.write (p0 [i]);
-            _vdelay1.write (p1 [i]);
-
-            t = 0.3f * _vdelay0.read ();
-            x0 = _diff1 [0].process (_delay [0].read () + t);
-            x1 = _diff1 [1].process (_delay [1].read () + t);
-            x2 = _diff1 [2].process (_delay [2].read () - t);
-            x3 = _diff1 [3].process (_delay [3].read () - t);
-            t = 0.3f * _vdelay1.read ();
-            x4 = _diff1 [4].process (_delay [4].read () + t);
-            x5 = _diff1 [5].process (_delay [5].read () + t);
-            x6 = _diff1 [6].process (_delay [6].read () - t);
-            x7 = _diff1 [7].process (_delay [7].read () - t);
+      for (int i = 0; i < nfram; i += ZITA_BLOCK)
+            process1 (qMin(nfram - i, ZITA_BLOCK), inp + i * 2, out + i * 2);
+
+      _pareq1.process (nfram, out);
+      _pareq2.process (nfram, out);
+
+      for (int i = 0; i < nfram; i++) {
+            *out++ += _g0 * *inp++;
+            *out++ += _g0 * *inp++;
+            _g0 += _d0;
+            }
+      }
+
+//---------------------------------------------------------
+//   process1
+//    Run the feedback delay network for n <= ZITA_BLOCK
+//    frames. All delays in the loop are longer than a
+//    block, so each stage can process the whole block
+//    before the next one starts: read the delay lines,
+//    diffuse, mix, filter and write back.
+//---------------------------------------------------------
 
+void ZitaReverb::process1 (int n, const float* inp, float* out)
+      {
+      float x [8][ZITA_BLOCK];
+      float t0 [ZITA_BLOCK];
+      float t1 [ZITA_BLOCK];
+
+      _vdelay0.write (n, inp, 2);
+      _vdelay1.write (n, inp + 1, 2);
+      _vdelay0.read (n, t0);
+      _vdelay1.read (n, t1);
+
+      for (int c = 0; c < 8; c++)
+            _delay [c].read (n, x [c]);
+      for (int k = 0; k < n; k++) {
+            float a = 0.3f * t0 [k];
+            float b = 0.3f * t1 [k];
+            x [0][k] += a;
+            x [1][k] += a;
+            x [2][k] -= a;
+            x [3][k] -= a;
+            x [4][k] += b;
+            x [5][k] += b;
+            x [6][k] -= b;
+            x [7][k] -= b;
+            }
+      for (int c = 0; c < 8; c++)
+            _diff1 [c].process (n, x [c]);
+
+      // 8 point Hadamard transform
+      int k = 0;
+#if defined(USE_SSE) && defined(__SSE2__)
+      for (; k + 4 <= n; k += 4) {
+            __m128 x0 = _mm_loadu_ps(x [0] + k);
+            __m128 x1 = _mm_loadu_ps(x [1] + k);
+            __m128 x2 = _mm_loadu_ps(x [2] + k);
+            __m128 x3 = _mm_loadu_ps(x [3] + k);
+            __m128 x4 = _mm_loadu_ps(x [4] + k);
+            __m128 x5 = _mm_loadu_ps(x [5] + k);
+            __m128 x6 = _mm_loadu_ps(x [6] + k);
+            __m128 x7 = _mm_loadu_ps(x [7] + k);
+            __m128 t;
+            t = _mm_sub_ps(x0, x1); x0 = _mm_add_ps(x0, x1); x1 = t;
+            t = _mm_sub_ps(x2, x3); x2 = _mm_add_ps(x2, x3); x3 = t;
+            t = _mm_sub_ps(x4, x5); x4 = _mm_add_ps(x4, x5); x5 = t;
+            t = _mm_sub_ps(x6, x7); x6 = _mm_add_ps(x6, x7); x7 = t;
+            t = _mm_sub_ps(x0, x2); x0 = _mm_add_ps(x0, x2); x2 = t;
+            t = _mm_sub_ps(x1, x3); x1 = _mm_add_ps(x1, x3); x3 = t;
+            t = _mm_sub_ps(x4, x6); x4 = _mm_add_ps(x4, x6); x6 = t;
+            t = _mm_sub_ps(x5, x7); x5 = _mm_add_ps(x5, x7); x7 = t;
+            t = _mm_sub_ps(x0, x4); x0 = _mm_add_ps(x0, x4); x4 = t;
+            t = _mm_sub_ps(x1, x5); x1 = _mm_add_ps(x1, x5); x5 = t;
+            t = _mm_sub_ps(x2, x6); x2 = _mm_add_ps(x2, x6); x6 = t;
+            t = _mm_sub_ps(x3, x7); x3 = _mm_add_ps(x3, x7); x7 = t;
+            _mm_storeu_ps(x [0] + k, x0);
+            _mm_storeu_ps(x [1] + k, x1);
+            _mm_storeu_ps(x [2] + k, x2);
+            _mm_storeu_ps(x [3] + k, x3);
+            _mm_storeu_ps(x [4] + k, x4);
+            _mm_storeu_ps(x [5] + k, x5);
+            _mm_storeu_ps(x [6] + k, x6);
+            _mm_storeu_ps(x [7] + k, x7);
+            }
+#endif
+      for (; k < n; k++) {
+            float x0 = x [0][k], x1 = x [1][k], x2 = x [2][k], x3 = x [3][k];
+            float x4 = x [4][k], x5 = x [5][k], x6 = x [6][k], x7 = x [7][k];
+            float t;
             t = x0 - x1; x0 += x1;  x1 = t;
             t = x2 - x3; x2 += x3;  x3 = t;
             t = x4 - x5; x4 += x5;  x5 = t;
@@ -457,29 +613,20 @@ void ZitaReverb::process (int nfram, float* inp, float* out)
             t = x1 - x5; x1 += x5;  x5 = t;
             t = x2 - x6; x2 += x6;  x6 = t;
             t = x3 - x7; x3 += x7;  x7 = t;
-
-            _g1 += _d1;
-
-            q0 [i] = _g1 * (x1 + x2);
-            q1 [i] = _g1 * (x1 - x2);
-
-            _delay [0].write (_filt1 [0].process (g * x0));
-            _delay [1].write (_filt1 [1].process (g * x1));
-            _delay [2].write (_filt1 [2].process (g * x2));
-            _delay [3].write (_filt1 [3].process (g * x3));
-            _delay [4].write (_filt1 [4].process (g * x4));
-            _delay [5].write (_filt1 [5].process (g * x5));
-            _delay [6].write (_filt1 [6].process (g * x6));
-            _delay [7].write (_filt1 [7].process (g * x7));
+            x [0][k] = x0; x [1][k] = x1; x [2][k] = x2; x [3][k] = x3;
+            x [4][k] = x4; x [5][k] = x5; x [6][k] = x6; x [7][k] = x7;
             }
-      _pareq1.process (nfram, out);
-      _pareq2.process (nfram, out);
 
-      for (int i = 0; i < nfram; i++) {
-            *out++ += _g0 * *inp++;
-            *out++ += _g0 * *inp++;
-            _g0 += _d0;
+      const float g = sqrtf (0.125f);
+      for (k = 0; k < n; k++) {
+            _g1 += _d1;
+            out [k * 2]     = _g1 * (x [1][k] + x [2][k]);
+            out [k * 2 + 1] = _g1 * (x [1][k] - x [2][k]);
+            for (int c = 0; c < 8; c++)
+                  x [c][k] = _filt1 [c].process (g * x [c][k]);
             }
+      for (int c = 0; c < 8; c++)
+            _delay [c].write (n, x [c]);
       }
 
 void ZitaReverb::setNValue(int idx, double value)
@@ -25,6 +25,10 @@ namespace Ms {
 
 class EffectGui;
 
+// Frames processed by one pass of ZitaReverb::process1(). Must not
+// exceed the shortest delay line (Diff1 at 8 kHz: 108 samples).
+static const int ZITA_BLOCK = 64;
+
 //---------------------------------------------------------
 //   Pareq
 //---------------------------------------------------------
@@ -97,14 +101,7 @@ class Diff1
       void  init(int size, float c);
       void  fini();
 
-      float process(float x) {
-            float z = _line [_i];
-            x -= _c * z;
-            _line [_i] = x;
-            if (++_i == _size)
-                  _i = 0;
-            return z + _c * x;
-            }
+      void process(int n, float* x);
       };
 
 //---------------------------------------------------------
@@ -148,13 +145,8 @@ class Delay
       void  init (int size);
       void  fini ();
 
-      float read () { return _line [_i]; }
-
-      void write (float x) {
-            _line [_i++] = x;
-            if (_i == _size)
-                  _i = 0;
-            }
+      void read (int n, float* y) const;
+      void write (int n, const float* x);
       int     _i;
       int     _size;
       float  *_line;
@@ -175,18 +167,8 @@ class Vdelay
       void  fini ();
       void  set_delay (int del);
 
-      float read () {
-            float x = _line [_ir++];
-            if (_ir == _size)
-                  _ir = 0;
-            return x;
-            }
-
-      void write (float x) {
-            _line [_iw++] = x;
-            if (_iw == _size)
-                  _iw = 0;
-            }
+      void read (int n, float* y);
+      void write (int n, const float* x, int step);
       int     _ir;
       int     _iw;
       int     _size;
@@ -234,6 +216,7 @@ class ZitaReverb : public Effect
       static float _tdelay [8];
 
       void prepare(int n);
+      void process1(int n, const float* inp, float* out);
 
    public:
       ZitaReverb() : Effect() {}
@@ -99,6 +99,14 @@ void Fluid::init(float sampleRate)
 
       for (int i = 0; i < 512; i++)
             freeVoices.append(new Voice(this));
+
+      int threads = qMax(1, preferences.synthesizerThreads);
+      renderList.reserve(512);
+      workerBuffers.assign((threads - 1) * 3 * MasterSynthesizer::MAX_BUFFERSIZE, 0.0f);
+      renderPool.start(threads);
+#ifdef SOUNDFONT3
+      _sampleCache.start(preferences.soundFontCacheSize);
+#endif
       }
 
 //---------------------------------------------------------
@@ -108,6 +116,9 @@ void Fluid::init(float sampleRate)
 Fluid::~Fluid()
       {
       _state = FLUID_SYNTH_STOPPED;
+#ifdef SOUNDFONT3
+      _sampleCache.stop();
+#endif
       foreach(Voice* v, activeVoices)
             delete v;
       foreach(Voice* v, freeVoices)
@@ -124,12 +135,15 @@ Fluid::~Fluid()
 
 void Fluid::freeVoice(Voice* v)
       {
+      if (deferFree)          // called from a render worker
+            return;
       if (activeVoices.removeOne(v))
             freeVoices.append(v);
       }
 
 //---------------------------------------------------------
 //   play
+//    realtime
 //---------------------------------------------------------
 
 void Fluid::play(const PlayEvent& event)
@@ -396,11 +410,140 @@ void Fluid::update_presets()
 
 void Fluid::process(unsigned len, float* out, float* effect1, float* effect2)
       {
-      if (mutex.tryLock()) {
+      if (!beginProcess())
+            return;     // queued messages are kept until the next call
+      processMessages();
+      if (activeVoices.size() > 1 && renderPool.parallel())
+            processParallel(len, out, effect1, effect2);
+      else {
             foreach (Voice* v, activeVoices)
                   v->write(len, out, effect1, effect2);
-            mutex.unlock();
             }
+      endProcess();
+      }
+
+//---------------------------------------------------------
+//   processParallel
+//    distribute the active voices over the render pool;
+//    every worker mixes into its own buffers which are
+//    summed up afterwards
+//    realtime
+//---------------------------------------------------------
+
+void Fluid::processParallel(unsigned len, float* out, float* effect1, float* effect2)
+      {
+      renderList.clear();
+      foreach (Voice* v, activeVoices)
+            renderList.push_back(v);
+
+      int threads = renderPool.threads();
+      unsigned n  = len * 2;
+      for (int w = 1; w < threads; ++w) {
+            float* b = &workerBuffers[(w - 1) * 3 * MasterSynthesizer::MAX_BUFFERSIZE];
+            for (int i = 0; i < 3; ++i)
+                  memset(b + i * MasterSynthesizer::MAX_BUFFERSIZE, 0, n * sizeof(float));
+            }
+      renderLen    = len;
+      renderOut[0] = out;
+      renderOut[1] = effect1;
+      renderOut[2] = effect2;
+
+      deferFree = true;
+      renderPool.run(renderVoices, this, len, sample_rate);     // a miss is counted for AudioStats
+      deferFree = false;
+
+      for (int w = 1; w < threads; ++w) {
+            const float* b = &workerBuffers[(w - 1) * 3 * MasterSynthesizer::MAX_BUFFERSIZE];
+            for (int i = 0; i < 3; ++i) {
+                  float* dst       = renderOut[i];
+                  const float* src = b + i * MasterSynthesizer::MAX_BUFFERSIZE;
+                  for (unsigned k = 0; k < n; ++k)
+                        dst[k] += src[k];
+                  }
+            }
+      // free the voices which were turned off while rendering
+      for (Voice* v : renderList) {
+            if (v->status == FLUID_VOICE_OFF)
+                  freeVoice(v);
+            }
+      }
+
+//---------------------------------------------------------
+//   renderVoices
+//    render every n-th voice of renderList, starting at
+//    partition, into the buffers of worker
+//    called from RenderPool, realtime
+//---------------------------------------------------------
+
+void Fluid::renderVoices(void* data, int worker, int partition)
+      {
+      Fluid* f       = static_cast<Fluid*>(data);
+      int partitions = f->renderPool.partitions();
+      float* out[3];
+      if (worker == 0) {
+            for (int i = 0; i < 3; ++i)
+                  out[i] = f->renderOut[i];
+            }
+      else {
+            float* b = &f->workerBuffers[(worker - 1) * 3 * MasterSynthesizer::MAX_BUFFERSIZE];
+            for (int i = 0; i < 3; ++i)
+                  out[i] = b + i * MasterSynthesizer::MAX_BUFFERSIZE;
+            }
+      int n = int(f->renderList.size());
+      for (int i = partition; i < n; i += partitions)
+            f->renderList[i]->write(f->renderLen, out[0], out[1], out[2]);
+      }
+
+//---------------------------------------------------------
+//   adopt
+//    switch to the staged soundfonts; stagedFonts gets
+//    the previous list
+//    realtime
+//---------------------------------------------------------
+
+void Fluid::adopt()
+      {
+      if (stagedStop) {
+            while (!activeVoices.isEmpty())
+                  activeVoices.last()->off();
+            }
+      sfonts.swap(stagedFonts);
+      int n = sfonts.size();
+      for (int i = 0; i < n; ++i)
+            sfonts[i]->setBankOffset(stagedOffsets[i]);
+      n = channel.size();
+      for (int i = 0; i < n; ++i) {
+            if (stagedReset)
+                  channel[i]->reset();
+            program_change(i, channel[i]->getPrognum());
+            }
+      }
+
+//---------------------------------------------------------
+//   setSoundFonts
+//    hand fonts over to the audio thread and delete the
+//    fonts which are not played anymore. Voices must be
+//    stopped if a font is removed.
+//    not realtime
+//---------------------------------------------------------
+
+void Fluid::setSoundFonts(const QList<SFont*>& fonts, bool stopVoices, bool resetChannels)
+      {
+      stagedFonts = fonts;
+      updatePatchList(stagedFonts, &stagedOffsets);
+      stagedStop  = stopVoices;
+      stagedReset = resetChannels;
+      handOver();
+
+      foreach (SFont* sf, stagedFonts) {
+            if (!sfonts.contains(sf)) {
+#ifdef SOUNDFONT3
+                  _sampleCache.purge(sf);
+#endif
+                  delete sf;
+                  }
+            }
+      stagedFonts.clear();
       }
 
 /*
@@ -558,16 +701,18 @@ void Fluid::start_voice(Voice* voice)
 
 //---------------------------------------------------------
 //   updatePatchList
+//    the patches of fonts and the bank offset of every font
 //---------------------------------------------------------
 
-void Fluid::updatePatchList()
+void Fluid::updatePatchList(const QList<SFont*>& fonts, QVector<int>* bankOffsets)
       {
       qDeleteAll(patches);
       patches.clear();
+      bankOffsets->clear();
 
       int bankOffset = 0;
-      for (SFont* sf : sfonts) {
-            sf->setBankOffset(bankOffset);
+      for (SFont* sf : fonts) {
+            bankOffsets->append(bankOffset);
             int banks = 0;
             for (Preset* p : sf->getPresets()) {
                   MidiPatch* patch = new MidiPatch;
@@ -582,10 +727,6 @@ void Fluid::updatePatchList()
                   }
             bankOffset += (banks + 1);
             }
-      /* try to set the correct presets */
-      int n = channel.size();
-      for (int i = 0; i < n; i++)
-            program_change(i, channel[i]->getPrognum());
       }
 
 //---------------------------------------------------------
@@ -602,6 +743,7 @@ QStringList Fluid::soundFonts() const
 
 //---------------------------------------------------------
 //   loadSoundFont
+//    fonts which are loaded already are kept
 //    return false on error
 //---------------------------------------------------------
 
@@ -612,15 +754,8 @@ bool Fluid::loadSoundFonts(const QStringList& sl)
             qDebug("Fluid:loadSoundFonts: already loaded");
             return true;
             }
-      mutex.lock();
-      foreach(Voice* v, activeVoices)
-            v->off();
-      foreach(Channel* c, channel)
-            c->reset();
-      foreach (SFont* sf, sfonts)
-            sfunload(sf->id());
       bool ok = true;
-
+      QList<SFont*> fonts;
 
       QFileInfoList l = sfFiles();
 
@@ -640,15 +775,19 @@ bool Fluid::loadSoundFonts(const QStringList& sl)
             if (path.isEmpty()) {
                   qDebug("Fluid: sf <%s> not found", qPrintable(s));
                   ok = false;
+                  continue;
                   }
-            else {
-                  if (sfload(path) == -1) {
-                        qDebug("loading sf failed: <%s>", qPrintable(path));
-                        ok = false;
-                        }
+            SFont* sf = get_sfont_by_name(fileName);
+            if (!sf)
+                  sf = sfload(path);
+            if (!sf) {
+                  qDebug("loading sf failed: <%s>", qPrintable(path));
+                  ok = false;
                   }
+            else if (!fonts.contains(sf))
+                  fonts.prepend(sf);
             }
-      mutex.unlock();
+      setSoundFonts(fonts, true, true);
       return ok;
       }
 
@@ -659,10 +798,13 @@ bool Fluid::loadSoundFonts(const QStringList& sl)
 
 bool Fluid::addSoundFont(const QString& s)
       {
-      mutex.lock();
-      bool rv = (sfload(s) == -1) ? false : true;
-      mutex.unlock();
-      return rv;
+      SFont* sf = sfload(s);
+      if (!sf)
+            return false;
+      QList<SFont*> fonts = sfonts;
+      fonts.prepend(sf);
+      setSoundFonts(fonts, false, false);
+      return true;
       }
 
 //---------------------------------------------------------
@@ -672,67 +814,40 @@ bool Fluid::addSoundFont(const QString& s)
 
 bool Fluid::removeSoundFont(const QString& s)
       {
-      mutex.lock();
-      foreach(Voice* v, activeVoices)
-            v->off();
       SFont* sf = get_sfont_by_name(s);
-      sfunload(sf->id());
-      mutex.unlock();
+      if (!sf)
+            return false;
+      QList<SFont*> fonts = sfonts;
+      fonts.removeAll(sf);
+      setSoundFonts(fonts, true, false);
       return true;
       }
 
 //---------------------------------------------------------
 //   sfload
+//    read a soundfont; it is played once it is handed
+//    over by setSoundFonts()
 //---------------------------------------------------------
 
-int Fluid::sfload(const QString& filename)
+SFont* Fluid::sfload(const QString& filename)
       {
       if (filename.isEmpty())
-            return -1;
+            return 0;
 
       SFont* sf = new SFont(this);
       try {
             if (!sf->read(filename)) {
                   delete sf;
-                  sf = 0;
-                  return -1;
+                  return 0;
                   }
             }
       catch(...) {
             delete sf;
-            sf = 0;
-            return -1;
+            return 0;
             }
 
       sf->setId(++sfont_id);
-
-      /* insert the sfont as the first one on the list */
-      sfonts.prepend(sf);
-
-      /* reset the presets for all channels */
-
-      updatePatchList();
-      return sf->id();
-      }
-
-//---------------------------------------------------------
-//   sfunload
-//---------------------------------------------------------
-
-bool Fluid::sfunload(int id)
-      {
-      SFont* sf = get_sfont_by_id(id);
-
-      if (!sf) {
-            qDebug("No SoundFont with id = %d", id);
-            return false;
-            }
-
-      sfonts.removeAll(sf);   // remove the SoundFont from the list
-      updatePatchList();
-
-      delete sf;
-      return true;
+      return sf;
       }
 
 //---------------------------------------------------------
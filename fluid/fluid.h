@@ -22,8 +22,11 @@
 #ifndef __FLUID_S_H__
 #define __FLUID_S_H__
 
+#include <atomic>
 #include "synthesizer/synthesizer.h"
 #include "synthesizer/midipatch.h"
+#include "synthesizer/renderpool.h"
+#include "samplecache.h"
 
 namespace FluidS {
 
@@ -295,7 +298,11 @@ enum {
 //---------------------------------------------------------
 
 class Fluid : public Synthesizer {
-      QList<SFont*> sfonts;               // the loaded soundfonts
+      QList<SFont*> sfonts;               // the soundfonts played by the audio thread
+      QList<SFont*> stagedFonts;          // next soundfonts, see setSoundFonts()
+      QVector<int> stagedOffsets;         // bank offset of every staged font
+      bool stagedStop { false };          // stop all voices when adopting
+      bool stagedReset { false };         // reset all channels when adopting
       QList<MidiPatch*> patches;
 
       QList<Voice*> freeVoices;           // unused synthesis processes
@@ -308,10 +315,25 @@ class Fluid : public Synthesizer {
       float _masterTuning;                // usually 440.0
       double _tuning[128];                // the pitch of every key, in cents
 
-      QMutex mutex;
-      void updatePatchList();
+      RenderPool renderPool;              // parallel voice rendering
+      std::vector<Voice*> renderList;     // voices of the block rendered in parallel
+      std::vector<float> workerBuffers;   // out, effect1, effect2 for every worker > 0
+      unsigned renderLen;
+      float* renderOut[3];                // buffers of worker 0
+      bool deferFree { false };           // voices are freed after the parallel block
+#ifdef SOUNDFONT3
+      SampleCache _sampleCache;           // decoded samples of SF3 fonts
+#endif
+
+      static void renderVoices(void* fluid, int worker, int partition);
+      void processParallel(unsigned len, float* out, float* effect1, float* effect2);
+
+      void updatePatchList(const QList<SFont*>&, QVector<int>* bankOffsets);
+      void setSoundFonts(const QList<SFont*>&, bool stopVoices, bool resetChannels);
 
    protected:
+      virtual void adopt();
+
       int _state;                         // the synthesizer state
 
       unsigned int sfont_id;
@@ -323,8 +345,7 @@ class Fluid : public Synthesizer {
       SFont* get_sfont_by_name(const QString& name);
       SFont* get_sfont_by_id(int id);
       SFont* get_sfont(int idx) const     { return sfonts[idx];   }
-      bool sfunload(int id);
-      int sfload(const QString& filename);
+      SFont* sfload(const QString& filename);
 
    public:
       Fluid();
@@ -378,6 +399,8 @@ class Fluid : public Synthesizer {
       void free_voice_by_kill();
 
       virtual void process(unsigned len, float* out, float* effect1, float* effect2);
+      virtual int voiceCount() const      { return activeVoices.size(); }
+      virtual unsigned renderMisses() const { return renderPool.misses(); }
 
       bool program_select(int chan, unsigned sfont_id, unsigned bank_num, unsigned preset_num);
       void get_program(int chan, unsigned* sfont_id, unsigned* bank_num, unsigned* preset_num);
@@ -389,6 +412,9 @@ class Fluid : public Synthesizer {
       void get_pitch_bend(int chan, int* ppitch_bend);
 
       void freeVoice(Voice* v);
+#ifdef SOUNDFONT3
+      SampleCache* sampleCache()     { return &_sampleCache; }
+#endif
 
       double getPitch(int k) const   { return _tuning[k]; }
       float ct2hz_real(float cents)  { return powf(2.0f, (cents - 6900.0f) / 1200.0f) * _masterTuning; }
@@ -0,0 +1,240 @@
+//=============================================================================
+//  MuseScore
+//  Music Composition & Notation
+//
+//  Copyright (C) 2015 Werner Schweer
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License version 2
+//  as published by the Free Software Foundation and appearing in
+//  the file LICENCE.GPL
+//=============================================================================
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+#include "samplecache.h"
+#include "sfont.h"
+
+namespace FluidS {
+
+//---------------------------------------------------------
+//   DecodeJob
+//---------------------------------------------------------
+
+class DecodeJob : public QRunnable {
+      SampleCache* cache;
+      Sample* sample;
+
+   public:
+      DecodeJob(SampleCache* c, Sample* s) : cache(c), sample(s) {}
+      virtual void run() { cache->decode(sample); }
+      };
+
+//---------------------------------------------------------
+//   ~SampleCache
+//---------------------------------------------------------
+
+SampleCache::~SampleCache()
+      {
+      stop();
+      }
+
+//---------------------------------------------------------
+//   start
+//    budgetMB == 0 keeps all decoded samples
+//    not realtime
+//---------------------------------------------------------
+
+void SampleCache::start(int budgetMB)
+      {
+      stop();
+      _budget = qint64(qMax(0, budgetMB)) * 1024 * 1024;
+      _quit   = false;
+      dispatcher = std::thread(&SampleCache::dispatch, this);
+      }
+
+//---------------------------------------------------------
+//   stop
+//    wait for all running decoders; must be called before
+//    the SoundFonts are deleted
+//    not realtime
+//---------------------------------------------------------
+
+void SampleCache::stop()
+      {
+      if (!dispatcher.joinable())
+            return;
+      {
+      std::lock_guard<std::mutex> lock(mutex);
+      _quit = true;
+      }
+      cond.notify_all();
+      dispatcher.join();
+      pool.waitForDone();
+      }
+
+//---------------------------------------------------------
+//   dispatch
+//    dispatcher thread: move the requests of the audio
+//    thread to the decoder pool
+//---------------------------------------------------------
+
+void SampleCache::dispatch()
+      {
+      std::unique_lock<std::mutex> lock(mutex);
+      while (!_quit) {
+            while (!fifo.isEmpty())
+                  schedule(fifo.dequeue());
+            cond.wait_for(lock, std::chrono::milliseconds(POLL_MS));
+            }
+      }
+
+//---------------------------------------------------------
+//   schedule
+//    the sample may have been decoded by decodeNow() in
+//    the meantime
+//---------------------------------------------------------
+
+void SampleCache::schedule(Sample* s)
+      {
+      Sample::State st = Sample::State::QUEUED;
+      if (s->state.compare_exchange_strong(st, Sample::State::DECODING))
+            pool.start(new DecodeJob(this, s));
+      }
+
+//---------------------------------------------------------
+//   request
+//    queue an unloaded sample for decoding
+//    realtime
+//---------------------------------------------------------
+
+void SampleCache::request(Sample* s)
+      {
+      Sample::State st = Sample::State::UNLOADED;
+      if (!s->state.compare_exchange_strong(st, Sample::State::QUEUED))
+            return;
+      s->lastUse = tick();
+      if (!fifo.enqueue(s))
+            s->state = Sample::State::UNLOADED;       // try again on next note on
+      }
+
+//---------------------------------------------------------
+//   decodeNow
+//    decode in the calling thread, used for offline
+//    rendering
+//    not realtime
+//---------------------------------------------------------
+
+void SampleCache::decodeNow(Sample* s)
+      {
+      for (;;) {
+            Sample::State st = s->state;
+            if (st == Sample::State::READY || st == Sample::State::FAILED)
+                  return;
+            if ((st == Sample::State::UNLOADED || st == Sample::State::QUEUED)
+               && s->state.compare_exchange_strong(st, Sample::State::DECODING)) {
+                  decode(s);
+                  return;
+                  }
+            // decoded or evicted by another thread
+            std::this_thread::yield();
+            }
+      }
+
+//---------------------------------------------------------
+//   decode
+//    the sample is in state DECODING
+//---------------------------------------------------------
+
+void SampleCache::decode(Sample* s)
+      {
+      if (!s->decode()) {
+            s->state = Sample::State::FAILED;
+            return;
+            }
+      {
+      std::lock_guard<std::mutex> lock(mutex);
+      resident.append(s);
+      _used += s->decodedSize();
+      }
+      s->state = Sample::State::READY;
+      evict();
+      }
+
+//---------------------------------------------------------
+//   evict
+//    unload least recently used samples until the budget
+//    is met. A sample is only unloaded if no voice
+//    acquired it, see Sample::acquire().
+//---------------------------------------------------------
+
+void SampleCache::evict()
+      {
+      if (_budget == 0 || _used <= _budget)
+            return;
+      std::lock_guard<std::mutex> lock(mutex);
+
+      // the age is computed relative to the clock to survive wrap around
+      unsigned now = _clock;
+      std::vector<std::pair<unsigned, Sample*>> candidates;
+      for (Sample* s : resident) {
+            if (s->refs == 0)
+                  candidates.push_back(std::make_pair(now - s->lastUse, s));
+            }
+      std::sort(candidates.begin(), candidates.end(),
+         [](const std::pair<unsigned, Sample*>& a, const std::pair<unsigned, Sample*>& b) {
+            return a.first > b.first;
+            });
+
+      for (const std::pair<unsigned, Sample*>& c : candidates) {
+            if (_used <= _budget)
+                  break;
+            Sample* s = c.second;
+            Sample::State st = Sample::State::READY;
+            if (!s->state.compare_exchange_strong(st, Sample::State::EVICTING))
+                  continue;
+            if (s->refs) {          // a voice acquired it after the check above
+                  s->state = Sample::State::READY;
+                  continue;
+                  }
+            _used -= s->decodedSize();
+            s->unload();
+            resident.removeOne(s);
+            s->state = Sample::State::UNLOADED;
+            ++_evictions;
+            }
+      }
+
+//---------------------------------------------------------
+//   purge
+//    forget all samples of sf before it is deleted; no
+//    voice plays from sf anymore
+//    not realtime
+//---------------------------------------------------------
+
+void SampleCache::purge(SFont* sf)
+      {
+      {
+      std::lock_guard<std::mutex> lock(mutex);
+      while (!fifo.isEmpty()) {
+            Sample* s = fifo.dequeue();
+            if (s->sf == sf)
+                  s->state = Sample::State::UNLOADED;
+            else
+                  schedule(s);
+            }
+      }
+      pool.waitForDone();
+
+      std::lock_guard<std::mutex> lock(mutex);
+      for (int i = resident.size() - 1; i >= 0; --i) {
+            Sample* s = resident[i];
+            if (s->sf == sf) {
+                  _used -= s->decodedSize();
+                  resident.removeAt(i);
+                  }
+            }
+      }
+
+}
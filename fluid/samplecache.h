@@ -0,0 +1,117 @@
+//=============================================================================
+//  MuseScore
+//  Music Composition & Notation
+//
+//  Copyright (C) 2015 Werner Schweer
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License version 2
+//  as published by the Free Software Foundation and appearing in
+//  the file LICENCE.GPL
+//=============================================================================
+
+#ifndef __FLUID_SAMPLECACHE_H__
+#define __FLUID_SAMPLECACHE_H__
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include "libmscore/fifo.h"
+
+namespace FluidS {
+
+class Sample;
+class SFont;
+
+//---------------------------------------------------------
+//   SampleRequestFifo
+//    the audio thread is the only writer, the dispatcher
+//    thread of the SampleCache the only reader
+//---------------------------------------------------------
+
+static const int SAMPLE_REQUEST_FIFO_SIZE = 1024*4;
+
+class SampleRequestFifo : public Ms::FifoBase {
+      Sample* requests[SAMPLE_REQUEST_FIFO_SIZE];
+
+   public:
+      SampleRequestFifo()            { maxCount = SAMPLE_REQUEST_FIFO_SIZE; clear(); }
+      virtual ~SampleRequestFifo()   {}
+
+      bool enqueue(Sample* s) {
+            if (isFull())
+                  return false;
+            requests[widx] = s;
+            push();
+            return true;
+            }
+      Sample* dequeue() {
+            Sample* s = requests[ridx];
+            pop();
+            return s;
+            }
+      };
+
+//---------------------------------------------------------
+//   SampleCache
+//    decodes the Ogg Vorbis compressed samples of SF3
+//    fonts on a thread pool and keeps at most budget
+//    bytes of decoded data.
+//
+//    Decoding is requested from the audio thread by
+//    Preset::loadSamples() (program change) and by a note
+//    on for a sample which is not ready; the note is
+//    skipped in this case. If the budget is exceeded the
+//    least recently used samples which are not played by
+//    any voice are evicted.
+//---------------------------------------------------------
+
+class SampleCache {
+      static const int POLL_MS = 5;       // dispatcher polls the request fifo
+
+      SampleRequestFifo fifo;
+      QList<Sample*> resident;            // decoded samples, candidates for eviction
+      std::atomic<qint64> _used { 0 };    // bytes of decoded sample data
+      qint64 _budget { 0 };               // 0: unlimited
+
+      QThreadPool pool;
+      std::thread dispatcher;
+      std::mutex mutex;                   // protects resident
+      std::condition_variable cond;
+      bool _quit { false };
+
+      std::atomic<unsigned> _clock     { 0 };
+      std::atomic<int> _misses         { 0 };
+      std::atomic<int> _hits           { 0 };
+      std::atomic<int> _evictions      { 0 };
+
+      void dispatch();
+      void schedule(Sample*);
+      void decode(Sample*);
+      void evict();
+
+      friend class DecodeJob;
+
+   public:
+      SampleCache() {}
+      ~SampleCache();
+
+      void start(int budgetMB);
+      void stop();
+      void purge(SFont*);
+
+      void request(Sample*);
+      void decodeNow(Sample*);
+      unsigned tick()                     { return ++_clock; }
+      void hit()                          { ++_hits;   }
+      void miss()                         { ++_misses; }
+
+      int misses() const                  { return _misses;    }
+      int hits() const                    { return _hits;      }
+      int evictions() const               { return _evictions; }
+      qint64 used() const                 { return _used;      }
+      };
+
+}
+#endif
@@ -25,6 +25,11 @@
 #include "fluid.h"
 #include "voice.h"
 
+#ifdef Q_OS_UNIX
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
 // #define DEBUG_SFONT
 
 #include "libmscore/xml.h"
@@ -52,6 +57,7 @@ SFont::SFont(Fluid* f)
       synth       = f;
       samplepos   = 0;
       samplesize  = 0;
+      _sampleData = 0;
       _bankOffset = 0;
       }
 
@@ -68,6 +74,8 @@ SFont::~SFont()
 //                  delete z;
             delete i;
             }
+      if (_sampleData)
+            f.unmap(_sampleData);
       }
 
 //---------------------------------------------------------
@@ -89,9 +97,51 @@ bool SFont::read(const QString& s)
             if (!p->importSfont())
                   return false;
             }
+      mapSampleData();
       return true;
       }
 
+//---------------------------------------------------------
+//   mapSampleData
+//    map the sample chunk of uncompressed SoundFonts into
+//    memory; samples then point directly into the mapping
+//    and pages are read on demand. The file stays open as
+//    long as the SoundFont is loaded.
+//
+//    The kernel is asked to read the first frames of every
+//    sample ahead so the attack of the first note does not
+//    wait for the disk; this is done here and not in
+//    Sample::load(), which runs on the audio thread.
+//---------------------------------------------------------
+
+void SFont::mapSampleData()
+      {
+      if (_version.major >= 3 || samplesize == 0)     // sf3: compressed samples
+            return;
+      if (QSysInfo::ByteOrder == QSysInfo::BigEndian)  // samples need byte swapping
+            return;
+      if (!f.open(QIODevice::ReadOnly))
+            return;
+      _sampleData = f.map(samplepos, samplesize);
+      if (!_sampleData) {
+            qDebug("fluid: cannot map sample data of <%s>, reading samples", qPrintable(f.fileName()));
+            f.close();
+            return;
+            }
+#ifdef Q_OS_UNIX
+      static const unsigned HEAD_FRAMES = 16384;
+      const uintptr_t pageSize = sysconf(_SC_PAGESIZE);
+      const short* sd = (const short*)_sampleData;
+      for (const Sample* s : sample) {
+            if (s->start > s->end || s->end * sizeof(short) > samplesize)
+                  continue;
+            uintptr_t a = uintptr_t(sd + s->start) & ~(pageSize - 1);
+            uintptr_t e = uintptr_t(sd + qMin(s->end, s->start + HEAD_FRAMES));
+            posix_madvise((void*)a, e - a, POSIX_MADV_WILLNEED);
+            }
+#endif
+      }
+
 //---------------------------------------------------------
 //   get_preset
 //---------------------------------------------------------
@@ -186,12 +236,19 @@ bool Preset::noteon(Fluid* synth, unsigned id, int chan, int key, int vel, doubl
                            instrument */
                         if (inst_zone->inside_range(key, vel) && (sample != 0)) {
 
+                              // a compressed sample which is not decoded yet
+                              // is skipped, the note stays silent
+                              if (!sample->acquire())
+                                    continue;
+
                               /* this is a good zone. allocate a new synthesis process and
-                                 initialize it */
+                                 initialize it; the voice releases the sample */
 
                               Voice* voice = synth->alloc_voice(id, sample, chan, key, vel, nt);
-                              if (voice == 0)
+                              if (voice == 0) {
+                                    sample->release();
                                     return false;
+                                    }
 
                               /* Instrumentrument level, generators */
 
@@ -586,6 +643,11 @@ Sample::Sample(SFont* s)
       pitchadj    = 0;
       sampletype  = 0;
       data        = 0;
+      _mapped     = false;
+#ifdef SOUNDFONT3
+      oggStart    = 0;
+      oggSize     = 0;
+#endif
       amplitude_that_reaches_noise_floor_is_valid = false;
       amplitude_that_reaches_noise_floor = 0.0;
       }
@@ -596,7 +658,8 @@ Sample::Sample(SFont* s)
 
 Sample::~Sample()
       {
-      delete[] data;
+      if (!_mapped)
+            delete[] data;
       }
 
 //---------------------------------------------------------
@@ -605,60 +668,111 @@ Sample::~Sample()
 
 void Sample::load()
       {
-      if (!_valid || data)
+      if (!_valid)
             return;
-      QFile fd(sf->get_name());
-      if (!fd.open(QIODevice::ReadOnly))
-            return;
-      if (sampletype & FLUID_SAMPLETYPE_OGG_VORBIS) {
-            if (!fd.seek(sf->samplePos() + start))
-                  return;
-            }
-      else {
-            if (!fd.seek(sf->samplePos() + start * sizeof(short)))
-                  return;
-            }
-      unsigned int size = end - start;
-
       if (sampletype & FLUID_SAMPLETYPE_OGG_VORBIS) {
 #ifdef SOUNDFONT3
-            char* p = new char[size];
-            if (fd.read(p, size) != size) {
-                  printf("  read %d failed\n", size);
-                  delete[] p;
-                  return;
-                  }
-            decompressOggVorbis(p, size);
-            delete[] p;
+            // decoded in the background
+            sf->synth->sampleCache()->request(this);
 #endif
+            return;
             }
-      else {
-            data = new short[size];
-            size *= sizeof(short);
-
-            if (fd.read((char*)data, size) != size)
-                  return;
-
-            if (QSysInfo::ByteOrder == QSysInfo::BigEndian) {
-                  unsigned char hi, lo;
-                  unsigned int i, j;
-                  short s;
-                  uchar* cbuf = (uchar*) data;
-                  for (i = 0, j = 0; j < size; i++) {
-                        lo = cbuf[j++];
-                        hi = cbuf[j++];
-                        s = (hi << 8) | lo;
-                        data[i] = s;
-                        }
-                  }
+      if (data)
+            return;
+      const uchar* sd = sf->sampleData();
+      if (sd && start <= end && end * sizeof(short) <= sf->getSamplesize()) {
+            //
+            // zero copy: point into the mapped sample chunk
+            //
+            data    = (short*)(sd) + start;
+            _mapped = true;           // pages were hinted in SFont::mapSampleData()
             end       -= (start + 1);       // marks last sample, contrary to SF spec.
             loopstart -= start;
             loopend   -= start;
             start      = 0;
+            optimize();
+            return;
             }
+      QFile fd(sf->get_name());
+      if (!fd.open(QIODevice::ReadOnly))
+            return;
+      if (!fd.seek(sf->samplePos() + start * sizeof(short)))
+            return;
+      unsigned int size = end - start;
+
+      data = new short[size];
+      size *= sizeof(short);
+
+      if (fd.read((char*)data, size) != size)
+            return;
+
+      if (QSysInfo::ByteOrder == QSysInfo::BigEndian) {
+            unsigned char hi, lo;
+            unsigned int i, j;
+            short s;
+            uchar* cbuf = (uchar*) data;
+            for (i = 0, j = 0; j < size; i++) {
+                  lo = cbuf[j++];
+                  hi = cbuf[j++];
+                  s = (hi << 8) | lo;
+                  data[i] = s;
+                  }
+            }
+      end       -= (start + 1);       // marks last sample, contrary to SF spec.
+      loopstart -= start;
+      loopend   -= start;
+      start      = 0;
       optimize();
       }
 
+//---------------------------------------------------------
+//   acquire
+//    called for every new voice; returns false if the
+//    sample data are not available (yet). A successful
+//    acquire() must be paired with release().
+//    realtime
+//---------------------------------------------------------
+
+bool Sample::acquire()
+      {
+#ifdef SOUNDFONT3
+      if (sampletype & FLUID_SAMPLETYPE_OGG_VORBIS) {
+            SampleCache* cache = sf->synth->sampleCache();
+            // the reference has to be taken before the state is
+            // checked, SampleCache::evict() does it the other way round
+            ++refs;
+            if (state == State::READY) {
+                  lastUse = cache->tick();
+                  cache->hit();
+                  return true;
+                  }
+            --refs;
+            cache->miss();
+            if (sf->synth->realtime()) {
+                  cache->request(this);
+                  return false;
+                  }
+            cache->decodeNow(this);
+            if (state == State::FAILED)
+                  return false;
+            return acquire();
+            }
+#endif
+      return true;
+      }
+
+//---------------------------------------------------------
+//   release
+//---------------------------------------------------------
+
+void Sample::release()
+      {
+#ifdef SOUNDFONT3
+      if (sampletype & FLUID_SAMPLETYPE_OGG_VORBIS)
+            --refs;
+#endif
+      }
+
 //---------------------------------------------------------
 //   inRom
 //---------------------------------------------------------
@@ -1621,6 +1735,11 @@ void SFont::load_shdr (int size)
                   }
             p->setValid(true);
             if (p->sampletype & FLUID_SAMPLETYPE_OGG_VORBIS) {
+#ifdef SOUNDFONT3
+                  // start and end are rewritten by the decoder
+                  p->oggStart = p->start;
+                  p->oggSize  = p->end - p->start;
+#endif
                   }
             else {
                   // loop is fowled?? (cluck cluck :)
@@ -54,6 +54,7 @@ class SFont {
       QFile f;
       unsigned samplepos;           // the position in the file at which the sample data starts
       unsigned samplesize;          // the size of the sample data
+      uchar* _sampleData;           // memory mapped sample chunk, 0 if not mapped
 
       QList<Instrument*> instruments;
       QList<Preset*> presets;
@@ -98,6 +99,7 @@ class SFont {
       void safe_fread(void *buf, int count);
       void safe_fseek(long ofs);
       bool load();
+      void mapSampleData();
 
    public:
       SFont(Fluid* f);
@@ -115,6 +117,7 @@ class SFont {
       void setSamplepos(unsigned v)             { samplepos = v; }
       void setSamplesize(unsigned v)            { samplesize = v; }
       unsigned getSamplesize() const            { return samplesize; }
+      const uchar* sampleData() const           { return _sampleData; }
       const QList<Preset*> getPresets() const   { return presets; }
       SFVersion version() const                 { return _version; }
       int bankOffset() const                    { return _bankOffset; }
@@ -128,6 +131,7 @@ class SFont {
 
 class Sample {
       bool _valid;
+      bool _mapped;                 // data points into the mapped SoundFont
 
    public:
       SFont* sf;
@@ -156,10 +160,23 @@ class Sample {
       bool inRom() const;
       void optimize();
       void load();
+      bool acquire();
+      void release();
       bool valid() const    { return _valid; }
       void setValid(bool v) { _valid = v; }
 #ifdef SOUNDFONT3
+      // compressed samples are decoded by the SampleCache
+      enum class State : char { UNLOADED, QUEUED, DECODING, READY, EVICTING, FAILED };
+      std::atomic<State> state       { State::UNLOADED };
+      std::atomic<int> refs          { 0 };     // voices playing this sample
+      std::atomic<unsigned> lastUse  { 0 };     // SampleCache clock
+      unsigned int oggStart;                    // compressed data in the sample chunk
+      unsigned int oggSize;
+
       bool decompressOggVorbis(char* p, int size);
+      bool decode();
+      void unload();
+      qint64 decodedSize() const { return qint64(end + 1) * sizeof(short); }
 #endif
       };
 
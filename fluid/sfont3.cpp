@@ -2,6 +2,7 @@
 #include <stdlib.h>
 #include <math.h>
 #include "sfont.h"
+#include "fluid.h"
 #include "audiofile/audiofile.h"
 
 namespace FluidS {
@@ -48,4 +49,37 @@ bool Sample::decompressOggVorbis(char* src, int size)
 
       return true;
       }
+
+//---------------------------------------------------------
+//   decode
+//    read and decompress the sample data
+//    not realtime
+//---------------------------------------------------------
+
+bool Sample::decode()
+      {
+      QFile fd(sf->get_name());
+      if (!fd.open(QIODevice::ReadOnly) || !fd.seek(sf->samplePos() + oggStart))
+            return false;
+      QByteArray ba = fd.read(oggSize);
+      if (ba.size() != int(oggSize)) {
+            qDebug("Sample::decode: read %d failed", oggSize);
+            return false;
+            }
+      if (!decompressOggVorbis(ba.data(), ba.size()) || !data)
+            return false;
+      optimize();
+      return true;
+      }
+
+//---------------------------------------------------------
+//   unload
+//    free the decoded data, called by SampleCache::evict()
+//---------------------------------------------------------
+
+void Sample::unload()
+      {
+      delete[] data;
+      data = 0;
+      }
 } // namespace
@@ -1342,6 +1342,10 @@ void Voice::off()
       modenv_section = FLUID_VOICE_ENVFINISHED;
       modenv_count   = 0;
       status         = FLUID_VOICE_OFF;
+      if (sample) {           // acquired in Preset::noteon()
+            sample->release();
+            sample = 0;
+            }
       _fluid->freeVoice(this);
       }
 
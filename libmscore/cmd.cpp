@@ -87,6 +87,8 @@ void Score::startCmd()
       {
       if (MScore::debugMode)
             qDebug("===startCmd()");
+      waitForBackgroundSave();
+      loadExcerpts();         // linked elements and staves must be complete
       _layoutAll = true;      ///< do a complete relayout
       _playNote = false;
 
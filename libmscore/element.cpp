@@ -653,7 +653,7 @@ bool Element::intersects(const QRectF& rr) const
 void Element::writeProperties(Xml& xml) const
       {
       //copy paste should not keep links
-      if (_links && (_links->size() > 1) && !xml.clipboardmode)
+      if (_links && (_links->size() > 1 || _links->pendingParts()) && !xml.clipboardmode)
             xml.tag("lid", _links->lid());
       if (!userOff().isNull()) {
             if (type() == Element::Type::VOLTA_SEGMENT
@@ -702,6 +702,10 @@ bool Element::readProperties(XmlReader& e)
             _userOff = e.readPoint();
       else if (tag == "lid") {
             int id = e.readInt();
+            if (e.deferLinks()) {
+                  e.addLinkId(id, this);
+                  return true;
+                  }
             _links = score()->links().value(id);
             if (!_links) {
                   if (score()->parentScore())   // DEBUG
@@ -70,6 +70,102 @@ void Excerpt::read(XmlReader& e)
             _title = name.trimmed();
       }
 
+//---------------------------------------------------------
+//   takePendingData
+//---------------------------------------------------------
+
+QByteArray Excerpt::takePendingData() const
+      {
+      QByteArray d;
+      d.swap(_data);
+      return d;
+      }
+
+//---------------------------------------------------------
+//   addPendingLink
+//    le has an element in the part score which is not
+//    read yet
+//---------------------------------------------------------
+
+void Excerpt::addPendingLink(LinkedElements* le)
+      {
+      le->addPendingPart();
+      _links.append(le);
+      }
+
+//---------------------------------------------------------
+//   addPendingStaff
+//    the part score which is not read yet has a staff
+//    linked to s, the staff idx of the main score
+//---------------------------------------------------------
+
+void Excerpt::addPendingStaff(int idx, Staff* s)
+      {
+      if (_linkedStaves.contains(idx))
+            return;
+      _linkedStaves.insert(idx, s);
+      }
+
+//---------------------------------------------------------
+//   hasPendingLink
+//---------------------------------------------------------
+
+bool Excerpt::hasPendingLink(const LinkedElements* le) const
+      {
+      return le && _links.contains(const_cast<LinkedElements*>(le));
+      }
+
+//---------------------------------------------------------
+//   releasePendingLinks
+//    called before the part score is read; the staves are
+//    kept for Score::attachExcerpt()
+//---------------------------------------------------------
+
+void Excerpt::releasePendingLinks()
+      {
+      for (LinkedElements* le : _links)
+            le->removePendingPart();
+      _links.clear();
+      }
+
+//---------------------------------------------------------
+//   pendingWritable
+//    the xml of a pending part score can be written as
+//    is while the staves it links to keep their index
+//---------------------------------------------------------
+
+bool Excerpt::pendingWritable() const
+      {
+      if (!pending())
+            return false;
+      for (auto i = _linkedStaves.cbegin(); i != _linkedStaves.cend(); ++i) {
+            if (_oscore->staffIdx(i.value()) != i.key())
+                  return false;
+            }
+      return true;
+      }
+
+//---------------------------------------------------------
+//   setLinkedParts
+//    the parts of the main score with staves linked to
+//    the part score
+//---------------------------------------------------------
+
+void Excerpt::setLinkedParts()
+      {
+      foreach (Staff* s, _partScore->staves()) {
+            LinkedStaves* ls = s->linkedStaves();
+            if (ls == 0)
+                  continue;
+            foreach (Staff* ps, ls->staves()) {
+                  if (ps->score() == _oscore) {
+                        _parts.append(ps->part());
+                        break;
+                        }
+                  }
+            }
+      }
+
 //---------------------------------------------------------
 //   operator!=
 //---------------------------------------------------------
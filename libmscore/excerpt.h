@@ -20,6 +20,7 @@ class Part;
 class Xml;
 class Staff;
 class XmlReader;
+class LinkedElements;
 
 //---------------------------------------------------------
 //   @@ Excerpt
@@ -36,6 +37,9 @@ class Excerpt : public QObject {
       Score* _partScore  { 0 };
       QString _title;
       QList<Part*> _parts;
+      mutable QByteArray _data;     // xml of a part score which is not read yet
+      QList<LinkedElements*> _links;      // links with elements in _data
+      QMap<int, Staff*> _linkedStaves;    // main score staves by their index in _data
 
    public:
       Excerpt(Score* s = 0)                { _oscore = s;       }
@@ -44,7 +48,19 @@ class Excerpt : public QObject {
       void setParts(const QList<Part*>& p) { _parts = p;        }
       Score* oscore() const                { return _oscore;    }
       void setPartScore(Score* s)          { _partScore = s;    }
-      Score* partScore() const             { return _partScore; }
+      Score* partScore() const             { return _partScore; }   // 0 while pending, see Score::loadExcerpt()
+
+      bool pending() const                 { return !_data.isEmpty(); }
+      void setPendingData(const QByteArray& d) { _data = d;     }
+      const QByteArray& pendingData() const    { return _data;  }
+      QByteArray takePendingData() const;
+      void addPendingLink(LinkedElements*);
+      void addPendingStaff(int idx, Staff*);
+      Staff* pendingStaff(int idx) const       { return _linkedStaves.value(idx); }
+      bool hasPendingLink(const LinkedElements* le) const;
+      void releasePendingLinks();
+      bool pendingWritable() const;
+      void setLinkedParts();
 
       void read(XmlReader&);
 
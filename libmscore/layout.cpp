@@ -1393,6 +1393,8 @@ void Score::layoutStage3()
 
 void Score::doLayout()
       {
+      waitForBackgroundSave();
+      ++_layouts;
 // printf("doLayout %p cmd %d undo empty %d\n", this, undo()->active(), undo()->isEmpty());
 
       if (!undo()->active() && !undo()->isEmpty() && !undoRedo()) {
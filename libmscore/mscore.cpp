@@ -88,7 +88,7 @@ qreal   MScore::nudgeStep10;
 qreal   MScore::nudgeStep50;
 int     MScore::defaultPlayDuration;
 // QString MScore::partStyle;
-QString MScore::lastError;
+thread_local QString MScore::lastError;
 bool    MScore::layoutDebug = false;
 int     MScore::division    = 480; // 3840;   // pulses per quarter note (PPQ) // ticks per beat
 int     MScore::sampleRate  = 44100;
@@ -96,6 +96,7 @@ int     MScore::mtcType;
 
 bool    MScore::noExcerpts = false;
 bool    MScore::noImages = false;
+int     MScore::compressionLevel = -1;
 bool    MScore::pdfPrinting = false;
 
 #ifdef SCRIPT_INTERFACE
@@ -399,7 +399,7 @@ class MScore : public QObject {
       static qreal nudgeStep10;
       static qreal nudgeStep50;
       static int defaultPlayDuration;
-      static QString lastError;
+      static thread_local QString lastError;    // part scores are read on worker threads
       static bool layoutDebug;
 
       static int division;
@@ -417,6 +417,7 @@ class MScore : public QObject {
 
       static bool noExcerpts;
       static bool noImages;
+      static int compressionLevel;        // zlib level for .mscz files, -1: default
 
       static bool pdfPrinting;
 
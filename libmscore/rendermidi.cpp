@@ -1488,25 +1488,29 @@ void Score::createPlayEvents(Chord* chord)
       // dont change event list if type is PlayEventType::User
       }
 
-void Score::createPlayEvents()
+void Score::createPlayEvents(Measure* m)
       {
       int etrack = nstaves() * VOICES;
       for (int track = 0; track < etrack; ++track) {
-            for (Measure* m = firstMeasure(); m; m = m->nextMeasure()) {
-                  // skip linked staves, except primary
-                  if (!m->score()->staff(track / VOICES)->primaryStaff())
+            // skip linked staves, except primary
+            if (!m->score()->staff(track / VOICES)->primaryStaff())
+                  continue;
+            const Segment::Type st = Segment::Type::ChordRest;
+            for (Segment* seg = m->first(st); seg; seg = seg->next(st)) {
+                  Chord* chord = static_cast<Chord*>(seg->element(track));
+                  if (chord == 0 || chord->type() != Element::Type::CHORD)
                         continue;
-                  const Segment::Type st = Segment::Type::ChordRest;
-                  for (Segment* seg = m->first(st); seg; seg = seg->next(st)) {
-                        Chord* chord = static_cast<Chord*>(seg->element(track));
-                        if (chord == 0 || chord->type() != Element::Type::CHORD)
-                              continue;
-                        createPlayEvents(chord);
-                        }
+                  createPlayEvents(chord);
                   }
             }
       }
 
+void Score::createPlayEvents()
+      {
+      for (Measure* m = firstMeasure(); m; m = m->nextMeasure())
+            createPlayEvents(m);
+      }
+
 //---------------------------------------------------------
 //   renderMetronome
 //---------------------------------------------------------
@@ -1608,5 +1612,87 @@ void Score::renderMidi(EventMap* events)
                   }
             }
       }
-}
 
+//---------------------------------------------------------
+//   renderMidiPrepare
+//    first part of renderMidi() for rendering the score in
+//    pieces with renderMidiRange(): update the score state
+//    and render the pedal events of the whole score
+//---------------------------------------------------------
+
+void Score::renderMidiPrepare(EventMap* events)
+      {
+      updateSwing();
+      updateRepeatList(MScore::playRepeats);
+      _foundPlayPosAfterRepeats = false;
+      updateChannel();
+      updateVelo();
+      renderSpanners(events, -1);
+      }
+
+//---------------------------------------------------------
+//   repeatMeasureSource
+//    return the measure a repeat measure m of repeat segment
+//    idx plays on staff: the last measure before it in play
+//    order which is no repeat measure, as in renderStaff()
+//---------------------------------------------------------
+
+Measure* Score::repeatMeasureSource(int idx, Measure* m, Staff* staff)
+      {
+      const RepeatList* rl = repeatList();
+      for (int i = idx; i >= 0; --i) {
+            const RepeatSegment* rs = rl->at(i);
+            Measure* first = tick2measure(rs->tick);
+            Measure* pm;
+            if (i == idx)
+                  pm = m == first ? 0 : m->prevMeasure();
+            else
+                  pm = tick2measure(rs->tick + rs->len - 1);
+            for (; pm; pm = pm == first ? 0 : pm->prevMeasure()) {
+                  if (!pm->isRepeatMeasure(staff))
+                        return pm;
+                  }
+            }
+      // renderStaff() plays the first measure in play order
+      return tick2measure(rl->first()->tick);
+      }
+
+//---------------------------------------------------------
+//   renderMidiRange
+//    render note, controller and metronome events of all
+//    measures starting in the unrolled range utick1 - utick2;
+//    the play events of their chords are created on the way.
+//    renderMidiPrepare() must be called first.
+//---------------------------------------------------------
+
+void Score::renderMidiRange(EventMap* events, int utick1, int utick2)
+      {
+      const RepeatList* rl = repeatList();
+      for (int idx = 0; idx < rl->size(); ++idx) {
+            const RepeatSegment* rs = rl->at(idx);
+            if (rs->utick >= utick2 || rs->utick + rs->len <= utick1)
+                  continue;
+            int startTick  = rs->tick;
+            int endTick    = startTick + rs->len;
+            int tickOffset = rs->utick - rs->tick;
+            for (Measure* m = tick2measure(qMax(startTick, utick1 - tickOffset)); m; m = m->nextMeasure()) {
+                  int utick = m->tick() + tickOffset;
+                  if (utick >= utick2)
+                        break;
+                  if (utick >= utick1) {
+                        createPlayEvents(m);
+                        foreach (Staff* staff, _staves) {
+                              Measure* pm = m->isRepeatMeasure(staff) ? repeatMeasureSource(idx, m, staff) : m;
+                              if (pm != m)
+                                    createPlayEvents(pm);
+                              collectMeasureEvents(events, pm, staff, tickOffset + m->tick() - pm->tick());
+                              }
+                        renderMetronome(events, m, m->tick(), tickOffset, false);
+                        }
+                  if (m->tick() + m->ticks() >= endTick)
+                        break;
+                  }
+            }
+      }
+
+}
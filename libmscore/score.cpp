@@ -362,6 +362,8 @@ Score::Score(const MStyle* s)
 //    _links
 //    _staffTypes
 //    _metaTags
+//  a part score read by loadExcerpts() has its own _sigmap
+//  and _tempomap until it is attached
 //
 
 Score::Score(Score* parent)
@@ -1908,7 +1910,7 @@ void Score::setTempomap(TempoMap* tm)
 
 TempoMap* Score::tempomap() const
       {
-      return rootScore()->_tempomap;
+      return _tempomap ? _tempomap : rootScore()->_tempomap;
       }
 
 //---------------------------------------------------------
@@ -1917,7 +1919,7 @@ TempoMap* Score::tempomap() const
 
 TimeSigMap* Score::sigmap() const
       {
-      return rootScore()->_sigmap;
+      return _sigmap ? _sigmap : rootScore()->_sigmap;
       }
 
 //---------------------------------------------------------
@@ -1950,17 +1952,7 @@ void Score::addExcerpt(Score* score)
       ex->setPartScore(score);
       excerpts().append(ex);
       ex->setTitle(score->name());
-      foreach(Staff* s, score->staves()) {
-            LinkedStaves* ls = s->linkedStaves();
-            if (ls == 0)
-                  continue;
-            foreach(Staff* ps, ls->staves()) {
-                  if (ps->score() == this) {
-                        ex->parts().append(ps->part());
-                        break;
-                        }
-                  }
-            }
+      ex->setLinkedParts();
       setExcerptsChanged(true);
       }
 
@@ -3313,25 +3305,29 @@ void Score::undo(UndoCommand* cmd) const
 
 //---------------------------------------------------------
 //   linkId
+//    safe on any thread; part scores read on a worker
+//    thread still collect their links in the XmlReader
 //---------------------------------------------------------
 
 int Score::linkId()
       {
-      return (rootScore()->_linkId)++;
+      return rootScore()->_linkId++;
       }
 
 // val is a used link id
 void Score::linkId(int val)
       {
-      Score* s = rootScore();
-      if (val >= s->_linkId)
-            s->_linkId = val + 1;   // update unused link id
+      std::atomic<int>& id = rootScore()->_linkId;
+      int next = id;
+      while (val >= next && !id.compare_exchange_weak(next, val + 1))
+            ;     // update unused link id
       }
 
 //---------------------------------------------------------
 //   scoreList
 //    return a list of scores containing the root score
-//    and all part scores (if there are any)
+//    and all part scores (if there are any); part scores
+//    which are not read yet are not in the list
 //---------------------------------------------------------
 
 QList<Score*> Score::scoreList()
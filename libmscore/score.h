@@ -28,6 +28,7 @@
 #include "spannermap.h"
 #include "rehearsalmark.h"
 #include <set>
+#include <atomic>
 
 class QPainter;
 
@@ -218,6 +219,18 @@ struct Layer {
       uint tags;
       };
 
+//---------------------------------------------------------
+//   MsczFile
+//    a file of a compressed score; an image is stored as
+//    png when the archive is written
+//---------------------------------------------------------
+
+struct MsczFile {
+      QString path;
+      QByteArray data;
+      QImage image;
+      };
+
 enum class PasteStatus : char {
       PS_NO_ERROR,
       NO_MIME,
@@ -298,7 +311,7 @@ class Score : public QObject, public ScoreElement {
             };
 
    private:
-      int _linkId;
+      std::atomic<int> _linkId;     ///< next unused link id; part scores may be read on worker threads
       Score* _parentScore;          // set if score is an excerpt (part)
       QList<MuseScoreView*> viewer;
 
@@ -346,6 +359,14 @@ class Score : public QObject, public ScoreElement {
       QFileInfo info;
       bool _created;          ///< file is never saved, has generated name
       QString _tmpName;       ///< auto saved with this name if not empty
+      QImage _thumbnail;      ///< last rendering of the first page
+      int _thumbnailChanges { -1 };   ///< undo()->changes() when _thumbnail was rendered
+      int _thumbnailLayouts { -1 };   ///< _layouts when _thumbnail was rendered
+      int _layouts          { 0 };    ///< number of layouts, also counts changes outside the undo stack
+      QMutex _saveMutex;
+      QWaitCondition _saveDone;
+      int _backgroundSaves  { 0 };    ///< threads reading this score in backgroundSave()
+      std::atomic<bool> _backgroundSaveAbort { true };  ///< set when the score changed since startBackgroundSave()
       QString _importedFilePath;    // file from which the score was imported, or empty
 
       // the following variables are reset on startCmd()
@@ -398,6 +419,7 @@ class Score : public QObject, public ScoreElement {
       int _mscVersion;   ///< version of current loading *.msc file
 
       QMap<int, LinkedElements*> _elinks;
+      QMap<int, LinkedElements*> _excerptLinks;   ///< links by file id for part scores not read yet
       QMap<QString, QString> _metaTags;
 
       bool _defaultsRead;            ///< defaults were read at MusicXML import, allow export of defaults in convertermode
@@ -486,9 +508,15 @@ class Score : public QObject, public ScoreElement {
       FileError loadCompressedMsc(QIODevice*, bool ignoreVersionError);
       FileError read114(XmlReader&);
       FileError read1(XmlReader&, bool ignoreVersionError);
+      bool thumbnailCurrent() const {
+            return !_thumbnail.isNull() && _thumbnailChanges == undo()->changes() && _thumbnailLayouts == _layouts;
+            }
+      void setThumbnail(const QImage&);
 
    protected:
       void createPlayEvents(Chord*);
+      void createPlayEvents(Measure*);
+      Measure* repeatMeasureSource(int idx, Measure* m, Staff* staff);
       void createGraceNotesPlayEvents(QList<Chord*> gnb, int tick, Chord* chord, int& ontime);
 
       SynthesizerState _synthesizerState;
@@ -496,6 +524,7 @@ class Score : public QObject, public ScoreElement {
    signals:
       void posChanged(POS, unsigned);
       void playlistChanged();
+      void aboutToChange();         // emitted by the root score, see waitForBackgroundSave()
 
    public:
       Score();
@@ -679,8 +708,15 @@ class Score : public QObject, public ScoreElement {
 
       bool saveFile(QFileInfo& info);
       void saveFile(QIODevice* f, bool msczFormat, bool onlySelection = false);
+      void writeFile(QIODevice* f, bool msczFormat, bool onlySelection = false, const std::atomic<bool>* abort = 0);
       void saveCompressedFile(QFileInfo&, bool onlySelection);
       void saveCompressedFile(QIODevice*, QFileInfo&, bool onlySelection);
+      QList<MsczFile> msczFiles(QFileInfo&, bool onlySelection, bool withScore = true);
+      static bool writeMscz(QIODevice*, const QList<MsczFile>&, const std::atomic<bool>* abort = 0);
+      bool startBackgroundSave();
+      bool backgroundSave(QIODevice*, const QList<MsczFile>&, const QString& path, const std::atomic<bool>* abort = 0);
+      void endBackgroundSave();
+      void waitForBackgroundSave();
       bool exportFile();
 
       void print(QPainter* printer, int page);
@@ -734,7 +770,7 @@ class Score : public QObject, public ScoreElement {
       void setAutosaveDirty(bool v)  { _autosaveDirty = v;    }
       bool autosaveDirty() const     { return _autosaveDirty; }
       bool playlistDirty()           { return _playlistDirty; }
-      void setPlaylistDirty()        { _playlistDirty = true; }
+      void setPlaylistDirty()        { if (!_playlistDirty) _playlistDirty = true; }   // see SpannerMap::setDirty()
 
       void spell();
       void spell(int startStaff, int endStaff, Segment* startSegment, Segment* endSegment);
@@ -784,6 +820,8 @@ class Score : public QObject, public ScoreElement {
       bool pasteStaff(XmlReader&, Segment* dst, int staffIdx);
       void pasteSymbols(XmlReader& e, ChordRest* dst);
       void renderMidi(EventMap* events);
+      void renderMidiPrepare(EventMap* events);
+      void renderMidiRange(EventMap* events, int utick1, int utick2);
       void renderStaff(EventMap* events, Staff*);
       void renderSpanners(EventMap* events, int staffIdx);
       int renderMetronome(EventMap* events, Measure* m, int playPos, int tickOffset, bool countIn);
@@ -938,6 +976,13 @@ class Score : public QObject, public ScoreElement {
       Score* rootScore();
       void addExcerpt(Score*);
       void removeExcerpt(Score*);
+      bool readPendingExcerpt(XmlReader&);
+      Score* startExcerpt(XmlReader&);
+      void attachExcerpt(Excerpt*, Score*, const XmlReader&);
+      void loadExcerpt(Excerpt*);
+      void loadExcerpts();
+      void loadExcerpts(const QList<Excerpt*>&);
+      void loadLinkedExcerpts(const LinkedElements*);
       void createRevision();
       QByteArray readCompressedToBuffer();
       QByteArray readToBuffer();
@@ -89,6 +89,8 @@ void ScoreElement::linkTo(ScoreElement* element)
 void ScoreElement::unlink()
       {
       if (_links) {
+            if (_links->pendingParts())   // the list may be deleted below
+                  _score->loadLinkedExcerpts(_links);
             Q_ASSERT(_links->contains(this));
             _links->removeOne(this);
 
@@ -26,13 +26,17 @@ class ScoreElement;
 //---------------------------------------------------------
 
 class LinkedElements : public QList<ScoreElement*> {
-      int _lid;         // unique id for every linked list
+      int _lid;               // unique id for every linked list
+      int _pendingParts { 0 };  // part scores not read yet with elements in this list
 
    public:
       LinkedElements(Score*);
       LinkedElements(Score*, int id);
       void setLid(Score*, int val);
-      int lid() const   { return _lid;    }
+      int lid() const           { return _lid;    }
+      int pendingParts() const  { return _pendingParts; }
+      void addPendingPart()     { ++_pendingParts; }
+      void removePendingPart()  { --_pendingParts; }
       };
 
 //---------------------------------------------------------
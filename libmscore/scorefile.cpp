@@ -42,6 +42,7 @@
 #endif
 
 #include "sig.h"
+#include "tempo.h"
 #include "undo.h"
 #include "imageStore.h"
 #include "audio.h"
@@ -52,6 +53,7 @@
 #include <windows.h>
 #include <stdio.h>
 #endif
+#include <atomic>
 
 namespace Ms {
 
@@ -221,7 +223,7 @@ void Score::write(Xml& xml, bool selectionOnly)
                   xml.tickDiff = xml.curTick;
                   xml.curTrack = staffIdx * VOICES;
                   bool writeSystemElements = staffIdx == staffStart;
-                  for (MeasureBase* m = measureStart; m != measureEnd; m = m->next())
+                  for (MeasureBase* m = measureStart; m != measureEnd && !xml.aborted(); m = m->next())
                         writeMeasure(xml, m, staffIdx, writeSystemElements);
                   xml.etag();
                   }
@@ -229,7 +231,11 @@ void Score::write(Xml& xml, bool selectionOnly)
       xml.curTrack = -1;
       if (!selectionOnly) {
             for (const Excerpt* excerpt : _excerpts) {
-                  if (excerpt->partScore() != this)
+                  if (xml.aborted())
+                        break;
+                  if (excerpt->pendingWritable())
+                        xml.writeRaw(excerpt->pendingData());     // not read yet, write it as read
+                  else if (excerpt->partScore() && excerpt->partScore() != this)  // others are read by saveFile()
                         excerpt->partScore()->write(xml, false);       // recursion
                   }
             }
@@ -471,16 +477,19 @@ void Score::saveCompressedFile(QFileInfo& info, bool onlySelection)
 
 //---------------------------------------------------------
 //   createThumbnail
+//    render the first page. The rendering is cached until
+//    the score is changed or laid out again. In the other
+//    layout modes there is no page to render, a null image
+//    is returned unless the cached rendering is current.
 //---------------------------------------------------------
 
 QImage Score::createThumbnail()
       {
-      LayoutMode layoutMode = _layoutMode;
-      if (layoutMode != LayoutMode::PAGE) {
-            startCmd();
-            ScoreElement::undoChangeProperty(P_ID::LAYOUT_MODE, QVariant(int(LayoutMode::PAGE)));
-            doLayout();
-            }
+      if (thumbnailCurrent())
+            return _thumbnail;
+      if (_layoutMode != LayoutMode::PAGE || pages().isEmpty())
+            return QImage();
+
       Page* page = pages().at(0);
       QRectF fr  = page->abbox();
       qreal mag  = 256.0 / qMax(fr.width(), fr.height());
@@ -497,11 +506,64 @@ QImage Score::createThumbnail()
       p.scale(mag, mag);
       print(&p, 0);
       p.end();
-      if (layoutMode != _layoutMode)
-            endCmd(true);       // rollback
+
+      setThumbnail(pm);
       return pm;
       }
 
+//---------------------------------------------------------
+//   setThumbnail
+//    cache the rendering of the current state of the score
+//---------------------------------------------------------
+
+void Score::setThumbnail(const QImage& pm)
+      {
+      _thumbnail        = pm;
+      _thumbnailChanges = undo()->changes();
+      _thumbnailLayouts = _layouts;
+      }
+
+//---------------------------------------------------------
+//   renderThumbnail
+//    render the first page of a page layout of the score
+//    file in data. Works on its own copy of the score and
+//    runs in another thread.
+//---------------------------------------------------------
+
+static QImage renderThumbnail(QString name, QByteArray data)
+      {
+      Score* score = new Score;
+      QBuffer buffer(&data);
+      buffer.open(QIODevice::ReadOnly);
+      QImage pm;
+      if (score->loadMsc(name, &buffer, true) == Score::FileError::FILE_NO_ERROR) {
+            score->setLayoutMode(LayoutMode::PAGE);
+            score->doLayout();
+            pm = score->createThumbnail();
+            }
+      delete score;
+      return pm;
+      }
+
+//---------------------------------------------------------
+//   addMsczFile
+//---------------------------------------------------------
+
+static void addMsczFile(MQZipWriter& uz, const MsczFile& file)
+      {
+      if (file.image.isNull()) {
+            uz.addFile(file.path, file.data);
+            return;
+            }
+      QByteArray ba;
+      QBuffer b(&ba);
+      if (!b.open(QIODevice::WriteOnly))
+            qDebug("open buffer failed");
+      if (!file.image.save(&b, "PNG"))
+            throw(QString("save file: cannot save image (%1x%2)").arg(file.image.width()).arg(file.image.height()));
+      uz.addFile(file.path, ba);
+      }
+
 //---------------------------------------------------------
 //   saveCompressedFile
 //    file is already opened
@@ -510,6 +572,46 @@ QImage Score::createThumbnail()
 void Score::saveCompressedFile(QIODevice* f, QFileInfo& info, bool onlySelection)
       {
       MQZipWriter uz(f);
+      uz.setCompressionPolicy(MQZipWriter::AutoCompress);
+      uz.setCompressionLevel(MScore::compressionLevel);
+      QString fn = info.completeBaseName() + ".mscx";
+      if (_layoutMode == LayoutMode::PAGE || thumbnailCurrent()) {
+            for (const MsczFile& file : msczFiles(info, onlySelection, false))
+                  addMsczFile(uz, file);
+            // serialize the score directly into the archive
+            saveFile(uz.openFile(fn), true, onlySelection);
+            }
+      else {
+            // not laid out in pages: the thumbnail is rendered from
+            // a page layout of the written score in another thread
+            // while the other files are compressed
+            QBuffer dbuf;
+            dbuf.open(QIODevice::ReadWrite);
+            saveFile(&dbuf, true, onlySelection);
+            QFuture<QImage> thumbnail = QtConcurrent::run(renderThumbnail, fn, dbuf.data());
+            uz.addFile(fn, dbuf.data());
+            for (const MsczFile& file : msczFiles(info, onlySelection, false))
+                  addMsczFile(uz, file);
+            QImage pm = thumbnail.result();
+            if (!pm.isNull()) {
+                  setThumbnail(pm);
+                  addMsczFile(uz, { "Thumbnails/thumbnail.png", QByteArray(), pm });
+                  }
+            }
+      uz.close();
+      }
+
+//---------------------------------------------------------
+//   msczFiles
+//    collect the contents of a compressed score. The
+//    result does not refer to the score anymore and can
+//    be written by writeMscz() in another thread.
+//    Without withScore the score itself is left out.
+//---------------------------------------------------------
+
+QList<MsczFile> Score::msczFiles(QFileInfo& info, bool onlySelection, bool withScore)
+      {
+      QList<MsczFile> files;
 
       QString fn = info.completeBaseName() + ".mscx";
       QBuffer cbuf;
@@ -531,7 +633,7 @@ void Score::saveCompressedFile(QIODevice* f, QFileInfo& info, bool onlySelection
       xml.etag();
       cbuf.seek(0);
       //uz.addDirectory("META-INF");
-      uz.addFile("META-INF/container.xml", cbuf.data());
+      files.append({ "META-INF/container.xml", cbuf.data(), QImage() });
 
       // save images
       //uz.addDirectory("Pictures");
@@ -539,19 +641,13 @@ void Score::saveCompressedFile(QIODevice* f, QFileInfo& info, bool onlySelection
             if (!ip->isUsed(this))
                   continue;
             QString path = QString("Pictures/") + ip->hashName();
-            uz.addFile(path, ip->buffer());
+            files.append({ path, ip->buffer(), QImage() });
             }
 
       // create thumbnail
-      QImage pm = createThumbnail();
-
-      QByteArray ba;
-      QBuffer b(&ba);
-      if (!b.open(QIODevice::WriteOnly))
-            qDebug("open buffer failed");
-      if (!pm.save(&b, "PNG"))
-            qDebug("save failed");
-      uz.addFile("Thumbnails/thumbnail.png", ba);
+      QImage thumbnail = createThumbnail();
+      if (!thumbnail.isNull())
+            files.append({ "Thumbnails/thumbnail.png", QByteArray(), thumbnail });
 
 #ifdef OMR
       //
@@ -561,13 +657,8 @@ void Score::saveCompressedFile(QIODevice* f, QFileInfo& info, bool onlySelection
             int n = _omr->numPages();
             for (int i = 0; i < n; ++i) {
                   QString path = QString("OmrPages/page%1.png").arg(i+1);
-                  QBuffer cbuf;
                   OmrPage* page = _omr->page(i);
-                  const QImage& image = page->image();
-                  if (!image.save(&cbuf, "PNG"))
-                        throw(QString("save file: cannot save image (%1x%2)").arg(image.width()).arg(image.height()));
-                  uz.addFile(path, cbuf.data());
-                  cbuf.close();
+                  files.append({ path, QByteArray(), page->image() });
                   }
             }
 #endif
@@ -575,14 +666,168 @@ void Score::saveCompressedFile(QIODevice* f, QFileInfo& info, bool onlySelection
       // save audio
       //
       if (_audio)
-            uz.addFile("audio.ogg", _audio->data());
+            files.append({ "audio.ogg", _audio->data(), QImage() });
 
+      if (!withScore)
+            return files;
       QBuffer dbuf;
       dbuf.open(QIODevice::ReadWrite);
       saveFile(&dbuf, true, onlySelection);
       dbuf.seek(0);
-      uz.addFile(fn, dbuf.data());
+      files.append({ fn, dbuf.data(), QImage() });
+      return files;
+      }
+
+//---------------------------------------------------------
+//   writeMscz
+//    write the files collected by msczFiles() into a
+//    compressed score; does not touch the score and is
+//    safe to call outside the gui thread.
+//    Returns false if abort was set.
+//---------------------------------------------------------
+
+bool Score::writeMscz(QIODevice* f, const QList<MsczFile>& files, const std::atomic<bool>* abort)
+      {
+      MQZipWriter uz(f);
+      uz.setCompressionPolicy(MQZipWriter::AutoCompress);
+      uz.setCompressionLevel(MScore::compressionLevel);
+      for (const MsczFile& file : files) {
+            if (abort && *abort)
+                  return false;
+            addMsczFile(uz, file);
+            }
       uz.close();
+      return true;
+      }
+
+extern QString revision;
+extern bool enableTestMode;
+
+//---------------------------------------------------------
+//   startBackgroundSave
+//    gui thread; prepare the score to be written by
+//    backgroundSave() in another thread. The next change
+//    aborts that, see waitForBackgroundSave().
+//    Returns false if Score::write() would change the score,
+//    it must be written on the gui thread then.
+//---------------------------------------------------------
+
+bool Score::startBackgroundSave()
+      {
+      Score* root = rootScore();
+      if (root->undo()->active())
+            return false;
+      for (const Excerpt* ex : root->_excerpts) {
+            if (ex->pending() && !ex->pendingWritable())    // saveFile() reads it
+                  return false;
+            }
+      QList<Score*> scores = root->scoreList();
+      for (Score* s : scores) {
+            if (s->styleB(StyleIdx::createMultiMeasureRests)) {
+                  for (const Part* part : s->parts()) {
+                        if (!part->show())            // write() does a layout
+                              return false;
+                        }
+                  }
+            }
+      // do here what write() would do in the other thread
+      for (Score* s : scores) {
+            if (s->styleB(StyleIdx::createMultiMeasureRests)) {
+                  for (Measure* m = s->firstMeasure(); m; m = m->nextMeasure()) {
+                        if (!m->findSegment(Segment::Type::EndBarLine, m->endTick()))
+                              m->createEndBarLines();
+                        }
+                  }
+            s->style()->chordList();      // detach the shared style data
+            }
+      if (!MScore::testMode)
+            MScore::testMode = enableTestMode;
+
+      QMutexLocker lock(&root->_saveMutex);
+      root->_backgroundSaveAbort = false;
+      return true;
+      }
+
+//---------------------------------------------------------
+//   backgroundSave
+//    write the files collected by msczFiles() and the score
+//    as path into a compressed score. Runs in another thread
+//    after startBackgroundSave(). Returns false if abort was
+//    set or the score was changed in the meantime, the
+//    output is incomplete then.
+//---------------------------------------------------------
+
+bool Score::backgroundSave(QIODevice* f, const QList<MsczFile>& files, const QString& path, const std::atomic<bool>* abort)
+      {
+      Score* root = rootScore();
+      MQZipWriter uz(f);
+      uz.setCompressionPolicy(MQZipWriter::AutoCompress);
+      uz.setCompressionLevel(MScore::compressionLevel);
+      for (const MsczFile& file : files) {
+            if ((abort && *abort) || root->_backgroundSaveAbort)
+                  return false;
+            addMsczFile(uz, file);
+            }
+      {
+      QMutexLocker lock(&root->_saveMutex);
+      if ((abort && *abort) || root->_backgroundSaveAbort)
+            return false;
+      ++root->_backgroundSaves;
+      }
+      // from here on changes wait for endBackgroundSave(),
+      // writeFile() polls the flag to keep that short
+      try {
+            root->writeFile(uz.openFile(path), true, false, &root->_backgroundSaveAbort);
+            }
+      catch (...) {
+            endBackgroundSave();
+            throw;
+            }
+      bool ok = !root->_backgroundSaveAbort;
+      endBackgroundSave();
+      if (!ok || (abort && *abort))
+            return false;
+      uz.close();
+      return true;
+      }
+
+//---------------------------------------------------------
+//   endBackgroundSave
+//    any thread; backgroundSave() has stopped reading
+//    the score
+//---------------------------------------------------------
+
+void Score::endBackgroundSave()
+      {
+      Score* root = rootScore();
+      QMutexLocker lock(&root->_saveMutex);
+      if (--root->_backgroundSaves == 0)
+            root->_saveDone.wakeAll();
+      }
+
+//---------------------------------------------------------
+//   waitForBackgroundSave
+//    gui thread; called before the score is changed.
+//    Aborts a background save of the score and waits
+//    only until it has stopped reading. The snapshot is
+//    lost, the score is marked for the next autosave.
+//    Other readers of the score in the background wait
+//    for their thread on aboutToChange().
+//---------------------------------------------------------
+
+void Score::waitForBackgroundSave()
+      {
+      Score* root = rootScore();
+      emit root->aboutToChange();
+      if (root->_backgroundSaveAbort)
+            return;
+      QMutexLocker lock(&root->_saveMutex);
+      if (!root->_backgroundSaveAbort) {
+            root->_backgroundSaveAbort = true;
+            root->setAutosaveDirty(true);
+            }
+      while (root->_backgroundSaves)
+            root->_saveDone.wait(&root->_saveMutex);
       }
 
 //---------------------------------------------------------
@@ -660,15 +905,43 @@ bool Score::saveStyle(const QString& name)
 //    return true on success
 //---------------------------------------------------------
 
-extern QString revision;
-extern bool enableTestMode;
-
 void Score::saveFile(QIODevice* f, bool msczFormat, bool onlySelection)
       {
+      waitForBackgroundSave();
+      if (!onlySelection) {
+            // part scores which cannot be written as read
+            Score* root = rootScore();
+            QList<Excerpt*> el;
+            for (Excerpt* ex : root->_excerpts) {
+                  if (ex->pending() && !ex->pendingWritable())
+                        el.append(ex);
+                  }
+            if (!el.isEmpty())
+                  root->loadExcerpts(el);
+            }
       if(!MScore::testMode)
             MScore::testMode = enableTestMode;
+      writeFile(f, msczFormat, onlySelection);
+      if (!onlySelection) {
+            //update version values for i.e. plugin access
+            _mscoreVersion = VERSION;
+            _mscoreRevision = revision.toInt();
+            _mscVersion = MSCVERSION;
+            }
+      }
+
+//---------------------------------------------------------
+//   writeFile
+//    serialize the score; unlike saveFile() it does not
+//    change the score itself. Stops early when abort is set,
+//    the output is incomplete then.
+//---------------------------------------------------------
+
+void Score::writeFile(QIODevice* f, bool msczFormat, bool onlySelection, const std::atomic<bool>* abort)
+      {
       Xml xml(f);
       xml.writeOmr = msczFormat;
+      xml.abort    = abort;
       xml.header();
       if (!MScore::testMode) {
             xml.stag("museScore version=\"" MSC_VERSION "\"");
@@ -682,12 +955,6 @@ void Score::saveFile(QIODevice* f, bool msczFormat, bool onlySelection)
       xml.etag();
       if (!parentScore())
             _revisions->write(xml);
-      if (!onlySelection) {
-            //update version values for i.e. plugin access
-            _mscoreVersion = VERSION;
-            _mscoreRevision = revision.toInt();
-            _mscVersion = MSCVERSION;
-            }
       }
 
 //---------------------------------------------------------
@@ -759,18 +1026,23 @@ Score::FileError Score::loadCompressedMsc(QIODevice* io, bool ignoreVersionError
                   }
             }
 
-      QByteArray dbuf = uz.fileData(rootfile);
-      if (dbuf.isEmpty()) {
+      // the score is inflated while it is read; dbuf keeps it
+      // for the part scores which are read later
+      QByteArray dbuf;
+      QIODevice* dev = uz.openFile(rootfile, &dbuf);
+      if (!dev || dev->atEnd()) {
 //            qDebug("root file <%s> is empty", qPrintable(rootfile));
             QList<MQZipReader::FileInfo> fil = uz.fileInfoList();
             foreach(const MQZipReader::FileInfo& fi, fil) {
                   if (fi.filePath.endsWith(".mscx")) {
-                        dbuf = uz.fileData(fi.filePath);
+                        dev = uz.openFile(fi.filePath, &dbuf);
                         break;
                         }
                   }
             }
-      XmlReader e(dbuf);
+      if (!dev)
+            return FileError::FILE_NO_ROOTFILE;
+      XmlReader e(dev, &dbuf);
       e.setDocName(info.completeBaseName());
 
       FileError retval = read1(e, ignoreVersionError);
@@ -941,9 +1213,19 @@ Score::FileError Score::read1(XmlReader& e, bool ignoreVersionError)
                   e.unknown();
             }
 
-      int id = 1;
-      foreach (LinkedElements* le, _elinks)
-            le->setLid(this, id++);
+      // part scores read later look up their links by file id;
+      // the ids are kept as long as their xml may be written as is
+      foreach (const Excerpt* ex, _excerpts) {
+            if (ex->pending()) {
+                  _excerptLinks = _elinks;
+                  break;
+                  }
+            }
+      if (_excerptLinks.isEmpty()) {
+            int id = 1;
+            foreach (LinkedElements* le, _elinks)
+                  le->setLid(this, id++);
+            }
       _elinks.clear();
 #if 0
       // check all spanners for missing end
@@ -1136,6 +1418,8 @@ bool Score::read(XmlReader& e)
             else if (tag == "Score") {          // recursion
                    if (MScore::noExcerpts)
                         e.skipCurrentElement();
+                  else if (!parentScore() && readPendingExcerpt(e))
+                        ;
                   else {
                         Score* s = new Score(this, MScore::baseStyle());
                         s->read(e);
@@ -1247,13 +1531,315 @@ bool Score::read(XmlReader& e)
             _showOmr = false;
 
       fixTicks();
-      rebuildMidiMapping();
+      if (!e.deferLinks())          // else done by attachExcerpt()
+            rebuildMidiMapping();
       updateChannel();
       createPlayEvents();
       setExcerptsChanged(false);
       return true;
       }
 
+//---------------------------------------------------------
+//   scanExcerptLinks
+//    collect the link ids and the linked main score staves
+//    of the current element
+//---------------------------------------------------------
+
+static void scanExcerptLinks(XmlReader& e, QList<int>& lids, QList<int>& staves)
+      {
+      while (e.readNextStartElement()) {
+            const QStringRef& tag(e.name());
+            if (tag == "lid")
+                  lids.append(e.readInt());
+            else if (tag == "linkedTo")
+                  staves.append(e.readInt() - 1);
+            else
+                  scanExcerptLinks(e, lids, staves);
+            }
+      }
+
+//---------------------------------------------------------
+//   readPendingExcerpt
+//    remember the xml of a part score instead of reading
+//    it; loadExcerpt() reads it on first access. Returns
+//    false if the score is not read from memory or is
+//    from an older version, the caller reads the part
+//    score then.
+//    The main score is read at this point; the links and
+//    staves the part score refers to are remembered, so
+//    the xml can be written as is until it is read.
+//---------------------------------------------------------
+
+bool Score::readPendingExcerpt(XmlReader& e)
+      {
+      const QByteArray& data = e.data();
+      int start = e.byteOffset();
+      static const char stag[] = "<Score>";
+      static const char etag[] = "</Score>";
+      if (data.isEmpty() || mscVersion() != MSCVERSION || start < int(sizeof(stag)) - 1
+         || data.mid(start - (sizeof(stag) - 1), sizeof(stag) - 1) != stag)
+            return false;
+
+      QString title;
+      QList<int> lids;
+      QList<int> staves;
+      while (e.readNextStartElement()) {
+            if (e.name() == "name")
+                  title = e.readElementText();
+            else
+                  scanExcerptLinks(e, lids, staves);
+            }
+      int end = data.lastIndexOf(etag, e.byteOffset());
+      if (end < start) {
+            qDebug("Score::readPendingExcerpt: end of part score <%s> not found", qPrintable(title));
+            return true;
+            }
+      Excerpt* ex = new Excerpt(this);
+      ex->setTitle(title);
+      ex->setPendingData(stag + data.mid(start, end - start) + etag);
+      for (int id : lids) {
+            LinkedElements* le = _elinks.value(id);
+            if (!le) {
+                  le = new LinkedElements(this, id);
+                  _elinks.insert(id, le);
+                  }
+            ex->addPendingLink(le);
+            }
+      for (int idx : staves)
+            ex->addPendingStaff(idx, staff(idx));
+      _excerpts.append(ex);
+      return true;
+      }
+
+//---------------------------------------------------------
+//   startExcerpt
+//    create the part score for the xml in e. The part
+//    score gets copies of the tempo and time signature maps
+//    and e collects its links, so reading it does not
+//    change this score; attachExcerpt() finishes it.
+//---------------------------------------------------------
+
+Score* Score::startExcerpt(XmlReader& e)
+      {
+      e.setDocName(info.completeBaseName());
+      e.setDeferLinks(true);
+      Score* s     = new Score(this, MScore::baseStyle());
+      s->_sigmap   = new TimeSigMap(*_sigmap);
+      s->_tempomap = new TempoMap(*_tempomap);
+      return s;
+      }
+
+//---------------------------------------------------------
+//   readExcerpt
+//    may run on a worker thread
+//---------------------------------------------------------
+
+static void readExcerpt(Score* s, XmlReader& e)
+      {
+      if (e.readNextStartElement())
+            s->read(e);
+      }
+
+//---------------------------------------------------------
+//   moveToThread
+//    objects created by readExcerpt() on a worker thread
+//    belong to that thread; hand them over to thread
+//    before attachExcerpt() links them to the main score
+//---------------------------------------------------------
+
+static void moveToThread(QObject* o, QThread* thread)
+      {
+      if (o->thread() == QThread::currentThread())
+            o->moveToThread(thread);
+      }
+
+static void moveElementToThread(void* thread, Element* e)
+      {
+      moveToThread(e, static_cast<QThread*>(thread));
+      }
+
+static void moveExcerptToThread(Score* s, QThread* thread)
+      {
+      moveToThread(s, thread);
+      for (Part* p : s->parts())
+            moveToThread(p, thread);
+      for (Staff* st : s->staves())
+            moveToThread(st, thread);
+      for (MeasureBase* mb = s->first(); mb; mb = mb->next()) {
+            moveToThread(mb, thread);
+            if (mb->type() == Element::Type::MEASURE) {
+                  for (Segment* seg = static_cast<Measure*>(mb)->first(); seg; seg = seg->next())
+                        moveToThread(seg, thread);
+                  }
+            }
+      for (auto i : s->spanner())
+            moveToThread(i.second, thread);
+      s->scanElements(thread, moveElementToThread, true);
+      }
+
+//---------------------------------------------------------
+//   attachExcerpt
+//    link the part score read by readExcerpt() to this
+//    score and make it the part score of ex
+//---------------------------------------------------------
+
+void Score::attachExcerpt(Excerpt* ex, Score* s, const XmlReader& e)
+      {
+      delete s->_sigmap;
+      s->_sigmap = 0;
+      delete s->_tempomap;
+      s->_tempomap = 0;
+
+      for (const auto& l : e.linkIds()) {
+            LinkedElements* le = _excerptLinks.value(l.first);
+            if (!le) {
+                  // not collected by readPendingExcerpt()
+                  le = new LinkedElements(this);
+                  _excerptLinks.insert(l.first, le);
+                  }
+            le->append(l.second);
+            l.second->setLinks(le);
+            }
+      for (const auto& l : e.staffLinks()) {
+            Staff* st = ex->pendingStaff(l.second);   // the index may have changed since
+            if (st)
+                  l.first->linkTo(st);
+            else
+                  qDebug("staff %d not found in parent", l.second);
+            }
+
+      for (Staff* st : s->staves())
+            st->updateOttava();
+      ex->setPartScore(s);
+      ex->setLinkedParts();
+
+      s->setPlaylistDirty();
+      s->rebuildMidiMapping();
+      s->updateChannel();
+      s->setSoloMute();
+      s->addLayoutFlags(LayoutFlag::FIX_TICKS | LayoutFlag::FIX_PITCH_VELO);
+      s->_layoutAll = true;
+      }
+
+//---------------------------------------------------------
+//   loadExcerpt
+//    read the part score of a pending excerpt
+//---------------------------------------------------------
+
+void Score::loadExcerpt(Excerpt* ex)
+      {
+      loadExcerpts(QList<Excerpt*>() << ex);
+      }
+
+//---------------------------------------------------------
+//   ExcerptJob
+//---------------------------------------------------------
+
+struct ExcerptJob {
+      Excerpt* excerpt;
+      Score* score;
+      XmlReader* reader;
+      };
+
+//---------------------------------------------------------
+//   ExcerptReader
+//    reads part scores until all jobs are done; several
+//    readers run in parallel
+//---------------------------------------------------------
+
+class ExcerptReader : public QRunnable {
+      std::vector<ExcerptJob>& jobs;
+      std::atomic<int>& next;
+      QThread* thread;        // the thread which attaches the part scores
+
+   public:
+      ExcerptReader(std::vector<ExcerptJob>& j, std::atomic<int>& n)
+         : jobs(j), next(n), thread(QThread::currentThread()) {}
+      virtual void run() {
+            for (;;) {
+                  int idx = next++;
+                  if (idx >= int(jobs.size()))
+                        break;
+                  readExcerpt(jobs[idx].score, *jobs[idx].reader);
+                  moveExcerptToThread(jobs[idx].score, thread);
+                  }
+            }
+      };
+
+//---------------------------------------------------------
+//   loadExcerpts
+//    read all pending part scores; called where edits
+//    start and before all parts are shown or exported
+//---------------------------------------------------------
+
+void Score::loadExcerpts()
+      {
+      QList<Excerpt*> el;
+      for (Excerpt* ex : rootScore()->_excerpts) {
+            if (ex->pending())
+                  el.append(ex);
+            }
+      if (!el.isEmpty())
+            loadExcerpts(el);
+      }
+
+//---------------------------------------------------------
+//   loadLinkedExcerpts
+//    read the pending part scores with elements linked
+//    to le
+//---------------------------------------------------------
+
+void Score::loadLinkedExcerpts(const LinkedElements* le)
+      {
+      QList<Excerpt*> el;
+      for (Excerpt* ex : rootScore()->_excerpts) {
+            if (ex->pending() && ex->hasPendingLink(le))
+                  el.append(ex);
+            }
+      if (!el.isEmpty())
+            loadExcerpts(el);
+      }
+
+//---------------------------------------------------------
+//   loadExcerpts
+//    read the part scores of the pending excerpts el. The
+//    part scores are read in parallel and linked to the
+//    main score in file order.
+//---------------------------------------------------------
+
+void Score::loadExcerpts(const QList<Excerpt*>& el)
+      {
+      waitForBackgroundSave();      // the xml may be written right now
+      Score* root = rootScore();
+      std::vector<ExcerptJob> jobs;
+      for (Excerpt* ex : el) {
+            if (ex->pending()) {
+                  ex->releasePendingLinks();
+                  XmlReader* e = new XmlReader(ex->takePendingData());
+                  jobs.push_back({ ex, root->startExcerpt(*e), e });
+                  }
+            }
+      if (jobs.size() == 1)
+            readExcerpt(jobs[0].score, *jobs[0].reader);
+      else if (jobs.size() > 1) {
+            std::atomic<int> next(0);
+            QThreadPool pool;
+            int threads = qMin(pool.maxThreadCount(), int(jobs.size()));
+            for (int i = 0; i < threads; ++i)
+                  pool.start(new ExcerptReader(jobs, next));
+            pool.waitForDone();
+            }
+      for (const ExcerptJob& j : jobs) {
+            root->attachExcerpt(j.excerpt, j.score, *j.reader);
+            delete j.reader;
+            }
+      for (const Excerpt* ex : root->_excerpts) {
+            if (ex->pending())
+                  return;
+            }
+      root->_excerptLinks.clear();
+      }
+
 //---------------------------------------------------------
 //   print
 //---------------------------------------------------------
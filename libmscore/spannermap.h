@@ -41,7 +41,9 @@ class SpannerMap : std::multimap<int, Spanner*> {
       void addSpanner(Spanner* s);
       bool removeSpanner(Spanner* s);
       void update() const;
-      void setDirty() const { dirty = true; }   // must be called if a spanner changes start/length
+      // must be called if a spanner changes start/length; does not write
+      // an already dirty map, so parallel readers of a part may call it
+      void setDirty() const { if (!dirty) dirty = true; }
       };
 
 }     // namespace Ms
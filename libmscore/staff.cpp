@@ -448,11 +448,11 @@ void Staff::write(Xml& xml) const
       {
       int idx = score()->staffIdx(this);
       xml.stag(QString("Staff id=\"%1\"").arg(idx + 1));
-      if (linkedStaves()) {
+      if (_linkedStaves) {          // part scores not read yet are written as read
             Score* s = score();
             if (s->parentScore())
                   s = s->parentScore();
-            foreach(Staff* staff, linkedStaves()->staves()) {
+            foreach(Staff* staff, _linkedStaves->staves()) {
                   if ((staff->score() == s) && (staff != this))
                         xml.tag("linkedTo", s->staffIdx(staff) + 1);
                   }
@@ -606,7 +606,9 @@ void Staff::read(XmlReader& e)
                   //
                   // if this is an excerpt, link staff to parentScore()
                   //
-                  if (score()->parentScore()) {
+                  if (e.deferLinks())
+                        e.addStaffLink(this, v);
+                  else if (score()->parentScore()) {
                         Staff* st = score()->parentScore()->staff(v);
                         if (st)
                               linkTo(st);
@@ -755,8 +757,8 @@ void Staff::setSlashStyle(bool val)
 void Staff::linkTo(Staff* staff)
       {
       if (!_linkedStaves) {
-            if (staff->linkedStaves()) {
-                  _linkedStaves = staff->linkedStaves();
+            if (staff->_linkedStaves) {
+                  _linkedStaves = staff->_linkedStaves;
                   }
             else {
                   _linkedStaves = new LinkedStaves;
@@ -767,7 +769,7 @@ void Staff::linkTo(Staff* staff)
             }
       else {
             _linkedStaves->add(staff);
-            if (!staff->linkedStaves())
+            if (!staff->_linkedStaves)
                   staff->_linkedStaves = _linkedStaves;
             }
       }
@@ -5730,6 +5730,8 @@ void ScoreFont::load()
             }*/
       }
 
+static QMutex fontLoadMutex;         // part scores are read in parallel
+
 //---------------------------------------------------------
 //   fontFactory
 //---------------------------------------------------------
@@ -5745,6 +5747,7 @@ ScoreFont* ScoreFont::fontFactory(QString s)
             }
       Q_ASSERT(f);
 
+      QMutexLocker locker(&fontLoadMutex);
       if (!f->face)
             f->load();
       return f;
@@ -5757,6 +5760,7 @@ ScoreFont* ScoreFont::fontFactory(QString s)
 ScoreFont* ScoreFont::fallbackFont()
       {
       ScoreFont* f = &_scoreFonts[FALLBACK_FONT];
+      QMutexLocker locker(&fontLoadMutex);
       if (!f->face)
             f->load();
       return f;
@@ -183,8 +183,9 @@ void UndoCommand::unwind()
 UndoStack::UndoStack()
       {
       curCmd   = 0;
-      curIdx   = 0;
-      cleanIdx = 0;
+      curIdx      = 0;
+      cleanIdx    = 0;
+      changeCount = 0;
       }
 
 //---------------------------------------------------------
@@ -237,6 +238,7 @@ void UndoStack::endMacro(bool rollback)
                   }
             list.append(curCmd);
             ++curIdx;
+            ++changeCount;
             }
       curCmd = 0;
       }
@@ -317,6 +319,7 @@ void UndoStack::undo()
             if (MScore::debugMode)
                   qDebug("--undo index %d", curIdx);
             list[curIdx]->undo();
+            ++changeCount;
             }
       }
 
@@ -330,6 +333,7 @@ void UndoStack::redo()
             if (MScore::debugMode)
                   qDebug("--redo index %d", curIdx);
             list[curIdx++]->redo();
+            ++changeCount;
             }
       }
 
@@ -123,6 +123,7 @@ class UndoStack {
       QList<UndoCommand*> list;
       int curIdx;
       int cleanIdx;
+      int changeCount;        // counts executed, undone and redone commands
 
    public:
       UndoStack();
@@ -140,6 +141,7 @@ class UndoStack {
       bool isClean() const          { return cleanIdx == curIdx;   }
       bool isEmpty() const          { return !canUndo() && !canRedo();  }
       UndoCommand* current() const  { return curCmd;               }
+      int changes() const           { return changeCount;          }
       void undo();
       void redo();
       };
@@ -18,9 +18,109 @@
 #include "sym.h"
 #include "note.h"
 
+#include <cmath>
+
 namespace Ms {
 
-QString docName;
+//---------------------------------------------------------
+//   parseInt
+//    convert the usual short decimal numbers directly from
+//    the characters; return false for anything else (signs
+//    other than '-', white space, overflow, errors), which
+//    is left to QString::toInt()
+//---------------------------------------------------------
+
+static bool parseInt(const QChar* s, int n, int* val)
+      {
+      const QChar* e = s + n;
+      bool neg = s < e && s->unicode() == '-';
+      if (neg)
+            ++s;
+      // nine digits can not overflow
+      if (s == e || e - s > 9)
+            return false;
+      int v = 0;
+      for (; s < e; ++s) {
+            ushort c = s->unicode();
+            if (c < '0' || c > '9')
+                  return false;
+            v = v * 10 + (c - '0');
+            }
+      *val = neg ? -v : v;
+      return true;
+      }
+
+//---------------------------------------------------------
+//   parseDouble
+//    convert plain decimal numbers like "-12.375" with at
+//    most 15 digits directly from the characters. The digits
+//    and the power of ten are exact doubles, so the single
+//    division rounds like QString::toDouble(). Return false
+//    for anything else, which is left to QString::toDouble().
+//---------------------------------------------------------
+
+static bool parseDouble(const QChar* s, int n, double* val)
+      {
+      static const double pow10[] = {
+            1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+            1e8,  1e9,  1e10, 1e11, 1e12, 1e13, 1e14, 1e15
+            };
+      const QChar* e = s + n;
+      bool neg = s < e && s->unicode() == '-';
+      if (neg)
+            ++s;
+      qint64 m     = 0;
+      int digits   = 0;
+      int decimals = -1;            // -1: no decimal point yet
+      for (; s < e; ++s) {
+            ushort c = s->unicode();
+            if (c == '.' && decimals == -1 && digits)
+                  decimals = 0;
+            else if (c >= '0' && c <= '9') {
+                  if (++digits > 15)
+                        return false;
+                  m = m * 10 + (c - '0');
+                  if (decimals >= 0)
+                        ++decimals;
+                  }
+            else
+                  return false;
+            }
+      if (digits == 0 || decimals == 0)
+            return false;
+      double v = double(m);
+      if (decimals > 0)
+            v /= pow10[decimals];
+      *val = neg ? -v : v;
+      return true;
+      }
+
+//---------------------------------------------------------
+//   toInt
+//---------------------------------------------------------
+
+static int toInt(const QChar* s, int n, bool* ok)
+      {
+      int val;
+      if (parseInt(s, n, &val)) {
+            if (ok)
+                  *ok = true;
+            return val;
+            }
+      return QString::fromRawData(s, n).toInt(ok);
+      }
+
+//---------------------------------------------------------
+//   toDouble
+//---------------------------------------------------------
+
+static double toDouble(const QChar* s, int n)
+      {
+      double val;
+      if (parseDouble(s, n, &val))
+            return val;
+      return QString::fromRawData(s, n).toDouble();
+      }
 
 //---------------------------------------------------------
 //   intAttribute
@@ -28,16 +128,18 @@ QString docName;
 
 int XmlReader::intAttribute(const char* s, int _default) const
       {
-      if (attributes().hasAttribute(s))
-            // return attributes().value(s).toString().toInt();
-            return attributes().value(s).toInt();
+      if (attributes().hasAttribute(s)) {
+            QStringRef r = attributes().value(s);
+            return toInt(r.unicode(), r.size(), 0);
+            }
       else
             return _default;
       }
 
 int XmlReader::intAttribute(const char* s) const
       {
-      return attributes().value(s).toInt();
+      QStringRef r = attributes().value(s);
+      return toInt(r.unicode(), r.size(), 0);
       }
 
 //---------------------------------------------------------
@@ -46,13 +148,16 @@ int XmlReader::intAttribute(const char* s) const
 
 double XmlReader::doubleAttribute(const char* s) const
       {
-      return attributes().value(s).toDouble();
+      QStringRef r = attributes().value(s);
+      return toDouble(r.unicode(), r.size());
       }
 
 double XmlReader::doubleAttribute(const char* s, double _default) const
       {
-      if (attributes().hasAttribute(s))
-            return attributes().value(s).toDouble();
+      if (attributes().hasAttribute(s)) {
+            QStringRef r = attributes().value(s);
+            return toDouble(r.unicode(), r.size());
+            }
       else
             return _default;
       }
@@ -160,8 +265,8 @@ QRectF XmlReader::readRect()
 Fraction XmlReader::readFraction()
       {
       Q_ASSERT(tokenType() == XmlStreamReader::StartElement);
-      int z = attribute("z", "0").toInt();
-      int n = attribute("n", "0").toInt();
+      int z = intAttribute("z", 0);
+      int n = intAttribute("n", 0);
       skipCurrentElement();
       return Fraction(z, n);
       }
@@ -181,6 +286,37 @@ void XmlReader::unknown()
       skipCurrentElement();
       }
 
+//---------------------------------------------------------
+//   byteOffset
+//    position of characterOffset() in data(), which is
+//    utf8; the position must not move backwards between
+//    two calls
+//---------------------------------------------------------
+
+int XmlReader::byteOffset()
+      {
+      const char* p = _source->constData();
+      int n         = _source->size();
+      if (_bytePos == 0 && n >= 3 && uchar(p[0]) == 0xef && uchar(p[1]) == 0xbb && uchar(p[2]) == 0xbf)
+            _bytePos = 3;                             // the decoder drops the byte order mark
+      qint64 offset = characterOffset();
+      while (_charPos < offset && _bytePos < n) {
+            uchar c = p[_bytePos];
+            if (c < 0xc0)
+                  _bytePos += 1;
+            else if (c < 0xe0)
+                  _bytePos += 2;
+            else if (c < 0xf0)
+                  _bytePos += 3;
+            else {
+                  _bytePos += 4;
+                  ++_charPos;                         // utf16 surrogate pair
+                  }
+            ++_charPos;
+            }
+      return qMin(_bytePos, n);
+      }
+
 //---------------------------------------------------------
 //   addBeam
 //---------------------------------------------------------
@@ -199,13 +335,125 @@ void XmlReader::addTuplet(Tuplet* s)
       _tuplets.insert(s->id(), s);
       }
 
+//---------------------------------------------------------
+//   clearText
+//---------------------------------------------------------
+
+void XmlReader::clearText()
+      {
+      if (_text.capacity() == 0)
+            _text.reserve(64);      // else resize(0) frees the buffer
+      _text.resize(0);
+      }
+
+//---------------------------------------------------------
+//   collectText
+//    append the current token and all following ones up to
+//    the end of the element to _text
+//---------------------------------------------------------
+
+void XmlReader::collectText()
+      {
+      for (;; readNext()) {
+            switch (tokenType()) {
+                  case Characters:
+                  case EntityReference:
+                        _text.append(text());
+                        break;
+                  case EndElement:
+                        return;
+                  case ProcessingInstruction:
+                  case Comment:
+                        break;
+                  default:
+                        if (!hasError())
+                              raiseError(QObject::tr("Expected character data."));
+                        return;
+                  }
+            }
+      }
+
+//---------------------------------------------------------
+//   readText
+//    readElementText() into a buffer that is reused. The
+//    result is valid until the next readText().
+//---------------------------------------------------------
+
+const QString& XmlReader::readText()
+      {
+      clearText();
+      if (isStartElement()) {
+            readNext();
+            collectText();
+            }
+      return _text;
+      }
+
+//---------------------------------------------------------
+//   readNumberText
+//    read the text of an element holding a number and
+//    return its length; *s points to the characters.
+//    The usual element, a single short character token, is
+//    copied from the tokenizer into _number and no string
+//    is built. Anything else is collected in _text.
+//---------------------------------------------------------
+
+int XmlReader::readNumberText(const QChar** s)
+      {
+      *s = _number;
+      if (!isStartElement())
+            return 0;
+      int n = 0;
+      switch (readNext()) {
+            case EndElement:
+                  return 0;
+            case Characters: {
+                  QStringRef r = text();
+                  n = r.size();
+                  if (n > NUMBER_SIZE) {
+                        n = 0;
+                        break;
+                        }
+                  memcpy(_number, r.unicode(), n * sizeof(QChar));
+                  if (readNext() == EndElement)
+                        return n;
+                  }
+                  break;
+            default:
+                  break;
+            }
+      clearText();
+      _text.append(_number, n);
+      collectText();
+      *s = _text.unicode();
+      return _text.size();
+      }
+
+//---------------------------------------------------------
+//   readInt
+//---------------------------------------------------------
+
+int XmlReader::readInt(bool* ok)
+      {
+      const QChar* s;
+      int n = readNumberText(&s);
+      return toInt(s, n, ok);
+      }
+
 //---------------------------------------------------------
 //   readDouble
 //---------------------------------------------------------
 
+double XmlReader::readDouble()
+      {
+      const QChar* s;
+      int n = readNumberText(&s);
+      return toDouble(s, n);
+      }
+
 double XmlReader::readDouble(double min, double max)
       {
-      double val = readElementText().toDouble();
+      double val = readDouble();
       if (val < min)
             val = min;
       else if (val > max)
@@ -246,13 +494,274 @@ bool compareProperty(void* val, void* defaultVal)
 
 Xml::Xml()
       {
-      setCodec("UTF-8");
+      _buf.reserve(FLUSH_SIZE + BS);
       }
 
 Xml::Xml(QIODevice* device)
-   : QTextStream(device)
+   : _device(device)
+      {
+      _buf.reserve(FLUSH_SIZE + BS);
+      }
+
+Xml::~Xml()
+      {
+      flush();
+      }
+
+//---------------------------------------------------------
+//   setDevice
+//---------------------------------------------------------
+
+void Xml::setDevice(QIODevice* device)
+      {
+      flush();
+      _device = device;
+      }
+
+//---------------------------------------------------------
+//   flush
+//    write the buffered output to the device
+//---------------------------------------------------------
+
+void Xml::flush()
+      {
+      if (_buf.isEmpty())
+            return;
+      if (_device)
+            _device->write(_buf);
+      _buf.resize(0);
+      }
+
+//---------------------------------------------------------
+//   writeRaw
+//    write a well formed fragment as is, e.g. the xml
+//    of a part score which is not read
+//---------------------------------------------------------
+
+void Xml::writeRaw(const QByteArray& data)
+      {
+      putLevel();
+      _buf.append(data);
+      lineEnd();
+      }
+
+//---------------------------------------------------------
+//   lineEnd
+//---------------------------------------------------------
+
+void Xml::lineEnd()
       {
-      setCodec("UTF-8");
+      _buf.append('\n');
+      if (_nameIdx.isEmpty() || _buf.size() >= FLUSH_SIZE)
+            flush();
+      }
+
+//---------------------------------------------------------
+//   putLatin1
+//    like QTextStream, take const char* as latin1
+//---------------------------------------------------------
+
+void Xml::putLatin1(const char* s)
+      {
+      if (s)
+            putLatin1(s, int(strlen(s)));
+      }
+
+void Xml::putLatin1(const char* s, int len)
+      {
+      for (int i = 0; i < len; ++i) {
+            uchar c = s[i];
+            if (c < 0x80)
+                  _buf.append(char(c));
+            else {
+                  _buf.append(char(0xc0 | (c >> 6)));
+                  _buf.append(char(0x80 | (c & 0x3f)));
+                  }
+            }
+      }
+
+//---------------------------------------------------------
+//   putUtf8
+//    lone surrogates are written as '?' like QTextCodec does
+//---------------------------------------------------------
+
+void Xml::putUtf8(const QString& s)
+      {
+      const QChar* p = s.constData();
+      int n = s.size();
+      for (int i = 0; i < n; ++i) {
+            uint c = p[i].unicode();
+            if (c < 0x80)
+                  _buf.append(char(c));
+            else if (c < 0x800) {
+                  _buf.append(char(0xc0 | (c >> 6)));
+                  _buf.append(char(0x80 | (c & 0x3f)));
+                  }
+            else if (QChar::isSurrogate(c)) {
+                  if (QChar::isHighSurrogate(c) && i + 1 < n && p[i+1].isLowSurrogate()) {
+                        c = QChar::surrogateToUcs4(ushort(c), p[++i].unicode());
+                        _buf.append(char(0xf0 | (c >> 18)));
+                        _buf.append(char(0x80 | ((c >> 12) & 0x3f)));
+                        _buf.append(char(0x80 | ((c >> 6) & 0x3f)));
+                        _buf.append(char(0x80 | (c & 0x3f)));
+                        }
+                  else
+                        _buf.append('?');
+                  }
+            else {
+                  _buf.append(char(0xe0 | (c >> 12)));
+                  _buf.append(char(0x80 | ((c >> 6) & 0x3f)));
+                  _buf.append(char(0x80 | (c & 0x3f)));
+                  }
+            }
+      }
+
+//---------------------------------------------------------
+//   putEscaped
+//    same as xmlString(), but written directly to the
+//    buffer; a const char* value is taken as utf8
+//---------------------------------------------------------
+
+void Xml::putEscaped(const char* s)
+      {
+      if (!s)
+            return;
+      for (; *s; ++s) {
+            uchar c = *s;
+            switch (c) {
+                  case '<':  _buf.append("&lt;");   break;
+                  case '>':  _buf.append("&gt;");   break;
+                  case '&':  _buf.append("&amp;");  break;
+                  case '\"': _buf.append("&quot;"); break;
+                  default:
+                        // ignore invalid characters in xml 1.0
+                        if (c >= 0x20 || c == 0x09 || c == 0x0A || c == 0x0D)
+                              _buf.append(char(c));
+                        break;
+                  }
+            }
+      }
+
+void Xml::putEscaped(const QString& s)
+      {
+      const QChar* p = s.constData();
+      int n = s.size();
+      int start = 0;
+      for (int i = 0; i < n; ++i) {
+            ushort c = p[i].unicode();
+            const char* r;
+            switch (c) {
+                  case '<':  r = "&lt;";   break;
+                  case '>':  r = "&gt;";   break;
+                  case '&':  r = "&amp;";  break;
+                  case '\"': r = "&quot;"; break;
+                  default:
+                        if (c >= 0x20 || c == 0x09 || c == 0x0A || c == 0x0D)
+                              continue;
+                        r = "";
+                        break;
+                  }
+            if (i > start)
+                  putUtf8(QString::fromRawData(p + start, i - start));
+            _buf.append(r);
+            start = i + 1;
+            }
+      if (start == 0)
+            putUtf8(s);
+      else if (n > start)
+            putUtf8(QString::fromRawData(p + start, n - start));
+      }
+
+//---------------------------------------------------------
+//   putInt
+//---------------------------------------------------------
+
+void Xml::putInt(int val)
+      {
+      char b[12];
+      char* p = b + sizeof(b);
+      uint v  = val < 0 ? 0u - uint(val) : uint(val);
+      do {
+            *--p = char('0' + v % 10);
+            v /= 10;
+            } while (v);
+      if (val < 0)
+            *--p = '-';
+      _buf.append(p, int(b + sizeof(b) - p));
+      }
+
+//---------------------------------------------------------
+//   putReal
+//    same output as QTextStream and QString::arg() with
+//    their default precision of 6 significant digits.
+//    Values with up to six digits and at most nine
+//    decimals in the range where %g does not switch to
+//    exponent notation are written directly, everything
+//    else is left to Qt.
+//---------------------------------------------------------
+
+void Xml::putReal(qreal d)
+      {
+      static const double p10[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9 };
+      static const int ipow10[]   = { 1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000 };
+
+      double a = qAbs(d);
+      if ((d == 0.0 && !std::signbit(d)) || (a >= 1e-4 && a < 1e6)) {
+            for (int k = 0; k < 10; ++k) {
+                  double m = a * p10[k];
+                  if (m >= 1e6)
+                        break;
+                  if (m != floor(m))
+                        continue;
+                  int n = int(m);
+                  while (k && n % 10 == 0) {    // 38.37 * 100 is not integral, * 1000 is
+                        n /= 10;
+                        --k;
+                        }
+                  if (d < 0.0)
+                        _buf.append('-');
+                  putInt(n / ipow10[k]);
+                  if (k) {
+                        char b[10];
+                        int f = n % ipow10[k];
+                        for (int i = k - 1; i >= 0; --i) {
+                              b[i] = char('0' + f % 10);
+                              f /= 10;
+                              }
+                        _buf.append('.');
+                        _buf.append(b, k);
+                        }
+                  return;
+                  }
+            }
+      putUtf8(QString("%1").arg(d));
+      }
+
+//---------------------------------------------------------
+//   startTag
+//    <name attribute="value">
+//---------------------------------------------------------
+
+void Xml::startTag(const char* name)
+      {
+      putLevel();
+      _buf.append('<');
+      _buf.append(name);
+      _buf.append('>');
+      }
+
+//---------------------------------------------------------
+//   endTag
+//    </name>, without the attributes of name
+//---------------------------------------------------------
+
+void Xml::endTag(const char* name)
+      {
+      const char* e = strchr(name, ' ');
+      _buf.append("</", 2);
+      _buf.append(name, e ? int(e - name) : int(strlen(name)));
+      _buf.append('>');
+      lineEnd();
       }
 
 //---------------------------------------------------------
@@ -286,24 +795,19 @@ PlaceText readPlacement(XmlReader& e)
       return PlaceText::AUTO;
       }
 
-//---------------------------------------------------------
-//   fTag
-//---------------------------------------------------------
-
-void Xml::fTag(const char* name, const Fraction& f)
-      {
-      tagE(QString("%1 z=\"%2\" n=\"%3\"").arg(name).arg(f.numerator()).arg(f.denominator()));
-      }
-
 //---------------------------------------------------------
 //   putLevel
 //---------------------------------------------------------
 
 void Xml::putLevel()
       {
-      int level = stack.size();
-      for (int i = 0; i < level * 2; ++i)
-            *this << ' ';
+      static const char spaces[] = "                                ";
+      int n = (_level + _nameIdx.size()) * 2;
+      while (n > 0) {
+            int k = qMin(n, int(sizeof(spaces)) - 1);
+            _buf.append(spaces, k);
+            n -= k;
+            }
       }
 
 //---------------------------------------------------------
@@ -312,7 +816,7 @@ void Xml::putLevel()
 
 void Xml::header()
       {
-      *this << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n";
+      _buf.append("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n");
       }
 
 //---------------------------------------------------------
@@ -320,11 +824,25 @@ void Xml::header()
 //    <mops attribute="value">
 //---------------------------------------------------------
 
+void Xml::stag(const char* s)
+      {
+      startTag(s);
+      const char* e = strchr(s, ' ');
+      _nameIdx.append(_names.size());
+      _names.append(s, e ? int(e - s) : int(strlen(s)));
+      lineEnd();
+      }
+
 void Xml::stag(const QString& s)
       {
       putLevel();
-      *this << '<' << s << '>' << endl;
-      stack.append(s.split(' ')[0]);
+      _buf.append('<');
+      putUtf8(s);
+      _buf.append('>');
+      int idx = s.indexOf(' ');
+      _nameIdx.append(_names.size());
+      _names.append((idx == -1 ? s : s.left(idx)).toUtf8());
+      lineEnd();
       }
 
 //---------------------------------------------------------
@@ -335,7 +853,12 @@ void Xml::stag(const QString& s)
 void Xml::etag()
       {
       putLevel();
-      *this << "</" << stack.takeLast() << '>' << endl;
+      int idx = _nameIdx.takeLast();
+      _buf.append("</", 2);
+      _buf.append(_names.constData() + idx, _names.size() - idx);
+      _buf.append('>');
+      _names.resize(idx);
+      lineEnd();
       }
 
 //---------------------------------------------------------
@@ -348,12 +871,13 @@ void Xml::tagE(const char* format, ...)
       va_list args;
       va_start(args, format);
       putLevel();
-      *this << '<';
+      _buf.append('<');
       char buffer[BS];
       vsnprintf(buffer, BS, format, args);
-      *this << buffer;
+      putLatin1(buffer);
       va_end(args);
-      *this << "/>" << endl;
+      _buf.append("/>", 2);
+      lineEnd();
       }
 
 //---------------------------------------------------------
@@ -363,7 +887,10 @@ void Xml::tagE(const char* format, ...)
 void Xml::tagE(const QString& s)
       {
       putLevel();
-      *this << '<' << s << "/>\n";
+      _buf.append('<');
+      putUtf8(s);
+      _buf.append("/>", 2);
+      lineEnd();
       }
 
 //---------------------------------------------------------
@@ -374,7 +901,9 @@ void Xml::tagE(const QString& s)
 void Xml::ntag(const char* name)
       {
       putLevel();
-      *this << "<" << name << ">";
+      _buf.append('<');
+      putLatin1(name);
+      _buf.append('>');
       }
 
 //---------------------------------------------------------
@@ -384,7 +913,10 @@ void Xml::ntag(const char* name)
 
 void Xml::netag(const char* s)
       {
-      *this << "</" << s << '>' << endl;
+      _buf.append("</", 2);
+      putLatin1(s);
+      _buf.append('>');
+      lineEnd();
       }
 
 //---------------------------------------------------------
@@ -525,48 +1057,57 @@ void Xml::tag(const QString& name, QVariant data)
             case QVariant::Int:
             case QVariant::UInt:
                   *this << "<" << name << ">";
-                  *this << data.toInt();
-                  *this << "</" << ename << ">\n";
+                  putInt(data.toInt());
+                  *this << "</" << ename << ">";
+                  lineEnd();
                   break;
             case QVariant::Double:
                   *this << "<" << name << ">";
-                  *this << data.value<double>();
-                  *this << "</" << ename << ">\n";
+                  putReal(data.value<double>());
+                  *this << "</" << ename << ">";
+                  lineEnd();
                   break;
             case QVariant::String:
                   *this << "<" << name << ">";
-                  *this << xmlString(data.value<QString>());
-                  *this << "</" << ename << ">\n";
+                  putEscaped(data.value<QString>());
+                  *this << "</" << ename << ">";
+                  lineEnd();
                   break;
             case QVariant::Color:
                   {
                   QColor color(data.value<QColor>());
-                  *this << QString("<%1 r=\"%2\" g=\"%3\" b=\"%4\" a=\"%5\"/>\n")
+                  *this << QString("<%1 r=\"%2\" g=\"%3\" b=\"%4\" a=\"%5\"/>")
                      .arg(name).arg(color.red()).arg(color.green()).arg(color.blue()).arg(color.alpha());
+                  lineEnd();
                   }
                   break;
             case QVariant::Rect:
                   {
                   QRect r(data.value<QRect>());
-                  *this << QString("<%1 x=\"%2\" y=\"%3\" w=\"%4\" h=\"%5\"/>\n").arg(name).arg(r.x()).arg(r.y()).arg(r.width()).arg(r.height());
+                  *this << QString("<%1 x=\"%2\" y=\"%3\" w=\"%4\" h=\"%5\"/>").arg(name).arg(r.x()).arg(r.y()).arg(r.width()).arg(r.height());
+                  lineEnd();
                   }
                   break;
             case QVariant::RectF:
                   {
                   QRectF r(data.value<QRectF>());
-                  *this << QString("<%1 x=\"%2\" y=\"%3\" w=\"%4\" h=\"%5\"/>\n").arg(name).arg(r.x()).arg(r.y()).arg(r.width()).arg(r.height());
+                  *this << QString("<%1 x=\"%2\" y=\"%3\" w=\"%4\" h=\"%5\"/>").arg(name).arg(r.x()).arg(r.y()).arg(r.width()).arg(r.height());
+                  lineEnd();
                   }
                   break;
             case QVariant::PointF:
-                  {
-                  QPointF p(data.value<QPointF>());
-                  *this << QString("<%1 x=\"%2\" y=\"%3\"/>\n").arg(name).arg(p.x()).arg(p.y());
-                  }
+                  *this << "<" << name << " x=\"";
+                  putReal(data.value<QPointF>().x());
+                  _buf.append("\" y=\"");
+                  putReal(data.value<QPointF>().y());
+                  _buf.append("\"/>");
+                  lineEnd();
                   break;
             case QVariant::SizeF:
                   {
                   QSizeF p(data.value<QSizeF>());
-                  *this << QString("<%1 w=\"%2\" h=\"%3\"/>\n").arg(name).arg(p.width()).arg(p.height());
+                  *this << QString("<%1 w=\"%2\" h=\"%3\"/>").arg(name).arg(p.width()).arg(p.height());
+                  lineEnd();
                   }
                   break;
             default:
@@ -576,6 +1117,83 @@ void Xml::tag(const QString& name, QVariant data)
             }
       }
 
+//---------------------------------------------------------
+//   tag
+//    typed versions of tag() which write the value
+//    without going through QVariant and QString
+//---------------------------------------------------------
+
+void Xml::tag(const char* name, const char* s)
+      {
+      startTag(name);
+      putEscaped(s);
+      endTag(name);
+      }
+
+void Xml::tag(const char* name, const QString& s)
+      {
+      startTag(name);
+      putEscaped(s);
+      endTag(name);
+      }
+
+void Xml::tag(const char* name, int val)
+      {
+      startTag(name);
+      putInt(val);
+      endTag(name);
+      }
+
+void Xml::tag(const char* name, bool val)
+      {
+      startTag(name);
+      _buf.append(val ? '1' : '0');
+      endTag(name);
+      }
+
+void Xml::tag(const char* name, qreal val)
+      {
+      startTag(name);
+      putReal(val);
+      endTag(name);
+      }
+
+//---------------------------------------------------------
+//   tag
+//    <mops x="1" y="2"/>
+//---------------------------------------------------------
+
+void Xml::tag(const char* name, const QPointF& p)
+      {
+      putLevel();
+      _buf.append('<');
+      _buf.append(name);
+      _buf.append(" x=\"");
+      putReal(p.x());
+      _buf.append("\" y=\"");
+      putReal(p.y());
+      _buf.append("\"/>");
+      lineEnd();
+      }
+
+//---------------------------------------------------------
+//   tag
+//    <mops z="1" n="4"/>
+//---------------------------------------------------------
+
+void Xml::tag(const char* name, const Fraction& f)
+      {
+      putLevel();
+      _buf.append('<');
+      _buf.append(name);
+      _buf.append(" z=\"");
+      putInt(f.numerator());
+      _buf.append("\" n=\"");
+      putInt(f.denominator());
+      _buf.append("\"/>");
+      lineEnd();
+      }
+
 void Xml::tag(const char* name, const QWidget* g)
       {
       tag(name, QRect(g->pos(), g->size()));
@@ -626,25 +1244,24 @@ QString Xml::xmlString(const QString& s)
 
 void Xml::dump(int len, const unsigned char* p)
       {
+      static const char hex[] = "0123456789abcdef";
       putLevel();
       int col = 0;
-      setFieldWidth(5);
-      setNumberFlags(numberFlags() | QTextStream::ShowBase);
-      setIntegerBase(16);
       for (int i = 0; i < len; ++i, ++col) {
             if (col >= 16) {
-                  setFieldWidth(0);
-                  *this << endl;
+                  lineEnd();
                   col = 0;
                   putLevel();
-                  setFieldWidth(5);
                   }
-            *this << (p[i] & 0xff);
+            // "%#5x", but with a "0x" also for zero
+            int v = p[i] & 0xff;
+            _buf.append(v < 16 ? "  0x" : " 0x");
+            if (v >= 16)
+                  _buf.append(hex[v >> 4]);
+            _buf.append(hex[v & 0xf]);
             }
       if (col)
-            *this << endl << dec;
-      setFieldWidth(0);
-      setIntegerBase(10);
+            lineEnd();
       }
 
 //---------------------------------------------------------
@@ -730,7 +1347,8 @@ void Xml::writeXml(const QString& name, QString s)
             }
       *this << "<" << name << ">";
       *this << s;
-      *this << "</" << ename << ">\n";
+      *this << "</" << ename << ">";
+      lineEnd();
       }
 
 //---------------------------------------------------------
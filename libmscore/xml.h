@@ -13,6 +13,7 @@
 #ifndef __XML_H__
 #define __XML_H__
 
+#include <atomic>
 #include "thirdparty/xmlstream/xmlstream.h"
 #include "stafftype.h"
 #include "interval.h"
@@ -27,6 +28,7 @@ class Spanner;
 class Beam;
 class Tuplet;
 class Measure;
+class Staff;
 
 //---------------------------------------------------------
 //   SpannerValues
@@ -60,11 +62,27 @@ class XmlReader : public XmlStreamReader {
       void htmlToString(int level, QString*);
       Interval _transpose;
       QList<QList<std::pair<int, ClefType>>> _clefs;   // for 1.3 scores
+      QByteArray _data;                   // the document if it is read from memory
+      const QByteArray* _source { &_data };     // the document read so far
+      qint64 _charPos       { 0       };  // byteOffset() position
+      int _bytePos          { 0       };
+      QString _text;                      // readText() buffer
+      static const int NUMBER_SIZE = 32;
+      QChar _number[NUMBER_SIZE];         // readNumberText() buffer
+      bool _deferLinks      { false   };  // collect links instead of resolving them
+      QList<std::pair<int, ScoreElement*>> _linkIds;
+      QList<std::pair<Staff*, int>> _staffLinks;
+
+      void clearText();
+      void collectText();
+      int readNumberText(const QChar**);
 
    public:
       XmlReader(QFile* f) : XmlStreamReader(f), docName(f->fileName()) {}
-      XmlReader(const QByteArray& d, const QString& s = QString()) : XmlStreamReader(d), docName(s)  {}
+      XmlReader(const QByteArray& d, const QString& s = QString()) : XmlStreamReader(d), docName(s), _data(d)  {}
       XmlReader(QIODevice* d, const QString& s = QString()) : XmlStreamReader(d), docName(s) {}
+      XmlReader(QIODevice* d, const QByteArray* source, const QString& s = QString())
+         : XmlStreamReader(d), docName(s), _source(source) {}
       XmlReader(const QString& d, const QString& s = QString()) : XmlStreamReader(d), docName(s) {}
 
       void unknown();
@@ -79,9 +97,10 @@ class XmlReader : public XmlStreamReader {
       bool hasAttribute(const char* s) const;
 
       // helper routines based on readElementText():
-      int readInt()         { return readElementText().toInt();    }
-      int readInt(bool* ok) { return readElementText().toInt(ok);  }
-      double readDouble()   { return readElementText().toDouble(); }
+      const QString& readText();
+      int readInt()         { return readInt(0); }
+      int readInt(bool* ok);
+      double readDouble();
       double readDouble(double min, double max);
       bool readBool();
       QPointF readPoint();
@@ -91,6 +110,9 @@ class XmlReader : public XmlStreamReader {
       Fraction readFraction();
       QString readXml();
 
+      const QByteArray& data() const    { return *_source; }
+      int byteOffset();
+
       void setDocName(const QString& s) { docName = s; }
       QString getDocName() const        { return docName; }
 
@@ -128,22 +150,48 @@ class XmlReader : public XmlStreamReader {
       void setTransposeDiatonic(int v) { _transpose.diatonic = v; }
 
       QList<std::pair<int, ClefType>>& clefs(int idx);
+
+      bool deferLinks() const                 { return _deferLinks; }
+      void setDeferLinks(bool v)              { _deferLinks = v;    }
+      void addLinkId(int id, ScoreElement* e) { _linkIds.append(std::make_pair(id, e));  }
+      void addStaffLink(Staff* s, int idx)    { _staffLinks.append(std::make_pair(s, idx)); }
+      const QList<std::pair<int, ScoreElement*>>& linkIds() const { return _linkIds;    }
+      const QList<std::pair<Staff*, int>>& staffLinks() const     { return _staffLinks; }
       };
 
 //---------------------------------------------------------
 //   Xml
-//    xml writer
+//    xml writer; the output is encoded as UTF-8 into a
+//    byte buffer which is written to the device when it
+//    gets full, when the outermost tag is closed and on
+//    destruction
 //---------------------------------------------------------
 
-class Xml : public QTextStream {
-      static const int BS = 2048;
+class Xml {
+      static const int BS         = 2048;
+      static const int FLUSH_SIZE = 65536;
 
-      QList<QString> stack;
-      void putLevel();
+      QIODevice* _device { 0 };
+      QByteArray _buf;
+      QByteArray _names;            // names of the open tags
+      QVector<int> _nameIdx;        // start of every name in _names
+      int _level { 0 };             // indentation of the outermost tag
       QList<std::pair<int,const Spanner*>> _spanner;
       int _spannerId = 1;
       SelectionFilter _filter;
 
+      void putLevel();
+      void lineEnd();
+      void putLatin1(const char*);
+      void putLatin1(const char*, int len);
+      void putUtf8(const QString&);
+      void putEscaped(const char*);
+      void putEscaped(const QString&);
+      void putInt(int);
+      void putReal(qreal);
+      void startTag(const char* name);
+      void endTag(const char* name);
+
    public:
       int curTick   =  0;           // used to optimize output
       int curTrack  = -1;
@@ -153,6 +201,7 @@ class Xml : public QTextStream {
       bool clipboardmode = false;   // used to modify write() behaviour
       bool excerptmode   = false;   // true when writing a part
       bool writeOmr      = true;    // false if writing into *.msc file
+      const std::atomic<bool>* abort = 0;   // polled by long writes, see aborted()
 
       int tupletId  = 1;
       int beamId    = 1;
@@ -163,13 +212,25 @@ class Xml : public QTextStream {
 
       Xml(QIODevice* dev);
       Xml();
+      ~Xml();
+
+      void setDevice(QIODevice*);
+      QIODevice* device() const { return _device; }
+      void flush();
+      void setLevel(int n)      { _level = n; }   // for fragments of an enclosing document
+      bool aborted() const      { return abort && *abort; }
+      void writeRaw(const QByteArray&);
+
+      Xml& operator<<(const char* s)    { putLatin1(s); return *this; }
+      Xml& operator<<(const QString& s) { putUtf8(s);   return *this; }
 
-      void sTag(const char* name, Spatium sp) { Xml::tag(name, QVariant(sp.val())); }
+      void sTag(const char* name, Spatium sp) { tag(name, sp.val()); }
       void pTag(const char* name, PlaceText);
-      void fTag(const char* name, const Fraction&);
+      void fTag(const char* name, const Fraction& f) { tag(name, f); }
 
       void header();
 
+      void stag(const char*);
       void stag(const QString&);
       void etag();
 
@@ -182,8 +243,13 @@ class Xml : public QTextStream {
       void tag(P_ID id, QVariant data, QVariant defaultData = QVariant());
       void tag(const char* name, QVariant data, QVariant defaultData = QVariant());
       void tag(const QString&, QVariant data);
-      void tag(const char* name, const char* s)    { tag(name, QVariant(s)); }
-      void tag(const char* name, const QString& s) { tag(name, QVariant(s)); }
+      void tag(const char* name, const char* s);
+      void tag(const char* name, const QString& s);
+      void tag(const char* name, int);
+      void tag(const char* name, bool);
+      void tag(const char* name, qreal);
+      void tag(const char* name, const QPointF&);
+      void tag(const char* name, const Fraction&);
       void tag(const char* name, const QWidget*);
 
       void writeXml(const QString&, QString s);
@@ -198,7 +264,6 @@ class Xml : public QTextStream {
       };
 
 extern PlaceText readPlacement(XmlReader&);
-extern QString docName;
 
 }     // namespace Ms
 #endif
@@ -140,6 +140,10 @@ void Album::print()
 bool Album::createScore(const QString& fn)
       {
       loadScores();
+      for (AlbumItem* item : _scores) {
+            if (item->score)
+                  item->score->loadExcerpts();
+            }
 
       Score* firstScore = _scores[0]->score;
       if (!firstScore) {
@@ -226,6 +226,7 @@ snd_pcm_sframes_t AlsaDriver::pcmWait()
             _stat |= 64;
             }
       if (_xrun) {
+            ++_xruns;
             recover();
             return 0;
             }
@@ -676,6 +677,7 @@ void AlsaAudio::alsaLoop()
             }
       int size = alsa->fsize();
       float buffer[size * 2];
+      unsigned xruns = alsa->xruns();
       runAlsa = 2;
       while (runAlsa == 2) {
             seq->process(size, buffer);
@@ -689,6 +691,10 @@ void AlsaAudio::alsaLoop()
                   *rp++ = *sp++;
                   }
             alsa->write(size, l, r);
+            if (alsa->xruns() != xruns) {
+                  seq->audioStats()->xrun(alsa->xruns() - xruns);
+                  xruns = alsa->xruns();
+                  }
             }
       alsa->pcmStop();
       runAlsa = 0;
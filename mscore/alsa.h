@@ -75,6 +75,7 @@ class AlsaDriver {
       int                    _stat;
       int                    _pcnt;
       bool                   _xrun;
+      unsigned               _xruns { 0 };
       clear_function         _clear_func;
       play_function          _play_func;
       bool                   mmappedInterface;
@@ -101,6 +102,7 @@ class AlsaDriver {
       int pcmStop();
       snd_pcm_uframes_t fsize() const { return _frsize;      }
       unsigned int sampleRate() const { return _rate; }
+      unsigned xruns() const          { return _xruns; }
       void write(int n, float* l, float* r);
       };
 
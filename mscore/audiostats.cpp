@@ -0,0 +1,182 @@
+//=============================================================================
+//  MuseScore
+//  Music Composition & Notation
+//
+//  Copyright (C) 2015 Werner Schweer
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License version 2
+//  as published by the Free Software Foundation and appearing in
+//  the file LICENCE.GPL
+//=============================================================================
+
+#include "audiostats.h"
+
+namespace Ms {
+
+//---------------------------------------------------------
+//   reset
+//    gui thread; a callback running concurrently may
+//    leave some of its values
+//---------------------------------------------------------
+
+void AudioStats::reset()
+      {
+      _callbacks = 0;
+      for (int i = 0; i < BINS; ++i)
+            _histogram[i] = 0;
+      _xruns     = 0;
+      _frames    = 0;
+      _period    = 0;
+      _time      = 0;
+      _maxTime   = 0;
+      _queue     = 0;
+      _maxQueue  = 0;
+      _voices    = 0;
+      _maxVoices = 0;
+      _dropped   = 0;
+      _renderMisses = 0;
+      _underruns = 0;
+      _starved   = 0;
+      }
+
+//---------------------------------------------------------
+//   record
+//    realtime
+//---------------------------------------------------------
+
+void AudioStats::record(unsigned frames, int sampleRate, int usec)
+      {
+      if (frames == 0 || sampleRate <= 0)
+            return;
+      int period = int(qint64(frames) * 1000000 / sampleRate);
+      int bin    = period ? qMin(int(qint64(usec) * 10 / period), BINS - 1) : BINS - 1;
+      ++_histogram[bin];
+      ++_callbacks;
+      _frames = frames;
+      _period = period;
+      _time   = usec;
+      if (usec > _maxTime)
+            _maxTime = usec;
+      }
+
+//---------------------------------------------------------
+//   setQueueDepth
+//    realtime
+//---------------------------------------------------------
+
+void AudioStats::setQueueDepth(int n)
+      {
+      _queue = n;
+      if (n > _maxQueue)
+            _maxQueue = n;
+      }
+
+//---------------------------------------------------------
+//   setVoices
+//    realtime
+//---------------------------------------------------------
+
+void AudioStats::setVoices(int n)
+      {
+      _voices = n;
+      if (n > _maxVoices)
+            _maxVoices = n;
+      }
+
+//---------------------------------------------------------
+//   setDroppedMessages
+//    total is the running count of the synthesizers,
+//    which reset() cannot clear
+//    realtime
+//---------------------------------------------------------
+
+void AudioStats::setDroppedMessages(unsigned total)
+      {
+      _dropped += total - _droppedTotal.exchange(total);
+      }
+
+//---------------------------------------------------------
+//   setRenderMisses
+//    total is the running count of the render pools, see
+//    setDroppedMessages()
+//    realtime
+//---------------------------------------------------------
+
+void AudioStats::setRenderMisses(unsigned total)
+      {
+      _renderMisses += total - _renderMissesTotal.exchange(total);
+      }
+
+//---------------------------------------------------------
+//   setStreamUnderruns
+//    total is the running count of the sample streamers,
+//    see setDroppedMessages()
+//    realtime
+//---------------------------------------------------------
+
+void AudioStats::setStreamUnderruns(unsigned total)
+      {
+      _underruns += total - _underrunsTotal.exchange(total);
+      }
+
+//---------------------------------------------------------
+//   setStarvedVoices
+//    realtime
+//---------------------------------------------------------
+
+void AudioStats::setStarvedVoices(unsigned total)
+      {
+      _starved += total - _starvedTotal.exchange(total);
+      }
+
+//---------------------------------------------------------
+//   toString
+//---------------------------------------------------------
+
+QString AudioStats::toString() const
+      {
+      QString s;
+      QTextStream os(&s);
+      unsigned n = callbacks();
+      os << "callbacks:     " << n << "\n";
+      os << "buffer:        " << frames() << " frames, " << period() << " us\n";
+      os << "callback time: " << time() << " us, max " << maxTime() << " us\n";
+      os << "deadline missed: " << misses() << "\n";
+      os << "xruns:         " << xruns() << "\n";
+      os << "event queue:   " << queueDepth() << ", max " << maxQueueDepth() << "\n";
+      os << "voices:        " << voices() << ", max " << maxVoices() << "\n";
+      os << "dropped synth messages: " << droppedMessages() << "\n";
+      os << "render deadline missed: " << renderMisses() << "\n";
+      os << "sample stream underruns: " << streamUnderruns() << ", voices without stream " << starvedVoices() << "\n";
+      os << "load histogram (callback time / buffer period):\n";
+      for (int i = 0; i < BINS; ++i) {
+            unsigned h = histogram(i);
+            QString range = i < BINS - 1 ? QString("%1-%2%").arg(i * 10, 3).arg(i * 10 + 10, 3)
+                                         : QString(" >=%1%").arg(i * 10);
+            os << "  " << range << ": " << h;
+            if (n)
+                  os << QString(" (%1%)").arg(100.0 * h / n, 0, 'f', 1);
+            os << "\n";
+            }
+      return s;
+      }
+
+//---------------------------------------------------------
+//   save
+//---------------------------------------------------------
+
+bool AudioStats::save(const QString& path) const
+      {
+      QFile f(path);
+      if (!f.open(QIODevice::WriteOnly | QIODevice::Text)) {
+            qDebug("AudioStats: cannot write <%s>", qPrintable(path));
+            return false;
+            }
+      QByteArray ba = toString().toUtf8();
+      bool ok = f.write(ba) == ba.size();
+      f.close();
+      return ok;
+      }
+
+} // namespace Ms
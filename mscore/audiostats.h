@@ -0,0 +1,110 @@
+//=============================================================================
+//  MuseScore
+//  Music Composition & Notation
+//
+//  Copyright (C) 2015 Werner Schweer
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License version 2
+//  as published by the Free Software Foundation and appearing in
+//  the file LICENCE.GPL
+//=============================================================================
+
+#ifndef __AUDIOSTATS_H__
+#define __AUDIOSTATS_H__
+
+#include <atomic>
+#include <chrono>
+
+namespace Ms {
+
+//---------------------------------------------------------
+//   AudioStats
+//    timing of the audio callback (Seq::process()).
+//    The audio thread is the only writer, the gui thread
+//    reads and resets the values; all members are atomic
+//    and no lock is taken.
+//---------------------------------------------------------
+
+class AudioStats {
+   public:
+      static const int BINS = 11;   // callback time in 10% steps of the buffer period,
+                                    // the last bin counts missed deadlines
+
+   private:
+      std::atomic<unsigned> _callbacks;
+      std::atomic<unsigned> _histogram[BINS];
+      std::atomic<unsigned> _xruns;       // reported by the driver
+      std::atomic<int> _frames;           // size of the last buffer
+      std::atomic<int> _period;           // usec
+      std::atomic<int> _time;             // usec of the last callback
+      std::atomic<int> _maxTime;
+      std::atomic<int> _queue;            // gui -> sequencer messages at callback start
+      std::atomic<int> _maxQueue;
+      std::atomic<int> _voices;
+      std::atomic<int> _maxVoices;
+      std::atomic<unsigned> _dropped;     // sequencer -> synthesizer messages lost
+      std::atomic<unsigned> _droppedTotal { 0 };  // synthesizer count at the last callback
+      std::atomic<unsigned> _renderMisses;        // parallel voice rendering missed its slot
+      std::atomic<unsigned> _renderMissesTotal { 0 };
+      std::atomic<unsigned> _underruns;           // streamed samples not read in time
+      std::atomic<unsigned> _underrunsTotal { 0 };
+      std::atomic<unsigned> _starved;             // voices started without a free stream
+      std::atomic<unsigned> _starvedTotal { 0 };
+
+   public:
+      //---------------------------------------------------------
+      //   Probe
+      //    measures the lifetime of the probe as one callback
+      //---------------------------------------------------------
+
+      class Probe {
+            AudioStats* stats;
+            unsigned frames;
+            int sampleRate;
+            std::chrono::steady_clock::time_point start;
+
+         public:
+            Probe(AudioStats* s, unsigned n, int sr)
+               : stats(s), frames(n), sampleRate(sr), start(std::chrono::steady_clock::now()) {}
+            ~Probe() {
+                  auto t = std::chrono::steady_clock::now() - start;
+                  stats->record(frames, sampleRate, int(std::chrono::duration_cast<std::chrono::microseconds>(t).count()));
+                  }
+            };
+
+      AudioStats()                  { reset(); }
+      void reset();
+
+      void record(unsigned frames, int sampleRate, int usec);
+      void xrun(int n = 1)          { _xruns += n; }
+      void setQueueDepth(int n);
+      void setVoices(int n);
+      void setDroppedMessages(unsigned total);
+      void setRenderMisses(unsigned total);
+      void setStreamUnderruns(unsigned total);
+      void setStarvedVoices(unsigned total);
+
+      unsigned callbacks() const    { return _callbacks; }
+      unsigned histogram(int bin) const { return _histogram[bin]; }
+      unsigned misses() const       { return _histogram[BINS - 1]; }
+      unsigned xruns() const        { return _xruns; }
+      int frames() const            { return _frames; }
+      int period() const            { return _period; }
+      int time() const              { return _time; }
+      int maxTime() const           { return _maxTime; }
+      int queueDepth() const        { return _queue; }
+      int maxQueueDepth() const     { return _maxQueue; }
+      int voices() const            { return _voices; }
+      int maxVoices() const         { return _maxVoices; }
+      unsigned droppedMessages() const { return _dropped; }
+      unsigned renderMisses() const { return _renderMisses; }
+      unsigned streamUnderruns() const { return _underruns; }
+      unsigned starvedVoices() const { return _starved; }
+
+      QString toString() const;
+      bool save(const QString& path) const;
+      };
+
+} // namespace Ms
+#endif
@@ -0,0 +1,156 @@
+//=============================================================================
+//  MuseScore
+//  Music Composition & Notation
+//
+//  Copyright (C) 2015 Werner Schweer
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License version 2
+//  as published by the Free Software Foundation and appearing in
+//  the file LICENCE.GPL
+//=============================================================================
+
+#include "autosave.h"
+
+namespace Ms {
+
+//---------------------------------------------------------
+//   AutoSaver
+//---------------------------------------------------------
+
+AutoSaver::AutoSaver(QObject* parent)
+   : QObject(parent)
+      {
+      worker = std::thread(&AutoSaver::run, this);
+      }
+
+AutoSaver::~AutoSaver()
+      {
+      {
+      std::lock_guard<std::mutex> lock(mutex);
+      quit  = true;
+      abort = true;
+      jobs.clear();           // the scores were cancelled and are gone
+      }
+      cond.notify_all();
+      worker.join();
+      }
+
+//---------------------------------------------------------
+//   save
+//    gui thread; files are moved into the job. If score
+//    is set, Score::startBackgroundSave() was called and
+//    the score is written with the files unless it is
+//    changed before.
+//---------------------------------------------------------
+
+void AutoSaver::save(const QString& path, QList<MsczFile>& files, bool newFile, Score* score)
+      {
+      {
+      std::lock_guard<std::mutex> lock(mutex);
+      for (auto i = jobs.begin(); i != jobs.end(); ++i) {
+            if (i->path == path) {
+                  newFile = newFile || i->newFile;
+                  jobs.erase(i);
+                  break;
+                  }
+            }
+      if (current == path) {
+            newFile = newFile || currentNewFile;
+            abort   = true;
+            }
+      jobs.push_back(Job());
+      Job& job   = jobs.back();
+      job.path    = path;
+      job.newFile = newFile;
+      job.score   = score;
+      job.files.swap(files);
+      }
+      cond.notify_all();
+      }
+
+//---------------------------------------------------------
+//   cancel
+//    gui thread; drop the pending snapshot of path and
+//    wait until a running one has stopped, the file
+//    can be removed afterwards
+//---------------------------------------------------------
+
+void AutoSaver::cancel(const QString& path)
+      {
+      std::unique_lock<std::mutex> lock(mutex);
+      for (auto i = jobs.begin(); i != jobs.end(); ++i) {
+            if (i->path == path) {
+                  jobs.erase(i);
+                  break;
+                  }
+            }
+      if (current == path) {
+            abort = true;
+            if (currentScore)
+                  currentScore->waitForBackgroundSave();    // stop reading the score now
+            cond.wait(lock, [this, &path] { return current != path; });
+            }
+      }
+
+//---------------------------------------------------------
+//   run
+//    worker thread
+//---------------------------------------------------------
+
+void AutoSaver::run()
+      {
+      std::unique_lock<std::mutex> lock(mutex);
+      for (;;) {
+            cond.wait(lock, [this] { return quit || !jobs.empty(); });
+            if (quit)
+                  break;
+            Job job = std::move(jobs.front());
+            jobs.pop_front();
+            current        = job.path;
+            currentNewFile = job.newFile;
+            currentScore   = job.score;
+            abort          = false;
+            lock.unlock();
+
+            bool ok = write(job);
+            if (ok && job.newFile)
+                  emit sessionChanged();
+
+            lock.lock();
+            current.clear();
+            currentScore = 0;
+            cond.notify_all();
+            }
+      }
+
+//---------------------------------------------------------
+//   write
+//    worker thread; the old file stays untouched if the
+//    job is aborted or fails
+//---------------------------------------------------------
+
+bool AutoSaver::write(const Job& job)
+      {
+      QSaveFile f(job.path);
+      if (!f.open(QIODevice::WriteOnly)) {
+            qDebug("AutoSaver: cannot write <%s>", qPrintable(job.path));
+            return false;
+            }
+      try {
+            bool ok;
+            if (job.score)
+                  ok = job.score->backgroundSave(&f, job.files, QFileInfo(job.path).completeBaseName() + ".mscx", &abort);
+            else
+                  ok = Score::writeMscz(&f, job.files, &abort);
+            if (!ok)
+                  f.cancelWriting();
+            }
+      catch (QString s) {
+            qDebug("AutoSaver: %s", qPrintable(s));
+            f.cancelWriting();
+            }
+      return f.commit();
+      }
+
+} // namespace Ms
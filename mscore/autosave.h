@@ -0,0 +1,71 @@
+//=============================================================================
+//  MuseScore
+//  Music Composition & Notation
+//
+//  Copyright (C) 2015 Werner Schweer
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License version 2
+//  as published by the Free Software Foundation and appearing in
+//  the file LICENCE.GPL
+//=============================================================================
+
+#ifndef __AUTOSAVE_H__
+#define __AUTOSAVE_H__
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include "libmscore/score.h"
+
+namespace Ms {
+
+//---------------------------------------------------------
+//   AutoSaver
+//    writes autosave snapshots of scores on a background
+//    thread. The snapshot is taken by the gui thread
+//    with Score::msczFiles(), compression and the disk
+//    write happen here. If the score could be prepared
+//    with Score::startBackgroundSave(), it is serialized
+//    here too; an edit aborts that. A file is replaced
+//    atomically, a newer snapshot of the same file
+//    replaces a pending one and aborts a running one.
+//---------------------------------------------------------
+
+class AutoSaver : public QObject {
+      Q_OBJECT
+
+      struct Job {
+            QString path;
+            QList<MsczFile> files;
+            bool newFile;           // path is not yet in the session file
+            Score* score { 0 };     // serialized here if set
+            };
+
+      std::thread worker;
+      std::mutex mutex;
+      std::condition_variable cond;
+      std::deque<Job> jobs;
+      QString current;              // path of the running job
+      bool currentNewFile { false };
+      Score* currentScore { 0 };    // read by the running job
+      std::atomic<bool> abort { false };
+      bool quit { false };
+
+      void run();
+      bool write(const Job&);
+
+   signals:
+      void sessionChanged();        // emitted from the worker thread
+
+   public:
+      AutoSaver(QObject* parent = 0);
+      ~AutoSaver();
+      void save(const QString& path, QList<MsczFile>& files, bool newFile, Score* score = 0);
+      void cancel(const QString& path);
+      };
+
+} // namespace Ms
+#endif
@@ -374,6 +374,7 @@ void EditStyle::apply()
 void EditStyle::applyToAllParts()
       {
       getValues();
+      cs->rootScore()->loadExcerpts();
       for (Excerpt* e : cs->rootScore()->excerpts()) {
             e->partScore()->undo(new ChangeStyle(e->partScore(), lstyle));
             e->partScore()->update();
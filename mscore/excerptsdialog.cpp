@@ -67,6 +67,7 @@ ExcerptsDialog::ExcerptsDialog(Score* s, QWidget* parent)
       score = s;
       if (score->parentScore())
             score = score->parentScore();
+      score->loadExcerpts();
 
       foreach(Excerpt* e, score->excerpts()) {
             ExcerptItem* ei = new ExcerptItem(e);
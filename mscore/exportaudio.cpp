@@ -57,6 +57,7 @@ bool MuseScore::saveAudio(Score* score, const QString& name)
 
       MasterSynthesizer* synti = synthesizerFactory();
       synti->init();
+      synti->setRealtime(false);
       int sampleRate = preferences.exportAudioSampleRate;
       synti->setSampleRate(sampleRate);
       bool r = synti->setState(score->synthesizerState());
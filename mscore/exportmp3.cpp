@@ -684,6 +684,7 @@ bool MuseScore::saveMp3(Score* score, const QString& name)
       uchar* bufferOut = new uchar[bufferSize];
       MasterSynthesizer* synti = synthesizerFactory();
       synti->init();
+      synti->setRealtime(false);
       synti->setSampleRate(sampleRate);
       bool r = synti->setState(score->synthesizerState());
       if (!r)
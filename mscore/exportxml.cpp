@@ -231,10 +231,12 @@ public:
 class SlurHandler {
       const Slur* slur[MAX_NUMBER_LEVEL];
       bool started[MAX_NUMBER_LEVEL];
+      QHash<const Element*, QList<const Slur*>> chordSlurs;  ///< slurs by start and end element
       int findSlur(const Slur* s) const;
 
 public:
       SlurHandler();
+      void init(const Score* score);
       void doSlurs(Chord* chord, Notations& notations, Xml& xml);
 
 private:
@@ -262,6 +264,10 @@ public:
 //---------------------------------------------------------
 
 typedef QHash<const Chord*, const Trill*> TrillHash;
+typedef QHash<QPair<int, int>, QList<const Spanner*>> SpannerStops;    // by track and tick2
+typedef QHash<int, QList<const Spanner*>> SpannerStarts;                // by tick
+typedef QHash<const Measure*, QList<const Trill*>> MeasureTrills;
+typedef QHash<QPair<const Segment*, int>, QList<QPair<const Harmony*, int>>> TrailingHarmonies; // by chordrest segment and track
 typedef QMap<const Instrument*, int> MxmlInstrumentMap;
 
 class ExportMusicXml {
@@ -280,6 +286,10 @@ class ExportMusicXml {
       int tenths;
       TrillHash trillStart;
       TrillHash trillStop;
+      SpannerStops spannerStops;
+      SpannerStarts spannerStarts;
+      MeasureTrills measureTrills;
+      TrailingHarmonies trailingHarmonies;
       MxmlInstrumentMap instrMap;
 
       int findHairpin(const Hairpin* tl) const;
@@ -297,6 +307,9 @@ class ExportMusicXml {
       void work(const MeasureBase* measure);
       void calcDivMoveToTick(int t);
       void calcDivisions();
+      void indexScore();
+      void writeParts();
+      void writePart(int idx, int staffCount);
       double getTenthsFromInches(double);
       double getTenthsFromDots(double);
       void keysigTimesig(const Measure* m, const Part* p);
@@ -310,6 +323,12 @@ public:
             {
             _score = s; tick = 0; div = 1; tenths = 40;
             millimeters = _score->spatium() * tenths / (10 * MScore::DPMM);
+            for (int i = 0; i < MAX_NUMBER_LEVEL; ++i) {
+                  brackets[i] = 0;
+                  hairpins[i] = 0;
+                  ottavas[i] = 0;
+                  trills[i] = 0;
+                  }
             }
       void write(QIODevice* dev);
       void credits(Xml& xml);
@@ -325,6 +344,8 @@ public:
       void tempoText(TempoText const* const text, int staff);
       void harmony(Harmony const* const, FretDiagram const* const fd, int offset = 0);
       Score* score() { return _score; }
+      QList<const Spanner*> spannersStarting(int tick) const { return spannerStarts.value(tick); }
+      QList<const Spanner*> spannersStopping(int track, int tick2) const { return spannerStops.value(qMakePair(track, tick2)); }
       };
 
 //---------------------------------------------------------
@@ -443,6 +464,26 @@ SlurHandler::SlurHandler()
             }
       }
 
+//---------------------------------------------------------
+//   init
+//    index the slurs of \a score by start and end element,
+//    in the order of the score's spanner map
+//---------------------------------------------------------
+
+void SlurHandler::init(const Score* score)
+      {
+      chordSlurs.clear();
+      for (auto it : score->spanner()) {
+            const Spanner* sp = it.second;
+            if (sp->generated() || sp->type() != Element::Type::SLUR)
+                  continue;
+            const Slur* s = static_cast<const Slur*>(sp);
+            chordSlurs[sp->startElement()].append(s);
+            if (sp->endElement() != sp->startElement())
+                  chordSlurs[sp->endElement()].append(s);
+            }
+      }
+
 static QString slurTieLineStyle(const SlurTie* s)
       {
       QString lineType;
@@ -537,27 +578,22 @@ static const Chord* findFirstChord(const Slur* s)
 
 void SlurHandler::doSlurs(Chord* chord, Notations& notations, Xml& xml)
       {
-      // loop over all slurs twice, first to handle the stops, then the starts
+      const QList<const Slur*> slurs = chordSlurs.value(chord);
+      // loop over the slurs starting or stopping at this chord twice,
+      // first to handle the stops, then the starts
       for (int i = 0; i < 2; ++i) {
-            // search for slur(s) starting or stopping at this chord
-            for (auto it : chord->score()->spanner()) {
-                  Spanner* sp = it.second;
-                  if (sp->generated() || sp->type() != Element::Type::SLUR)
-                        continue;
-                  if (chord == sp->startElement() || chord == sp->endElement()) {
-                        const Slur* s = static_cast<const Slur*>(sp);
-                        const Chord* firstChord = findFirstChord(s);
-                        if (firstChord) {
-                              if (i == 0) {
-                                    // first time: do slur stops
-                                    if (firstChord != chord)
-                                          doSlurStop(s, notations, xml);
-                                    }
-                              else {
-                                    // second time: do slur starts
-                                    if (firstChord == chord)
-                                          doSlurStart(s, notations, xml);
-                                    }
+            for (const Slur* s : slurs) {
+                  const Chord* firstChord = findFirstChord(s);
+                  if (firstChord) {
+                        if (i == 0) {
+                              // first time: do slur stops
+                              if (firstChord != chord)
+                                    doSlurStop(s, notations, xml);
+                              }
+                        else {
+                              // second time: do slur starts
+                              if (firstChord == chord)
+                                    doSlurStart(s, notations, xml);
                               }
                         }
                   }
@@ -842,22 +878,17 @@ static void findTrillAnchors(const Trill* trill, Chord*& startChord, Chord*& sto
       }
 
 // find all trills in this measure and this part
+// trills are the trills starting in the measure, in spanner map order
 
-static void findTrills(Measure* measure, int strack, int etrack, TrillHash& trillStart, TrillHash& trillStop)
+static void findTrills(const QList<const Trill*>& trills, int strack, int etrack, TrillHash& trillStart, TrillHash& trillStop)
       {
-      // loop over all spanners in this measure
-      int stick = measure->tick();
-      int etick = measure->tick() + measure->ticks();
-      for (auto it = measure->score()->spanner().lower_bound(stick); it != measure->score()->spanner().upper_bound(etick); ++it) {
-            Spanner* e = it->second;
+      for (const Trill* e : trills) {
             //qDebug("findTrills 1 trill %p type %d track %d tick %d", e, e->type(), e->track(), e->tick());
-            if (e->type() == Element::Type::TRILL && strack <= e->track() && e->track() < etrack
-                && e->tick() >= measure->tick() && e->tick() < (measure->tick() + measure->ticks()))
-                  {
+            if (strack <= e->track() && e->track() < etrack) {
                   //qDebug("findTrills 2 trill %p", e);
                   // a trill is found starting in this segment, trill end time is known
                   // determine notes to write trill start and stop
-                  const Trill* tr = static_cast<const Trill*>(e);
+                  const Trill* tr = e;
                   Chord* startChord = 0;  // chord where trill starts
                   Chord* stopChord = 0;   // chord where trill stops
 
@@ -4038,9 +4069,7 @@ static void figuredBass(Xml& xml, int strack, int etrack, int track, const Chord
 static void spannerStart(ExportMusicXml* exp, int strack, int etrack, int track, int sstaff, Segment* seg)
       {
       if (seg->segmentType() == Segment::Type::ChordRest) {
-            int stick = seg->tick();
-            for (auto it = exp->score()->spanner().lower_bound(stick); it != exp->score()->spanner().upper_bound(stick); ++it) {
-                  Spanner* e = it->second;
+            for (const Spanner* e : exp->spannersStarting(seg->tick())) {
 
                   int wtrack = -1; // track to write spanner
                   if (strack <= e->track() && e->track() < etrack)
@@ -4087,12 +4116,7 @@ static void spannerStart(ExportMusicXml* exp, int strack, int etrack, int track,
 
 static void spannerStop(ExportMusicXml* exp, int strack, int tick2, int sstaff, QSet<const Spanner*>& stopped)
       {
-      for (auto it : exp->score()->spanner()) {
-            Spanner* e = it.second;
-
-            if (e->tick2() != tick2 || e->track() != strack)
-                  continue;
-
+      for (const Spanner* e : exp->spannersStopping(strack, tick2)) {
             if (!stopped.contains(e)) {
                   stopped.insert(e);
                   switch (e->type()) {
@@ -4371,16 +4395,9 @@ void ExportMusicXml::write(QIODevice* dev)
             }
 
       calcDivisions();
-
-      for (int i = 0; i < MAX_NUMBER_LEVEL; ++i) {
-            brackets[i] = 0;
-            hairpins[i] = 0;
-            ottavas[i] = 0;
-            trills[i] = 0;
-            }
+      indexScore();
 
       xml.setDevice(dev);
-      xml.setCodec("UTF-8");
       xml << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n";
       xml << "<!DOCTYPE score-partwise PUBLIC \"-//Recordare//DTD MusicXML 3.0 Partwise//EN\" \"http://www.musicxml.org/dtds/partwise.dtd\">\n";
       xml.stag("score-partwise");
@@ -4509,451 +4526,561 @@ void ExportMusicXml::write(QIODevice* dev)
             }
       xml.etag();
 
-      staffCount = 0;
+      writeParts();
+
+      xml.etag();
+
+      if (concertPitch) {
+            // restore concert pitch
+            score()->endCmd(true);        // rollback
+            }
+      }
+
+//---------------------------------------------------------
+//   indexScore
+//    collect what the parts look up per chord or rest
+//    in one pass over the spanners and one over the measures
+//---------------------------------------------------------
+
+void ExportMusicXml::indexScore()
+      {
+      spannerStarts.clear();
+      spannerStops.clear();
+      measureTrills.clear();
+      for (auto it : _score->spanner()) {
+            const Spanner* sp = it.second;
+            spannerStarts[sp->tick()].append(sp);
+            spannerStops[qMakePair(sp->track(), sp->tick2())].append(sp);
+            }
+      sh.init(_score);
+
+      // harmonies in segments without a chord or rest in their own track
+      // belong to the last chord or rest before them in the measure
+      trailingHarmonies.clear();
+      QVector<const Segment*> lastCR(_score->ntracks());
+      auto si = _score->spanner().cbegin();
+      for (const MeasureBase* mb = _score->measures()->first(); mb; mb = mb->next()) {
+            if (mb->type() != Element::Type::MEASURE)
+                  continue;
+            const Measure* m = static_cast<const Measure*>(mb);
+
+            // the spanner map is sorted by tick, like the measures
+            while (si != _score->spanner().cend() && si->first < m->tick())
+                  ++si;
+            for (; si != _score->spanner().cend() && si->first < m->endTick(); ++si) {
+                  if (si->second->type() == Element::Type::TRILL)
+                        measureTrills[m].append(static_cast<const Trill*>(si->second));
+                  }
+
+            lastCR.fill(0);
+            for (const Segment* seg = m->first(); seg; seg = seg->next()) {
+                  if (!seg->isChordRest())
+                        continue;
+                  for (const Element* annot : seg->annotations()) {
+                        int track = annot->track();
+                        if (annot->type() == Element::Type::HARMONY && track >= 0 && track < lastCR.size()
+                            && !seg->element(track) && lastCR[track])
+                              trailingHarmonies[qMakePair(lastCR[track], track)].append(
+                                 qMakePair(static_cast<const Harmony*>(annot), seg->tick() - lastCR[track]->tick()));
+                        }
+                  for (int track = 0; track < lastCR.size(); ++track) {
+                        if (seg->element(track))
+                              lastCR[track] = seg;
+                        }
+                  }
+            }
+      }
+
+//---------------------------------------------------------
+//   writeParts
+//    write the parts on worker threads into buffers and append
+//    them in score order; at most one part per thread is held
+//    in memory
+//---------------------------------------------------------
+
+void ExportMusicXml::writeParts()
+      {
+      const QList<Part*>& il = _score->parts();
+      int threads = QThread::idealThreadCount();
+      if (threads < 2 || il.size() < 2) {
+            int staffCount = 0;
+            for (int idx = 0; idx < il.size(); ++idx) {
+                  writePart(idx, staffCount);
+                  staffCount += il.at(idx)->nstaves();
+                  }
+            return;
+            }
+
+      // the parts read the style through non-const accessors, make sure
+      // none of them has to detach it while the others read it
+      _score->style()->chordList();
 
+      QList<ExportMusicXml*> writers;
+      QList<QBuffer*> buffers;
+      QList<QFuture<void>> jobs;
+      int next       = 0;
+      int staffCount = 0;
       for (int idx = 0; idx < il.size(); ++idx) {
-            Part* part = il.at(idx);
-            tick = 0;
-            xml.stag(QString("part id=\"P%1\"").arg(idx+1));
+            while (next < il.size() && next < idx + threads) {
+                  ExportMusicXml* w = new ExportMusicXml(_score);
+                  w->div               = div;
+                  w->spannerStops      = spannerStops;
+                  w->spannerStarts     = spannerStarts;
+                  w->measureTrills     = measureTrills;
+                  w->trailingHarmonies = trailingHarmonies;
+                  w->sh                = sh;
+                  QBuffer* b = new QBuffer;
+                  b->open(QIODevice::WriteOnly);
+                  w->xml.setDevice(b);
+                  w->xml.setLevel(1);     // inside <score-partwise>
+                  writers.append(w);
+                  buffers.append(b);
+                  jobs.append(QtConcurrent::run(w, &ExportMusicXml::writePart, next, staffCount));
+                  staffCount += il.at(next)->nstaves();
+                  ++next;
+                  }
+            jobs.takeFirst().waitForFinished();
+            ExportMusicXml* w = writers.takeFirst();
+            QBuffer* b = buffers.takeFirst();
+            w->xml.flush();
+            xml.flush();
+            xml.device()->write(b->data());
+            delete w;
+            delete b;
+            }
+      }
 
-            int staves = part->nstaves();
-            int strack = part->startTrack();
-            int etrack = part->endTrack();
+//---------------------------------------------------------
+//   writePart
+//    staffCount is the number of staves in the parts before
+//---------------------------------------------------------
 
-            trillStart.clear();
-            trillStop.clear();
-            initInstrMap(instrMap, part->instruments(), _score);
+void ExportMusicXml::writePart(int idx, int staffCount)
+      {
+      Part* part = _score->parts().at(idx);
+      tick = 0;
+      xml.stag(QString("part id=\"P%1\"").arg(idx+1));
 
-            int measureNo = 1;          // number of next regular measure
-            int irregularMeasureNo = 1; // number of next irregular measure
-            int pickupMeasureNo = 1;    // number of next pickup measure
+      int staves = part->nstaves();
+      int strack = part->startTrack();
+      int etrack = part->endTrack();
 
-            FigBassMap fbMap;           // pending figured bass extends
+      trillStart.clear();
+      trillStop.clear();
+      initInstrMap(instrMap, part->instruments(), _score);
 
-            for (MeasureBase* mb = _score->measures()->first(); mb; mb = mb->next()) {
-                  if (mb->type() != Element::Type::MEASURE)
-                        continue;
-                  Measure* m = static_cast<Measure*>(mb);
-                  const PageFormat* pf = _score->pageFormat();
+      int measureNo = 1;          // number of next regular measure
+      int irregularMeasureNo = 1; // number of next irregular measure
+      int pickupMeasureNo = 1;    // number of next pickup measure
 
+      FigBassMap fbMap;           // pending figured bass extends
 
-                  // pickup and other irregular measures need special care
-                  QString measureTag = "measure number=";
-                  if ((irregularMeasureNo + measureNo) == 2 && m->irregular()) {
-                        measureTag += "\"0\" implicit=\"yes\"";
-                        pickupMeasureNo++;
-                        }
-                  else if (m->irregular())
-                        measureTag += QString("\"X%1\" implicit=\"yes\"").arg(irregularMeasureNo++);
-                  else
-                        measureTag += QString("\"%1\"").arg(measureNo++);
-                  if (preferences.musicxmlExportLayout)
-                        measureTag += QString(" width=\"%1\"").arg(QString::number(m->bbox().width() / MScore::DPMM / millimeters * tenths,'f',2));
-                  xml.stag(measureTag);
-
-                  // Handle the <print> element.
-                  // When exporting layout and all breaks, a <print> with layout informations
-                  // is generated for the measure types TopSystem, NewSystem and newPage.
-                  // When exporting layout but only manual or no breaks, a <print> with
-                  // layout informations is generated only for the measure type TopSystem,
-                  // as it is assumed the system layout is broken by the importing application
-                  // anyway and is thus useless.
-
-                  int currentSystem = NoSystem;
-                  Measure* previousMeasure = 0;
-
-                  for (MeasureBase* currentMeasureB = m->prev(); currentMeasureB; currentMeasureB = currentMeasureB->prev()) {
-                        if (currentMeasureB->type() == Element::Type::MEASURE) {
-                              previousMeasure = (Measure*) currentMeasureB;
-                              break;
-                              }
-                        }
+      for (MeasureBase* mb = _score->measures()->first(); mb; mb = mb->next()) {
+            if (mb->type() != Element::Type::MEASURE)
+                  continue;
+            Measure* m = static_cast<Measure*>(mb);
+            const PageFormat* pf = _score->pageFormat();
 
-                  if (!previousMeasure)
-                        currentSystem = TopSystem;
-                  else if (m->parent() && previousMeasure->parent()) {
-                        if (m->parent()->parent() != previousMeasure->parent()->parent())
-                              currentSystem = NewPage;
-                        else if (m->parent() != previousMeasure->parent())
-                              currentSystem = NewSystem;
-                        }
 
-                  bool prevMeasLineBreak = false;
-                  bool prevMeasPageBreak = false;
-                  if (previousMeasure) {
-                        prevMeasLineBreak = previousMeasure->lineBreak();
-                        prevMeasPageBreak = previousMeasure->pageBreak();
+            // pickup and other irregular measures need special care
+            QString measureTag = "measure number=";
+            if ((irregularMeasureNo + measureNo) == 2 && m->irregular()) {
+                  measureTag += "\"0\" implicit=\"yes\"";
+                  pickupMeasureNo++;
+                  }
+            else if (m->irregular())
+                  measureTag += QString("\"X%1\" implicit=\"yes\"").arg(irregularMeasureNo++);
+            else
+                  measureTag += QString("\"%1\"").arg(measureNo++);
+            if (preferences.musicxmlExportLayout)
+                  measureTag += QString(" width=\"%1\"").arg(QString::number(m->bbox().width() / MScore::DPMM / millimeters * tenths,'f',2));
+            xml.stag(measureTag);
+
+            // Handle the <print> element.
+            // When exporting layout and all breaks, a <print> with layout informations
+            // is generated for the measure types TopSystem, NewSystem and newPage.
+            // When exporting layout but only manual or no breaks, a <print> with
+            // layout informations is generated only for the measure type TopSystem,
+            // as it is assumed the system layout is broken by the importing application
+            // anyway and is thus useless.
+
+            int currentSystem = NoSystem;
+            Measure* previousMeasure = 0;
+
+            for (MeasureBase* currentMeasureB = m->prev(); currentMeasureB; currentMeasureB = currentMeasureB->prev()) {
+                  if (currentMeasureB->type() == Element::Type::MEASURE) {
+                        previousMeasure = (Measure*) currentMeasureB;
+                        break;
                         }
+                  }
+
+            if (!previousMeasure)
+                  currentSystem = TopSystem;
+            else if (m->parent() && previousMeasure->parent()) {
+                  if (m->parent()->parent() != previousMeasure->parent()->parent())
+                        currentSystem = NewPage;
+                  else if (m->parent() != previousMeasure->parent())
+                        currentSystem = NewSystem;
+                  }
 
-                  if (currentSystem != NoSystem) {
+            bool prevMeasLineBreak = false;
+            bool prevMeasPageBreak = false;
+            if (previousMeasure) {
+                  prevMeasLineBreak = previousMeasure->lineBreak();
+                  prevMeasPageBreak = previousMeasure->pageBreak();
+                  }
 
-                        // determine if a new-system or new-page is required
-                        QString newThing; // new-[system|page]="yes" or empty
-                        if (preferences.musicxmlExportBreaks == MusicxmlExportBreaks::ALL) {
-                              if (currentSystem == NewSystem)
-                                    newThing = " new-system=\"yes\"";
-                              else if (currentSystem == NewPage)
-                                    newThing = " new-page=\"yes\"";
-                              }
-                        else if (preferences.musicxmlExportBreaks == MusicxmlExportBreaks::MANUAL) {
-                              if (currentSystem == NewSystem && prevMeasLineBreak)
-                                    newThing = " new-system=\"yes\"";
-                              else if (currentSystem == NewPage && prevMeasPageBreak)
-                                    newThing = " new-page=\"yes\"";
-                              }
+            if (currentSystem != NoSystem) {
 
-                        // determine if layout information is required
-                        bool doLayout = false;
-                        if (preferences.musicxmlExportLayout) {
-                              if (currentSystem == TopSystem
-                                  || (preferences.musicxmlExportBreaks == MusicxmlExportBreaks::ALL && newThing != "")) {
-                                    doLayout = true;
-                                    }
+                  // determine if a new-system or new-page is required
+                  QString newThing; // new-[system|page]="yes" or empty
+                  if (preferences.musicxmlExportBreaks == MusicxmlExportBreaks::ALL) {
+                        if (currentSystem == NewSystem)
+                              newThing = " new-system=\"yes\"";
+                        else if (currentSystem == NewPage)
+                              newThing = " new-page=\"yes\"";
+                        }
+                  else if (preferences.musicxmlExportBreaks == MusicxmlExportBreaks::MANUAL) {
+                        if (currentSystem == NewSystem && prevMeasLineBreak)
+                              newThing = " new-system=\"yes\"";
+                        else if (currentSystem == NewPage && prevMeasPageBreak)
+                              newThing = " new-page=\"yes\"";
+                        }
+
+                  // determine if layout information is required
+                  bool doLayout = false;
+                  if (preferences.musicxmlExportLayout) {
+                        if (currentSystem == TopSystem
+                            || (preferences.musicxmlExportBreaks == MusicxmlExportBreaks::ALL && newThing != "")) {
+                              doLayout = true;
                               }
+                        }
 
-                        if (doLayout) {
-                              xml.stag(QString("print%1").arg(newThing));
-                              const double pageWidth  = getTenthsFromInches(pf->size().width());
-                              const double lm = getTenthsFromInches(pf->oddLeftMargin());
-                              const double rm = getTenthsFromInches(pf->oddRightMargin());
-                              const double tm = getTenthsFromInches(pf->oddTopMargin());
-
-                              // System Layout
-
-                              // For a multi-meaure rest positioning is valid only
-                              // in the replacing measure
-                              // note: for a normal measure, mmRest1 is the measure itself,
-                              // for a multi-meaure rest, it is the replacing measure
-                              const Measure* mmR1 = m->mmRest1();
-                              const System* system = mmR1->system();
-
-                              // Put the system print suggestions only for the first part in a score...
-                              if (idx == 0) {
-
-                                    // Find the right margin of the system.
-                                    double systemLM = getTenthsFromDots(mmR1->pagePos().x() - system->page()->pagePos().x()) - lm;
-                                    double systemRM = pageWidth - rm - (getTenthsFromDots(system->bbox().width()) + lm);
-
-                                    xml.stag("system-layout");
-                                    xml.stag("system-margins");
-                                    xml.tag("left-margin", QString("%1").arg(QString::number(systemLM,'f',2)));
-                                    xml.tag("right-margin", QString("%1").arg(QString::number(systemRM,'f',2)) );
-                                    xml.etag();
-
-                                    if (currentSystem == NewPage || currentSystem == TopSystem) {
-                                          const double topSysDist = getTenthsFromDots(mmR1->pagePos().y()) - tm;
-                                          xml.tag("top-system-distance", QString("%1").arg(QString::number(topSysDist,'f',2)) );
-                                          }
-                                    if (currentSystem == NewSystem) {
-                                          // see System::layout2() for the factor 2 * score()->spatium()
-                                          const double sysDist = getTenthsFromDots(mmR1->pagePos().y()
-                                                                                   - previousMeasure->pagePos().y()
-                                                                                   - previousMeasure->bbox().height()
-                                                                                   + 2 * score()->spatium()
-                                                                                   );
-                                          xml.tag("system-distance",
-                                                  QString("%1").arg(QString::number(sysDist,'f',2)));
-                                          }
+                  if (doLayout) {
+                        xml.stag(QString("print%1").arg(newThing));
+                        const double pageWidth  = getTenthsFromInches(pf->size().width());
+                        const double lm = getTenthsFromInches(pf->oddLeftMargin());
+                        const double rm = getTenthsFromInches(pf->oddRightMargin());
+                        const double tm = getTenthsFromInches(pf->oddTopMargin());
+
+                        // System Layout
+
+                        // For a multi-meaure rest positioning is valid only
+                        // in the replacing measure
+                        // note: for a normal measure, mmRest1 is the measure itself,
+                        // for a multi-meaure rest, it is the replacing measure
+                        const Measure* mmR1 = m->mmRest1();
+                        const System* system = mmR1->system();
+
+                        // Put the system print suggestions only for the first part in a score...
+                        if (idx == 0) {
+
+                              // Find the right margin of the system.
+                              double systemLM = getTenthsFromDots(mmR1->pagePos().x() - system->page()->pagePos().x()) - lm;
+                              double systemRM = pageWidth - rm - (getTenthsFromDots(system->bbox().width()) + lm);
+
+                              xml.stag("system-layout");
+                              xml.stag("system-margins");
+                              xml.tag("left-margin", QString("%1").arg(QString::number(systemLM,'f',2)));
+                              xml.tag("right-margin", QString("%1").arg(QString::number(systemRM,'f',2)) );
+                              xml.etag();
 
-                                    xml.etag();
+                              if (currentSystem == NewPage || currentSystem == TopSystem) {
+                                    const double topSysDist = getTenthsFromDots(mmR1->pagePos().y()) - tm;
+                                    xml.tag("top-system-distance", QString("%1").arg(QString::number(topSysDist,'f',2)) );
                                     }
-
-                              // Staff layout elements.
-                              for (int staffIdx = (staffCount == 0) ? 1 : 0; staffIdx < staves; staffIdx++) {
-                                    xml.stag(QString("staff-layout number=\"%1\"").arg(staffIdx + 1));
-                                    const double staffDist =
-                                          getTenthsFromDots(system->staff(staffCount + staffIdx - 1)->distanceDown());
-                                    xml.tag("staff-distance", QString("%1").arg(QString::number(staffDist,'f',2)));
-                                    xml.etag();
+                              if (currentSystem == NewSystem) {
+                                    // see System::layout2() for the factor 2 * score()->spatium()
+                                    const double sysDist = getTenthsFromDots(mmR1->pagePos().y()
+                                                                             - previousMeasure->pagePos().y()
+                                                                             - previousMeasure->bbox().height()
+                                                                             + 2 * score()->spatium()
+                                                                             );
+                                    xml.tag("system-distance",
+                                            QString("%1").arg(QString::number(sysDist,'f',2)));
                                     }
 
                               xml.etag();
                               }
-                        else {
-                              // !doLayout
-                              if (newThing != "")
-                                    xml.tagE(QString("print%1").arg(newThing));
+
+                        // Staff layout elements.
+                        for (int staffIdx = (staffCount == 0) ? 1 : 0; staffIdx < staves; staffIdx++) {
+                              xml.stag(QString("staff-layout number=\"%1\"").arg(staffIdx + 1));
+                              const double staffDist =
+                                    getTenthsFromDots(system->staff(staffCount + staffIdx - 1)->distanceDown());
+                              xml.tag("staff-distance", QString("%1").arg(QString::number(staffDist,'f',2)));
+                              xml.etag();
                               }
 
-                        } // if (currentSystem ...
+                        xml.etag();
+                        }
+                  else {
+                        // !doLayout
+                        if (newThing != "")
+                              xml.tagE(QString("print%1").arg(newThing));
+                        }
 
-                  attr.start();
+                  } // if (currentSystem ...
 
-                  findTrills(m, strack, etrack, trillStart, trillStop);
+            attr.start();
 
-                  // barline left must be the first element in a measure
-                  barlineLeft(m);
+            findTrills(measureTrills.value(m), strack, etrack, trillStart, trillStop);
 
-                  // output attributes with the first actual measure (pickup or regular)
-                  if ((irregularMeasureNo + measureNo + pickupMeasureNo) == 4) {
-                        attr.doAttr(xml, true);
-                        xml.tag("divisions", MScore::division / div);
-                        }
-                  // output attributes at start of measure: key, time
-                  keysigTimesig(m, part);
-                  // output attributes with the first actual measure (pickup or regular) only
-                  if ((irregularMeasureNo + measureNo + pickupMeasureNo) == 4) {
-                        if (staves > 1)
-                              xml.tag("staves", staves);
-                        if (instrMap.size() > 1)
-                              xml.tag("instruments", instrMap.size());
-                        }
+            // barline left must be the first element in a measure
+            barlineLeft(m);
 
-                        {
-                        // make sure clefs at end of measure get exported at start of next measure
-                        Measure* prevMeasure = m->prevMeasure();
-                        int tick             = m->tick();
-                        Segment* cs1;
-                        Segment* cs2         = m->findSegment(Segment::Type::Clef, tick);
-                        Segment* seg         = 0;
-
-                        if (prevMeasure)
-                              cs1 = prevMeasure->findSegment(Segment::Type::Clef,  tick);
-                        else
-                              cs1 = 0;
+            // output attributes with the first actual measure (pickup or regular)
+            if ((irregularMeasureNo + measureNo + pickupMeasureNo) == 4) {
+                  attr.doAttr(xml, true);
+                  xml.tag("divisions", MScore::division / div);
+                  }
+            // output attributes at start of measure: key, time
+            keysigTimesig(m, part);
+            // output attributes with the first actual measure (pickup or regular) only
+            if ((irregularMeasureNo + measureNo + pickupMeasureNo) == 4) {
+                  if (staves > 1)
+                        xml.tag("staves", staves);
+                  if (instrMap.size() > 1)
+                        xml.tag("instruments", instrMap.size());
+                  }
 
-                        if (cs1 && cs2) {
-                              // should only happen at begin of new system
-                              // when previous system ends with a non-generated clef
-                              seg = cs1;
-                              }
-                        else if (cs1)
-                              seg = cs1;
-                        else
-                              seg = cs2;
-                        clefDebug("exportxml: clef segments cs1=%p cs2=%p seg=%p", cs1, cs2, seg);
-
-                        // output attribute at start of measure: clef
-                        if (seg) {
-                              for (int st = strack; st < etrack; st += VOICES) {
-                                    // sstaff - xml staff number, counting from 1 for this
-                                    // instrument
-                                    // special number 0 -> dont show staff number in
-                                    // xml output (because there is only one staff)
-
-                                    int sstaff = (staves > 1) ? st - strack + VOICES : 0;
-                                    sstaff /= VOICES;
-
-                                    Clef* cle = static_cast<Clef*>(seg->element(st));
-                                    if (cle) {
-                                          clefDebug("exportxml: clef at start measure ti=%d ct=%d gen=%d", tick, int(cle->clefType()), cle->generated());
-                                          // output only clef changes, not generated clefs at line beginning
-                                          // exception: at tick=0, export clef anyway
-                                          if (tick == 0 || !cle->generated()) {
-                                                clefDebug("exportxml: clef exported");
-                                                clef(sstaff, cle);
-                                                }
-                                          else {
-                                                clefDebug("exportxml: clef not exported");
-                                                }
+                  {
+                  // make sure clefs at end of measure get exported at start of next measure
+                  Measure* prevMeasure = m->prevMeasure();
+                  int tick             = m->tick();
+                  Segment* cs1;
+                  Segment* cs2         = m->findSegment(Segment::Type::Clef, tick);
+                  Segment* seg         = 0;
+
+                  if (prevMeasure)
+                        cs1 = prevMeasure->findSegment(Segment::Type::Clef,  tick);
+                  else
+                        cs1 = 0;
+
+                  if (cs1 && cs2) {
+                        // should only happen at begin of new system
+                        // when previous system ends with a non-generated clef
+                        seg = cs1;
+                        }
+                  else if (cs1)
+                        seg = cs1;
+                  else
+                        seg = cs2;
+                  clefDebug("exportxml: clef segments cs1=%p cs2=%p seg=%p", cs1, cs2, seg);
+
+                  // output attribute at start of measure: clef
+                  if (seg) {
+                        for (int st = strack; st < etrack; st += VOICES) {
+                              // sstaff - xml staff number, counting from 1 for this
+                              // instrument
+                              // special number 0 -> dont show staff number in
+                              // xml output (because there is only one staff)
+
+                              int sstaff = (staves > 1) ? st - strack + VOICES : 0;
+                              sstaff /= VOICES;
+
+                              Clef* cle = static_cast<Clef*>(seg->element(st));
+                              if (cle) {
+                                    clefDebug("exportxml: clef at start measure ti=%d ct=%d gen=%d", tick, int(cle->clefType()), cle->generated());
+                                    // output only clef changes, not generated clefs at line beginning
+                                    // exception: at tick=0, export clef anyway
+                                    if (tick == 0 || !cle->generated()) {
+                                          clefDebug("exportxml: clef exported");
+                                          clef(sstaff, cle);
+                                          }
+                                    else {
+                                          clefDebug("exportxml: clef not exported");
                                           }
                                     }
                               }
                         }
+                  }
 
-                  // output attributes with the first actual measure (pickup or regular) only
-                  if ((irregularMeasureNo + measureNo + pickupMeasureNo) == 4) {
-                        const Instrument* instrument = part->instrument();
-
-                        // staff details
-                        // TODO: decide how to handle linked regular / TAB staff
-                        //       currently exported as a two staff part ...
-                        for (int i = 0; i < staves; i++) {
-                              Staff* st = part->staff(i);
-                              if (st->lines() != 5 || st->isTabStaff()) {
-                                    if (staves > 1)
-                                          xml.stag(QString("staff-details number=\"%1\"").arg(i+1));
-                                    else
-                                          xml.stag("staff-details");
-                                    xml.tag("staff-lines", st->lines());
-                                    if (st->isTabStaff() && instrument->stringData()) {
-                                          QList<instrString> l = instrument->stringData()->stringList();
-                                          for (int i = 0; i < l.size(); i++) {
-                                                char step  = ' ';
-                                                int alter  = 0;
-                                                int octave = 0;
-                                                midipitch2xml(l.at(i).pitch, step, alter, octave);
-                                                xml.stag(QString("staff-tuning line=\"%1\"").arg(i+1));
-                                                xml.tag("tuning-step", QString("%1").arg(step));
-                                                if (alter)
-                                                      xml.tag("tuning-alter", alter);
-                                                xml.tag("tuning-octave", octave);
-                                                xml.etag();
-                                                }
+            // output attributes with the first actual measure (pickup or regular) only
+            if ((irregularMeasureNo + measureNo + pickupMeasureNo) == 4) {
+                  const Instrument* instrument = part->instrument();
+
+                  // staff details
+                  // TODO: decide how to handle linked regular / TAB staff
+                  //       currently exported as a two staff part ...
+                  for (int i = 0; i < staves; i++) {
+                        Staff* st = part->staff(i);
+                        if (st->lines() != 5 || st->isTabStaff()) {
+                              if (staves > 1)
+                                    xml.stag(QString("staff-details number=\"%1\"").arg(i+1));
+                              else
+                                    xml.stag("staff-details");
+                              xml.tag("staff-lines", st->lines());
+                              if (st->isTabStaff() && instrument->stringData()) {
+                                    QList<instrString> l = instrument->stringData()->stringList();
+                                    for (int i = 0; i < l.size(); i++) {
+                                          char step  = ' ';
+                                          int alter  = 0;
+                                          int octave = 0;
+                                          midipitch2xml(l.at(i).pitch, step, alter, octave);
+                                          xml.stag(QString("staff-tuning line=\"%1\"").arg(i+1));
+                                          xml.tag("tuning-step", QString("%1").arg(step));
+                                          if (alter)
+                                                xml.tag("tuning-alter", alter);
+                                          xml.tag("tuning-octave", octave);
+                                          xml.etag();
                                           }
-                                    xml.etag();
                                     }
-                              }
-                        // instrument details
-                        if (instrument->transpose().chromatic) {
-                              xml.stag("transpose");
-                              xml.tag("diatonic",  instrument->transpose().diatonic % 7);
-                              xml.tag("chromatic", instrument->transpose().chromatic % 12);
-                              int octaveChange = instrument->transpose().chromatic / 12;
-                              if (octaveChange != 0)
-                                    xml.tag("octave-change", octaveChange);
                               xml.etag();
                               }
                         }
+                  // instrument details
+                  if (instrument->transpose().chromatic) {
+                        xml.stag("transpose");
+                        xml.tag("diatonic",  instrument->transpose().diatonic % 7);
+                        xml.tag("chromatic", instrument->transpose().chromatic % 12);
+                        int octaveChange = instrument->transpose().chromatic / 12;
+                        if (octaveChange != 0)
+                              xml.tag("octave-change", octaveChange);
+                        xml.etag();
+                        }
+                  }
 
-                  // output attribute at start of measure: measure-style
-                  measureStyle(xml, attr, m);
-
-                  // set of spanners already stopped in this measure
-                  // required to prevent multiple spanner stops for the same spanner
-                  QSet<const Spanner*> spannersStopped;
-
-                  // MuseScore limitation: repeats are always in the first part
-                  // and are implicitly placed at either measure start or stop
-                  if (idx == 0)
-                        repeatAtMeasureStart(xml, attr, m, strack, etrack, strack);
-
-                  for (int st = strack; st < etrack; ++st) {
-                        // sstaff - xml staff number, counting from 1 for this
-                        // instrument
-                        // special number 0 -> dont show staff number in
-                        // xml output (because there is only one staff)
+            // output attribute at start of measure: measure-style
+            measureStyle(xml, attr, m);
+
+            // set of spanners already stopped in this measure
+            // required to prevent multiple spanner stops for the same spanner
+            QSet<const Spanner*> spannersStopped;
+
+            // MuseScore limitation: repeats are always in the first part
+            // and are implicitly placed at either measure start or stop
+            if (idx == 0)
+                  repeatAtMeasureStart(xml, attr, m, strack, etrack, strack);
+
+            for (int st = strack; st < etrack; ++st) {
+                  // sstaff - xml staff number, counting from 1 for this
+                  // instrument
+                  // special number 0 -> dont show staff number in
+                  // xml output (because there is only one staff)
+
+                  int sstaff = (staves > 1) ? st - strack + VOICES : 0;
+                  sstaff /= VOICES;
+                  for (Segment* seg = m->first(); seg; seg = seg->next()) {
+                        Element* el = seg->element(st);
+                        if (!el) {
+                              continue;
+                              }
+                        // must ignore start repeat to prevent spurious backup/forward
+                        if (el->type() == Element::Type::BAR_LINE && static_cast<BarLine*>(el)->barLineType() == BarLineType::START_REPEAT)
+                              continue;
 
-                        int sstaff = (staves > 1) ? st - strack + VOICES : 0;
-                        sstaff /= VOICES;
-                        for (Segment* seg = m->first(); seg; seg = seg->next()) {
-                              Element* el = seg->element(st);
-                              if (!el) {
-                                    continue;
-                                    }
-                              // must ignore start repeat to prevent spurious backup/forward
-                              if (el->type() == Element::Type::BAR_LINE && static_cast<BarLine*>(el)->barLineType() == BarLineType::START_REPEAT)
-                                    continue;
+                        // generate backup or forward to the start time of the element
+                        if (tick != seg->tick()) {
+                              attr.doAttr(xml, false);
+                              moveToTick(seg->tick());
+                              }
 
-                              // generate backup or forward to the start time of the element
-                              if (tick != seg->tick()) {
-                                    attr.doAttr(xml, false);
-                                    moveToTick(seg->tick());
-                                    }
+                        // handle annotations and spanners (directions attached to this note or rest)
+                        if (el->isChordRest()) {
+                              attr.doAttr(xml, false);
+                              annotations(this, xml, strack, etrack, st, sstaff, seg);
+                              // more harmony up to the next chord or rest in this track
+                              for (auto h : trailingHarmonies.value(qMakePair<const Segment*, int>(seg, st)))
+                                    harmony(h.first, 0, h.second / div);
+                              figuredBass(xml, strack, etrack, st, static_cast<const ChordRest*>(el), fbMap, div);
+                              spannerStart(this, strack, etrack, st, sstaff, seg);
+                              }
 
-                              // handle annotations and spanners (directions attached to this note or rest)
-                              if (el->isChordRest()) {
-                                    attr.doAttr(xml, false);
-                                    annotations(this, xml, strack, etrack, st, sstaff, seg);
-                                    // look for more harmony
-                                    for (Segment* seg1 = seg->next(); seg1; seg1 = seg1->next()) {
-                                          if (seg1->isChordRest()) {
-                                                Element* el1 = seg1->element(st);
-                                                if (el1) // found a ChordRest, next harmony will be attach to this one
-                                                      break;
-                                                for (Element* annot : seg1->annotations()) {
-                                                      if (annot->type() == Element::Type::HARMONY && annot->track() == st)
-                                                            harmony(static_cast<Harmony*>(annot), 0, (seg1->tick() - seg->tick()) / div);
-                                                      }
-                                                }
+                        switch (el->type()) {
+
+                              case Element::Type::CLEF:
+                                    {
+                                    // output only clef changes, not generated clefs
+                                    // at line beginning
+                                    // also ignore clefs at the start of a measure,
+                                    // these have already been output
+                                    // also ignore clefs at the end of a measure
+                                    // these will be output at the start of the next measure
+                                    Clef* cle = static_cast<Clef*>(el);
+                                    int ti = seg->tick();
+                                    clefDebug("exportxml: clef in measure ti=%d ct=%d gen=%d", ti, int(cle->clefType()), el->generated());
+                                    if (el->generated()) {
+                                          clefDebug("exportxml: generated clef not exported");
+                                          break;
                                           }
-                                    figuredBass(xml, strack, etrack, st, static_cast<const ChordRest*>(el), fbMap, div);
-                                    spannerStart(this, strack, etrack, st, sstaff, seg);
-                                    }
-
-                              switch (el->type()) {
-
-                                    case Element::Type::CLEF:
-                                          {
-                                          // output only clef changes, not generated clefs
-                                          // at line beginning
-                                          // also ignore clefs at the start of a measure,
-                                          // these have already been output
-                                          // also ignore clefs at the end of a measure
-                                          // these will be output at the start of the next measure
-                                          Clef* cle = static_cast<Clef*>(el);
-                                          int ti = seg->tick();
-                                          clefDebug("exportxml: clef in measure ti=%d ct=%d gen=%d", ti, int(cle->clefType()), el->generated());
-                                          if (el->generated()) {
-                                                clefDebug("exportxml: generated clef not exported");
-                                                break;
-                                                }
-                                          if (!el->generated() && ti != m->tick() && ti != m->endTick())
-                                                clef(sstaff, cle);
-                                          else {
-                                                clefDebug("exportxml: clef not exported");
-                                                }
+                                    if (!el->generated() && ti != m->tick() && ti != m->endTick())
+                                          clef(sstaff, cle);
+                                    else {
+                                          clefDebug("exportxml: clef not exported");
                                           }
-                                          break;
+                                    }
+                                    break;
 
-                                    case Element::Type::KEYSIG:
-                                          // ignore
-                                          break;
+                              case Element::Type::KEYSIG:
+                                    // ignore
+                                    break;
 
-                                    case Element::Type::TIMESIG:
-                                          // ignore
-                                          break;
+                              case Element::Type::TIMESIG:
+                                    // ignore
+                                    break;
 
-                                    case Element::Type::CHORD:
-                                          {
-                                          Chord* c                 = static_cast<Chord*>(el);
-                                          const QList<Lyrics*>* ll = &c->lyricsList();
-                                          // ise grace after
-                                          if (c) {
-                                                for (Chord* g : c->graceNotesBefore()) {
-                                                      chord(g, sstaff, ll, part->instrument()->useDrumset());
-                                                      }
-                                                chord(c, sstaff, ll, part->instrument()->useDrumset());
-                                                for (Chord* g : c->graceNotesAfter()) {
-                                                      chord(g, sstaff, ll, part->instrument()->useDrumset());
-                                                      }
+                              case Element::Type::CHORD:
+                                    {
+                                    Chord* c                 = static_cast<Chord*>(el);
+                                    const QList<Lyrics*>* ll = &c->lyricsList();
+                                    // ise grace after
+                                    if (c) {
+                                          for (Chord* g : c->graceNotesBefore()) {
+                                                chord(g, sstaff, ll, part->instrument()->useDrumset());
+                                                }
+                                          chord(c, sstaff, ll, part->instrument()->useDrumset());
+                                          for (Chord* g : c->graceNotesAfter()) {
+                                                chord(g, sstaff, ll, part->instrument()->useDrumset());
                                                 }
-                                          break;
                                           }
-                                    case Element::Type::REST:
-                                          rest((Rest*)el, sstaff);
-                                          break;
+                                    break;
+                                    }
+                              case Element::Type::REST:
+                                    rest((Rest*)el, sstaff);
+                                    break;
 
-                                    case Element::Type::BAR_LINE:
-                                          // Following must be enforced (ref MusicXML barline.dtd):
-                                          // If location is left, it should be the first element in the measure;
-                                          // if location is right, it should be the last element.
-                                          // implementation note: BarLineType::START_REPEAT already written by barlineLeft()
-                                          // any bars left should be "middle"
-                                          // TODO: print barline only if middle
-                                          // if (el->subtype() != BarLineType::START_REPEAT)
-                                          //       bar((BarLine*) el);
-                                          break;
-                                    case Element::Type::BREATH:
-                                          // ignore, already exported as note articulation
-                                          break;
+                              case Element::Type::BAR_LINE:
+                                    // Following must be enforced (ref MusicXML barline.dtd):
+                                    // If location is left, it should be the first element in the measure;
+                                    // if location is right, it should be the last element.
+                                    // implementation note: BarLineType::START_REPEAT already written by barlineLeft()
+                                    // any bars left should be "middle"
+                                    // TODO: print barline only if middle
+                                    // if (el->subtype() != BarLineType::START_REPEAT)
+                                    //       bar((BarLine*) el);
+                                    break;
+                              case Element::Type::BREATH:
+                                    // ignore, already exported as note articulation
+                                    break;
 
-                                    default:
-                                          qDebug("ExportMusicXml::write unknown segment type %s", el->name());
-                                          break;
-                                    }
+                              default:
+                                    qDebug("ExportMusicXml::write unknown segment type %s", el->name());
+                                    break;
+                              }
 
-                              // handle annotations and spanners (directions attached to this note or rest)
-                              if (el->isChordRest()) {
-                                    int spannerStaff = (st / VOICES) * VOICES;
-                                    spannerStop(this, spannerStaff, tick, sstaff, spannersStopped);
-                                    }
+                        // handle annotations and spanners (directions attached to this note or rest)
+                        if (el->isChordRest()) {
+                              int spannerStaff = (st / VOICES) * VOICES;
+                              spannerStop(this, spannerStaff, tick, sstaff, spannersStopped);
+                              }
 
-                              } // for (Segment* seg = ...
-                        attr.stop(xml);
-                        } // for (int st = ...
-                  // move to end of measure (in case of incomplete last voice)
+                        } // for (Segment* seg = ...
+                  attr.stop(xml);
+                  } // for (int st = ...
+            // move to end of measure (in case of incomplete last voice)
 #ifdef DEBUG_TICK
-                  qDebug("end of measure");
+            qDebug("end of measure");
 #endif
-                  moveToTick(m->tick() + m->ticks());
-                  if (idx == 0)
-                        repeatAtMeasureStop(xml, m, strack, etrack, strack);
-                  // note: don't use "m->repeatFlags() & Repeat::END" here, because more
-                  // barline types need to be handled besides repeat end ("light-heavy")
-                  barlineRight(m);
-                  xml.etag();
-                  }
-            staffCount += staves;
+            moveToTick(m->tick() + m->ticks());
+            if (idx == 0)
+                  repeatAtMeasureStop(xml, m, strack, etrack, strack);
+            // note: don't use "m->repeatFlags() & Repeat::END" here, because more
+            // barline types need to be handled besides repeat end ("light-heavy")
+            barlineRight(m);
             xml.etag();
             }
-
       xml.etag();
-
-      if (concertPitch) {
-            // restore concert pitch
-            score()->endCmd(true);        // rollback
-            }
       }
 
 //---------------------------------------------------------
@@ -5015,7 +5142,6 @@ bool saveMxl(Score* score, const QString& name)
       cbuf.open(QIODevice::ReadWrite);
       Xml xml;
       xml.setDevice(&cbuf);
-      xml.setCodec("UTF-8");
       xml << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n";
       xml.stag("container");
       xml.stag("rootfiles");
@@ -5027,14 +5153,11 @@ bool saveMxl(Score* score, const QString& name)
       //uz.addDirectory("META-INF");
       uz.addFile("META-INF/container.xml", cbuf.data());
 
-      QBuffer dbuf;
-      dbuf.open(QIODevice::ReadWrite);
+      // write the score directly into the archive
       ExportMusicXml em(score);
-      em.write(&dbuf);
-      dbuf.seek(0);
-      uz.addFile(fn, dbuf.data());
+      em.write(uz.openFile(fn));
       uz.close();
-      return true;
+      return uz.status() == MQZipWriter::NoError;
       }
 
 double ExportMusicXml::getTenthsFromInches(double inches)
@@ -84,6 +84,7 @@
 #include "libmscore/chordlist.h"
 #include "libmscore/mscore.h"
 #include "thirdparty/qzip/qzipreader_p.h"
+#include "autosave.h"
 
 extern Ms::Score::FileError importOve(Ms::Score*, const QString& name);
 
@@ -424,6 +425,7 @@ bool MuseScore::saveFile(Score* score)
             tab2->setTabText(idx, score->name());
       QString tmp = score->tmpName();
       if (!tmp.isEmpty()) {
+            autoSaver->cancel(tmp);
             QFile f(tmp);
             if (!f.remove())
                   qDebug("cannot remove temporary file <%s>", qPrintable(f.fileName()));
@@ -1688,6 +1690,7 @@ bool MuseScore::exportParts()
       QString confirmReplaceMessage = tr("\"%1\" already exists.\nDo you want to replace it?\n");
       QString replaceMessage = tr("Replace");
       QString skipMessage = tr("Skip");
+      thisScore->loadExcerpts();
       foreach (Excerpt* e, thisScore->excerpts())  {
             Score* pScore = e->partScore();
             QString partfn = fi.absolutePath() + QDir::separator() + fi.baseName() + "-" + createDefaultFileName(pScore->name()) + "." + ext;
@@ -2089,7 +2092,7 @@ Score::FileError readScore(Score* score, QString name, bool ignoreVersionError)
             }
 
       score->setLayoutAll(true);
-      for (Score* s : score->scoreList()) {
+      for (Score* s : score->scoreList()) {    // pending part scores are set up when read
             s->setPlaylistDirty();
             s->rebuildMidiMapping();
             s->updateChannel();
@@ -2555,6 +2558,7 @@ static QPixmap createThumbnail(const QString& name)
       Score::FileError error = readScore(score, name, true);
       if (error != Score::FileError::FILE_NO_ERROR)
             return QPixmap();
+      score->setLayoutMode(LayoutMode::PAGE);
       score->doLayout();
       QImage pm = score->createThumbnail();
       delete score;
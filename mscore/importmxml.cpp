@@ -37,17 +37,20 @@ Score::FileError importMusicXMLfromBuffer(Score* score, const QString& name, QIO
       qDebug("importMusicXMLfromBuffer(score %p, name '%s', dev %p)",
              score, qPrintable(name), dev);
 
-      // pass 1
+      // tokenize once, both passes replay the tokens
       dev->seek(0);
+      MxmlTokenBuffer tokens;
+      tokens.read(dev);
+
+      // pass 1
       MusicXMLParserPass1 pass1(score);
-      Score::FileError res = pass1.parse(dev);
+      Score::FileError res = pass1.parse(tokens);
       if (res != Score::FileError::FILE_NO_ERROR)
             return res;
 
       // pass 2
-      dev->seek(0);
       MusicXMLParserPass2 pass2(score, pass1);
-      return pass2.parse(dev);
+      return pass2.parse(tokens);
       }
 
 } // namespace Ms
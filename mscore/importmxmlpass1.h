@@ -48,7 +48,7 @@ class MusicXMLParserPass1 {
 public:
       MusicXMLParserPass1(Score* score);
       void initPartState(const QString& partId);
-      Score::FileError parse(QIODevice* device);
+      Score::FileError parse(const MxmlTokenBuffer& tokens);
       Score::FileError parse();
       void scorePartwise();
       void identification();
@@ -101,7 +101,7 @@ public:
 private:
       // generic pass 1 data
 
-      QXmlStreamReader _e;
+      MxmlReader _e;
       int _divs;                                ///< Current MusicXML divisions value
       QMap<QString, MusicXmlPart> _parts;       ///< Parts data, mapped on part id
       QVector<Fraction> _measureLength;         ///< Length of each measure
@@ -664,7 +664,7 @@ static QString decodeEntities( const QString& src )
  Read the next part of a MusicXML formatted string and convert to MuseScore internal encoding.
  */
 
-static QString nextPartOfFormattedString(QXmlStreamReader& e)
+static QString nextPartOfFormattedString(MxmlReader& e)
       {
       //QString lang       = e.attribute(QString("xml:lang"), "it");
       QString fontWeight = e.attributes().value("font-weight").toString();
@@ -1394,8 +1394,10 @@ static void handleSpannerStop(SLine* cur_sp, int track2, int tick, MusicXmlSpann
 //   MusicXMLParserPass2
 //---------------------------------------------------------
 
+int MusicXMLParserPass2::partThreads = 0;
+
 MusicXMLParserPass2::MusicXMLParserPass2(Score* score, MusicXMLParserPass1& pass1)
-      : _divs(0), _score(score), _pass1(pass1)
+      : _divs(0), _score(score), _pass1(pass1), _firstMeasure(0)
       {
       // nothing
       }
@@ -1581,13 +1583,13 @@ void MusicXMLParserPass2::skipLogCurrElem()
 //---------------------------------------------------------
 
 /**
- Parse MusicXML in \a device and extract pass 2 data.
+ Parse the MusicXML \a tokens and extract pass 2 data.
  */
 
-Score::FileError MusicXMLParserPass2::parse(QIODevice* device)
+Score::FileError MusicXMLParserPass2::parse(const MxmlTokenBuffer& tokens)
       {
       qDebug("MusicXMLParserPass2::parse()");
-      _e.setDevice(device);
+      _e.setTokens(&tokens);
       Score::FileError res = parse();
       qDebug("MusicXMLParserPass2::parse() res %hhd", res);
       return res;
@@ -1636,15 +1638,210 @@ void MusicXMLParserPass2::scorePartwise()
       {
       Q_ASSERT(_e.isStartElement() && _e.name() == "score-partwise");
 
+      QVector<int> parts;
       while (_e.readNextStartElement()) {
             if (_e.name() == "part") {
-                  part();
+                  parts.append(_e.position());
+                  _e.skipCurrentElement();
                   }
             else if (_e.name() == "part-list")
                   partList();
             else
                   skipLogCurrElem();
             }
+      readParts(parts);
+      }
+
+//---------------------------------------------------------
+//   lastDivisions
+//---------------------------------------------------------
+
+/**
+ Return the value of the last divisions element inside the element
+ starting at token \a pos, or \a divs if there is none.
+ */
+
+static int lastDivisions(const MxmlTokenBuffer& tokens, const int pos, const int divs)
+      {
+      for (int i = tokens.token(pos).end; i > pos; --i) {
+            const MxmlTokenBuffer::Token& t = tokens.token(i);
+            if (t.type == QXmlStreamReader::StartElement && tokens.name(t.name) == "divisions") {
+                  MxmlReader e;
+                  e.setTokens(&tokens, i);
+                  return e.readElementText().toInt();
+                  }
+            }
+      return divs;
+      }
+
+//---------------------------------------------------------
+//   readParts
+//---------------------------------------------------------
+
+/**
+ Read the part elements starting at token positions \a starts.
+ With more than one core each part is read on a worker thread by its own
+ parser into staging measures, which start with the divisions value a
+ serial read would have at that part. Changes outside the part (spanners,
+ tempo and time signature maps, measure properties, boxes) are deferred.
+ When all parts are read the staging measures and deferred changes are
+ merged into the score in document order, so the result is the same as
+ that of a serial read and does not depend on timing.
+ */
+
+void MusicXMLParserPass2::readParts(const QVector<int>& starts)
+      {
+      const MxmlTokenBuffer* tokens = _e.tokens();
+      const int end = _e.position();
+      QStringList ids;
+      bool known = true;
+      for (int pos : starts) {
+            _e.setTokens(tokens, pos);
+            ids.append(_e.attributes().value("id").toString());
+            known = known && _pass1.hasPart(ids.last());
+            }
+
+      // a part id used twice continues the same part and
+      // an unknown part is reported by part(): read serially
+      int threads = partThreads > 0 ? partThreads : QThread::idealThreadCount();
+      if (threads < 2 || starts.size() < 2 || !known || ids.toSet().size() != ids.size()) {
+            for (int pos : starts) {
+                  _e.setTokens(tokens, pos);
+                  part();
+                  }
+            _e.setTokens(tokens, end);
+            return;
+            }
+
+      // the parts read the style through non-const accessors, make sure
+      // none of them has to detach it while the others read it
+      _score->style()->chordList();
+      // notes and spanners mark these on the score, set them once here
+      // so the workers find them set and do not write them
+      _score->setPlaylistDirty();
+      _score->spannerMap().setDirty();
+
+      QList<MusicXMLParserPass2*> readers;
+      QList<QFuture<void>> jobs;
+      for (int pos : starts) {
+            MusicXMLParserPass2* r = new MusicXMLParserPass2(_score, _pass1);
+            r->_divs = _divs;
+            r->stage();
+            r->_e.setTokens(tokens, pos);
+            readers.append(r);
+            // a part without divisions uses the ones of the part before
+            _divs = lastDivisions(*tokens, pos, _divs);
+            }
+      int next = 0;
+      for (int idx = 0; idx < readers.size(); ++idx) {
+            while (next < readers.size() && next < idx + threads) {
+                  jobs.append(QtConcurrent::run(readers.at(next), &MusicXMLParserPass2::part));
+                  ++next;
+                  }
+            jobs[idx].waitForFinished();
+            }
+      for (MusicXMLParserPass2* r : readers) {
+            r->merge();
+            _parseStatus += r->_parseStatus;
+            }
+      qDeleteAll(readers);
+      _e.setTokens(tokens, end);
+      }
+
+//---------------------------------------------------------
+//   stage
+//---------------------------------------------------------
+
+/**
+ Create a staging measure for every measure of the score.
+ The part is read into these instead of the measures shared by all parts.
+ */
+
+void MusicXMLParserPass2::stage()
+      {
+      Measure* prev = 0;
+      for (Measure* m = _score->firstMeasure(); m; m = m->nextMeasure()) {
+            Measure* sm = new Measure(_score);
+            sm->setTick(m->tick());
+            sm->setLen(m->len());
+            sm->setTimesig(m->timesig());
+            sm->setPrev(prev);
+            if (prev)
+                  prev->setNext(sm);
+            else
+                  _firstMeasure = sm;
+            _realMeasures.insert(sm, m);
+            prev = sm;
+            }
+      }
+
+//---------------------------------------------------------
+//   merge
+//---------------------------------------------------------
+
+/**
+ Move the contents of the staging measures into the score's measures,
+ then apply the deferred changes in the order they were made.
+ */
+
+void MusicXMLParserPass2::merge()
+      {
+      const int tracks = _score->ntracks();
+      for (Measure* sm = _firstMeasure; sm; sm = sm->nextMeasure()) {
+            Measure* m = realMeasure(sm);
+            for (Segment* ss = sm->first(); ss; ss = ss->next()) {
+                  Segment* s = m->getSegment(ss->segmentType(), ss->tick());
+                  for (int track = 0; track < tracks; ++track) {
+                        Element* el = ss->element(track);
+                        if (!el)
+                              continue;
+                        ss->setElement(track, 0);
+                        s->setElement(track, el);
+                        if (el->isChordRest()) {
+                              for (Tuplet* t = static_cast<ChordRest*>(el)->tuplet(); t; t = t->tuplet()) {
+                                    if (t->parent() == sm)
+                                          t->setParent(m);
+                                    }
+                              }
+                        }
+                  std::vector<Element*> al = ss->annotations();
+                  ss->clearAnnotations();
+                  for (Element* el : al)
+                        s->add(el);
+                  }
+            for (int staffIdx = 0; staffIdx < _score->nstaves(); ++staffIdx) {
+                  if (sm->mstaff(staffIdx)->hasVoices)
+                        m->mstaff(staffIdx)->hasVoices = true;
+                  }
+            }
+      for (const std::function<void()>& op : _deferred)
+            op();
+      _deferred.clear();
+
+      for (Measure* sm = _firstMeasure; sm;) {
+            Measure* next = sm->nextMeasure();
+            delete sm;
+            sm = next;
+            }
+      _firstMeasure = 0;
+      _realMeasures.clear();
+      }
+
+//---------------------------------------------------------
+//   defer
+//---------------------------------------------------------
+
+/**
+ Apply \a op, which changes the score outside the part being read.
+ When reading into staging measures \a op is kept for merge().
+ */
+
+void MusicXMLParserPass2::defer(std::function<void()> op)
+      {
+      if (_firstMeasure)
+            _deferred.append(op);
+      else
+            op();
       }
 
 //---------------------------------------------------------
@@ -1760,11 +1957,26 @@ void MusicXMLParserPass2::part()
             //       sp, sp->type(), tick1, tick2, sp->track(), sp->track2());
             sp->setTick(tick1);
             sp->setTick2(tick2);
-            sp->score()->addElement(sp);
+            defer([sp]() { sp->score()->addElement(sp); });
             ++i;
             }
       _spanners.clear();
 
+      // the drumset defaults are deferred too, finish the part after them
+      const bool hasDrumset = _hasDrumset;
+      defer([this, id, mxmlDrumset, hasDrumset]() { finishPart(id, mxmlDrumset, hasDrumset); });
+      }
+
+//---------------------------------------------------------
+//   finishPart
+//---------------------------------------------------------
+
+/**
+ Set the instruments and staff type of part \a id after it has been read.
+ */
+
+void MusicXMLParserPass2::finishPart(const QString& id, const MusicXMLDrumset& mxmlDrumset, const bool hasDrumset)
+      {
       // determine if the part contains a drumset
       // this is the case if any instrument has a midi-unpitched element,
       // (which stored in the MusicXMLDrumInstrument pitch field)
@@ -1790,7 +2002,7 @@ void MusicXMLParserPass2::part()
       QString instrId = _pass1.getInstrList(id).instrument(Fraction(0, 1));
       setFirstInstrument(_pass1.getPart(id), id, instrId, mxmlDrumset);
 
-      if (_hasDrumset) {
+      if (hasDrumset) {
             // set staff type to percussion if incorrectly imported as pitched staff
             // Note: part has been read, staff type already set based on clef type and staff-details
             // but may be incorrect for a percussion staff that does not use a percussion clef
@@ -1809,13 +2021,13 @@ void MusicXMLParserPass2::part()
 //---------------------------------------------------------
 
 /**
- In Score \a score find the measure starting at \a tick.
+ In the measures starting with \a first find the measure starting at \a tick.
  */
 
-static Measure* findMeasure(Score* score, const int tick)
+static Measure* findMeasure(Measure* first, const int tick)
       {
-      for (Measure* m = score->firstMeasure();; m = m->nextMeasure()) {
-            if (m && m->tick() == tick)
+      for (Measure* m = first; m; m = m->nextMeasure()) {
+            if (m->tick() == tick)
                   return m;
             }
       return 0;
@@ -2002,7 +2214,7 @@ void MusicXMLParserPass2::measure(const QString& partId,
       QString number = _e.attributes().value("number").toString();
       //qDebug("measure %s start", qPrintable(number));
 
-      Measure* measure = findMeasure(_score, time.ticks());
+      Measure* measure = findMeasure(_firstMeasure ? _firstMeasure : _score->firstMeasure(), time.ticks());
       if (!measure) {
             logError(QString("measure at tick %1 not found!").arg(time.ticks()));
             skipLogCurrElem();
@@ -2010,7 +2222,7 @@ void MusicXMLParserPass2::measure(const QString& partId,
 
       // handle implicit measure
       if (_e.attributes().value("implicit") == "yes")
-            measure->setIrregular(true);
+            defer([this, measure]() { realMeasure(measure)->setIrregular(true); });
 
       Fraction mTime; // current time stamp within measure
       Fraction prevTime; // time stamp within measure previous chord
@@ -2111,8 +2323,10 @@ void MusicXMLParserPass2::measure(const QString& partId,
       // TODO:
       // - how to handle _timeSigDura.isZero (shouldn't happen ?)
       // - how to handle unmetered music
-      if (_timeSigDura.isValid() && !_timeSigDura.isZero())
-            measure->setTimesig(_timeSigDura);
+      if (_timeSigDura.isValid() && !_timeSigDura.isZero()) {
+            const Fraction timeSigDura = _timeSigDura;
+            defer([this, measure, timeSigDura]() { realMeasure(measure)->setTimesig(timeSigDura); });
+            }
 
       // mark superfluous accidentals as user accidentals
       const int scoreRelStaff = _score->staffIdx(part);
@@ -2122,7 +2336,7 @@ void MusicXMLParserPass2::measure(const QString& partId,
       // multi-measure rest handling
       if (getAndDecMultiMeasureRestCount() == 0) {
             // measure is first measure after a multi-measure rest
-            measure->setBreakMultiMeasureRest(true);
+            defer([this, measure]() { realMeasure(measure)->setBreakMultiMeasureRest(true); });
             }
 
       Q_ASSERT(_e.isEndElement() && _e.name() == "measure");
@@ -2182,8 +2396,10 @@ void MusicXMLParserPass2::measureStyle(Measure* measure)
                   int multipleRest = _e.readElementText().toInt();
                   if (multipleRest > 1) {
                         _multiMeasureRestCount = multipleRest;
-                        _score->style()->set(StyleIdx::createMultiMeasureRests, true);
-                        measure->setBreakMultiMeasureRest(true);
+                        defer([this, measure]() {
+                              _score->style()->set(StyleIdx::createMultiMeasureRests, true);
+                              realMeasure(measure)->setBreakMultiMeasureRest(true);
+                              });
                         }
                   else
                         logError(QString("multiple-rest %1 not supported").arg(multipleRest));
@@ -2209,26 +2425,31 @@ void MusicXMLParserPass2::print(Measure* measure)
       bool newSystem = _e.attributes().value("new-system") == "yes";
       bool newPage   = _e.attributes().value("new-page") == "yes";
       int blankPage = _e.attributes().value("blank-page").toInt();
+      if (!realMeasure(measure)->prevMeasure())
+            logDebugInfo("break on first measure");
+
       //
       // in MScore the break happens _after_ the marked measure:
       //
-      MeasureBase* pm = measure->prevMeasure();        // We insert VBox only for title, no HBox for the moment
-      if (pm == 0) {
-            logDebugInfo("break on first measure");
-            if (blankPage == 1) {       // blank title page, insert a VBOX if needed
-                  pm = measure->prev();
-                  if (pm == 0) {
-                        pm = _score->insertMeasure(Element::Type::VBOX, measure);
+      defer([this, measure, newSystem, newPage, blankPage]() {
+            Measure* m = realMeasure(measure);
+            MeasureBase* pm = m->prevMeasure();       // We insert VBox only for title, no HBox for the moment
+            if (pm == 0) {
+                  if (blankPage == 1) {       // blank title page, insert a VBOX if needed
+                        pm = m->prev();
+                        if (pm == 0) {
+                              pm = _score->insertMeasure(Element::Type::VBOX, m);
+                              }
                         }
                   }
-            }
-      if (pm) {
-            if (preferences.musicxmlImportBreaks && (newSystem || newPage)) {
-                  LayoutBreak* lb = new LayoutBreak(_score);
-                  lb->setLayoutBreakType(newSystem ? LayoutBreak::Type::LINE : LayoutBreak::Type::PAGE);
-                  pm->add(lb);
+            if (pm) {
+                  if (preferences.musicxmlImportBreaks && (newSystem || newPage)) {
+                        LayoutBreak* lb = new LayoutBreak(_score);
+                        lb->setLayoutBreakType(newSystem ? LayoutBreak::Type::LINE : LayoutBreak::Type::PAGE);
+                        pm->add(lb);
+                        }
                   }
-            }
+            });
 
       while (_e.readNextStartElement()) {
             skipLogCurrElem();
@@ -2306,7 +2527,9 @@ void MusicXMLParserDirection::direction(const QString& partId,
                   t->setXmlText(_wordsText + _metroText);
                   ((TempoText*) t)->setTempo(_tpoSound);
                   ((TempoText*) t)->setFollowText(true);
-                  _score->setTempo(tick, _tpoSound);
+                  const qreal tempo = _tpoSound;
+                  Score* score = _score;
+                  _pass2.defer([score, tick, tempo]() { score->setTempo(tick, tempo); });
                   }
             else {
                   if (_wordsText != "" || _metroText != "") {
@@ -2643,13 +2866,15 @@ void MusicXMLParserDirection::handleRepeats(Measure* measure, const int track)
                   jp->setTrack(track);
                   qDebug("jumpsMarkers adding jm %p meas %p",jp, measure);
                   // TODO jumpsMarkers.append(JumpMarkerDesc(jp, measure));
-                  measure->add(jp);
+                  MusicXMLParserPass2* pass2 = &_pass2;
+                  _pass2.defer([pass2, measure, jp]() { pass2->realMeasure(measure)->add(jp); });
                   }
             if (Marker* m = findMarker(repeat, _score)) {
                   m->setTrack(track);
                   qDebug("jumpsMarkers adding jm %p meas %p",m, measure);
                   // TODO jumpsMarkers.append(JumpMarkerDesc(m, measure));
-                  measure->add(m);
+                  MusicXMLParserPass2* pass2 = &_pass2;
+                  _pass2.defer([pass2, measure, m]() { pass2->realMeasure(measure)->add(m); });
                   }
             }
       }
@@ -3081,7 +3306,8 @@ void MusicXMLParserPass2::barline(const QString& partId, Measure* measure)
                   if (count.isEmpty()) {
                         count = "2";
                         }
-                  measure->setRepeatCount(count.toInt());
+                  const int repeatCount = count.toInt();
+                  defer([this, measure, repeatCount]() { realMeasure(measure)->setRepeatCount(repeatCount); });
                   _e.skipCurrentElement();
                   }
             else
@@ -3091,18 +3317,22 @@ void MusicXMLParserPass2::barline(const QString& partId, Measure* measure)
       BarLineType type = BarLineType::NORMAL;
       bool visible = true;
       if (determineBarLineType(barStyle, repeat, type, visible)) {
-            if (type == BarLineType::START_REPEAT) {
-                  measure->setRepeatFlags(Repeat::START);
-                  }
-            else if (type == BarLineType::END_REPEAT) {
-                  measure->setRepeatFlags(Repeat::END);
-                  }
-            else {
-                  if (loc == "right")
-                        measure->setEndBarLineType(type, false, visible);
-                  else if (measure->prevMeasure())
-                        measure->prevMeasure()->setEndBarLineType(type, false, visible);
-                  }
+            const bool right = loc == "right";
+            defer([this, measure, type, visible, right]() {
+                  Measure* m = realMeasure(measure);
+                  if (type == BarLineType::START_REPEAT) {
+                        m->setRepeatFlags(Repeat::START);
+                        }
+                  else if (type == BarLineType::END_REPEAT) {
+                        m->setRepeatFlags(Repeat::END);
+                        }
+                  else {
+                        if (right)
+                              m->setEndBarLineType(type, false, visible);
+                        else if (m->prevMeasure())
+                              m->prevMeasure()->setEndBarLineType(type, false, visible);
+                        }
+                  });
             }
 
       doEnding(partId, measure, endingNumber, endingType, endingText);
@@ -3144,7 +3374,7 @@ void MusicXMLParserPass2::doEnding(const QString& partId, Measure* measure,
                               volta->endings().clear();
                               volta->endings().append(iEndingNumbers);
                               volta->setTick(measure->tick());
-                              _score->addElement(volta);
+                              defer([volta]() { volta->score()->addElement(volta); });
                               _lastVolta = volta;
                               }
                         else if (type == "stop") {
@@ -3614,7 +3844,8 @@ void MusicXMLParserPass2::time(const QString& partId, Measure* measure, const in
                   _timeSigDura = Fraction(bts, btp);
                   // TODO: verify if fractionTSig handling must be copied from DOM parser
                   Fraction fractionTSig = Fraction(bts, btp);
-                  _score->sigmap()->add(tick, fractionTSig);
+                  Score* score = _score;
+                  defer([score, tick, fractionTSig]() { score->sigmap()->add(tick, fractionTSig); });
                   //Part* part = score->staff(staff)->part();
                   //int staves = part->nstaves();
                   for (int i = 0; i < _pass1.getPart(partId)->nstaves(); ++i) {
@@ -3890,7 +4121,7 @@ static Chord* createGraceChord(Score* score, const int track,
  until after allocating the note.
  */
 
-static bool elementMustBePostponed(const QXmlStreamReader& e)
+static bool elementMustBePostponed(const MxmlReader& e)
       {
       return e.name() == "notations"
              || e.name() == "lyric"
@@ -3926,7 +4157,7 @@ static void handleDisplayStep(ChordRest* cr, int step, int octave, int tick, qre
  Handle <display-step> and <display-octave> for <rest> and <unpitched>
  */
 
-static void displayStepOctave(QXmlStreamReader& e,
+static void displayStepOctave(MxmlReader& e,
                               int& step,
                               int& oct)
       {
@@ -4285,12 +4516,10 @@ Note* MusicXMLParserPass2::note(const QString& partId,
             if (noteheadParentheses) {
                   Symbol* s = new Symbol(_score);
                   s->setSym(SymId::noteheadParenthesisLeft);
-                  s->setParent(note);
-                  _score->addElement(s);
+                  note->add(s);
                   s = new Symbol(_score);
                   s->setSym(SymId::noteheadParenthesisRight);
-                  s->setParent(note);
-                  _score->addElement(s);
+                  note->add(s);
                   }
 
             if (velocity > 0) {
@@ -4358,7 +4587,10 @@ Note* MusicXMLParserPass2::note(const QString& partId,
                   }
                    */
                   // this should be done in pass 1, would make _pass1 const here
-                  _pass1.setDrumsetDefault(partId, instrId, headGroup, line, stemDir);
+                  MusicXMLParserPass1* pass1 = &_pass1;
+                  defer([pass1, partId, instrId, headGroup, line, stemDir]() {
+                        pass1->setDrumsetDefault(partId, instrId, headGroup, line, stemDir);
+                        });
                   }
 
             if (acc) {
@@ -4906,18 +5138,21 @@ void MusicXMLParserPass2::harmony(const QString& partId, Measure* measure, const
             s->add(fd);
             }
 
-      const ChordDescription* d = 0;
-      if (ha->rootTpc() != Tpc::TPC_INVALID)
-            d = ha->fromXml(kind, kindText, symbols, parens, degreeList);
-      if (d) {
-            ha->setId(d->id);
-            ha->setTextName(d->names.front());
-            }
-      else {
-            ha->setId(-1);
-            ha->setTextName(kindText);
-            }
-      ha->render();
+      // the chord descriptions are shared by all parts
+      defer([ha, kind, kindText, symbols, parens, degreeList]() {
+            const ChordDescription* d = 0;
+            if (ha->rootTpc() != Tpc::TPC_INVALID)
+                  d = ha->fromXml(kind, kindText, symbols, parens, degreeList);
+            if (d) {
+                  ha->setId(d->id);
+                  ha->setTextName(d->names.front());
+                  }
+            else {
+                  ha->setId(-1);
+                  ha->setTextName(kindText);
+                  }
+            ha->render();
+            });
 
       ha->setVisible(printObject);
 
@@ -5338,7 +5573,7 @@ void MusicXMLParserPass2::notations(Note* note, ChordRest* cr, const int tick,
                               newSlur->setTrack(track);
                               newSlur->setTrack2(track);
                               _slur[slurNo].start(newSlur);
-                              _score->addElement(newSlur);
+                              defer([newSlur]() { newSlur->score()->addElement(newSlur); });
                               }
                         }
                   else if (slurType == "stop") {
@@ -5873,7 +6108,7 @@ void MusicXMLParserPass2::tuplet(MusicXmlTupletDesc& tupletDesc)
  MusicXMLParserDirection constructor.
  */
 
-MusicXMLParserDirection::MusicXMLParserDirection(QXmlStreamReader& e,
+MusicXMLParserDirection::MusicXMLParserDirection(MxmlReader& e,
                                                  Score* score,
                                                  const MusicXMLParserPass1& pass1,
                                                  MusicXMLParserPass2& pass2)
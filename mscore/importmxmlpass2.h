@@ -20,6 +20,8 @@
 #ifndef __IMPORTMXMLPASS2_H__
 #define __IMPORTMXMLPASS2_H__
 
+#include <functional>
+
 #include "libmscore/score.h"
 #include "libmscore/tuplet.h"
 #include "importxmlfirstpass.h"
@@ -99,12 +101,14 @@ class MusicXMLParserPass2 {
 public:
       MusicXMLParserPass2(Score* score, MusicXMLParserPass1& pass1);
       void initPartState(const QString& partId);
-      Score::FileError parse(QIODevice* device);
+      Score::FileError parse(const MxmlTokenBuffer& tokens);
       Score::FileError parse();
       void scorePartwise();
+      void readParts(const QVector<int>& starts);
       void partList();
       void scorePart();
       void part();
+      void finishPart(const QString& id, const MusicXMLDrumset& mxmlDrumset, const bool hasDrumset);
       void measChordNote( /*, const MxmlPhase2Note note, ChordRest& currChord */);
       void measChordFlush( /*, ChordRest& currChord */);
       void measure(const QString& partId, const Fraction time);
@@ -156,15 +160,30 @@ public:
       void setMultiMeasureRestCount(int count);
       int getAndDecMultiMeasureRestCount();
 
+      // changes to the score outside the part being read
+      void defer(std::function<void()> op);
+      Measure* realMeasure(Measure* m) const { return _realMeasures.value(m, m); }
+
+      static int partThreads;             ///< parts read at the same time, 0: one per core
+
 private:
+      void stage();
+      void merge();
+
       // generic pass 2 data
 
-      QXmlStreamReader _e;
+      MxmlReader _e;
       int _divs;                          // the current divisions value
       QString _parseStatus;               // the parse status (typicallay a short error message)
       Score* const _score;                // the score
       MusicXMLParserPass1& _pass1;  // the pass1 results
 
+      // staging data, used when parts are read in parallel
+
+      Measure* _firstMeasure;             ///< first staging measure, 0 if reading into the score
+      QHash<Measure*, Measure*> _realMeasures;    ///< score measure for each staging measure
+      QList<std::function<void()>> _deferred;     ///< score changes replayed by merge()
+
       // part specific data (TODO: move to part-specific class)
 
       // Measure duration according to last timesig read
@@ -205,14 +224,14 @@ private:
 
 class MusicXMLParserDirection {
 public:
-      MusicXMLParserDirection(QXmlStreamReader& e, Score* score, const MusicXMLParserPass1& pass1, MusicXMLParserPass2& pass2);
+      MusicXMLParserDirection(MxmlReader& e, Score* score, const MusicXMLParserPass1& pass1, MusicXMLParserPass2& pass2);
       void direction(const QString& partId, Measure* measure, const int tick, MusicXmlSpannerMap& spanners);
       void logError(const QString& error);
       void logDebugInfo(const QString& info);
       void skipLogCurrElem();
 
 private:
-      QXmlStreamReader& _e;
+      MxmlReader& _e;
       Score* const _score;                      // the score
       const MusicXMLParserPass1& _pass1;        // the pass1 results
       MusicXMLParserPass2& _pass2;              // the pass2 results
@@ -612,7 +612,7 @@ static Score::FileError doValidate(const QString& name, QIODevice* dev)
  */
 
 #ifndef PULL_PARSER
-static Score::FileError doImport(Score* score, const QString& name, QIODevice* dev, MxmlReaderFirstPass const& pass1)
+static Score::FileError doImport(Score* score, const QString& /*name*/, QIODevice* dev, MxmlReaderFirstPass const& pass1)
       {
       QTime t;
       t.start();
@@ -624,7 +624,6 @@ static Score::FileError doImport(Score* score, const QString& name, QIODevice* d
             MScore::lastError = QObject::tr("Error at line %1 column %2: %3\n").arg(line).arg(column).arg(err);
             return Score::FileError::FILE_BAD_FORMAT;
             }
-      docName = name; // set filename for domError
       MusicXml musicxml(&doc, pass1);
       musicxml.import(score);
       score->fixTicks();
@@ -268,6 +268,18 @@ static void freewheel_callback(int /*starting*/, void*)
       {
       }
 
+//---------------------------------------------------------
+//   xrunCallback
+//    JACK callback
+//---------------------------------------------------------
+
+int JackAudio::xrunCallback(void* p)
+      {
+      JackAudio* audio = (JackAudio*)p;
+      audio->seq->audioStats()->xrun();
+      return 0;
+      }
+
 //---------------------------------------------------------
 //   sampleRateCallback
 //---------------------------------------------------------
@@ -464,6 +476,7 @@ bool JackAudio::init(bool hot)
       jack_set_port_registration_callback(client, registration_callback, this);
       jack_set_graph_order_callback(client, graph_callback, this);
       jack_set_freewheel_callback (client, freewheel_callback, this);
+      jack_set_xrun_callback(client, xrunCallback, this);
       if (preferences.jackTimebaseMaster)
             setTimebaseCallback();
       if (jack_set_buffer_size_callback (client, bufferSizeCallback, this) != 0)
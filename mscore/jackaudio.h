@@ -52,6 +52,7 @@ class JackAudio : public Driver {
       QList<jack_port_t*> midiInputPorts;
 
       static int processAudio(jack_nframes_t, void*);
+      static int xrunCallback(void*);
       static void timebase (jack_transport_state_t, jack_nframes_t, jack_position_t*, int, void *);
       void hotPlug();
       void setTimebaseCallback();
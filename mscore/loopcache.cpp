@@ -0,0 +1,133 @@
+//=============================================================================
+//  MuseScore
+//  Music Composition & Notation
+//
+//  Copyright (C) 2015 Werner Schweer
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License version 2
+//  as published by the Free Software Foundation and appearing in
+//  the file LICENCE.GPL
+//=============================================================================
+
+#include "loopcache.h"
+#include "musescore.h"
+#include "libmscore/mscore.h"
+#include "synthesizer/msynthesizer.h"
+
+namespace Ms {
+
+//---------------------------------------------------------
+//   ~LoopCache
+//---------------------------------------------------------
+
+LoopCache::~LoopCache()
+      {
+      _abort = true;
+      if (renderer.joinable())
+            renderer.join();
+      delete audio;
+      delete synti;
+      }
+
+//---------------------------------------------------------
+//   render
+//    start rendering frames of audio into a with a
+//    synthesizer in state s; key identifies s. The events
+//    are sorted by frame. Does nothing if the last
+//    renderer has not been taken yet.
+//---------------------------------------------------------
+
+void LoopCache::render(const SynthesizerState& s, const QString& key, std::vector<LoopEvent>& ev, LoopAudio* a, int n)
+      {
+      if (busy()) {
+            delete a;
+            return;
+            }
+      if (key != stateKey) {
+            state    = s;
+            stateKey = key;
+            }
+      audio  = a;
+      frames = n;
+      events.swap(ev);
+      _done  = false;
+      _abort = false;
+      renderer = std::thread(&LoopCache::run, this);
+      }
+
+//---------------------------------------------------------
+//   setup
+//    create the synthesizer or silence the one of the
+//    last loop; renderer thread
+//---------------------------------------------------------
+
+void LoopCache::setup()
+      {
+      if (!synti) {
+            synti = synthesizerFactory();
+            synti->init();
+            synti->setRealtime(false);
+            synti->setSampleRate(MScore::sampleRate);
+            }
+      if (loadedKey != stateKey) {
+            synti->setState(state);
+            loadedKey = stateKey;
+            }
+      synti->allSoundsOff(-1);
+      }
+
+//---------------------------------------------------------
+//   run
+//    renderer thread
+//---------------------------------------------------------
+
+void LoopCache::run()
+      {
+      setup();
+      std::vector<float>& data = audio->data;
+      data.assign(frames * 2, 0.0f);
+      auto e  = events.cbegin();
+      int pos = 0;
+      while (pos < frames && !_abort) {
+            int end = qMin(pos + BLOCK, frames);
+            for (; e != events.cend() && e->frame < end; ++e) {
+                  int n = e->frame - pos;
+                  if (n > 0) {
+                        synti->process(n, &data[pos * 2]);
+                        pos += n;
+                        }
+                  synti->play(e->event, e->synti);
+                  }
+            if (end > pos) {
+                  synti->process(end - pos, &data[pos * 2]);
+                  pos = end;
+                  }
+            }
+      _done = true;
+      }
+
+//---------------------------------------------------------
+//   take
+//    return the rendered audio or 0 if the renderer is
+//    not finished or was canceled; a finished renderer
+//    is released in both cases
+//---------------------------------------------------------
+
+LoopAudio* LoopCache::take()
+      {
+      if (!_done)
+            return 0;
+      renderer.join();
+      events.clear();
+      LoopAudio* a = audio;
+      audio = 0;
+      _done = false;
+      if (_abort) {
+            delete a;
+            return 0;
+            }
+      return a;
+      }
+
+} // namespace Ms
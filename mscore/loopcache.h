@@ -0,0 +1,91 @@
+//=============================================================================
+//  MuseScore
+//  Music Composition & Notation
+//
+//  Copyright (C) 2015 Werner Schweer
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License version 2
+//  as published by the Free Software Foundation and appearing in
+//  the file LICENCE.GPL
+//=============================================================================
+
+#ifndef __LOOPCACHE_H__
+#define __LOOPCACHE_H__
+
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "synthesizer/event.h"
+#include "libmscore/synthesizerstate.h"
+
+namespace Ms {
+
+class MasterSynthesizer;
+
+//---------------------------------------------------------
+//   LoopAudio
+//    the rendered loop range. It is not changed after
+//    rendering; the gui thread hands it to the sequencer
+//    with a SeqMsg and gets it back the same way for
+//    deletion.
+//---------------------------------------------------------
+
+struct LoopAudio {
+      int utickIn;
+      int utickOut;
+      int frameIn;                  // playTime of utickIn
+      std::vector<float> data;      // stereo frames from frameIn on
+
+      int frames() const            { return int(data.size() / 2); }
+      bool covers(int frame, int n) const {
+            return frame >= frameIn && frame + n <= frameIn + frames();
+            }
+      };
+
+//---------------------------------------------------------
+//   LoopEvent
+//---------------------------------------------------------
+
+struct LoopEvent {
+      int frame;                    // relative to LoopAudio::frameIn
+      int synti;                    // index in the rendering MasterSynthesizer
+      NPlayEvent event;
+      };
+
+//---------------------------------------------------------
+//   LoopCache
+//    renders a loop range with a private MasterSynthesizer
+//    on a background thread; used from the gui thread only.
+//    The synthesizer is created by the first render and
+//    kept; sound fonts are only loaded again when the
+//    synthesizer state changes.
+//---------------------------------------------------------
+
+class LoopCache {
+      static const int BLOCK = 512;
+
+      MasterSynthesizer* synti { 0 };   // renderer thread
+      SynthesizerState state;
+      QString stateKey;                 // of state
+      QString loadedKey;                // state synti is set up for, renderer thread
+      std::vector<LoopEvent> events;
+      LoopAudio* audio         { 0 };   // being rendered
+      int frames               { 0 };
+      std::thread renderer;
+      std::atomic<bool> _done  { false };
+      std::atomic<bool> _abort { false };
+
+      void run();
+      void setup();
+
+   public:
+      ~LoopCache();
+      void render(const SynthesizerState&, const QString& key, std::vector<LoopEvent>& events, LoopAudio*, int frames);
+      void cancel()                 { _abort = true; }
+      bool busy() const             { return renderer.joinable(); }
+      LoopAudio* take();
+      };
+
+} // namespace Ms
+#endif
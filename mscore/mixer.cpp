@@ -329,6 +329,7 @@ void PartEdit::muteChanged(bool val)
       if (val)
             seq->stopNotes(channel->channel);
       channel->mute = val;
+      seq->loopStateChanged();
       }
 
 //---------------------------------------------------------
@@ -339,6 +340,7 @@ void PartEdit::soloToggled(bool val)
       {
       channel->solo = val;
       channel->soloMute = !val;
+      seq->loopStateChanged();
       if (val) {
             mute->setChecked(false);
             for (Part* p : part->score()->parts()) {
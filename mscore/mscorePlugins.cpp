@@ -458,6 +458,8 @@ void MuseScore::pluginTriggered(int idx)
       // dont call startCmd for non modal dialog
       if (cs && p->pluginType() != "dock")
             cs->startCmd();
+      else if (cs)
+            cs->loadExcerpts();     // startCmd() does it otherwise
       p->runPlugin();
       if (cs && p->pluginType() != "dock")
             cs->endCmd();
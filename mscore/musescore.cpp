@@ -82,6 +82,7 @@
 #include "textpalette.h"
 #include "resourceManager.h"
 #include "scoreaccessibility.h"
+#include "autosave.h"
 
 #include "libmscore/mscore.h"
 #include "libmscore/system.h"
@@ -95,6 +96,7 @@
 
 #include "effects/zita1/zita.h"
 #include "effects/compressor/compressor.h"
+#include "effects/freeverb/freeverb.h"
 #include "effects/noeffect/noeffect.h"
 #include "synthesizer/synthesizer.h"
 #include "synthesizer/synthesizergui.h"
@@ -139,6 +141,7 @@ QString mscoreGlobalShare;
 
 static QString outFileName;
 static QString audioDriver;
+static QString audioStatsFile;
 static QString pluginName;
 static QString styleFile;
 static bool scoresOnCommandline { false };
@@ -263,6 +266,7 @@ void MuseScore::closeEvent(QCloseEvent* ev)
       writeSessionFile(true);
       foreach(Score* score, scoreList) {
             if (!score->tmpName().isEmpty()) {
+                  autoSaver->cancel(score->tmpName());
                   QFile f(score->tmpName());
                   f.remove();
                   }
@@ -989,6 +993,8 @@ MuseScore::MuseScore()
       autoSaveTimer = new QTimer(this);
       autoSaveTimer->setSingleShot(true);
       connect(autoSaveTimer, SIGNAL(timeout()), this, SLOT(autoSaveTimerTimeout()));
+      autoSaver = new AutoSaver(this);
+      connect(autoSaver, SIGNAL(sessionChanged()), SLOT(autoSaveSessionChanged()));
       initOsc();
       startAutoSave();
 
@@ -1852,6 +1858,7 @@ void MuseScore::removeTab(int i)
             setCurrentScoreView((firstTab ? tab1 : tab2)->view());
       writeSessionFile(false);
       if (!tmpName.isEmpty()) {
+            autoSaver->cancel(tmpName);
             QFile f(tmpName);
             f.remove();
             }
@@ -2129,6 +2136,7 @@ static bool processNonGui()
                                     cs->endCmd();
                                     }
                               }
+                        cs->loadExcerpts();
                         QList<Score*> scores;
                         scores.append(cs);
                         foreach(Excerpt* e, cs->excerpts())
@@ -2256,11 +2264,11 @@ MasterSynthesizer* synthesizerFactory()
       ms->registerEffect(0, new NoEffect);
       ms->registerEffect(0, new ZitaReverb);
       ms->registerEffect(0, new Compressor);
-      // ms->registerEffect(0, new Freeverb);
+      ms->registerEffect(0, new Freeverb);
       ms->registerEffect(1, new NoEffect);
       ms->registerEffect(1, new ZitaReverb);
       ms->registerEffect(1, new Compressor);
-      // ms->registerEffect(1, new Freeverb);
+      ms->registerEffect(1, new Freeverb);
       ms->setEffect(0, 1);
       ms->setEffect(1, 0);
       return ms;
@@ -2739,6 +2747,8 @@ void MuseScore::writeSettings()
       if (seq) {
             seq->stopWait();
             seq->exit();
+            if (!audioStatsFile.isEmpty())
+                  seq->audioStats()->save(audioStatsFile);
             }
       if (instrList)
             instrList->writeSettings();
@@ -3055,6 +3065,7 @@ void MuseScore::undoRedo(bool undo)
       if (cv)
             cv->startUndoRedo();
       if (cs) {
+            cs->waitForBackgroundSave();
             if (undo)
                   cs->undo()->undo();
             else
@@ -3263,16 +3274,11 @@ void MuseScore::removeSessionFile()
 
 void MuseScore::autoSaveTimerTimeout()
       {
-      bool sessionChanged = false;
       foreach (Score* s, scoreList) {
             if (s->autosaveDirty()) {
                   QString tmp = s->tmpName();
-                  if (!tmp.isEmpty()) {
-                        QFileInfo fi(tmp);
-                        // TODO: cannot catch exeption here:
-                        s->saveCompressedFile(fi, false);
-                        }
-                  else {
+                  bool newFile = false;
+                  if (tmp.isEmpty()) {
                         QDir dir;
                         dir.mkpath(dataPath);
                         QTemporaryFile tf(dataPath + "/scXXXXXX.mscz");
@@ -3281,17 +3287,36 @@ void MuseScore::autoSaveTimerTimeout()
                               qDebug("autoSaveTimerTimeout(): create temporary file failed");
                               return;
                               }
-                        s->setTmpName(tf.fileName());
-                        QFileInfo info(tf.fileName());
-                        s->saveCompressedFile(&tf, info, false);
+                        tmp = tf.fileName();
                         tf.close();
-                        sessionChanged = true;
+                        s->setTmpName(tmp);
+                        newFile = true;
+                        }
+                  // the snapshot is taken here, the file is written by
+                  // autoSaver; the session file is written when a new
+                  // file is complete. If possible the score is serialized
+                  // by autoSaver too, edits wait for it.
+                  QFileInfo fi(tmp);
+                  QList<MsczFile> files;
+                  bool background = false;
+                  try {
+                        files = s->msczFiles(fi, false, false);
+                        background = s->startBackgroundSave();
+                        if (!background)
+                              files = s->msczFiles(fi, false);
+                        }
+                  catch (QString e) {
+                        qDebug("autoSaveTimerTimeout(): %s", qPrintable(e));
+                        if (newFile) {
+                              QFile::remove(tmp);
+                              s->setTmpName("");
+                              }
+                        continue;
                         }
+                  autoSaver->save(tmp, files, newFile, background ? s : 0);
                   s->setAutosaveDirty(false);
                   }
             }
-      if (sessionChanged)
-            writeSessionFile(false);
       if (preferences.autoSave) {
             int t = preferences.autoSaveTime * 60 * 1000;
             autoSaveTimer->start(t);
@@ -4626,6 +4651,7 @@ int main(int argc, char* av[])
       parser.addOption(QCommandLineOption({"s", "no-synthesizer"}, "No internal synthesizer"));
       parser.addOption(QCommandLineOption({"m", "no-midi"}, "No midi"));
       parser.addOption(QCommandLineOption({"a", "use-audio"}, "Use audio driver: jack, alsa, pulse, or portaudio", "driver"));
+      parser.addOption(QCommandLineOption(      "audio-stats", "Write audio callback timing and xrun statistics to 'file' on exit", "file"));
       parser.addOption(QCommandLineOption({"n", "new-score"}, "Start with new score"));
       parser.addOption(QCommandLineOption({"I", "dump-midi-in"}, "Dump midi input"));
       parser.addOption(QCommandLineOption({"O", "dump-midi-out"}, "Dump midi output"));
@@ -4664,6 +4690,11 @@ int main(int argc, char* av[])
             if (audioDriver.isEmpty())
                   parser.showHelp(EXIT_FAILURE);
             }
+      if (parser.isSet("audio-stats")) {
+            audioStatsFile = parser.value("audio-stats");
+            if (audioStatsFile.isEmpty())
+                  parser.showHelp(EXIT_FAILURE);
+            }
       startWithNewScore = parser.isSet("n");
       externalIcons = parser.isSet("i");
       midiInputTrace = parser.isSet("I");
@@ -66,6 +66,7 @@ class Staff;
 class ScoreTab;
 class Drumset;
 class TextTools;
+class AutoSaver;
 class DrumTools;
 class ScriptEngine;
 class KeyEditor;
@@ -303,6 +304,7 @@ class MuseScore : public QMainWindow, public MuseScoreCore {
       void removeMenuEntry(PluginDescription*);
 
       QTimer* autoSaveTimer;
+      AutoSaver* autoSaver;
       QList<QAction*> qmlPluginActions;
       QList<QAction*> pluginActions;
       QSignalMapper* pluginMapper        { 0 };
@@ -419,6 +421,7 @@ class MuseScore : public QMainWindow, public MuseScoreCore {
    private slots:
       void cmd(QAction* a, const QString& cmd);
       void autoSaveTimerTimeout();
+      void autoSaveSessionChanged() { writeSessionFile(false); }
       void helpBrowser1() const;
       void about();
       void aboutQt();
@@ -191,6 +191,263 @@ void ValidatorMessageHandler::handleMessage(QtMsgType type, const QString& descr
       errors += errorStr;
       }
 
+//---------------------------------------------------------
+//   read
+//---------------------------------------------------------
+
+/**
+ Tokenize the document in \a device. Reading stops at the end
+ of the document or at the first error, which is stored as
+ an Invalid token, like QXmlStreamReader reports it.
+ */
+
+void MxmlTokenBuffer::read(QIODevice* device)
+      {
+      _tokens.clear();
+      _names.clear();
+      _texts.clear();
+      _attributes.clear();
+
+      QXmlStreamReader e(device);
+      QHash<QString, int> names;
+      QHash<QString, int> spaces;
+      QVector<int> open;                 // unclosed StartElement tokens
+
+      auto nameIndex = [&](const QStringRef& ref) {
+            QString n = ref.toString();
+            auto i = names.constFind(n);
+            if (i != names.constEnd())
+                  return i.value();
+            names.insert(n, _names.size());
+            _names.append(n);
+            return _names.size() - 1;
+            };
+      auto textIndex = [&](const QStringRef& ref) {
+            if (e.isWhitespace()) {
+                  QString t = ref.toString();
+                  auto i = spaces.constFind(t);
+                  if (i != spaces.constEnd())
+                        return i.value();
+                  spaces.insert(t, _texts.size());
+                  }
+            _texts.append(ref.toString());
+            return _texts.size() - 1;
+            };
+
+      for (;;) {
+            QXmlStreamReader::TokenType type = e.readNext();
+            Token t { type, -1, -1, -1, int(e.lineNumber()), int(e.columnNumber()) };
+            switch (type) {
+                  case QXmlStreamReader::StartElement: {
+                        t.name = nameIndex(e.name());
+                        QXmlStreamAttributes attrs;
+                        for (const QXmlStreamAttribute& a : e.attributes())
+                              attrs.append(_names[nameIndex(a.qualifiedName())], a.value().toString());
+                        t.data = _attributes.size();
+                        _attributes.append(attrs);
+                        open.append(_tokens.size());
+                        }
+                        break;
+                  case QXmlStreamReader::EndElement:
+                        t.name = nameIndex(e.name());
+                        if (!open.isEmpty())
+                              _tokens[open.takeLast()].end = _tokens.size();
+                        break;
+                  case QXmlStreamReader::Characters:
+                        t.data = textIndex(e.text());
+                        break;
+                  case QXmlStreamReader::EntityReference:
+                        t.name = nameIndex(e.name());
+                        t.data = textIndex(e.text());
+                        break;
+                  default:
+                        break;
+                  }
+            _tokens.append(t);
+            if (type == QXmlStreamReader::Invalid || type == QXmlStreamReader::EndDocument)
+                  break;
+            }
+      // after an error, skipping an unclosed element ends at the error
+      for (int i : open)
+            _tokens[i].end = _tokens.size() - 1;
+      _errorString = e.errorString();
+      }
+
+//---------------------------------------------------------
+//   setTokens
+//---------------------------------------------------------
+
+/**
+ Read \a buf, the next token read is the one after \a pos.
+ */
+
+void MxmlReader::setTokens(const MxmlTokenBuffer* buf, int pos)
+      {
+      _buf   = buf;
+      _pos   = pos;
+      _error = false;
+      }
+
+//---------------------------------------------------------
+//   current
+//---------------------------------------------------------
+
+const MxmlTokenBuffer::Token* MxmlReader::current() const
+      {
+      if (!_buf || _pos < 0 || _pos >= _buf->size())
+            return 0;
+      return &_buf->token(_pos);
+      }
+
+//---------------------------------------------------------
+//   tokenType
+//---------------------------------------------------------
+
+QXmlStreamReader::TokenType MxmlReader::tokenType() const
+      {
+      if (_error)
+            return QXmlStreamReader::Invalid;
+      const MxmlTokenBuffer::Token* t = current();
+      if (t)
+            return t->type;
+      return _pos < 0 ? QXmlStreamReader::NoToken : QXmlStreamReader::Invalid;
+      }
+
+//---------------------------------------------------------
+//   tokenString
+//---------------------------------------------------------
+
+QString MxmlReader::tokenString() const
+      {
+      static const char* const names[] = {
+            "NoToken", "Invalid", "StartDocument", "EndDocument", "StartElement", "EndElement",
+            "Characters", "Comment", "DTD", "EntityReference", "ProcessingInstruction"
+            };
+      return QLatin1String(names[tokenType()]);
+      }
+
+//---------------------------------------------------------
+//   name
+//---------------------------------------------------------
+
+QStringRef MxmlReader::name() const
+      {
+      const MxmlTokenBuffer::Token* t = current();
+      if (_error || !t || t->name < 0)
+            return QStringRef();
+      return QStringRef(&_buf->name(t->name));
+      }
+
+//---------------------------------------------------------
+//   attributes
+//---------------------------------------------------------
+
+QXmlStreamAttributes MxmlReader::attributes() const
+      {
+      const MxmlTokenBuffer::Token* t = current();
+      if (_error || !t || t->type != QXmlStreamReader::StartElement)
+            return QXmlStreamAttributes();
+      return _buf->attributes(t->data);
+      }
+
+//---------------------------------------------------------
+//   lineNumber
+//---------------------------------------------------------
+
+qint64 MxmlReader::lineNumber() const
+      {
+      const MxmlTokenBuffer::Token* t = current();
+      return t ? t->line : 0;
+      }
+
+//---------------------------------------------------------
+//   columnNumber
+//---------------------------------------------------------
+
+qint64 MxmlReader::columnNumber() const
+      {
+      const MxmlTokenBuffer::Token* t = current();
+      return t ? t->column : 0;
+      }
+
+//---------------------------------------------------------
+//   readNext
+//---------------------------------------------------------
+
+QXmlStreamReader::TokenType MxmlReader::readNext()
+      {
+      if (_error || !_buf)
+            return QXmlStreamReader::Invalid;
+      if (_pos < _buf->size())
+            ++_pos;
+      return tokenType();
+      }
+
+//---------------------------------------------------------
+//   readNextStartElement
+//---------------------------------------------------------
+
+bool MxmlReader::readNextStartElement()
+      {
+      while (readNext() != QXmlStreamReader::Invalid) {
+            if (isEndElement())
+                  return false;
+            else if (isStartElement())
+                  return true;
+            }
+      return false;
+      }
+
+//---------------------------------------------------------
+//   skipCurrentElement
+//    the matching EndElement is known, no need to read
+//    the tokens in between
+//---------------------------------------------------------
+
+void MxmlReader::skipCurrentElement()
+      {
+      if (isStartElement()) {
+            _pos = _buf->token(_pos).end;
+            return;
+            }
+      int depth = 1;
+      while (depth && readNext() != QXmlStreamReader::Invalid) {
+            if (isEndElement())
+                  --depth;
+            else if (isStartElement())
+                  ++depth;
+            }
+      }
+
+//---------------------------------------------------------
+//   readElementText
+//    like QXmlStreamReader::readElementText() with
+//    ErrorOnUnexpectedElement
+//---------------------------------------------------------
+
+QString MxmlReader::readElementText()
+      {
+      if (!isStartElement())
+            return QString();
+      QString result;
+      for (;;) {
+            switch (readNext()) {
+                  case QXmlStreamReader::Characters:
+                  case QXmlStreamReader::EntityReference:
+                        result += _buf->text(_buf->token(_pos).data);
+                        break;
+                  case QXmlStreamReader::EndElement:
+                        return result;
+                  case QXmlStreamReader::ProcessingInstruction:
+                  case QXmlStreamReader::Comment:
+                        break;
+                  default:
+                        _error = true;
+                        return result;
+                  }
+            }
+      }
+
 //---------------------------------------------------------
 //   printDomElementPath
 //---------------------------------------------------------
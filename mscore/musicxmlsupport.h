@@ -158,6 +158,82 @@ typedef QMap<QString, MusicXMLDrumInstrument> MusicXMLDrumset;
 typedef QMapIterator<QString, MusicXMLDrumInstrument> MusicXMLDrumsetIterator;
 
 
+//---------------------------------------------------------
+//   MxmlTokenBuffer
+//---------------------------------------------------------
+
+/**
+ A MusicXML document tokenized once by QXmlStreamReader, to be
+ replayed by one or more MxmlReader.
+ Element names and whitespace are shared between tokens.
+ */
+
+class MxmlTokenBuffer {
+public:
+      struct Token {
+            QXmlStreamReader::TokenType type;
+            int name;                  ///< index in _names, -1 if none
+            int data;                  ///< index in _attributes (StartElement) or _texts, -1 if none
+            int end;                   ///< StartElement: index of the matching EndElement
+            int line;
+            int column;
+            };
+
+      void read(QIODevice* device);
+      int size() const                             { return _tokens.size(); }
+      const Token& token(int i) const              { return _tokens[i]; }
+      const QString& name(int i) const             { return _names[i]; }
+      const QString& text(int i) const             { return _texts[i]; }
+      const QXmlStreamAttributes& attributes(int i) const { return _attributes[i]; }
+      QString errorString() const                  { return _errorString; }
+
+private:
+      QVector<Token> _tokens;
+      QVector<QString> _names;
+      QVector<QString> _texts;
+      QVector<QXmlStreamAttributes> _attributes;
+      QString _errorString;
+      };
+
+//---------------------------------------------------------
+//   MxmlReader
+//---------------------------------------------------------
+
+/**
+ Reads an MxmlTokenBuffer through the subset of the
+ QXmlStreamReader interface used by the MusicXML importer.
+ The buffer must not change while it is being read.
+ */
+
+class MxmlReader {
+public:
+      MxmlReader() : _buf(0), _pos(-1), _error(false) {}
+      void setTokens(const MxmlTokenBuffer* buf, int pos = -1);
+      const MxmlTokenBuffer* tokens() const        { return _buf; }
+      int position() const                         { return _pos; }
+
+      QXmlStreamReader::TokenType tokenType() const;
+      QString tokenString() const;
+      bool isStartElement() const                  { return tokenType() == QXmlStreamReader::StartElement; }
+      bool isEndElement() const                    { return tokenType() == QXmlStreamReader::EndElement; }
+      QStringRef name() const;
+      QXmlStreamAttributes attributes() const;
+      qint64 lineNumber() const;
+      qint64 columnNumber() const;
+
+      QXmlStreamReader::TokenType readNext();
+      bool readNextStartElement();
+      void skipCurrentElement();
+      QString readElementText();
+
+private:
+      const MxmlTokenBuffer::Token* current() const;
+
+      const MxmlTokenBuffer* _buf;
+      int _pos;                  ///< current token, -1 before the first one
+      bool _error;               ///< unexpected element in readElementText()
+      };
+
 //---------------------------------------------------------
 //   MxmlSupport -- MusicXML import support functions
 //---------------------------------------------------------
@@ -42,8 +42,10 @@ static PaStream* stream;
 //---------------------------------------------------------
 
 int paCallback(const void*, void* out, long unsigned frames,
-   const PaStreamCallbackTimeInfo*, PaStreamCallbackFlags, void *)
+   const PaStreamCallbackTimeInfo*, PaStreamCallbackFlags flags, void *)
       {
+      if (flags & (paOutputUnderflow | paOutputOverflow))
+            seq->audioStats()->xrun();
       seq->process((unsigned)frames, (float*)out);
       return 0;
       }
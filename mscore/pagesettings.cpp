@@ -345,6 +345,7 @@ void PageSettings::applyToScore(Score* s)
 
 void PageSettings::applyToAllParts()
       {
+      cs->rootScore()->loadExcerpts();
       for (Excerpt* e : cs->rootScore()->excerpts())
             applyToScore(e->partScore());
       }
@@ -140,6 +140,10 @@ void Preferences::init()
       alsaPeriodSize     = 1024;
       alsaFragments      = 3;
       portaudioDevice    = -1;
+      synthesizerThreads = 1;
+      soundFontCacheSize = 512;
+      zerberusPreload    = 0;
+      loopCache          = false;
       portMidiInput      = "";
 
       antialiasedDrawing       = true;
@@ -155,6 +159,7 @@ void Preferences::init()
       midiExportRPNs           = false;
       MScore::playRepeats      = true;
       MScore::panPlayback      = true;
+      MScore::compressionLevel = -1;
       instrumentList1          = ":/data/instruments.xml";
       instrumentList2          = "";
 
@@ -270,6 +275,10 @@ void Preferences::write()
       s.setValue("alsaPeriodSize",     alsaPeriodSize);
       s.setValue("alsaFragments",      alsaFragments);
       s.setValue("portaudioDevice",    portaudioDevice);
+      s.setValue("synthesizerThreads", synthesizerThreads);
+      s.setValue("soundFontCacheSize", soundFontCacheSize);
+      s.setValue("zerberusPreload", zerberusPreload);
+      s.setValue("loopCache", loopCache);
       s.setValue("portMidiInput",   portMidiInput);
 
       s.setValue("layoutBreakColor",   MScore::layoutBreakColor);
@@ -288,6 +297,7 @@ void Preferences::write()
       s.setValue("midiExportRPNs",     midiExportRPNs);
       s.setValue("playRepeats",        MScore::playRepeats);
       s.setValue("panPlayback",        MScore::panPlayback);
+      s.setValue("compressionLevel",   MScore::compressionLevel);
       s.setValue("instrumentList",     instrumentList1);
       s.setValue("instrumentList2",    instrumentList2);
 
@@ -421,6 +431,10 @@ void Preferences::read()
       alsaPeriodSize     = s.value("alsaPeriodSize", alsaPeriodSize).toInt();
       alsaFragments      = s.value("alsaFragments", alsaFragments).toInt();
       portaudioDevice    = s.value("portaudioDevice", portaudioDevice).toInt();
+      synthesizerThreads = s.value("synthesizerThreads", synthesizerThreads).toInt();
+      soundFontCacheSize = s.value("soundFontCacheSize", soundFontCacheSize).toInt();
+      zerberusPreload    = s.value("zerberusPreload", zerberusPreload).toInt();
+      loopCache          = s.value("loopCache", loopCache).toBool();
       portMidiInput      = s.value("portMidiInput", portMidiInput).toString();
       MScore::layoutBreakColor   = s.value("layoutBreakColor", MScore::layoutBreakColor).value<QColor>();
       MScore::frameMarginColor   = s.value("frameMarginColor", MScore::frameMarginColor).value<QColor>();
@@ -432,6 +446,7 @@ void Preferences::read()
       midiExportRPNs           = s.value("midiExportRPNs", midiExportRPNs).toBool();
       MScore::playRepeats      = s.value("playRepeats", MScore::playRepeats).toBool();
       MScore::panPlayback      = s.value("panPlayback", MScore::panPlayback).toBool();
+      MScore::compressionLevel = qBound(-1, s.value("compressionLevel", MScore::compressionLevel).toInt(), 9);
       alternateNoteEntryMethod = s.value("alternateNoteEntry", alternateNoteEntryMethod).toBool();
       rememberLastConnections  = s.value("rememberLastMidiConnections", rememberLastConnections).toBool();
       proximity                = s.value("proximity", proximity).toInt();
@@ -826,6 +841,8 @@ void PreferenceDialog::updateValues()
       alsaPeriodSize->setCurrentIndex(index);
 
       alsaFragments->setValue(prefs.alsaFragments);
+      synthesizerThreads->setValue(prefs.synthesizerThreads);
+      zerberusPreload->setValue(prefs.zerberusPreload);
       drawAntialiased->setChecked(prefs.antialiasedDrawing);
       switch(prefs.sessionStart) {
             case SessionStart::EMPTY:  emptySession->setChecked(true); break;
@@ -1376,6 +1393,8 @@ void PreferenceDialog::apply()
       prefs.myTemplatesPath    = myTemplates->text();
       prefs.myPluginsPath      = myPlugins->text();
       prefs.sfPath             = sfPath->text();
+      prefs.synthesizerThreads = synthesizerThreads->value();
+      prefs.zerberusPreload    = zerberusPreload->value();
 
       int idx = exportAudioSampleRate->currentIndex();
       prefs.exportAudioSampleRate = exportAudioSampleRates[idx];
@@ -110,6 +110,10 @@ struct Preferences {
       int alsaFragments;
       int portaudioDevice;
       QString portMidiInput;
+      int synthesizerThreads;       // threads used to render the voices of one synthesizer
+      int soundFontCacheSize;       // MB of decoded SF3 samples kept in memory, 0: unlimited
+      int zerberusPreload;          // ms of every SFZ sample loaded, the rest is streamed; 0: load all
+      bool loopCache;               // play repeated loops from audio rendered in the background
 
       bool antialiasedDrawing;
       SessionStart sessionStart;
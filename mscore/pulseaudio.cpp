@@ -20,6 +20,16 @@ namespace Ms {
 
 #define FRAMES 2048
 
+//---------------------------------------------------------
+//   underflowCallback
+//---------------------------------------------------------
+
+void PulseAudio::underflowCallback(pa_stream*, void* data)
+      {
+      PulseAudio* pa = (PulseAudio*)data;
+      pa->seq->audioStats()->xrun();
+      }
+
 //---------------------------------------------------------
 //   PulseAudio
 //---------------------------------------------------------
@@ -35,6 +45,7 @@ class PulseAudio : public Driver {
       pthread_t thread;
 
       static void paCallback(pa_stream* s, size_t len, void* data);
+      static void underflowCallback(pa_stream* s, void* data);
       static void* paLoop(void*);
 
    public:
@@ -144,6 +155,7 @@ bool PulseAudio::init(bool)
             return false;
             }
       pa_stream_set_write_callback(playstream, paCallback, this);
+      pa_stream_set_underflow_callback(playstream, underflowCallback, this);
 
       bufattr.fragsize  = (uint32_t)-1;
       bufattr.maxlength = FRAMES * 2 * sizeof(float);
@@ -210,7 +210,7 @@ void ScoreTab::setCurrent(int n)
                   tab2->blockSignals(true);
                   tab2->addTab(score->name().replace("&","&&"));
                   foreach(const Excerpt* excerpt, excerpts) {
-                        tab2->addTab(excerpt->partScore()->name().replace("&","&&"));
+                        tab2->addTab(excerpt->title().replace("&","&&"));
                         }
                   tab2->setCurrentIndex(tsv->part);
                   tab2->blockSignals(false);
@@ -258,7 +258,7 @@ void ScoreTab::updateExcerpts()
             tab2->blockSignals(true);
             tab2->addTab(score->name().replace("&","&&"));
             foreach(const Excerpt* excerpt, excerpts)
-                  tab2->addTab(excerpt->partScore()->name().replace("&","&&"));
+                  tab2->addTab(excerpt->title().replace("&","&&"));
             tab2->blockSignals(false);
             tab2->setVisible(true);
 
@@ -283,15 +283,18 @@ void ScoreTab::setExcerpt(int n)
       if (tsv == 0)
             return;
       tsv->part     = n;
-      QSplitter* vs = viewSplitter(idx);
-      ScoreView* v;
       Score* score = tsv->score;
       if (n) {
             QList<Excerpt*>& excerpts = score->excerpts();
             if (!excerpts.isEmpty()) {
-                  score = excerpts.at(n - 1)->partScore();
+                  Excerpt* ex = excerpts.at(n - 1);
+                  if (ex->pending())
+                        score->loadExcerpt(ex);       // first time the part is shown
+                  score = ex->partScore();
                   }
             }
+      QSplitter* vs = viewSplitter(idx);
+      ScoreView* v;
       if (!vs) {
             vs = new QSplitter;
             v = new ScoreView;
@@ -372,6 +375,8 @@ void ScoreTab::removeTab(int idx)
                   }
             }
       foreach (Excerpt* excerpt, score->excerpts()) {
+            if (excerpt->pending())       // never shown
+                  continue;
             Score* sc = excerpt->partScore();
             for (int i = 0; i < stack->count(); ++i) {
                   QSplitter* vs = static_cast<QSplitter*>(stack->widget(i));
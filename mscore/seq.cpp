@@ -55,6 +55,9 @@ Seq* seq;
 static const int guiRefresh   = 10;       // Hz
 static const int peakHoldTime = 1400;     // msec
 static const int peakHold     = (peakHoldTime * guiRefresh) / 1000;
+static const int maxLoopCacheTime = 300;  // sec, longer loops are always synthesized live
+static const qreal renderAhead = 3.0;     // sec of the playlist rendered before playback starts
+static const qreal renderChunk = 2.0;     // sec of the playlist rendered per piece in the background
 static OggVorbis_File vf;
 
 #if 0 // yet(?) unused
@@ -144,6 +147,11 @@ Seq::Seq()
       maxMidiOutPort  = 0;
 
       endTick  = 0;
+      renderStart   = 0;
+      renderPos     = 0;
+      renderEnd     = 0;
+      renderWrapped = false;
+      renderedTo    = INT_MAX;
       state    = Transport::STOP;
       oggInit  = false;
       _driver  = 0;
@@ -186,7 +194,10 @@ Seq::Seq()
 
 Seq::~Seq()
       {
+      renderFuture.waitForFinished();
       delete _driver;
+      delete loopAudio;
+      delete controllerIndex;
       }
 
 //---------------------------------------------------------
@@ -204,9 +215,15 @@ void Seq::setScoreView(ScoreView* v)
             stopWait();
             }
       cv = v;
-      if (cs)
+      stopRendering();
+      if (cs) {
             disconnect(cs, SIGNAL(playlistChanged()), this, SLOT(setPlaylistChanged()));
+            disconnect(cs->rootScore(), SIGNAL(aboutToChange()), this, SLOT(waitForRendering()));
+            }
       cs = cv ? cv->score() : 0;
+      loopStateValid = false;
+      invalidateLoopCache();
+      renderedTo = INT_MAX;
 
       if (!heartBeatTimer->isActive())
             heartBeatTimer->start(20);    // msec
@@ -216,6 +233,7 @@ void Seq::setScoreView(ScoreView* v)
       if (cs) {
             initInstruments();
             connect(cs, SIGNAL(playlistChanged()), this, SLOT(setPlaylistChanged()));
+            connect(cs->rootScore(), SIGNAL(aboutToChange()), this, SLOT(waitForRendering()));
             }
       }
 
@@ -279,7 +297,7 @@ bool Seq::canStart()
       if (!_driver)
             return false;
       if (playlistChanged)
-            collectEvents();
+            startCollectEvents(cs->repeatList()->tick2utick(mscore->loop() ? cs->loopInTick() : cs->playPos()));
       return (!events.empty() && endTick != 0);
       }
 
@@ -291,7 +309,7 @@ bool Seq::canStart()
 void Seq::start()
       {
       if (playlistChanged)
-            collectEvents();
+            startCollectEvents(cs->repeatList()->tick2utick(mscore->loop() ? cs->loopInTick() : cs->playPos()));
       if (cs->playMode() == PlayMode::AUDIO) {
             if (!oggInit) {
                   vorbisData.pos  = 0;
@@ -448,6 +466,7 @@ void Seq::seqMessage(int msg, int arg)
                   break;
             case '3':   // Loop restart while playing
                   seek(cs->repeatList()->tick2utick(cs->loopInTick()));
+                  renderLoop();
                   break;
             case '2':
                   guiStop();
@@ -488,6 +507,22 @@ void Seq::seqMessage(int msg, int arg)
             }
       }
 
+//---------------------------------------------------------
+//   muted
+//    true if the note of a note on event is muted in
+//    the mixer
+//---------------------------------------------------------
+
+static bool muted(const NPlayEvent& event)
+      {
+      const Note* note = event.note();
+      if (!note)
+            return false;
+      Instrument* instr = note->staff()->part()->instrument(note->chord()->tick());
+      const Channel* a = instr->channel(note->subchannel());
+      return a->mute || a->soloMute;
+      }
+
 //---------------------------------------------------------
 //   playEvent
 //    send one event to the synthesizer
@@ -497,18 +532,7 @@ void Seq::playEvent(const NPlayEvent& event, unsigned framePos)
       {
       int type = event.type();
       if (type == ME_NOTEON) {
-            bool mute;
-            const Note* note = event.note();
-
-            if (note) {
-                  Instrument* instr = note->staff()->part()->instrument(note->chord()->tick());
-                  const Channel* a = instr->channel(note->subchannel());
-                  mute = a->mute || a->soloMute;
-                  }
-            else
-                  mute = false;
-
-            if (!mute)
+            if (!muted(event))
                   putEvent(event, framePos);
             }
       else if (type == ME_CONTROLLER || type == ME_PITCHBEND)
@@ -568,6 +592,14 @@ void Seq::processMessages()
                   case SeqMsgId::SEEK:
                         setPos(msg.intVal);
                         break;
+                  case SeqMsgId::ALL_NOTE_OFF:
+                        _synti->allNotesOff(msg.intVal);
+                        break;
+                  case SeqMsgId::LOOP_AUDIO:
+                        if (loopAudio)
+                              fromSeq.enqueue(SeqMsg(SeqMsgId::LOOP_AUDIO, loopAudio));
+                        loopAudio = msg.loopAudio;
+                        break;
                   default:
                         break;
                   }
@@ -638,6 +670,16 @@ void Seq::addCountInClicks()
 
 void Seq::process(unsigned n, float* buffer)
       {
+      AudioStats::Probe probe(&_audioStats, n, MScore::sampleRate);
+      _audioStats.setQueueDepth(toSeq.count());
+      if (_synti) {
+            _audioStats.setVoices(_synti->voiceCount());
+            _audioStats.setDroppedMessages(_synti->droppedMessages());
+            _audioStats.setRenderMisses(_synti->renderMisses());
+            _audioStats.setStreamUnderruns(_synti->streamUnderruns());
+            _audioStats.setStarvedVoices(_synti->starvedVoices());
+            }
+
       unsigned frames = n;
       Transport driverState = _driver->getState();
       // Checking for the reposition from JACK Transport
@@ -713,6 +755,7 @@ void Seq::process(unsigned n, float* buffer)
       processMessages();
 
       if (state == Transport::PLAY) {
+            preview.drain(_synti, 0);
             if (!cs)
                   return;
             EventMap::const_iterator* pPlayPos = &playPos;
@@ -728,65 +771,86 @@ void Seq::process(unsigned n, float* buffer)
                   pPlayPos  = &countInPlayPos;
                   pPlayTime = &countInPlayTime;
                   }
+            unsigned framePos = 0;
+            int startTime = *pPlayTime;
+            int endTime   = startTime + frames;
+            int utickEnd  = cs->repeatList()->tick2utick(cs->lastMeasure()->endTick());
             //
-            // play events for one segment
+            // play a repeated loop from the pre-rendered audio; the
+            // synthesizer still runs and gets all events besides
+            // note ons, so it is in sync when the loop is left and
+            // the notes played before the loop are released
             //
-            unsigned framePos = 0;
-            int endTime = *pPlayTime + frames;
-            int utickEnd = cs->repeatList()->tick2utick(cs->lastMeasure()->endTick());
-            for ( ; *pPlayPos != pEvents->cend(); ) {
-                  int n;
-                  if (inCountIn) {
-
-                        qreal bps = curTempo() * cs->tempomap()->relTempo();
-                        // relTempo needed here to ensure that bps changes as we slide the tempo bar
-
-                        qreal tickssec = bps * MScore::division;
-                        qreal secs = (*pPlayPos)->first / tickssec;
-                        int f = secs * MScore::sampleRate;
-                        if (f >= endTime)
-                              break;
-                        n = f - *pPlayTime;
-                        if (n < 0) {
-                              qDebug("Count-in: %d:  %d - %d", (*pPlayPos)->first, f, *pPlayTime);
-                              n = 0;
-                              }
+            bool fromLoop = !inCountIn && cs->playMode() == PlayMode::SYNTHESIZER && loopAudioCovers(frames);
+            //
+            // collect the events of this period. The gui thread
+            // holds the mutex while it merges a rendered part of
+            // the playlist into events, see mergeEvents(); then
+            // the events are played one period late instead of
+            // waiting for it. The gui thread may still be rendering
+            // the playlist, events at or after horizon are not
+            // played yet
+            //
+            int due      = 0;
+            bool loopOut = false;
+            bool atEnd   = false;
+            if (mutex.tryLock()) {
+                  int horizon = renderedTo;
+                  int last    = 0;
+                  if (renderWait >= 0 && horizon > renderWait) {
+                        playPos    = events.lower_bound(renderWait);
+                        renderWait = -1;
                         }
-                  else {
-                        int f = cs->utick2utime(playPos->first) * MScore::sampleRate;
-                        if (f >= endTime)
-                              break;
-                        n = f - *pPlayTime;
-                        if (n < 0) {
-                              qDebug("%d:  %d - %d", (*pPlayPos)->first, f, *pPlayTime);
-                              n = 0;
+                  for ( ; *pPlayPos != pEvents->cend() && due < MAX_DUE_EVENTS; ++(*pPlayPos)) {
+                        int f;
+                        if (inCountIn) {
+                              qreal bps = curTempo() * cs->tempomap()->relTempo();
+                              // relTempo needed here to ensure that bps changes as we slide the tempo bar
+
+                              qreal tickssec = bps * MScore::division;
+                              qreal secs = (*pPlayPos)->first / tickssec;
+                              f = secs * MScore::sampleRate;
+                              if (f >= endTime)
+                                    break;
                               }
-                        if (mscore->loop()) {
-                              int utickLoop = cs->repeatList()->tick2utick(cs->loopOutTick());
-                              if (utickLoop < utickEnd)
-                                    if ((*pPlayPos)->first >= utickLoop) {
-                                          qDebug ("Process playPos = %d  in/out tick = %d/%d  getCurTick() = %d   tickLoop = %d   playTime = %d",
-                                             (*pPlayPos)->first, cs->loopInTick(), cs->loopOutTick(), getCurTick(), utickLoop, *pPlayTime);
-                                          if (preferences.useJackTransport) {
-                                                int loopInUtick = cs->repeatList()->tick2utick(cs->loopInTick());
-                                                _driver->seekTransport(loopInUtick);
-                                                if (loopInUtick != 0) {
-                                                      int seekto = loopInUtick - 2 * cs->utime2utick((qreal)_driver->bufferSize() / MScore::sampleRate);
-                                                      seekRT((seekto > 0) ? seekto : 0 );
-                                                      }
-                                                }
-                                          else {
-                                                emit toGui('3');
-                                                }
-                                          // Exit this function to avoid segmentation fault in Scoreview
-                                          return;
+                        else {
+                              if (playPos->first >= horizon)
+                                    break;
+                              f = cs->utick2utime(playPos->first) * MScore::sampleRate;
+                              if (f >= endTime)
+                                    break;
+                              if (mscore->loop()) {
+                                    int utickLoop = cs->repeatList()->tick2utick(cs->loopOutTick());
+                                    if (utickLoop < utickEnd && (*pPlayPos)->first >= utickLoop) {
+                                          loopOut = true;
+                                          break;
                                           }
+                                    }
                               }
+                        last = qMax(f - startTime, last);     // late events are played at once
+                        dueEvents[due].event = (*pPlayPos)->second;
+                        dueEvents[due].frame = last;
+                        ++due;
+                        }
+                  if (!loopOut && *pPlayPos == pEvents->cend()) {
+                        if (!inCountIn && horizon != INT_MAX)
+                              renderWait = qMax(renderWait, horizon);   // wait for the next part of the playlist
+                        else
+                              atEnd = true;
                         }
+                  mutex.unlock();
+                  }
+            //
+            // play the events of this period
+            //
+            for (int i = 0; i < due; ++i) {
+                  int n = dueEvents[i].frame - framePos;
                   if (n) {
                         if (cs->playMode() == PlayMode::SYNTHESIZER) {
                               metronome(n, p, inCountIn);
                               _synti->process(n, p);
+                              if (fromLoop)
+                                    playLoopAudio(n, p);
                               p += n * 2;
                               *pPlayTime  += n;
                               frames    -= n;
@@ -810,20 +874,35 @@ void Seq::process(unsigned n, float* buffer)
                                     }
                               }
                         }
-                  const NPlayEvent& event = (*pPlayPos)->second;
-                  playEvent(event, framePos);
+                  const NPlayEvent& event = dueEvents[i].event;
+                  if (!fromLoop || event.type() != ME_NOTEON || event.velo() == 0)
+                        playEvent(event, framePos);
                   if (event.type() == ME_TICK1)
                         tickRest = tickLength;
                   else if (event.type() == ME_TICK2)
                         tackRest = tackLength;
-                  mutex.lock();
-                  ++(*pPlayPos);
-                  mutex.unlock();
+                  }
+            if (loopOut) {
+                  if (preferences.useJackTransport) {
+                        int loopInUtick = cs->repeatList()->tick2utick(cs->loopInTick());
+                        _driver->seekTransport(loopInUtick);
+                        if (loopInUtick != 0) {
+                              int seekto = loopInUtick - 2 * cs->utime2utick((qreal)_driver->bufferSize() / MScore::sampleRate);
+                              seekRT((seekto > 0) ? seekto : 0 );
+                              }
+                        }
+                  else {
+                        emit toGui('3');
+                        }
+                  // Exit this function to avoid segmentation fault in Scoreview
+                  return;
                   }
             if (frames) {
                   if (cs->playMode() == PlayMode::SYNTHESIZER) {
                         metronome(frames, p, inCountIn);
                         _synti->process(frames, p);
+                        if (fromLoop)
+                              playLoopAudio(frames, p);
                         *pPlayTime += frames;
                         }
                   else {
@@ -845,7 +924,7 @@ void Seq::process(unsigned n, float* buffer)
                               }
                         }
                   }
-            if (*pPlayPos == pEvents->cend()) {
+            if (atEnd) {
                   if (inCountIn) {
                         inCountIn = false;
                         // Connecting to JACK Transport if MuseScore was temporarily disconnected from it
@@ -862,7 +941,7 @@ void Seq::process(unsigned n, float* buffer)
                   }
             }
       else {
-            _synti->process(frames, p);
+            preview.render(_synti, frames, p);
             }
       //
       // metering / master gain
@@ -948,9 +1027,11 @@ void Seq::collectEvents()
       //do not collect even while playing
       if (state ==  Transport::PLAY)
             return;
-      events.clear();
 
+      stopRendering();
+      renderedTo = INT_MAX;
       mutex.lock();
+      events.clear();
       cs->renderMidi(&events);
       endTick = 0;
 
@@ -962,9 +1043,318 @@ void Seq::collectEvents()
       playPos  = events.cbegin();
       mutex.unlock();
 
+      ControllerIndex* ci = new ControllerIndex;
+      ci->build(events);
+      setControllerIndex(ci);
+
       playlistChanged = false;
       }
 
+//---------------------------------------------------------
+//   startCollectEvents
+//    collect the playlist progressively for playback from
+//    utick on: the first renderAhead seconds are rendered
+//    at once, the rest of the score in renderChunk pieces
+//    in another thread, followed by the part before utick.
+//    gui thread
+//---------------------------------------------------------
+
+void Seq::startCollectEvents(int utick)
+      {
+      if (state == Transport::PLAY)
+            return;
+      // jack transport seeks from the audio thread and needs
+      // the complete playlist
+      if (preferences.useJackTransport) {
+            collectEvents();
+            return;
+            }
+      restartCollectEvents(utick, -1);
+      }
+
+//---------------------------------------------------------
+//   restartCollectEvents
+//    throw the playlist away and render it progressively
+//    from the measure containing utick on. If resume is
+//    not -1 the audio thread continues playing at resume
+//    once it is rendered, otherwise playPos is reset.
+//    gui thread
+//---------------------------------------------------------
+
+void Seq::restartCollectEvents(int utick, int resume)
+      {
+      stopRendering();
+
+      EventMap ev;
+      cs->renderMidiPrepare(&ev);
+      int start = 0;
+      int end   = 0;
+      if (!cs->repeatList()->isEmpty()) {
+            const RepeatSegment* rs = cs->repeatList()->last();
+            end        = rs->utick + rs->len;
+            int tick   = cs->repeatList()->utick2tick(utick);
+            Measure* m = cs->tick2measure(tick);
+            start      = qBound(0, m ? utick - (tick - m->tick()) : 0, end);
+            }
+      // the old playlist is freed outside of the mutex
+      mutex.lock();
+      events.swap(ev);
+      endTick       = 0;
+      renderEnd     = end;
+      renderStart   = start;
+      renderPos     = start;
+      renderWrapped = false;
+      renderedTo    = cs->repeatList()->isEmpty() ? INT_MAX : start;
+      if (resume == -1) {
+            playPos    = events.cbegin();
+            renderWait = -1;
+            }
+      else {
+            playPos    = events.cend();
+            renderWait = resume;
+            }
+      mutex.unlock();
+      // the pedal events of the whole score are indexed
+      // together with the rendered pieces
+      controllerEvents.clear();
+      for (const auto& e : events) {
+            if (e.second.type() == ME_CONTROLLER)
+                  controllerEvents.insert(e);
+            }
+      controllerState   = ControllerIndex::State();
+      controllerIndexed = 0;
+      setControllerIndex(new ControllerIndex);
+      playlistChanged = false;
+      if (cs->repeatList()->isEmpty())
+            return;
+
+      rendering = renderEvents(cs->utime2utick(cs->utick2utime(renderStart) + renderAhead));
+      if (resume != -1)
+            guiPos = events.lower_bound(resume);
+      }
+
+//---------------------------------------------------------
+//   setPlaylistChanged
+//    a playlist which is still being rendered would mix the
+//    old and the new version of the score; while playing,
+//    rendering restarts at the play position
+//---------------------------------------------------------
+
+void Seq::setPlaylistChanged()
+      {
+      playlistChanged = true;
+      loopStateValid  = false;
+      invalidateLoopCache();
+      if (!rendering)
+            return;
+      if (state == Transport::PLAY && cs) {
+            int utick = getCurTick();
+            restartCollectEvents(utick, utick);
+            }
+      else
+            stopRendering();
+      }
+
+//---------------------------------------------------------
+//   renderEvents
+//    render the playlist from renderPos up to utick and
+//    merge it into events; return false if the playlist is
+//    complete. gui thread
+//---------------------------------------------------------
+
+bool Seq::renderEvents(int utick)
+      {
+      int utick2 = qMin(utick, renderWrapped ? renderStart : renderEnd);
+      EventMap ev;
+      cs->renderMidiRange(&ev, renderPos, utick2);
+      return mergeEvents(ev, utick2);
+      }
+
+//---------------------------------------------------------
+//   mergeEvents
+//    merge the playlist rendered from renderPos up to utick
+//    into events; return false if the playlist is complete
+//    gui thread
+//---------------------------------------------------------
+
+bool Seq::mergeEvents(const EventMap& ev, int utick)
+      {
+      // inserting keeps playPos valid; the audio thread does
+      // not wait for the mutex, see process()
+      mutex.lock();
+      events.insert(ev.cbegin(), ev.cend());
+      if (!events.empty())
+            endTick = qMax(endTick, (--events.cend())->first);
+      mutex.unlock();
+      for (const auto& e : ev) {
+            if (e.second.type() == ME_CONTROLLER)
+                  controllerEvents.insert(e);
+            }
+
+      renderPos = utick;
+      if (!renderWrapped) {
+            indexControllers(renderPos);
+            if (renderPos < renderEnd) {
+                  renderedTo = renderPos;
+                  return true;
+                  }
+            renderedTo    = INT_MAX;
+            renderWrapped = true;
+            renderPos     = 0;
+            }
+      if (renderPos < renderStart)
+            return true;
+      if (renderStart > 0) {
+            // the part before renderStart changes the state
+            // of all that follows
+            ControllerIndex* ci = new ControllerIndex;
+            ci->build(controllerEvents);
+            setControllerIndex(ci);
+            }
+      controllerEvents.clear();
+      return false;
+      }
+
+//---------------------------------------------------------
+//   indexControllers
+//    append the controller events from controllerIndexed up
+//    to utick to the published index, so a seek finds the
+//    state of what is rendered so far. The pieces are
+//    indexed in utick order, up to the end of the score.
+//    gui thread
+//---------------------------------------------------------
+
+void Seq::indexControllers(int utick)
+      {
+      auto i1 = controllerEvents.lower_bound(controllerIndexed);
+      auto i2 = utick >= renderEnd ? controllerEvents.cend() : controllerEvents.lower_bound(utick);
+      controllerIndexed = utick;
+      if (i1 == i2)
+            return;
+      ControllerIndex* ci = new ControllerIndex(controllerIndex);
+      ci->append(i1, i2, &controllerState);
+      setControllerIndex(ci);
+      }
+
+//---------------------------------------------------------
+//   setControllerIndex
+//    publish a new controller index; the old one is deleted
+//    once the audio thread has stopped reading it
+//    gui thread
+//---------------------------------------------------------
+
+void Seq::setControllerIndex(ControllerIndex* ci)
+      {
+      ControllerIndex* old = controllerIndex.exchange(ci);
+      while (controllerIndexBusy)
+            QThread::yieldCurrentThread();
+      delete old;
+      }
+
+//---------------------------------------------------------
+//   nextRenderTick
+//    end of the next renderChunk seconds of the playlist
+//---------------------------------------------------------
+
+int Seq::nextRenderTick() const
+      {
+      int utick = cs->utime2utick(cs->utick2utime(renderPos) + renderChunk);
+      return qMin(qMax(utick, renderPos + MScore::division), renderWrapped ? renderStart : renderEnd);
+      }
+
+//---------------------------------------------------------
+//   renderNext
+//    render the next renderChunk seconds of the playlist
+//---------------------------------------------------------
+
+bool Seq::renderNext()
+      {
+      return renderEvents(nextRenderTick());
+      }
+
+//---------------------------------------------------------
+//   mergeRendered
+//    merge the piece rendered by renderFuture, if there is
+//    one; return false if the playlist is complete
+//    gui thread
+//---------------------------------------------------------
+
+bool Seq::mergeRendered()
+      {
+      renderFuture.waitForFinished();
+      if (renderingTo == -1)
+            return true;
+      EventMap ev;
+      ev.swap(renderChunkEvents);
+      int utick   = renderingTo;
+      renderingTo = -1;
+      return mergeEvents(ev, utick);
+      }
+
+//---------------------------------------------------------
+//   renderStep
+//    merge the piece of the playlist rendered in another
+//    thread and start the next one. Rendering reads the
+//    score: it is not started while a command is open and
+//    the score waits for it before it is changed, see
+//    waitForRendering(). Called from heartBeatTimeout()
+//---------------------------------------------------------
+
+void Seq::renderStep()
+      {
+      if (!rendering || !renderFuture.isFinished())
+            return;
+      if (!mergeRendered()) {
+            rendering = false;
+            return;
+            }
+      if (cs->undo()->active())
+            return;
+      renderingTo  = nextRenderTick();
+      renderFuture = QtConcurrent::run(cs, &Score::renderMidiRange, &renderChunkEvents, renderPos, renderingTo);
+      }
+
+//---------------------------------------------------------
+//   waitForRendering
+//    the score is about to be changed; the rendered piece
+//    is merged later, if the playlist did not change
+//    gui thread
+//---------------------------------------------------------
+
+void Seq::waitForRendering()
+      {
+      renderFuture.waitForFinished();
+      }
+
+//---------------------------------------------------------
+//   stopRendering
+//    gui thread
+//---------------------------------------------------------
+
+void Seq::stopRendering()
+      {
+      renderFuture.waitForFinished();
+      renderChunkEvents.clear();
+      renderingTo = -1;
+      rendering   = false;
+      }
+
+//---------------------------------------------------------
+//   finishEvents
+//    render the rest of a progressively collected playlist
+//---------------------------------------------------------
+
+void Seq::finishEvents()
+      {
+      if (!rendering)
+            return;
+      if (mergeRendered()) {
+            while (renderNext())
+                  ;
+            }
+      rendering = false;
+      }
+
 //---------------------------------------------------------
 //   getCurTick
 //---------------------------------------------------------
@@ -997,16 +1387,19 @@ void Seq::setPos(int utick)
       stopNotes(-1, true);
 
       int ucur;
+      mutex.lock();
       if (playPos != events.end())
             ucur = cs->repeatList()->utick2tick(playPos->first);
       else
             ucur = utick - 1;
+      mutex.unlock();
       if (utick != ucur)
             updateSynthesizerState(ucur, utick);
 
       playTime  = cs->utick2utime(utick) * MScore::sampleRate;
       mutex.lock();
-      playPos   = events.lower_bound(utick);
+      playPos    = events.lower_bound(utick);
+      renderWait = -1;
       mutex.unlock();
       }
 
@@ -1024,6 +1417,8 @@ void Seq::seekCommon(int utick)
 
       if (playlistChanged)
             collectEvents();
+      else if (utick < renderStart || utick >= renderedTo)
+            finishEvents();
 
       if (cs->playMode() == PlayMode::AUDIO) {
             ogg_int64_t sp = cs->utick2utime(utick) * MScore::sampleRate;
@@ -1086,7 +1481,7 @@ void Seq::startNote(int channel, int pitch, int velo, double nt)
             return;
       NPlayEvent ev(ME_NOTEON, channel, pitch, velo);
       ev.setTuning(nt);
-      sendEvent(ev);
+      previewEvent(ev);
       }
 
 void Seq::startNote(int channel, int pitch, int velo, int duration, double nt)
@@ -1129,7 +1524,7 @@ void Seq::stopNotes(int channel, bool realTime)
             if (realTime)
                   putEvent(event);
             else
-                  sendEvent(event);
+                  previewEvent(event);
       };
       // Stop notes in all channels
       if (channel == -1) {
@@ -1146,8 +1541,13 @@ void Seq::stopNotes(int channel, bool realTime)
             if (cs->midiChannel(channel) != 9)
                   send(NPlayEvent(ME_PITCHBEND,  channel, 0, 64));
             }
-      if (preferences.useAlsaAudio || preferences.useJackAudio || preferences.usePulseAudio || preferences.usePortaudioAudio)
-            _synti->allNotesOff(channel);
+      if (preferences.useAlsaAudio || preferences.useJackAudio || preferences.usePulseAudio || preferences.usePortaudioAudio) {
+            // the synthesizer message fifo has only one writer: the sequencer thread
+            if (realTime)
+                  _synti->allNotesOff(channel);
+            else if (!preview.enqueue(PreviewMsg(channel)))
+                  guiToSeq(SeqMsg(SeqMsgId::ALL_NOTE_OFF, channel));
+            }
       }
 
 //---------------------------------------------------------
@@ -1158,6 +1558,7 @@ void Seq::setController(int channel, int ctrl, int data)
       {
       NPlayEvent event(ME_CONTROLLER, channel, ctrl, data);
       sendEvent(event);
+      loopStateChanged();
       }
 
 //---------------------------------------------------------
@@ -1171,6 +1572,39 @@ void Seq::sendEvent(const NPlayEvent& ev)
       guiToSeq(SeqMsg(SeqMsgId::PLAY, ev));
       }
 
+//---------------------------------------------------------
+//   previewEvent
+//    called from GUI context to play a note preview event;
+//    it goes through the preview queue which places it in
+//    the next buffer by the time it was queued. stopNotes()
+//    uses the same queue, so a note off never overtakes the
+//    next note.
+//---------------------------------------------------------
+
+void Seq::previewEvent(const NPlayEvent& ev)
+      {
+      if (!cs || ev.channel() >= cs->midiMapping()->size()) {
+            sendEvent(ev);
+            return;
+            }
+      int syntiIdx = _synti->index(cs->midiMapping(ev.channel())->articulation->synti);
+      if (!preview.enqueue(PreviewMsg(syntiIdx, ev)))
+            sendEvent(ev);
+      }
+
+//---------------------------------------------------------
+//   SeqPreviewQueue::play
+//    realtime
+//---------------------------------------------------------
+
+void SeqPreviewQueue::play(MasterSynthesizer* synti, const PreviewMsg& msg, unsigned framePos)
+      {
+      PreviewQueue::play(synti, msg, framePos);
+      Driver* driver = seq->driver();
+      if (msg.synti >= 0 && driver && (preferences.useJackMidi || preferences.useAlsaAudio))
+            driver->putEvent(msg.event, framePos);
+      }
+
 //---------------------------------------------------------
 //   nextMeasure
 //---------------------------------------------------------
@@ -1380,7 +1814,9 @@ void Seq::heartBeatTimeout()
 
       while (!fromSeq.isEmpty()) {
             SeqMsg msg = fromSeq.dequeue();
-            if (msg.id == SeqMsgId::MIDI_INPUT_EVENT) {
+            if (msg.id == SeqMsgId::LOOP_AUDIO)
+                  delete msg.loopAudio;
+            else if (msg.id == SeqMsgId::MIDI_INPUT_EVENT) {
                   int type = msg.event.type();
                   if (type == ME_NOTEON)
                         mscore->midiNoteReceived(msg.event.channel(), msg.event.pitch(), msg.event.velo());
@@ -1390,6 +1826,8 @@ void Seq::heartBeatTimeout()
                         mscore->midiCtrlReceived(msg.event.controller(), msg.event.value());
                   }
             }
+      updateLoopCache();
+      renderStep();
 
       if (state != Transport::PLAY || inCountIn)
             return;
@@ -1468,16 +1906,83 @@ void Seq::updateSynthesizerState(int tick1, int tick2)
       {
       if (tick1 > tick2)
             tick1 = 0;
-      // Making a local copy of events to avoid touching it
-      // from different threads at the same time
-      EventMap ev = events;
-      EventMap::const_iterator i1 = ev.lower_bound(tick1);
-      EventMap::const_iterator i2 = ev.upper_bound(tick2);
+      // the gui thread does not delete the index while the flag is set
+      controllerIndexBusy = true;
+      const ControllerIndex* ci = controllerIndex;
+      if (ci) {
+            const ControllerIndex::Snapshot* s = ci->find(tick2);
+            if (s && s->utick > tick1) {
+                  // start from the nearest snapshot instead of tick1
+                  for (int i = 0; i < s->count; ++i)
+                        playEvent(s->controllers[i], 0);
+                  tick1 = s->utick;
+                  }
+            ci->changes(tick1, tick2 + 1, [this](const NPlayEvent& e) { playEvent(e, 0); });
+            }
+      controllerIndexBusy = false;
+      }
 
-      for (; i1 != i2; ++i1) {
-            if (i1->second.type() == ME_CONTROLLER)
-                  playEvent(i1->second, 0);
+//---------------------------------------------------------
+//   ControllerIndex::build
+//    not realtime
+//---------------------------------------------------------
+
+void ControllerIndex::build(const EventMap& events)
+      {
+      pieces.clear();
+      State state;
+      append(events.cbegin(), events.cend(), &state);
+      }
+
+//---------------------------------------------------------
+//   ControllerIndex::append
+//    add a piece for the events from i1 up to i2, which
+//    follow all events indexed so far; state is carried
+//    from the last append() and updated
+//    not realtime
+//---------------------------------------------------------
+
+void ControllerIndex::append(EventMap::const_iterator i1, EventMap::const_iterator i2, State* state)
+      {
+      Piece* p = new Piece;
+      std::vector<int> first;
+      for (auto i = i1; i != i2; ++i) {
+            while (i->first >= state->next) {
+                  Snapshot s;
+                  s.utick = state->next;
+                  s.count = int(state->controllers.size());
+                  first.push_back(int(p->controllers.size()));
+                  for (const auto& c : state->controllers)
+                        p->controllers.push_back(c.second);
+                  p->snapshots.push_back(s);
+                  state->next += SNAPSHOT_TICKS;
+                  }
+            const NPlayEvent& e = i->second;
+            if (e.type() == ME_CONTROLLER) {
+                  state->controllers[(e.channel() << 8) | e.controller()] = e;
+                  p->changes.push_back(*i);
+                  }
             }
+      for (size_t i = 0; i < p->snapshots.size(); ++i)
+            p->snapshots[i].controllers = p->controllers.data() + first[i];
+      pieces.push_back(std::shared_ptr<const Piece>(p));
+      }
+
+//---------------------------------------------------------
+//   ControllerIndex::find
+//    return the last snapshot at or before utick or 0
+//---------------------------------------------------------
+
+const ControllerIndex::Snapshot* ControllerIndex::find(int utick) const
+      {
+      for (auto p = pieces.crbegin(); p != pieces.crend(); ++p) {
+            const std::vector<Snapshot>& sl = (*p)->snapshots;
+            auto i = std::upper_bound(sl.cbegin(), sl.cend(), utick,
+               [](int t, const Snapshot& s) { return t < s.utick; });
+            if (i != sl.cbegin())
+                  return &*(i - 1);
+            }
+      return 0;
       }
 
 //---------------------------------------------------------
@@ -1555,4 +2060,186 @@ void Seq::handleTimeSigTempoChanged()
       {
       _driver->handleTimeSigTempoChanged();
       }
+
+//---------------------------------------------------------
+//   loopAudioCovers
+//    true if the next n frames can be played from the
+//    pre-rendered loop
+//    realtime
+//---------------------------------------------------------
+
+bool Seq::loopAudioCovers(unsigned n) const
+      {
+      return loopAudio && mscore->loop()
+         && loopAudio->utickIn  == cs->repeatList()->tick2utick(cs->loopInTick())
+         && loopAudio->utickOut == cs->repeatList()->tick2utick(cs->loopOutTick())
+         && loopAudio->covers(playTime, n);
+      }
+
+//---------------------------------------------------------
+//   playLoopAudio
+//    mix n frames of the pre-rendered loop into p which
+//    holds the metronome and the release of notes played
+//    live; the loop audio already has the master gain
+//    applied
+//    realtime
+//---------------------------------------------------------
+
+void Seq::playLoopAudio(unsigned n, float* p)
+      {
+      const float* src = loopAudio->data.data() + (playTime - loopAudio->frameIn) * 2;
+      for (unsigned i = 0; i < n * 2; ++i)
+            p[i] += src[i];
+      }
+
+//---------------------------------------------------------
+//   synthesizerStateKey
+//---------------------------------------------------------
+
+static QString synthesizerStateKey(const SynthesizerState& state)
+      {
+      QString s;
+      for (const SynthesizerGroup& g : state) {
+            s += g.name();
+            for (const IdValue& v : g)
+                  s += QString(" %1=%2").arg(v.id).arg(v.data);
+            s += ";";
+            }
+      return s;
+      }
+
+//---------------------------------------------------------
+//   loopCacheSignature
+//    everything besides the playlist which changes the
+//    rendered loop. The synthesizer and mixer part is
+//    only built again after loopStateChanged() or a
+//    score change.
+//---------------------------------------------------------
+
+QString Seq::loopCacheSignature()
+      {
+      if (!loopStateValid) {
+            loopState = synthesizerStateKey(_synti->state());
+            for (const MidiMapping& mm : *cs->midiMapping()) {
+                  const Channel* a = mm.articulation;
+                  loopState += QString("%1 %2 %3 %4 %5 %6 %7%8;").arg(a->program).arg(a->bank).arg(int(a->volume))
+                     .arg(int(a->pan)).arg(int(a->chorus)).arg(int(a->reverb)).arg(a->mute).arg(a->soloMute);
+                  }
+            loopStateValid = true;
+            }
+      return QString("%1 %2 %3;").arg(cs->loopInTick()).arg(cs->loopOutTick()).arg(cs->tempomap()->relTempo()) + loopState;
+      }
+
+//---------------------------------------------------------
+//   renderLoop
+//    start rendering the loop range in the background;
+//    called when playback wraps around the loop
+//---------------------------------------------------------
+
+void Seq::renderLoop()
+      {
+      if (!preferences.loopCache || preferences.useJackMidi || loopAudioSent || loopCache.busy()
+         || !cs || cs->playMode() != PlayMode::SYNTHESIZER || !mscore->loop())
+            return;
+      int utickIn  = cs->repeatList()->tick2utick(cs->loopInTick());
+      int utickOut = cs->repeatList()->tick2utick(cs->loopOutTick());
+      int frameIn  = cs->utick2utime(utickIn) * MScore::sampleRate;
+      int frameOut = cs->utick2utime(utickOut) * MScore::sampleRate;
+      if (frameOut <= frameIn || frameOut - frameIn > maxLoopCacheTime * MScore::sampleRate)
+            return;
+      // the loop range is not rendered yet, try again on the next pass
+      if (rendering && (utickIn < renderStart || utickOut > renderedTo))
+            return;
+
+      // the cache synthesizer comes from the same factory, its
+      // synthesizers have the same indices
+      std::vector<LoopEvent> el;
+      auto add = [&](int frame, const NPlayEvent& e) {
+            int channel = e.channel();
+            if (channel < cs->midiMapping()->size())
+                  el.push_back({ frame, _synti->index(cs->midiMapping(channel)->articulation->synti), e });
+            };
+      // instrument and controller state at the loop start, see initInstruments()
+      // and updateSynthesizerState(); the synthesizer may have played
+      // another loop before
+      for (const MidiMapping& mm : *cs->midiMapping()) {
+            Channel* a = mm.articulation;
+            add(0, NPlayEvent(ME_CONTROLLER, a->channel, CTRL_RESET_ALL_CTRL, 0));
+            for (const MidiCoreEvent& e : a->init) {
+                  if (e.type() != ME_INVALID)
+                        add(0, NPlayEvent(e.type(), a->channel, e.dataA(), e.dataB()));
+                  }
+            }
+      // the gui thread is the only one which replaces the index
+      const ControllerIndex* ci = controllerIndex;
+      if (ci) {
+            int tick1 = 0;
+            const ControllerIndex::Snapshot* snapshot = ci->find(utickIn);
+            if (snapshot && snapshot->utick > tick1) {
+                  for (int i = 0; i < snapshot->count; ++i)
+                        add(0, snapshot->controllers[i]);
+                  tick1 = snapshot->utick;
+                  }
+            ci->changes(tick1, utickIn, [&add](const NPlayEvent& e) { add(0, e); });
+            }
+      // only the gui thread changes events, it reads them
+      // without the mutex the audio thread needs
+      auto i2 = events.lower_bound(utickIn);
+      for (auto i3 = events.lower_bound(utickOut); i2 != i3; ++i2) {
+            const NPlayEvent& e = i2->second;
+            int type = e.type();
+            if ((type == ME_NOTEON && !muted(e)) || type == ME_CONTROLLER || type == ME_PITCHBEND) {
+                  int f = cs->utick2utime(i2->first) * MScore::sampleRate;
+                  add(f - frameIn, e);
+                  }
+            }
+
+      LoopAudio* a = new LoopAudio;
+      a->utickIn   = utickIn;
+      a->utickOut  = utickOut;
+      a->frameIn   = frameIn;
+      loopSignature = loopCacheSignature();
+      SynthesizerState state = _synti->state();
+      // the tail lets the last buffer of a pass be played from the cache
+      loopCache.render(state, synthesizerStateKey(state), el, a, frameOut - frameIn + MasterSynthesizer::MAX_BUFFERSIZE);
+      }
+
+//---------------------------------------------------------
+//   invalidateLoopCache
+//    the score, the mixer or the synthesizer changed
+//---------------------------------------------------------
+
+void Seq::invalidateLoopCache()
+      {
+      loopCache.cancel();
+      if (loopAudioSent) {
+            guiToSeq(SeqMsg(SeqMsgId::LOOP_AUDIO, (LoopAudio*)0));
+            loopAudioSent = false;
+            }
+      }
+
+//---------------------------------------------------------
+//   updateLoopCache
+//    hand finished loop audio to the sequencer and drop
+//    it if anything it depends on changed
+//    called from heartBeatTimeout()
+//---------------------------------------------------------
+
+void Seq::updateLoopCache()
+      {
+      if (!loopAudioSent && !loopCache.busy())
+            return;
+      if (!cs || loopCacheSignature() != loopSignature)
+            invalidateLoopCache();
+      // also releases a canceled renderer
+      LoopAudio* a = loopCache.take();
+      if (!a)
+            return;
+      if (_driver && running) {
+            guiToSeq(SeqMsg(SeqMsgId::LOOP_AUDIO, a));
+            loopAudioSent = true;
+            }
+      else
+            delete a;
+      }
 }
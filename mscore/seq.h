@@ -27,6 +27,11 @@
 #include "driver.h"
 #include "libmscore/fifo.h"
 #include "libmscore/tempo.h"
+#include "audiostats.h"
+#include "loopcache.h"
+#include "synthesizer/previewqueue.h"
+
+#include <memory>
 
 class QTimer;
 
@@ -39,6 +44,7 @@ class Measure;
 class Fraction;
 class Driver;
 class Part;
+class Seq;
 struct Channel;
 class ScoreView;
 class MasterSynthesizer;
@@ -54,7 +60,9 @@ enum class SeqMsgId : char {
       NO_MESSAGE,
       TEMPO_CHANGE,
       PLAY, SEEK,
-      MIDI_INPUT_EVENT
+      ALL_NOTE_OFF,
+      MIDI_INPUT_EVENT,
+      LOOP_AUDIO              // gui -> sequencer: new loop audio, sequencer -> gui: delete it
       };
 
 struct SeqMsg {
@@ -62,12 +70,14 @@ struct SeqMsg {
       union {
             int intVal;
             qreal realVal;
+            LoopAudio* loopAudio;
             };
       NPlayEvent event;
 
       SeqMsg() {}
       SeqMsg(SeqMsgId _id, int val) : id(_id), intVal(val) {}
       SeqMsg(SeqMsgId _id, qreal val) : id(_id), realVal(val) {}
+      SeqMsg(SeqMsgId _id, LoopAudio* a) : id(_id), loopAudio(a) {}
       SeqMsg(SeqMsgId _id, const NPlayEvent& e) : id(_id), event(e) {}
       };
 
@@ -95,6 +105,80 @@ enum class Transport : char {
       NET_STARTING=4
       };
 
+//---------------------------------------------------------
+//   ControllerIndex
+//    controller state of all channels at every
+//    SNAPSHOT_TICKS ticks of the playlist and all controller
+//    events; built on the gui thread and used to restore the
+//    synthesizer state on seek without reading the playlist.
+//    The index is made of pieces which are shared with the
+//    index it was appended to. Immutable once it is
+//    published, see Seq::setControllerIndex()
+//---------------------------------------------------------
+
+class ControllerIndex {
+   public:
+      static const int SNAPSHOT_TICKS = 480 * 16;
+
+      struct Snapshot {
+            int utick;                          // state before the events at utick
+            const NPlayEvent* controllers;
+            int count;
+            };
+      // controller state carried from one append() to the next
+      struct State {
+            std::map<int, NPlayEvent> controllers;    // last event for channel/controller
+            int next { SNAPSHOT_TICKS };              // utick of the next snapshot
+            };
+
+   private:
+      struct Piece {
+            std::vector<Snapshot> snapshots;
+            std::vector<NPlayEvent> controllers;
+            std::vector<std::pair<int, NPlayEvent>> changes;  // controller events by utick
+            };
+      std::vector<std::shared_ptr<const Piece>> pieces;     // in utick order
+
+   public:
+      ControllerIndex() {}
+      ControllerIndex(const ControllerIndex* ci) { if (ci) pieces = ci->pieces; }
+      void build(const EventMap&);
+      void append(EventMap::const_iterator, EventMap::const_iterator, State*);
+      const Snapshot* find(int utick) const;
+      template <class F> void changes(int utick1, int utick2, F f) const;
+      };
+
+//---------------------------------------------------------
+//   changes
+//    call f for the controller events from utick1 up to
+//    but not including utick2; realtime safe
+//---------------------------------------------------------
+
+template <class F> void ControllerIndex::changes(int utick1, int utick2, F f) const
+      {
+      for (const auto& p : pieces) {
+            auto i = std::lower_bound(p->changes.cbegin(), p->changes.cend(), utick1,
+               [](const std::pair<int, NPlayEvent>& c, int t) { return c.first < t; });
+            for (; i != p->changes.cend() && i->first < utick2; ++i)
+                  f(i->second);
+            }
+      }
+
+//---------------------------------------------------------
+//   SeqPreviewQueue
+//    sends the preview notes to the midi driver too
+//---------------------------------------------------------
+
+class SeqPreviewQueue : public PreviewQueue {
+      Seq* seq;
+
+   protected:
+      virtual void play(MasterSynthesizer*, const PreviewMsg&, unsigned framePos) override;
+
+   public:
+      SeqPreviewQueue(Seq* s) : seq(s) {}
+      };
+
 //---------------------------------------------------------
 //   Seq
 //    sequencer
@@ -125,20 +209,56 @@ class Seq : public QObject, public Sequencer {
 
       SeqMsgFifo toSeq;
       SeqMsgFifo fromSeq;
+      SeqPreviewQueue preview { this };   // note preview, gui -> sequencer
       Driver* _driver;
       MasterSynthesizer* _synti;
+      AudioStats _audioStats;             // filled by process()
+
+      LoopCache loopCache;                // renders the loop range, gui thread
+      bool loopAudioSent { false };       // the sequencer has a valid LoopAudio, gui thread
+      QString loopSignature;              // loopCacheSignature() of the rendered loop, gui thread
+      QString loopState;                  // synthesizer and mixer part of loopCacheSignature(), gui thread
+      bool loopStateValid  { false };
+      LoopAudio* loopAudio { 0 };         // audio thread
 
       double meterValue[2];
       double meterPeakValue[2];
       int peakTimer[2];
 
       EventMap events;                    // playlist
+      std::atomic<ControllerIndex*> controllerIndex { 0 };  // of events, set by the gui thread
+      std::atomic<bool> controllerIndexBusy { false };      // audio thread reads controllerIndex
+      EventMap controllerEvents;          // controller events rendered so far, gui thread
+      ControllerIndex::State controllerState;   // at controllerIndexed, gui thread
+      int controllerIndexed { 0 };        // controller events before this utick are indexed, gui thread
       EventMap countInEvents;
 
       int playTime;                       // current play position in samples
       int countInPlayTime;
       int endTick;
 
+      // progressive rendering of the playlist, see startCollectEvents()
+      int renderStart;                    // utick of the first rendered measure, gui thread
+      int renderPos;                      // next utick to render, gui thread
+      int renderEnd;                      // utick of the score end, gui thread
+      bool renderWrapped;                 // rendering the part before renderStart, gui thread
+      std::atomic<int> renderedTo;        // events before this utick are complete, INT_MAX if
+                                          // they are complete up to the end of the score
+      int renderWait { -1 };              // playPos continues at this utick once it is rendered,
+                                          // protected by mutex
+      bool rendering { false };           // the playlist is rendered in another thread, gui thread
+      QFuture<void> renderFuture;         // renders renderChunkEvents up to renderingTo
+      EventMap renderChunkEvents;
+      int renderingTo { -1 };             // -1 if no piece is rendered
+
+      // the events of one process() call, collected with the mutex held
+      struct DueEvent {
+            NPlayEvent event;
+            unsigned frame;               // in the buffer
+            };
+      static const int MAX_DUE_EVENTS = 4096;
+      DueEvent dueEvents[MAX_DUE_EVENTS]; // audio thread
+
       EventMap::const_iterator playPos;   // moved in real time thread
       EventMap::const_iterator countInPlayPos;
       EventMap::const_iterator guiPos;    // moved in gui thread
@@ -160,13 +280,32 @@ class Seq : public QObject, public Sequencer {
       void seekCommon(int utick);
       void unmarkNotes();
       void updateSynthesizerState(int tick1, int tick2);
+      void setControllerIndex(ControllerIndex*);
+      void indexControllers(int utick);
       void addCountInClicks();
+      bool loopAudioCovers(unsigned n) const;
+      void playLoopAudio(unsigned n, float* p);
+      void renderLoop();
+      void invalidateLoopCache();
+      void updateLoopCache();
+      QString loopCacheSignature();
+      void startCollectEvents(int utick);
+      void restartCollectEvents(int utick, int resume);
+      bool renderEvents(int utick);
+      bool mergeEvents(const EventMap&, int utick);
+      bool mergeRendered();
+      int nextRenderTick() const;
+      bool renderNext();
+      void renderStep();
+      void stopRendering();
+      void finishEvents();
 
    private slots:
       void seqMessage(int msg, int arg = 0);
       void heartBeatTimeout();
+      void waitForRendering();
       void midiInputReady();
-      void setPlaylistChanged() { playlistChanged = true; }
+      void setPlaylistChanged();
       void handleTimeSigTempoChanged();
 
    public slots:
@@ -178,6 +317,7 @@ class Seq : public QObject, public Sequencer {
       void stop();
       void setPos(POS, unsigned);
       void setMetronomeGain(float val) { metronomeVolume = val; }
+      void loopStateChanged()          { loopStateValid = false; }
 
    signals:
       void started();
@@ -220,6 +360,7 @@ class Seq : public QObject, public Sequencer {
 
       void setController(int, int, int);
       virtual void sendEvent(const NPlayEvent&);
+      void previewEvent(const NPlayEvent&);
       void setScoreView(ScoreView*);
       Score* score() const   { return cs; }
       ScoreView* viewer() const { return cv; }
@@ -229,6 +370,7 @@ class Seq : public QObject, public Sequencer {
       void setDriver(Driver* d)                        { _driver = d;    }
       MasterSynthesizer* synti() const                 { return _synti;  }
       void setMasterSynthesizer(MasterSynthesizer* ms) { _synti = ms;    }
+      AudioStats* audioStats()                         { return &_audioStats; }
 
       int getCurTick();
       double curTempo() const;
@@ -105,6 +105,14 @@ SynthControl::SynthControl(QWidget* parent)
       connect(storeButton,  SIGNAL(clicked()),                SLOT(storeButtonClicked()));
       connect(recallButton, SIGNAL(clicked()),                SLOT(recallButtonClicked()));
       connect(gain,         SIGNAL(valueChanged(double,int)), SLOT(setDirty()));
+      connect(resetAudioStatsButton, SIGNAL(clicked()),       SLOT(resetAudioStats()));
+
+      QFont font("Monospace");
+      font.setStyleHint(QFont::TypeWriter);
+      audioStats->setFont(font);
+      audioStatsTimer = new QTimer(this);
+      connect(audioStatsTimer, SIGNAL(timeout()), SLOT(updateAudioStats()));
+      audioStatsTimer->start(500);
       }
 
 //---------------------------------------------------------
@@ -174,6 +182,7 @@ void MuseScore::showSynthControl(bool val)
             if (mixer)
                   connect(synthControl, SIGNAL(soundFontChanged()), mixer, SLOT(patchListChanged()));
             connect(synthControl, SIGNAL(metronomeGainChanged(float)), seq, SLOT(setMetronomeGain(float)));
+            connect(synthControl, SIGNAL(stateChanged()), seq, SLOT(loopStateChanged()));
             }
       synthControl->setVisible(val);
       }
@@ -244,6 +253,7 @@ void SynthControl::effectAChanged(int idx)
       {
       synti->setEffect(0, idx);
       effectStackA->setCurrentIndex(idx);
+      emit stateChanged();
       }
 
 //---------------------------------------------------------
@@ -254,6 +264,7 @@ void SynthControl::effectBChanged(int idx)
       {
       synti->setEffect(1, idx);
       effectStackB->setCurrentIndex(idx);
+      emit stateChanged();
       }
 
 //---------------------------------------------------------
@@ -267,6 +278,7 @@ void SynthControl::loadButtonClicked()
             return;
       synti->setState(_score->synthesizerState());
       updateGui();
+      emit stateChanged();
       loadButton->setEnabled(false);
       saveButton->setEnabled(false);
       storeButton->setEnabled(true);
@@ -321,6 +333,7 @@ void SynthControl::recallButtonClicked()
             }
       synti->setState(state);
       updateGui();
+      emit stateChanged();
 
       storeButton->setEnabled(false);
       recallButton->setEnabled(false);
@@ -392,6 +405,28 @@ void SynthControl::setDirty()
       saveButton->setEnabled(true);
       storeButton->setEnabled(true);
       recallButton->setEnabled(true);
+      emit stateChanged();
+      }
+
+//---------------------------------------------------------
+//   updateAudioStats
+//---------------------------------------------------------
+
+void SynthControl::updateAudioStats()
+      {
+      if (!isVisible() || tabWidget->currentWidget() != audioStatsTab)
+            return;
+      audioStats->setPlainText(seq->audioStats()->toString());
+      }
+
+//---------------------------------------------------------
+//   resetAudioStats
+//---------------------------------------------------------
+
+void SynthControl::resetAudioStats()
+      {
+      seq->audioStats()->reset();
+      updateAudioStats();
       }
 
 //---------------------------------------------------------
@@ -37,6 +37,7 @@ class SynthControl : public QWidget, Ui::SynthControl {
 
       Score* _score;
       EnablePlayForWidget* enablePlay;
+      QTimer* audioStatsTimer;
 
       virtual void closeEvent(QCloseEvent*);
       virtual void showEvent(QShowEvent*);
@@ -56,11 +57,14 @@ class SynthControl : public QWidget, Ui::SynthControl {
       void storeButtonClicked();
       void recallButtonClicked();
       void setDirty();
+      void updateAudioStats();
+      void resetAudioStats();
 
    signals:
       void gainChanged(float);
       void metronomeGainChanged(float);
       void soundFontChanged();
+      void stateChanged();          // any synthesizer or effect setting
       void closed(bool);
 
    public slots:
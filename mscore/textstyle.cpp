@@ -185,6 +185,7 @@ void TextStyleDialog::applyToScore(Score* s)
 void TextStyleDialog::applyToAllParts()
       {
       saveStyle(current);     // update local copy of style list
+      cs->rootScore()->loadExcerpts();
       QList<Excerpt*>& el = cs->rootScore()->excerpts();
       for (Excerpt* e : el)
             applyToScore(e->partScore());
@@ -0,0 +1,269 @@
+//=============================================================================
+//  MuseScore
+//  Music Composition & Notation
+//  $Id:$
+//
+//  Copyright (C) 2015 Werner Schweer
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License version 2
+//  as published by the Free Software Foundation and appearing in
+//  the file LICENCE.GPL
+//=============================================================================
+
+#include <QtTest/QtTest>
+#include <cmath>
+#include "mtest/testutils.h"
+#include "effects/zita1/zita.h"
+#include "effects/compressor/compressor.h"
+#include "effects/freeverb/freeverb.h"
+#include "synthesizer/msynthesizer.h"
+
+using namespace Ms;
+
+static const int SAMPLE_RATE = 44100;
+static const int FRAMES      = SAMPLE_RATE * 10;      // 10 sec of audio
+static const int BUFFER      = 256;                   // frames per process() call
+
+//---------------------------------------------------------
+//   TestEffects
+//    throughput of the master effects
+//---------------------------------------------------------
+
+class TestEffects : public QObject, public MTest
+      {
+      Q_OBJECT
+
+      std::vector<float> in;
+      std::vector<float> out;
+
+      void run(Effect* e, int buffer);
+
+   private slots:
+      void initTestCase();
+      void compressorBlocks();
+      void freeverbReference();
+      void masterChunks();
+      void zitaBenchmark();
+      void freeverbBenchmark();
+      void compressorBenchmark();
+      };
+
+//---------------------------------------------------------
+//   initTestCase
+//    stereo noise with a slow amplitude modulation
+//---------------------------------------------------------
+
+void TestEffects::initTestCase()
+      {
+      initMTest();
+      in.resize(FRAMES * 2);
+      out.resize(FRAMES * 2);
+      qsrand(1);
+      for (int i = 0; i < FRAMES * 2; ++i)
+            in[i] = (qrand() / float(RAND_MAX) * 2.0f - 1.0f) * (0.5f + 0.5f * sin(i * 1e-5));
+      }
+
+//---------------------------------------------------------
+//   run
+//---------------------------------------------------------
+
+void TestEffects::run(Effect* e, int buffer)
+      {
+      for (int i = 0; i < FRAMES; i += buffer) {
+            int n = qMin(buffer, FRAMES - i);
+            e->process(n, in.data() + i * 2, out.data() + i * 2);
+            }
+      }
+
+//---------------------------------------------------------
+//   compressorBlocks
+//    the SIMD stages must not depend on how the signal
+//    is split into buffers
+//---------------------------------------------------------
+
+void TestEffects::compressorBlocks()
+      {
+      Compressor c1;
+      c1.init(SAMPLE_RATE);
+      c1.setNValue(3, -20.0);       // threshold
+      c1.setNValue(4, 4.0);         // ratio
+      run(&c1, 4096);
+      std::vector<float> ref = out;
+
+      Compressor c2;
+      c2.init(SAMPLE_RATE);
+      c2.setNValue(3, -20.0);
+      c2.setNValue(4, 4.0);
+      run(&c2, 7);
+      QVERIFY(out == ref);
+      }
+
+//---------------------------------------------------------
+//   RefFreeverb
+//    the per sample freeverb the block version replaced,
+//    for preset "Test 4"
+//---------------------------------------------------------
+
+class RefFreeverb {
+      struct Filter {
+            std::vector<float> buffer;
+            int idx { 0 };
+            float store { 0.0f };
+            Filter(int size) : buffer(size, 1e-8) {}
+            float comb(float input, float feedback, float damp1, float damp2) {
+                  float tmp   = buffer[idx];
+                  store       = (tmp * damp2) + (store * damp1);
+                  buffer[idx] = input + (store * feedback);
+                  ++idx      %= buffer.size();
+                  return tmp;
+                  }
+            float allpass(float input) {
+                  float bufout = buffer[idx];
+                  float output = bufout - input;
+                  buffer[idx]  = input + (bufout * 0.5f);
+                  ++idx       %= buffer.size();
+                  return output;
+                  }
+            };
+      std::vector<Filter> combL, combR, allpassL, allpassR;
+
+   public:
+      static constexpr float wet = 0.8f, roomsize = 0.7f, damp = 0.5f, width = 0.5f, send = 0.6f;
+
+      RefFreeverb() {
+            for (int size : { 1116, 1188, 1277, 1356, 1422, 1491, 1557, 1617 }) {
+                  combL.push_back(Filter(size));
+                  combR.push_back(Filter(size + 23));
+                  }
+            for (int size : { 556, 441, 341, 225 }) {
+                  allpassL.push_back(Filter(size));
+                  allpassR.push_back(Filter(size + 23));
+                  }
+            }
+      void process(int n, const float* in, float* out) {
+            float wet1 = width * .5 + .5;
+            float wet2 = (1.0 - width) * .5;
+            float dry  = 1.0 - wet;
+            for (int k = 0; k < n; ++k) {
+                  float l     = in[k * 2];
+                  float r     = in[k * 2 + 1];
+                  float input = ((l + r) * send) + 1e-8;
+                  float outL  = 0.0;
+                  float outR  = 0.0;
+                  for (unsigned i = 0; i < combL.size(); ++i) {
+                        outL += combL[i].comb(input, roomsize, damp, 1 - damp);
+                        outR += combR[i].comb(input, roomsize, damp, 1 - damp);
+                        }
+                  for (unsigned i = 0; i < allpassL.size(); ++i) {
+                        outL = allpassL[i].allpass(outL);
+                        outR = allpassR[i].allpass(outR);
+                        }
+                  outL -= 1e-8;
+                  outR -= 1e-8;
+                  out[k * 2]     = l * dry + (outL * wet1 + outR * wet2) * wet;
+                  out[k * 2 + 1] = r * dry + (outR * wet1 + outL * wet2) * wet;
+                  }
+            }
+      };
+
+//---------------------------------------------------------
+//   freeverbReference
+//    the block processing matches the per sample filters;
+//    the vectorized damping lowpass sums in another order,
+//    so the results are close but not identical
+//---------------------------------------------------------
+
+void TestEffects::freeverbReference()
+      {
+      RefFreeverb ref;
+      std::vector<float> refOut(FRAMES * 2);
+      ref.process(FRAMES, in.data(), refOut.data());
+
+      for (int buffer : { 7, BUFFER, 4096 }) {
+            Freeverb f;
+            f.setPreset(3);
+            QVERIFY(float(f.nvalue(1)) == RefFreeverb::roomsize);
+            run(&f, buffer);
+            float peak = 0.0f;
+            float diff = 0.0f;
+            for (int i = 0; i < FRAMES * 2; ++i) {
+                  peak = qMax(peak, std::abs(refOut[i]));
+                  diff = qMax(diff, std::abs(out[i] - refOut[i]));
+                  }
+            QVERIFY(peak > 0.1f);
+            QVERIFY2(diff <= 1e-5f * peak, qPrintable(QString("buffer %1: %2").arg(buffer).arg(diff / peak)));
+            }
+      }
+
+//---------------------------------------------------------
+//   masterChunks
+//    buffers larger than the internal effect buffers are
+//    processed in chunks
+//---------------------------------------------------------
+
+void TestEffects::masterChunks()
+      {
+      std::vector<float> ref;
+      for (int buffer : { BUFFER, FRAMES }) {
+            MasterSynthesizer* m = new MasterSynthesizer;
+            Compressor* c = new Compressor;
+            m->registerEffect(0, c);
+            m->setSampleRate(SAMPLE_RATE);
+            m->setEffect(0, 0);
+            c->setNValue(3, -20.0);
+            c->setNValue(4, 4.0);
+            out = in;
+            for (int i = 0; i < FRAMES; i += buffer)
+                  m->process(qMin(buffer, FRAMES - i), out.data() + i * 2);
+            delete m;
+            if (ref.empty())
+                  ref = out;
+            }
+      QVERIFY(out == ref);
+      QVERIFY(out != in);
+      }
+
+//---------------------------------------------------------
+//   zitaBenchmark
+//---------------------------------------------------------
+
+void TestEffects::zitaBenchmark()
+      {
+      ZitaReverb z;
+      z.init(SAMPLE_RATE);
+      QBENCHMARK {
+            run(&z, BUFFER);
+            }
+      }
+
+//---------------------------------------------------------
+//   freeverbBenchmark
+//---------------------------------------------------------
+
+void TestEffects::freeverbBenchmark()
+      {
+      Freeverb f;
+      f.setPreset(3);
+      QBENCHMARK {
+            run(&f, BUFFER);
+            }
+      }
+
+//---------------------------------------------------------
+//   compressorBenchmark
+//---------------------------------------------------------
+
+void TestEffects::compressorBenchmark()
+      {
+      Compressor c;
+      c.init(SAMPLE_RATE);
+      c.setNValue(3, -20.0);
+      c.setNValue(4, 4.0);
+      QBENCHMARK {
+            run(&c, BUFFER);
+            }
+      }
+
+QTEST_MAIN(TestEffects)
+#include "tst_effects.moc"
@@ -0,0 +1,142 @@
+//=============================================================================
+//  MuseScore
+//  Music Composition & Notation
+//
+//  Copyright (C) 2015 Werner Schweer
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License version 2
+//  as published by the Free Software Foundation and appearing in
+//  the file LICENCE.GPL
+//=============================================================================
+
+#include <QtTest/QtTest>
+#include "mtest/testutils.h"
+#include "fluid/fluid.h"
+#include "fluid/sfont.h"
+
+#ifdef Q_OS_LINUX
+#include <unistd.h>
+#endif
+
+using namespace Ms;
+
+//---------------------------------------------------------
+//   TestSFont
+//    load time and resident memory of a SoundFont; the
+//    file is not part of the repository, it is named by
+//    MSCORE_SOUNDFONT, e.g. MuseScore_General.sf2
+//---------------------------------------------------------
+
+class TestSFont : public QObject, public MTest
+      {
+      Q_OBJECT
+
+      QString path;
+      FluidS::Fluid* fluid;
+
+      static qint64 rss();
+
+   private slots:
+      void initTestCase();
+      void cleanupTestCase();
+      void load();
+      void benchmark();
+      };
+
+//---------------------------------------------------------
+//   rss
+//    resident set size of the process in bytes,
+//    -1 if unknown
+//---------------------------------------------------------
+
+qint64 TestSFont::rss()
+      {
+#ifdef Q_OS_LINUX
+      QFile f("/proc/self/statm");
+      if (f.open(QIODevice::ReadOnly)) {
+            QList<QByteArray> l = f.readAll().split(' ');
+            if (l.size() > 1)
+                  return l[1].toLongLong() * sysconf(_SC_PAGESIZE);
+            }
+#endif
+      return -1;
+      }
+
+//---------------------------------------------------------
+//   initTestCase
+//---------------------------------------------------------
+
+void TestSFont::initTestCase()
+      {
+      initMTest();
+      path  = QString::fromLocal8Bit(qgetenv("MSCORE_SOUNDFONT"));
+      fluid = new FluidS::Fluid;
+      fluid->init(44100);
+      }
+
+//---------------------------------------------------------
+//   cleanupTestCase
+//---------------------------------------------------------
+
+void TestSFont::cleanupTestCase()
+      {
+      delete fluid;
+      }
+
+//---------------------------------------------------------
+//   load
+//    read the SoundFont, then load the samples of every
+//    preset as a score using all instruments would; the
+//    samples of a SF2 font are mapped, so neither step
+//    should add the sample chunk to the resident memory
+//---------------------------------------------------------
+
+void TestSFont::load()
+      {
+      if (path.isEmpty())
+            QSKIP("set MSCORE_SOUNDFONT to the SoundFont to measure");
+      qint64 rss0 = rss();
+      QElapsedTimer t;
+      t.start();
+      FluidS::SFont* sf = new FluidS::SFont(fluid);
+      QVERIFY(sf->read(path));
+      qint64 readTime = t.restart();
+      qint64 rss1     = rss();
+      if (sf->version().major >= 3) {
+            delete sf;
+            QSKIP("the samples of SF3 fonts are decoded by the sample cache, not mapped");
+            }
+
+      for (FluidS::Preset* p : sf->getPresets())
+            p->loadSamples();
+      qint64 loadTime = t.elapsed();
+      qint64 rss2     = rss();
+
+      qDebug("%s: %d presets, sample chunk %u KiB, %s",
+         qPrintable(QFileInfo(path).fileName()), sf->getPresets().size(),
+         sf->getSamplesize() / 1024, sf->sampleData() ? "mapped" : "read");
+      qDebug("   read:         %5lld ms, RSS +%lld KiB", readTime, (rss1 - rss0) / 1024);
+      qDebug("   all presets:  %5lld ms, RSS +%lld KiB", loadTime, (rss2 - rss1) / 1024);
+      delete sf;
+      }
+
+//---------------------------------------------------------
+//   benchmark
+//    SFont::read(), the part of the startup time which
+//    depends on the SoundFont
+//---------------------------------------------------------
+
+void TestSFont::benchmark()
+      {
+      if (path.isEmpty())
+            QSKIP("set MSCORE_SOUNDFONT to the SoundFont to measure");
+      QBENCHMARK {
+            FluidS::SFont* sf = new FluidS::SFont(fluid);
+            sf->read(path);
+            delete sf;
+            }
+      }
+
+QTEST_MAIN(TestSFont)
+#include "tst_sfont.moc"
@@ -0,0 +1,177 @@
+//=============================================================================
+//  MuseScore
+//  Music Composition & Notation
+//
+//  Copyright (C) 2015 Werner Schweer
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License version 2
+//  as published by the Free Software Foundation and appearing in
+//  the file LICENCE.GPL
+//=============================================================================
+
+#include <QtTest/QtTest>
+#include "mtest/testutils.h"
+#include "libmscore/score.h"
+#include "thirdparty/qzip/qzipreader_p.h"
+
+#define DIR QString("libmscore/backgroundsave/")
+
+using namespace Ms;
+
+//---------------------------------------------------------
+//   TestBackgroundSave
+//---------------------------------------------------------
+
+class TestBackgroundSave : public QObject, public MTest
+      {
+      Q_OBJECT
+
+      QByteArray written(Score*);
+      bool backgroundSave(Score*, QByteArray* data, const std::atomic<bool>* abort = 0);
+
+   private slots:
+      void initTestCase();
+      void save();
+      void abortOnChange();
+      void abortFlag();
+      void abortWhileWriting();
+      };
+
+//---------------------------------------------------------
+//   initTestCase
+//---------------------------------------------------------
+
+void TestBackgroundSave::initTestCase()
+      {
+      initMTest();
+      }
+
+//---------------------------------------------------------
+//   written
+//    the score as written on the gui thread
+//---------------------------------------------------------
+
+QByteArray TestBackgroundSave::written(Score* score)
+      {
+      QBuffer buffer;
+      buffer.open(QIODevice::WriteOnly);
+      score->writeFile(&buffer, true);
+      return buffer.data();
+      }
+
+//---------------------------------------------------------
+//   backgroundSave
+//    write score into a compressed score and read the
+//    score file back into data
+//---------------------------------------------------------
+
+bool TestBackgroundSave::backgroundSave(Score* score, QByteArray* data, const std::atomic<bool>* abort)
+      {
+      QBuffer buffer;
+      buffer.open(QIODevice::ReadWrite);
+      if (!score->backgroundSave(&buffer, QList<MsczFile>(), "score.mscx", abort))
+            return false;
+      buffer.seek(0);
+      MQZipReader uz(&buffer);
+      *data = uz.fileData("score.mscx");
+      return true;
+      }
+
+//---------------------------------------------------------
+//   save
+//    a background save writes what writeFile() writes
+//---------------------------------------------------------
+
+void TestBackgroundSave::save()
+      {
+      Score* score = readScore(DIR + "backgroundsave.mscx");
+      score->doLayout();
+      QByteArray expected = written(score);
+
+      QVERIFY(score->startBackgroundSave());
+      QByteArray data;
+      QVERIFY(backgroundSave(score, &data));
+      QCOMPARE(data, expected);
+
+      // the snapshot was written, nobody reads the score anymore
+      score->waitForBackgroundSave();
+      delete score;
+      }
+
+//---------------------------------------------------------
+//   abortOnChange
+//    a change after startBackgroundSave() drops the
+//    snapshot and marks the score for the next autosave
+//---------------------------------------------------------
+
+void TestBackgroundSave::abortOnChange()
+      {
+      Score* score = readScore(DIR + "backgroundsave.mscx");
+      score->doLayout();
+      score->setAutosaveDirty(false);
+
+      QVERIFY(score->startBackgroundSave());
+      score->startCmd();
+      score->endCmd();
+      QVERIFY(score->autosaveDirty());
+      QByteArray data;
+      QVERIFY(!backgroundSave(score, &data));
+
+      // the next snapshot is written again
+      QVERIFY(score->startBackgroundSave());
+      QVERIFY(backgroundSave(score, &data));
+      QCOMPARE(data, written(score));
+      delete score;
+      }
+
+//---------------------------------------------------------
+//   abortFlag
+//    the flag of the autosaver stops the save
+//---------------------------------------------------------
+
+void TestBackgroundSave::abortFlag()
+      {
+      Score* score = readScore(DIR + "backgroundsave.mscx");
+      score->doLayout();
+
+      QVERIFY(score->startBackgroundSave());
+      std::atomic<bool> abort { true };
+      QByteArray data;
+      QVERIFY(!backgroundSave(score, &data, &abort));
+      score->waitForBackgroundSave();           // must not block
+      delete score;
+      }
+
+//---------------------------------------------------------
+//   abortWhileWriting
+//    waitForBackgroundSave() returns once the other
+//    thread has stopped reading; a finished save is
+//    complete
+//---------------------------------------------------------
+
+void TestBackgroundSave::abortWhileWriting()
+      {
+      Score* score = readScore(DIR + "backgroundsave.mscx");
+      score->doLayout();
+      QByteArray expected = written(score);
+
+      for (int i = 0; i < 20; ++i) {
+            QVERIFY(score->startBackgroundSave());
+            QByteArray data;
+            QFuture<bool> f = QtConcurrent::run(this, &TestBackgroundSave::backgroundSave, score, &data,
+               static_cast<const std::atomic<bool>*>(0));
+            if (i & 1)
+                  QThread::usleep(100 * i);
+            score->waitForBackgroundSave();
+            // the score may be changed now
+            score->startCmd();
+            score->endCmd();
+            if (f.result())
+                  QCOMPARE(data, expected);
+            }
+      delete score;
+      }
+
+QTEST_MAIN(TestBackgroundSave)
+#include "tst_backgroundsave.moc"
@@ -14,6 +14,8 @@
 #include <QtTest/QtTest>
 #include "mtest/testutils.h"
 #include "libmscore/score.h"
+#include "libmscore/repeatlist.h"
+#include "synthesizer/event.h"
 
 #define DIR QString("libmscore/layout/")
 
@@ -37,8 +39,11 @@ class TestBenchmark : public QObject, public MTest
    private slots:
       void initTestCase();
       void benchmark3();
+      void benchmark6();
       void benchmark1();
       void benchmark2();
+      void benchmark4();
+      void benchmark5();
       };
 
 //---------------------------------------------------------
@@ -66,6 +71,26 @@ void TestBenchmark::benchmark3()
 //      Ms::dumpTags();
       }
 
+//---------------------------------------------------------
+//   benchmark6
+//    load the compressed score, which is inflated while
+//    it is read
+//---------------------------------------------------------
+
+void TestBenchmark::benchmark6()
+      {
+      QBuffer buffer;
+      buffer.open(QIODevice::ReadWrite);
+      QFileInfo fi("goldberg.mscz");
+      score->saveCompressedFile(&buffer, fi, false);
+      QBENCHMARK {
+            Score* s = new Score(mscore->baseStyle());
+            buffer.seek(0);
+            s->loadMsc(fi.fileName(), &buffer, false);
+            delete s;
+            }
+      }
+
 void TestBenchmark::benchmark1()
       {
       score = readScore(DIR + "goldberg.mscx");
@@ -82,6 +107,30 @@ void TestBenchmark::benchmark2()
             }
       }
 
+//---------------------------------------------------------
+//   benchmark4, benchmark5
+//    the playlist work done before playback starts: the
+//    whole score, and the first three seconds rendered as
+//    the sequencer does it
+//---------------------------------------------------------
+
+void TestBenchmark::benchmark4()
+      {
+      QBENCHMARK {
+            EventMap events;
+            score->renderMidi(&events);
+            }
+      }
+
+void TestBenchmark::benchmark5()
+      {
+      QBENCHMARK {
+            EventMap events;
+            score->renderMidiPrepare(&events);
+            score->renderMidiRange(&events, 0, score->utime2utick(3.0));
+            }
+      }
+
 QTEST_MAIN(TestBenchmark)
 #include "tst_benchmark.moc"
 
@@ -23,6 +23,7 @@
 #include "libmscore/chord.h"
 #include "libmscore/note.h"
 #include "libmscore/keysig.h"
+#include "libmscore/repeatlist.h"
 #include "mscore/exportmidi.h"
 #include "mscore/preferences.h"
 #include <QIODevice>
@@ -53,6 +54,8 @@ class TestMidi : public QObject, public MTest
       void midi03();
       void events_data();
       void events();
+      void renderMidiRange_data();
+      void renderMidiRange();
       void midiBendsExport1() { midiExportTestRef("testBends1"); }
       void midiBendsExport2() { midiExportTestRef("testBends2"); }      // Play property test
       void midiPortExport()   { midiExportTestRef("testMidiPort"); }
@@ -382,6 +385,62 @@ void TestMidi::events()
      // QVERIFY(saveCompareScore(score, writeFile, reference));
       }
 
+//---------------------------------------------------------
+//   eventList
+//    the events of a playlist in a canonical order
+//---------------------------------------------------------
+
+static QStringList eventList(const EventMap& events)
+      {
+      QStringList l;
+      for (const auto& e : events) {
+            const NPlayEvent& ev = e.second;
+            l.append(QString("%1 %2 %3 %4 %5").arg(e.first).arg(ev.type())
+               .arg(ev.channel()).arg(ev.dataA()).arg(ev.dataB()));
+            }
+      l.sort();
+      return l;
+      }
+
+//---------------------------------------------------------
+//   renderMidiRange
+//    rendering a score in pieces, as the sequencer does when
+//    it starts playback before the playlist is complete,
+//    gives the events of renderMidi()
+//---------------------------------------------------------
+
+void TestMidi::renderMidiRange_data()
+      {
+      QTest::addColumn<QString>("file");
+      QTest::newRow("testPedal") << DIR + "testPedal.mscx";
+      QTest::newRow("testAndanteExcerpts") << DIR + "testAndanteExcerpts.mscx";
+      // repeat measure after a repeat
+      QTest::newRow("timesig-03") << QString("libmscore/timesig/timesig-03.mscx");
+      }
+
+void TestMidi::renderMidiRange()
+      {
+      QFETCH(QString, file);
+
+      Score* score = readScore(file);
+      QVERIFY(score);
+      score->doLayout();
+      EventMap events;
+      score->renderMidi(&events);
+
+      EventMap pieces;
+      score->renderMidiPrepare(&pieces);
+      const RepeatSegment* rs = score->repeatList()->last();
+      int end = rs->utick + rs->len;
+      // pieces do not start at measure boundaries
+      int step = MScore::division * 3 / 2;
+      for (int utick = 0; utick < end; utick += step)
+            score->renderMidiRange(&pieces, utick, utick + step);
+
+      QCOMPARE(eventList(pieces), eventList(events));
+      delete score;
+      }
+
 //---------------------------------------------------------
 //   midiExportTest
 //   read a MuseScore mscx file, write to a MIDI file and verify against reference
@@ -111,6 +111,8 @@ class TestParts : public QObject, public MTest
 //      void staffStyles();
 
       void measureProperties();
+      void readParts();
+      void readPartsOnEdit();
 
  // second part has system text on empty chordrest segment
       void createPart3() {
@@ -1057,6 +1059,78 @@ void TestParts::measureProperties()
       {
       }
 
+//---------------------------------------------------------
+//   readParts
+//    the part scores of a .mscz file are read on first
+//    use, loadExcerpts() reads them in parallel; the result
+//    must be the same as reading them with the main score
+//---------------------------------------------------------
+
+void TestParts::readParts()
+      {
+      Score* score = readScore(DIR + "part-all-parts.mscx");
+      QVERIFY(score);
+      QFileInfo fi("part-all-parts.mscz");
+      score->saveCompressedFile(fi, false);
+      score->doLayout();
+      QVERIFY(saveScore(score, "part-all-parts-read.mscx"));
+      delete score;
+
+      score = readCreatedScore("part-all-parts.mscz");
+      QVERIFY(score);
+      QCOMPARE(score->excerpts().size(), 2);
+      for (Excerpt* ex : score->excerpts())
+            QVERIFY(ex->pending());
+      score->loadExcerpts();
+      for (Excerpt* ex : score->excerpts())
+            QVERIFY(!ex->pending());
+      score->doLayout();
+      QVERIFY(saveScore(score, "part-all-parts-load.mscx"));
+      delete score;
+
+      QFile f1("part-all-parts-read.mscx");
+      QFile f2("part-all-parts-load.mscx");
+      QVERIFY(f1.open(QIODevice::ReadOnly) && f2.open(QIODevice::ReadOnly));
+      QVERIFY(f1.readAll() == f2.readAll());
+      }
+
+//---------------------------------------------------------
+//   readPartsOnEdit
+//    looking at links and staves does not read pending
+//    part scores, starting an edit does
+//---------------------------------------------------------
+
+void TestParts::readPartsOnEdit()
+      {
+      Score* score = readScore(DIR + "part-all-parts.mscx");
+      QVERIFY(score);
+      QFileInfo fi("part-all-parts-edit.mscz");
+      score->saveCompressedFile(fi, false);
+      delete score;
+
+      score = readCreatedScore("part-all-parts-edit.mscz");
+      QVERIFY(score);
+      score->doLayout();
+      Staff* staff = score->staff(0);
+      Element* e   = score->firstSegment(Segment::Type::ChordRest)->element(0);
+      QCOMPARE(staff->staffList().size(), 1);
+      QCOMPARE(e->linkList().size(), 1);
+      for (Excerpt* ex : score->excerpts()) {
+            QVERIFY(ex->pending());
+            QVERIFY(!ex->partScore());
+            }
+      QCOMPARE(score->scoreList().size(), 1);
+
+      score->startCmd();
+      QCOMPARE(staff->staffList().size(), 2);
+      QCOMPARE(e->linkList().size(), 2);
+      score->endCmd();
+      for (Excerpt* ex : score->excerpts())
+            QVERIFY(ex->partScore());
+      QCOMPARE(score->scoreList().size(), 3);
+      delete score;
+      }
+
 
 QTEST_MAIN(TestParts)
 
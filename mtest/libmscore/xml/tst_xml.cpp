@@ -0,0 +1,333 @@
+//=============================================================================
+//  MuseScore
+//  Music Composition & Notation
+//
+//  Copyright (C) 2015 Werner Schweer
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License version 2
+//  as published by the Free Software Foundation and appearing in
+//  the file LICENCE.GPL
+//=============================================================================
+
+#include <QtTest/QtTest>
+#include "mtest/testutils.h"
+#include "libmscore/xml.h"
+#include "libmscore/score.h"
+#include "thirdparty/qzip/qzipreader_p.h"
+#include "thirdparty/qzip/qzipwriter_p.h"
+
+#include <cmath>
+#include <limits>
+
+using namespace Ms;
+
+//---------------------------------------------------------
+//   TestXml
+//---------------------------------------------------------
+
+class TestXml : public QObject, public MTest
+      {
+      Q_OBJECT
+
+      QByteArray document(const QStringList& values, const char* tag);
+
+   private slots:
+      void initTestCase();
+      void readInt();
+      void readDouble();
+      void attributes();
+      void readZipEntry();
+      void writeTags();
+      void writeScores();
+      void benchmarkReadInt();
+      void benchmarkReadDouble();
+      };
+
+//---------------------------------------------------------
+//   values
+//    element texts the numeric fast paths take, and some
+//    they leave to QString
+//---------------------------------------------------------
+
+static const QStringList values = {
+      "0", "1", "-1", "+7", "42", " 12 ", "\n480\n", "999999999", "-999999999",
+      "2147483647", "-2147483648", "2147483648", "1234567890123",
+      "0.5", "-0.25", ".5", "5.", "-0", "-0.0", "3.14159", "0.1", "0.3",
+      "123456789012345", "1234567890.12345", "0.000000000000001",
+      "1234567890123456", "1e3", "-2.5E-3", "inf", "nan",
+      "", "-", ".", "+", "1.2.3", "12a", "0x10", "1 2",
+      "1<!-- comment -->2", "&#49;0", "1234567890123456789012345678901234567890"
+      };
+
+//---------------------------------------------------------
+//   initTestCase
+//---------------------------------------------------------
+
+void TestXml::initTestCase()
+      {
+      initMTest();
+      }
+
+//---------------------------------------------------------
+//   document
+//---------------------------------------------------------
+
+QByteArray TestXml::document(const QStringList& vl, const char* tag)
+      {
+      QByteArray d("<museScore>");
+      for (const QString& v : vl)
+            d += QString("<%1>%2</%1>").arg(tag).arg(v).toUtf8();
+      d += "</museScore>";
+      return d;
+      }
+
+//---------------------------------------------------------
+//   plain
+//    the text of a value as the xml reader sees it
+//---------------------------------------------------------
+
+static QString plain(const QString& v)
+      {
+      QString s = v;
+      s.replace("<!-- comment -->", "");
+      s.replace("&#49;", "1");
+      return s;
+      }
+
+//---------------------------------------------------------
+//   readInt
+//    same results as QString::toInt()
+//---------------------------------------------------------
+
+void TestXml::readInt()
+      {
+      XmlReader e(document(values, "v"));
+      e.readNextStartElement();
+      for (const QString& v : values) {
+            QVERIFY(e.readNextStartElement());
+            bool ok1, ok2;
+            int val = e.readInt(&ok1);
+            QCOMPARE(val, plain(v).toInt(&ok2));
+            QCOMPARE(ok1, ok2);
+            }
+      QVERIFY(!e.hasError());
+      }
+
+//---------------------------------------------------------
+//   readDouble
+//    same results as QString::toDouble(), bit for bit
+//---------------------------------------------------------
+
+void TestXml::readDouble()
+      {
+      XmlReader e(document(values, "v"));
+      e.readNextStartElement();
+      for (const QString& v : values) {
+            QVERIFY(e.readNextStartElement());
+            double val = e.readDouble();
+            double ref = plain(v).toDouble();
+            if (std::isnan(ref))
+                  QVERIFY(std::isnan(val));
+            else
+                  QVERIFY2(memcmp(&val, &ref, sizeof(double)) == 0, qPrintable(v));
+            }
+      QVERIFY(!e.hasError());
+      }
+
+//---------------------------------------------------------
+//   attributes
+//---------------------------------------------------------
+
+void TestXml::attributes()
+      {
+      for (const QString& v : values) {
+            if (v.contains('<') || v.contains('&'))
+                  continue;
+            XmlReader e(QString("<v a=\"%1\"/>").arg(v).toUtf8());
+            QVERIFY(e.readNextStartElement());
+            QCOMPARE(e.intAttribute("a"), v.toInt());
+            QCOMPARE(e.intAttribute("a", 5), v.toInt());
+            double val = e.doubleAttribute("a");
+            double ref = v.toDouble();
+            if (!std::isnan(ref))
+                  QVERIFY2(memcmp(&val, &ref, sizeof(double)) == 0, qPrintable(v));
+            }
+      }
+
+//---------------------------------------------------------
+//   readZipEntry
+//    read a document while it is inflated, in several
+//    chunks; data() grows to the whole document
+//---------------------------------------------------------
+
+void TestXml::readZipEntry()
+      {
+      QStringList vl;
+      for (int i = 0; i < 50000; ++i)
+            vl.append(QString::number(i * 7 - 1000));
+      QByteArray d = document(vl, "v");
+
+      QBuffer buffer;
+      buffer.open(QIODevice::ReadWrite);
+      MQZipWriter zw(&buffer);
+      zw.setCompressionPolicy(MQZipWriter::AlwaysCompress);
+      zw.addFile("deflated.mscx", d);
+      zw.setCompressionPolicy(MQZipWriter::NeverCompress);
+      zw.addFile("stored.mscx", d);
+      zw.close();
+
+      buffer.seek(0);
+      MQZipReader uz(&buffer);
+      for (const char* name : { "deflated.mscx", "stored.mscx" }) {
+            QByteArray data;
+            QIODevice* dev = uz.openFile(name, &data);
+            QVERIFY(dev);
+            XmlReader e(dev, &data);
+            e.readNextStartElement();
+            for (const QString& v : vl) {
+                  QVERIFY(e.readNextStartElement());
+                  QCOMPARE(e.readInt(), v.toInt());
+                  QVERIFY(e.byteOffset() <= data.size());
+                  }
+            QVERIFY(!e.readNextStartElement());
+            QVERIFY(!e.hasError());
+            QCOMPARE(data, d);
+            }
+      QVERIFY(!uz.openFile("missing.mscx"));
+      }
+
+//---------------------------------------------------------
+//   writeTags
+//    the typed tag() overloads write what the QVariant
+//    version and QString::arg() write; reals which are
+//    not written directly take the %g fallback
+//---------------------------------------------------------
+
+void TestXml::writeTags()
+      {
+      static const int ints[] = {
+            0, 1, -1, 7, 480, -12345, 1000000, 2147483647, -2147483647 - 1
+            };
+      static const qreal reals[] = {
+            0.0, 1.0, -1.5, 0.1, 0.3, 0.25, 38.37, -2.5e-3, 3.14159, 3.14159265,
+            123456.0, 999999.0, 0.0001, 1.234567, 5.0000001,
+            // %g fallback
+            -0.0, 999999.5, 1e6, 1234567.0, 0.00001, 0.000123456789, 1e20, -1e-20,
+            1.0 / 3.0, std::numeric_limits<qreal>::infinity()
+            };
+
+      QBuffer buffer;
+      buffer.open(QIODevice::WriteOnly);
+      QString expected;
+      {
+      Xml xml(&buffer);
+      xml.stag("museScore version=\"2.00\"");
+      expected += "<museScore version=\"2.00\">\n";
+      for (int i : ints) {
+            xml.tag("int", i);
+            xml.tag("variant", QVariant(i));
+            expected += QString("  <int>%1</int>\n  <variant>%1</variant>\n").arg(i);
+            }
+      for (bool b : { false, true }) {
+            xml.tag("bool", b);
+            xml.tag("variant", QVariant(b));
+            expected += QString("  <bool>%1</bool>\n  <variant>%1</variant>\n").arg(int(b));
+            }
+      for (qreal r : reals) {
+            xml.tag("real", r);
+            xml.tag("variant", QVariant(r));
+            xml.tag("point", QPointF(r, -r));
+            xml.tag("variant", QVariant(QPointF(-r, r)));
+            expected += QString("  <real>%1</real>\n  <variant>%1</variant>\n").arg(r);
+            expected += QString("  <point x=\"%1\" y=\"%2\"/>\n").arg(r).arg(-r);
+            expected += QString("  <variant x=\"%1\" y=\"%2\"/>\n").arg(-r).arg(r);
+            }
+      for (const Fraction& f : { Fraction(0, 1), Fraction(3, 4), Fraction(-7, 8), Fraction(1920, 480) }) {
+            xml.tag("fraction", f);
+            xml.fTag("duration", f);
+            expected += QString("  <fraction z=\"%1\" n=\"%2\"/>\n").arg(f.numerator()).arg(f.denominator());
+            expected += QString("  <duration z=\"%1\" n=\"%2\"/>\n").arg(f.numerator()).arg(f.denominator());
+            }
+      xml.tag("text", QString("a < b & \"c\" \u00e4\u266d"));
+      xml.tag("text", QVariant(QString("a < b & \"c\" \u00e4\u266d")));
+      expected += QString("  <text>a &lt; b &amp; &quot;c&quot; \u00e4\u266d</text>\n").repeated(2);
+      xml.etag();
+      expected += "</museScore>\n";
+      }
+      QCOMPARE(QString::fromUtf8(buffer.data()), expected);
+      QCOMPARE(buffer.data(), expected.toUtf8());
+      }
+
+//---------------------------------------------------------
+//   writeScores
+//    reference scores which other tests read and write
+//    back unchanged are written byte for byte as they
+//    are checked in
+//---------------------------------------------------------
+
+void TestXml::writeScores()
+      {
+      static const char* scores[] = {
+            "libmscore/spanners/lyricsline01.mscx",
+            "libmscore/spanners/lyricsline02.mscx",
+            "libmscore/spanners/lyricsline03.mscx",
+            "libmscore/earlymusic/mensurstrich01.mscx",
+            "libmscore/measure/measure-insert_bf_clef.mscx",
+            "libmscore/measure/measure-insert_bf_key.mscx",
+            };
+      for (const char* path : scores) {
+            Score* score = readScore(path);
+            QVERIFY2(score, path);
+            score->doLayout();
+            QString name = QFileInfo(path).fileName();
+            QVERIFY(saveScore(score, name));
+            delete score;
+
+            QFile saved(name);
+            QFile ref(root + "/" + path);
+            QVERIFY(saved.open(QIODevice::ReadOnly));
+            QVERIFY(ref.open(QIODevice::ReadOnly));
+            QVERIFY2(saved.readAll() == ref.readAll(), path);
+            }
+      }
+
+//---------------------------------------------------------
+//   benchmarkReadInt, benchmarkReadDouble
+//    ticks, pitches and offsets as they appear in a score
+//---------------------------------------------------------
+
+void TestXml::benchmarkReadInt()
+      {
+      QStringList vl;
+      for (int i = 0; i < 100000; ++i)
+            vl.append(QString::number(i * 120));
+      QByteArray d = document(vl, "tick");
+      int sum = 0;
+      QBENCHMARK {
+            XmlReader e(d);
+            e.readNextStartElement();
+            while (e.readNextStartElement())
+                  sum += e.readInt();
+            }
+      QVERIFY(sum != 0);
+      }
+
+void TestXml::benchmarkReadDouble()
+      {
+      QStringList vl;
+      for (int i = 0; i < 100000; ++i)
+            vl.append(QString::number(i * 0.37 - 5000.0));
+      QByteArray d = document(vl, "offset");
+      double sum = 0.0;
+      QBENCHMARK {
+            XmlReader e(d);
+            e.readNextStartElement();
+            while (e.readNextStartElement())
+                  sum += e.readDouble();
+            }
+      QVERIFY(sum != 0.0);
+      }
+
+QTEST_MAIN(TestXml)
+#include "tst_xml.moc"
@@ -15,6 +15,7 @@
 #include "mtest/testutils.h"
 #include "libmscore/score.h"
 #include "mscore/preferences.h"
+#include "mscore/importmxmlpass2.h"
 // start includes required for fixupScore()
 #include "libmscore/measure.h"
 #include "libmscore/staff.h"
@@ -42,6 +43,7 @@ class TestMxmlIO : public QObject, public MTest
       void mxmlMscxExportTestRef(const char* file);
       void mxmlReadTestCompr(const char* file);
       void mxmlReadWriteTestCompr(const char* file);
+      void mxmlParallelIoTest(const char* file);
 
 
       // The list of MusicXML regression tests
@@ -160,6 +162,15 @@ private slots:
 //      void wedge2() { mxmlIoTest("testWedge2"); }
       void words1() { mxmlIoTest("testWords1"); }
       void words2() { mxmlIoTest("testWords2"); }
+
+      // the same files with the parts read on worker threads
+      void parallelDrumset2() { mxmlParallelIoTest("testDrumset2"); }
+      void parallelDynamics2() { mxmlParallelIoTest("testDynamics2"); }
+      void parallelFiguredBass2() { mxmlParallelIoTest("testFiguredBass2"); }
+      void parallelLyricsVoice2a() { mxmlParallelIoTest("testLyricsVoice2a"); }
+      void parallelSystemBrackets1() { mxmlParallelIoTest("testSystemBrackets1"); }
+      void parallelVoicePiano1() { mxmlParallelIoTest("testVoicePiano1"); }
+      void parallelWords2() { mxmlParallelIoTest("testWords2"); }
       };
 
 //---------------------------------------------------------
@@ -258,6 +269,18 @@ void TestMxmlIO::mxmlIoTestRef(const char* file)
       delete score;
       }
 
+//---------------------------------------------------------
+//   mxmlParallelIoTest
+//   as mxmlIoTest, but read the parts in parallel also on a single core
+//---------------------------------------------------------
+
+void TestMxmlIO::mxmlParallelIoTest(const char* file)
+      {
+      MusicXMLParserPass2::partThreads = 4;
+      mxmlIoTest(file);
+      MusicXMLParserPass2::partThreads = 0;
+      }
+
 //---------------------------------------------------------
 //   mxmlMscxExportTestRef
 //   read a MuseScore mscx file, write to a MusicXML file and verify against reference
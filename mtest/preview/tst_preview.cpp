@@ -0,0 +1,229 @@
+//=============================================================================
+//  MuseScore
+//  Music Composition & Notation
+//  $Id:$
+//
+//  Copyright (C) 2015 Werner Schweer
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License version 2
+//  as published by the Free Software Foundation and appearing in
+//  the file LICENCE.GPL
+//=============================================================================
+
+#include <QtTest/QtTest>
+#include "mtest/testutils.h"
+#include "synthesizer/msynthesizer.h"
+#include "synthesizer/synthesizer.h"
+#include "synthesizer/previewqueue.h"
+
+using namespace Ms;
+
+static const int SAMPLE_RATE = 44100;
+static const int BUFFER      = 1024;                            // frames per driver callback
+static const qint64 PERIOD   = qint64(BUFFER) * 1000000 / SAMPLE_RATE;   // usec
+static const qint64 JITTER   = PERIOD / 5;                      // max. late wakeup of a callback
+static const qint64 RENDER   = PERIOD / 4;                      // usec to render a buffer
+static const int CALLBACKS   = 8;
+
+class DummyDriver;
+
+//---------------------------------------------------------
+//   ClickSynth
+//    outputs 1.0 while a note is on; tells the driver
+//    how many frames it rendered
+//---------------------------------------------------------
+
+class ClickSynth : public Synthesizer {
+      QList<MidiPatch*> patches;
+      bool sounding { false };
+
+   public:
+      DummyDriver* driver { 0 };
+
+      virtual const char* name() const override                 { return "Click"; }
+      virtual bool loadSoundFonts(const QStringList&) override  { return true; }
+      virtual QStringList soundFonts() const override           { return QStringList(); }
+      virtual const QList<MidiPatch*>& getPatchInfo() const override { return patches; }
+      virtual SynthesizerGroup state() const override           { return SynthesizerGroup(); }
+      virtual bool setState(const SynthesizerGroup&) override   { return true; }
+
+      virtual void play(const PlayEvent& e) override {
+            if (e.type() == ME_NOTEON)
+                  sounding = e.velo() > 0;
+            }
+      virtual void allNotesOff(int) override { sounding = false; }
+
+      virtual void process(unsigned n, float* p, float*, float*) override;
+      };
+
+//---------------------------------------------------------
+//   DummyDriver
+//    models a double buffered sound card on a virtual
+//    clock: callback k is due at k * PERIOD but wakes up
+//    to JITTER late and needs RENDER usec for its buffer,
+//    which is heard from (k + 2) * PERIOD on, as the card
+//    reads at a steady rate. A key pressed at time t is
+//    queued by the gui thread at t, also while a buffer is
+//    rendered.
+//---------------------------------------------------------
+
+class DummyDriver {
+      MasterSynthesizer* synti;
+      PreviewQueue* queue;
+      qint64 clock;
+      qint64 keyTime;
+      bool queued;
+
+      void queueKey() {
+            if (!queued && keyTime < clock) {
+                  queue->enqueue(PreviewMsg(0, NPlayEvent(ME_NOTEON, 0, 60, 100)));
+                  queued = true;
+                  }
+            }
+
+   public:
+      std::vector<float> out;
+
+      DummyDriver(MasterSynthesizer* s, PreviewQueue* q) : synti(s), queue(q) {}
+
+      static qint64 wakeup(int k) {
+            unsigned r = unsigned(k) * 1103515245u + 12345u;      // repeatable jitter
+            return k * PERIOD + qint64((r >> 8) % unsigned(JITTER + 1));
+            }
+      void run(qint64 key, bool poll) {
+            out.assign(CALLBACKS * BUFFER * 2, 0.0f);
+            keyTime = key;
+            queued  = keyTime < 0;
+            for (int k = 0; k < CALLBACKS; ++k) {
+                  clock = wakeup(k);
+                  queueKey();
+                  float* p = out.data() + k * BUFFER * 2;
+                  if (poll)
+                        queue->render(synti, BUFFER, p);
+                  else {
+                        // play at the start of the buffer only
+                        queue->drain(synti, 0);
+                        synti->process(BUFFER, p);
+                        }
+                  }
+            }
+      // the synthesizer rendered n frames
+      void rendered(unsigned n) {
+            clock += qint64(n) * RENDER / BUFFER;
+            queueKey();
+            }
+      // usec at which the first sounding frame is heard, -1 if silent
+      qint64 onset() const {
+            for (size_t i = 0; i < out.size(); i += 2) {
+                  if (out[i] != 0.0f) {
+                        int frame = int(i / 2);
+                        int k     = frame / BUFFER;
+                        return (k + 2) * PERIOD + qint64(frame % BUFFER) * 1000000 / SAMPLE_RATE;
+                        }
+                  }
+            return -1;
+            }
+      };
+
+//---------------------------------------------------------
+//   process
+//---------------------------------------------------------
+
+void ClickSynth::process(unsigned n, float* p, float*, float*)
+      {
+      processMessages();
+      for (unsigned i = 0; i < n * 2; ++i)
+            p[i] += sounding ? 1.0f : 0.0f;
+      if (driver)
+            driver->rendered(n);
+      }
+
+//---------------------------------------------------------
+//   TestPreview
+//---------------------------------------------------------
+
+class TestPreview : public QObject, public MTest
+      {
+      Q_OBJECT
+
+      qint64 latency(qint64 keyTime, bool poll);
+
+   private slots:
+      void initTestCase()     { initMTest(); }
+      void keyToAudio();
+      void noteOffOrder();
+      };
+
+//---------------------------------------------------------
+//   latency
+//    usec from the key press at keyTime until it is heard
+//---------------------------------------------------------
+
+qint64 TestPreview::latency(qint64 keyTime, bool poll)
+      {
+      MasterSynthesizer synti;
+      ClickSynth* click = new ClickSynth;
+      synti.registerSynthesizer(click);
+      synti.setSampleRate(SAMPLE_RATE);
+      PreviewQueue queue;
+      DummyDriver driver(&synti, &queue);
+      click->driver = &driver;
+      driver.run(keyTime, poll);
+      qint64 onset = driver.onset();
+      return onset < 0 ? -1 : onset - keyTime;
+      }
+
+//---------------------------------------------------------
+//   keyToAudio
+//    a key pressed while a buffer is rendered is heard in
+//    that buffer instead of the next one; the baseline
+//    plays every key at the start of the next buffer
+//---------------------------------------------------------
+
+void TestPreview::keyToAudio()
+      {
+      qint64 sumPoll = 0, maxPoll = 0;
+      qint64 sumBase = 0, maxBase = 0;
+      int n = 0;
+      for (qint64 keyTime = 0; keyTime < 5 * PERIOD; keyTime += 997, ++n) {
+            qint64 lp = latency(keyTime, true);
+            qint64 lb = latency(keyTime, false);
+            QVERIFY(lp > 0);
+            QVERIFY(lb > 0);
+            QVERIFY(lp <= lb);
+            sumPoll += lp;
+            sumBase += lb;
+            maxPoll  = qMax(maxPoll, lp);
+            maxBase  = qMax(maxBase, lb);
+            }
+      qDebug("key to audio latency at %d frames/buffer, %lld us to render a buffer: "
+         "polled mean %.2f ms max %.2f ms, next buffer mean %.2f ms max %.2f ms",
+         BUFFER, RENDER,
+         sumPoll / 1000.0 / n, maxPoll / 1000.0, sumBase / 1000.0 / n, maxBase / 1000.0);
+      QVERIFY(sumPoll < sumBase);
+      QVERIFY(maxPoll <= maxBase);
+      }
+
+//---------------------------------------------------------
+//   noteOffOrder
+//    the all notes off of stopNotes() must not silence the
+//    note queued after it
+//---------------------------------------------------------
+
+void TestPreview::noteOffOrder()
+      {
+      MasterSynthesizer synti;
+      synti.registerSynthesizer(new ClickSynth);
+      synti.setSampleRate(SAMPLE_RATE);
+      PreviewQueue queue;
+      QVERIFY(queue.enqueue(PreviewMsg(-1)));
+      QVERIFY(queue.enqueue(PreviewMsg(0, NPlayEvent(ME_NOTEON, 0, 60, 100))));
+      std::vector<float> out(BUFFER * 2, 0.0f);
+      queue.render(&synti, BUFFER, out.data());
+      QVERIFY(out[0] != 0.0f);
+      QVERIFY(queue.isEmpty());
+      }
+
+QTEST_MAIN(TestPreview)
+#include "tst_preview.moc"
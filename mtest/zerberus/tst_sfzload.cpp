@@ -0,0 +1,135 @@
+//=============================================================================
+//  MuseScore
+//  Music Composition & Notation
+//  $Id:$
+//
+//  Copyright (C) 2015 Werner Schweer
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License version 2
+//  as published by the Free Software Foundation and appearing in
+//  the file LICENCE.GPL
+//=============================================================================
+
+#include <QtTest/QtTest>
+#include <sndfile.h>
+#include "mtest/testutils.h"
+#include "zerberus/zerberus.h"
+#include "zerberus/instrument.h"
+
+using namespace Ms;
+
+static const int REGIONS = 2000;
+static const int SAMPLES = 200;           // every sample is used by REGIONS/SAMPLES regions
+static const int FRAMES  = 22050;         // 0.5 sec at 44.1 kHz
+
+//---------------------------------------------------------
+//   TestSfzLoad
+//    load a synthetic instrument with REGIONS regions
+//---------------------------------------------------------
+
+class TestSfzLoad : public QObject, public MTest
+      {
+      Q_OBJECT
+
+      QTemporaryDir dir;
+      QString sfz;
+
+      bool writeSample(const QString& path, int key);
+
+   private slots:
+      void initTestCase();
+      void load();
+      void cancel();
+      void benchmark();
+      };
+
+//---------------------------------------------------------
+//   writeSample
+//---------------------------------------------------------
+
+bool TestSfzLoad::writeSample(const QString& path, int key)
+      {
+      SF_INFO info;
+      memset(&info, 0, sizeof(info));
+      info.samplerate = 44100;
+      info.channels   = 1;
+      info.format     = SF_FORMAT_WAV | SF_FORMAT_PCM_16;
+      SNDFILE* sf = sf_open(qPrintable(path), SFM_WRITE, &info);
+      if (!sf)
+            return false;
+      double f = 440.0 * pow(2.0, (key - 69) / 12.0);
+      std::vector<short> data(FRAMES);
+      for (int i = 0; i < FRAMES; ++i)
+            data[i] = short(16000 * sin(2.0 * M_PI * f * i / 44100.0));
+      bool ok = sf_writef_short(sf, data.data(), FRAMES) == FRAMES;
+      sf_close(sf);
+      return ok;
+      }
+
+//---------------------------------------------------------
+//   initTestCase
+//---------------------------------------------------------
+
+void TestSfzLoad::initTestCase()
+      {
+      initMTest();
+      QVERIFY(dir.isValid());
+      for (int i = 0; i < SAMPLES; ++i)
+            QVERIFY(writeSample(dir.path() + QString("/s%1.wav").arg(i), 21 + i % 88));
+
+      sfz = dir.path() + "/synthetic.sfz";
+      QFile f(sfz);
+      QVERIFY(f.open(QIODevice::WriteOnly));
+      QTextStream os(&f);
+      os << "// synthetic instrument\n<group> ampeg_release=0.3\n";
+      for (int i = 0; i < REGIONS; ++i) {
+            int key   = 21 + i % 88;
+            int layer = (i / 88) % 8;
+            os << "<region> sample=s" << (i % SAMPLES) << ".wav"
+               << " lokey=" << key << " hikey=" << key << " pitch_keycenter=" << key
+               << " lovel=" << layer * 16 << " hivel=" << layer * 16 + 15 << "\n";
+            }
+      }
+
+//---------------------------------------------------------
+//   load
+//---------------------------------------------------------
+
+void TestSfzLoad::load()
+      {
+      Zerberus z;
+      ZInstrument instr(&z);
+      QVERIFY(instr.load(sfz));
+      QCOMPARE(int(instr.zones().size()), REGIONS);
+      QCOMPARE(z.loadProgress(), 100);
+      }
+
+//---------------------------------------------------------
+//   cancel
+//---------------------------------------------------------
+
+void TestSfzLoad::cancel()
+      {
+      Zerberus z;
+      z.setLoadWasCanceled(true);
+      ZInstrument instr(&z);
+      QVERIFY(!instr.load(sfz));
+      QVERIFY(instr.zones().empty());
+      }
+
+//---------------------------------------------------------
+//   benchmark
+//---------------------------------------------------------
+
+void TestSfzLoad::benchmark()
+      {
+      QBENCHMARK {
+            Zerberus z;
+            ZInstrument instr(&z);
+            instr.load(sfz);
+            }
+      }
+
+QTEST_MAIN(TestSfzLoad)
+#include "tst_sfzload.moc"
@@ -0,0 +1,334 @@
+//=============================================================================
+//  MuseScore
+//  Music Composition & Notation
+//
+//  Copyright (C) 2015 Werner Schweer
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License version 2
+//  as published by the Free Software Foundation and appearing in
+//  the file LICENCE.GPL
+//=============================================================================
+
+#include <QtTest/QtTest>
+#include "mtest/testutils.h"
+#include "zerberus/zerberus.h"
+#include "zerberus/voice.h"
+#include "zerberus/channel.h"
+#include "zerberus/zone.h"
+#include "zerberus/sample.h"
+
+using namespace Ms;
+
+static const int FRAMES     = 441000;     // 10 sec at 44.1 kHz
+static const int VOICES     = 64;
+static const int BUFFER     = 256;        // frames rendered by one process() call
+static const int STOP_BLOCK = 700;        // the voices are released here
+static const int BLOCKS     = 1500;
+
+// largest difference between the block kernels and the per-frame
+// reference, relative to the peak output: float rounding from the
+// changed order of gain and filter
+static const double TOLERANCE = 1e-6;
+
+//---------------------------------------------------------
+//   TestVoice
+//    the block kernels of Voice::process() against the
+//    per-frame rendering they replaced
+//---------------------------------------------------------
+
+class TestVoice : public QObject, public MTest
+      {
+      Q_OBJECT
+
+      Zerberus* zerberus;
+      Channel* channel;
+
+      Zone* zone(int channels);
+      void processReference(Voice* v, int frames, float* p);
+      double compare(int channels);
+      void benchmark(int channels, bool reference);
+
+   private slots:
+      void initTestCase();
+      void cleanupTestCase();
+      void mono();
+      void stereo();
+      void benchmarkMono();
+      void benchmarkMonoReference();
+      void benchmarkStereo();
+      void benchmarkStereoReference();
+      };
+
+//---------------------------------------------------------
+//   initTestCase
+//---------------------------------------------------------
+
+void TestVoice::initTestCase()
+      {
+      initMTest();
+      zerberus = new Zerberus;
+      zerberus->init(44100);
+      channel = new Channel(zerberus, 0);
+      }
+
+//---------------------------------------------------------
+//   cleanupTestCase
+//---------------------------------------------------------
+
+void TestVoice::cleanupTestCase()
+      {
+      delete channel;
+      delete zerberus;
+      }
+
+//---------------------------------------------------------
+//   zone
+//    a zone with a synthetic 16 bit sample; the frames
+//    before and after the sample are read by the
+//    interpolation
+//---------------------------------------------------------
+
+Zone* TestVoice::zone(int ch)
+      {
+      short* data = new short[(FRAMES + 8) * ch]();
+      for (int i = 0; i < FRAMES * ch; ++i)
+            data[i + ch] = short(12000 * sin(i * 0.013) + 3000 * sin(i * 0.31));
+      Zone* z   = new Zone;
+      z->sample = new Sample(ch, data, FRAMES, 44100);
+      return z;
+      }
+
+//---------------------------------------------------------
+//   processReference
+//    Voice::process() as it rendered one frame at a time
+//    before the block kernels; resident samples only
+//---------------------------------------------------------
+
+void TestVoice::processReference(Voice* v, int frames, float* p)
+      {
+      float _fres = zerberus->ct2hz(v->fres);
+      int sr      = zerberus->sampleRate();
+      if (_fres > 0.45f * sr)
+            _fres = 0.45f * sr;
+      else if (_fres < 5.f)
+            _fres = 5.f;
+      if ((fabs(_fres - v->last_fres) > 0.01f)) {
+            v->updateFilter(_fres);
+            v->last_fres = _fres;
+            }
+
+      const short* data = v->data;
+      if (v->audioChan == 1) {
+            while (frames--) {
+                  int idx = v->phase.index();
+                  if (idx >= v->eidx) {
+                        v->off();
+                        break;
+                        }
+                  const float* coeffs = Voice::interpCoeff[v->phase.fract()];
+                  float f;
+                  f =  (coeffs[0] * data[idx-1]
+                      + coeffs[1] * data[idx+0]
+                      + coeffs[2] * data[idx+1]
+                      + coeffs[3] * data[idx+2]) * v->gain
+                      - v->a1 * v->hist1l
+                      - v->a2 * v->hist2l;
+                  float val = v->b02 * (f + v->hist2l) + v->b1 * v->hist1l;
+                  v->hist2l = v->hist1l;
+                  v->hist1l = f;
+
+                  if (v->filter_coeff_incr_count) {
+                        --v->filter_coeff_incr_count;
+                        v->a1  += v->a1_incr;
+                        v->a2  += v->a2_incr;
+                        v->b02 += v->b02_incr;
+                        v->b1  += v->b1_incr;
+                        }
+
+                  if (v->_state == VoiceState::STOP) {
+                        if (v->stopEnv.step()) {
+                              v->off();
+                              break;
+                              }
+                        val *= v->stopEnv.val;
+                        }
+                  *p++  += val * v->_channel->panLeftGain();
+                  *p++  += val * v->_channel->panRightGain();
+                  v->phase += v->phaseIncr;
+                  }
+            }
+      else {
+            while (frames--) {
+                  int idx = v->phase.index() * 2;
+                  if (idx >= v->eidx) {
+                        v->off();
+                        break;
+                        }
+                  const float* coeffs = Voice::interpCoeff[v->phase.fract()];
+                  float f1, f2;
+
+                  f1 = (coeffs[0] * data[idx-2]
+                      + coeffs[1] * data[idx]
+                      + coeffs[2] * data[idx+2]
+                      + coeffs[3] * data[idx+4])
+                      * v->gain * v->_channel->panLeftGain();
+
+                  f2 = (coeffs[0] * data[idx-1]
+                      + coeffs[1] * data[idx+1]
+                      + coeffs[2] * data[idx+3]
+                      + coeffs[3] * data[idx+5])
+                      * v->gain * v->_channel->panRightGain();
+
+                  if (v->_state == VoiceState::ATTACK) {
+                        if (v->attackEnv.step())
+                              v->_state = VoiceState::PLAYING;
+                        else {
+                              f1 *= v->attackEnv.val;
+                              f2 *= v->attackEnv.val;
+                              }
+                        }
+                  else if (v->_state == VoiceState::STOP) {
+                        if (v->stopEnv.step()) {
+                              v->off();
+                              break;
+                              }
+                        f1 *= v->stopEnv.val;
+                        f2 *= v->stopEnv.val;
+                        }
+
+                  f1      += -v->a1 * v->hist1l - v->a2 * v->hist2l;
+                  float vl = v->b02 * (f1 + v->hist2l) + v->b1 * v->hist1l;
+                  v->hist2l = v->hist1l;
+                  v->hist1l = f1;
+
+                  f2      +=  -v->a1 * v->hist1r - v->a2 * v->hist2r;
+                  float vr = v->b02 * (f2 + v->hist2r) + v->b1 * v->hist1r;
+                  v->hist2r = v->hist1r;
+                  v->hist1r = f2;
+
+                  if (v->filter_coeff_incr_count) {
+                        --v->filter_coeff_incr_count;
+                        v->a1  += v->a1_incr;
+                        v->a2  += v->a2_incr;
+                        v->b02 += v->b02_incr;
+                        v->b1  += v->b1_incr;
+                        }
+
+                  *p++  += vl;
+                  *p++  += vr;
+                  v->phase += v->phaseIncr;
+                  }
+            }
+      }
+
+//---------------------------------------------------------
+//   compare
+//    render the same voices through both paths, through
+//    attack, sustain and release; returns the largest
+//    difference relative to the peak output
+//---------------------------------------------------------
+
+double TestVoice::compare(int ch)
+      {
+      Zone* z = zone(ch);
+      std::vector<Voice*> voices;
+      std::vector<Voice*> refs;
+      for (int i = 0; i < VOICES; ++i) {
+            Voice* v = new Voice(zerberus);
+            v->start(channel, 48 + i % 24, 100, z);
+            voices.push_back(v);
+            refs.push_back(new Voice(*v));
+            }
+      std::vector<float> out(BUFFER * 2);
+      std::vector<float> ref(BUFFER * 2);
+      double peak = 0.0;
+      double diff = 0.0;
+      bool ended  = true;     // both paths end the voices in the same block
+      for (int b = 0; b < BLOCKS; ++b) {
+            if (b == STOP_BLOCK) {
+                  for (int i = 0; i < VOICES; ++i) {
+                        voices[i]->stop(300 + i);
+                        refs[i]->stop(300 + i);
+                        }
+                  }
+            std::fill(out.begin(), out.end(), 0.0f);
+            std::fill(ref.begin(), ref.end(), 0.0f);
+            for (int i = 0; i < VOICES; ++i) {
+                  if (!voices[i]->isOff())
+                        voices[i]->process(BUFFER, out.data());
+                  if (!refs[i]->isOff())
+                        processReference(refs[i], BUFFER, ref.data());
+                  if (voices[i]->isOff() != refs[i]->isOff())
+                        ended = false;
+                  }
+            for (int i = 0; i < BUFFER * 2; ++i) {
+                  peak = qMax(peak, double(qAbs(ref[i])));
+                  diff = qMax(diff, double(qAbs(out[i] - ref[i])));
+                  }
+            }
+      qDeleteAll(voices);
+      qDeleteAll(refs);
+      delete z;
+      return (ended && peak > 0.0) ? diff / peak : 1.0;
+      }
+
+//---------------------------------------------------------
+//   mono, stereo
+//---------------------------------------------------------
+
+void TestVoice::mono()
+      {
+      double d = compare(1);
+      QVERIFY2(d <= TOLERANCE, qPrintable(QString("relative difference %1").arg(d)));
+      }
+
+void TestVoice::stereo()
+      {
+      double d = compare(2);
+      QVERIFY2(d <= TOLERANCE, qPrintable(QString("relative difference %1").arg(d)));
+      }
+
+//---------------------------------------------------------
+//   benchmark
+//    VOICES voices rendered in BUFFER frame blocks until
+//    their release ends; divide the frames rendered per
+//    second by 44100 for the voices one core can play
+//---------------------------------------------------------
+
+void TestVoice::benchmark(int ch, bool reference)
+      {
+      Zone* z = zone(ch);
+      std::vector<Voice*> voices;
+      for (int i = 0; i < VOICES; ++i)
+            voices.push_back(new Voice(zerberus));
+      std::vector<float> out(BUFFER * 2);
+      QBENCHMARK {
+            for (int i = 0; i < VOICES; ++i)
+                  voices[i]->start(channel, 48 + i % 24, 100, z);
+            for (int b = 0; b < BLOCKS; ++b) {
+                  if (b == STOP_BLOCK) {
+                        for (Voice* v : voices)
+                              v->stop(300);
+                        }
+                  for (Voice* v : voices) {
+                        if (v->isOff())
+                              continue;
+                        if (reference)
+                              processReference(v, BUFFER, out.data());
+                        else
+                              v->process(BUFFER, out.data());
+                        }
+                  }
+            }
+      qDeleteAll(voices);
+      delete z;
+      }
+
+void TestVoice::benchmarkMono()                 { benchmark(1, false); }
+void TestVoice::benchmarkMonoReference()        { benchmark(1, true);  }
+void TestVoice::benchmarkStereo()               { benchmark(2, false); }
+void TestVoice::benchmarkStereoReference()      { benchmark(2, true);  }
+
+QTEST_MAIN(TestVoice)
+#include "tst_voice.moc"
@@ -109,7 +109,7 @@ void MasterSynthesizer::play(const NPlayEvent& event, unsigned syntiIdx)
       if (syntiIdx >= _synthesizer.size())
             return;
       _synthesizer[syntiIdx]->setActive(true);
-      _synthesizer[syntiIdx]->play(event);
+      _synthesizer[syntiIdx]->sendEvent(event);
       }
 
 //---------------------------------------------------------
@@ -160,7 +160,7 @@ QList<MidiPatch*> MasterSynthesizer::getPatchInfo() const
 void MasterSynthesizer::allSoundsOff(int channel)
       {
       for (Synthesizer* s : _synthesizer)
-            s->allSoundsOff(channel);
+            s->sendAllSoundsOff(channel);
       }
 
 //---------------------------------------------------------
@@ -170,7 +170,7 @@ void MasterSynthesizer::allSoundsOff(int channel)
 void MasterSynthesizer::allNotesOff(int channel)
       {
       for (Synthesizer* s : _synthesizer)
-            s->allNotesOff(channel);
+            s->sendAllNotesOff(channel);
       }
 
 //---------------------------------------------------------
@@ -215,11 +215,23 @@ void MasterSynthesizer::setEffect(int ab, int idx)
             qDebug("MasterSynthesizer::setEffect: bad idx %d %d", ab, idx);
             return;
             }
-      lock2 = true;
-      while (lock1)
-            sleep(1);
       _effect[ab] = _effectList[ab][idx];
-      lock2 = false;
+      publishConfig();
+      }
+
+//---------------------------------------------------------
+//   publishConfig
+//    hand the current configuration to the audio thread;
+//    it is used from the next buffer on
+//    gui thread, not realtime
+//---------------------------------------------------------
+
+void MasterSynthesizer::publishConfig()
+      {
+      Config& c = _config[_writeConfig];
+      for (int i = 0; i < MAX_EFFECTS; ++i)
+            c.effect[i] = _effect[i];
+      _writeConfig = _pendingConfig.exchange(_writeConfig | CONFIG_DIRTY) & ~CONFIG_DIRTY;
       }
 
 //---------------------------------------------------------
@@ -231,6 +243,16 @@ Effect* MasterSynthesizer::effect(int idx)
       return _effect[idx];
       }
 
+//---------------------------------------------------------
+//   setRealtime
+//---------------------------------------------------------
+
+void MasterSynthesizer::setRealtime(bool val)
+      {
+      for (Synthesizer* s : _synthesizer)
+            s->setRealtime(val);
+      }
+
 //---------------------------------------------------------
 //   setSampleRate
 //---------------------------------------------------------
@@ -246,8 +268,8 @@ void MasterSynthesizer::setSampleRate(float val)
             e->init(_sampleRate);
       for (Effect* e : _effectList[1])
             e->init(_sampleRate);
-      lock2 = false;
-      lock1 = false;
+      publishConfig();
+      _ready = true;
       }
 
 //---------------------------------------------------------
@@ -256,37 +278,117 @@ void MasterSynthesizer::setSampleRate(float val)
 
 void MasterSynthesizer::process(unsigned n, float* p)
       {
-      if (lock2)
-            return;
-      lock1 = true;
-      if (lock2) {
-            lock1 = false;
+      if (!_ready)
             return;
+      if (_pendingConfig & CONFIG_DIRTY)
+            _readConfig = _pendingConfig.exchange(_readConfig) & ~CONFIG_DIRTY;
+      const Config& c = _config[_readConfig];
+
+      // the effect buffers hold MAX_BUFFERSIZE / 2 stereo frames
+      while (n) {
+            unsigned frames = qMin(n, unsigned(MAX_BUFFERSIZE / 2));
+            processChunk(c, frames, p);
+            p += frames * 2;
+            n -= frames;
             }
-      // avoid overflow
-      if (n > MAX_BUFFERSIZE / 2)
-            return;
+      }
+
+//---------------------------------------------------------
+//   processChunk
+//    realtime
+//---------------------------------------------------------
+
+void MasterSynthesizer::processChunk(const Config& c, unsigned n, float* p)
+      {
       for (Synthesizer* s : _synthesizer) {
             if (s->active())
                   s->process(n, p, effect1Buffer, effect2Buffer);
             }
 
-      if (_effect[0] && _effect[1]) {
+      Effect* e0 = c.effect[0];
+      Effect* e1 = c.effect[1];
+      if (e0 && e1) {
             memset(effect1Buffer, 0, n * sizeof(float) * 2);
-            _effect[0]->process(n, p, effect1Buffer);
-            _effect[1]->process(n, effect1Buffer, p);
+            e0->process(n, p, effect1Buffer);
+            e1->process(n, effect1Buffer, p);
             }
-      else if (_effect[0] || _effect[1]) {
+      else if (e0 || e1) {
             memcpy(effect1Buffer, p, n * sizeof(float) * 2);
-            if (_effect[0])
-                  _effect[0]->process(n, effect1Buffer, p);
+            if (e0)
+                  e0->process(n, effect1Buffer, p);
             else
-                  _effect[1]->process(n, effect1Buffer, p);
+                  e1->process(n, effect1Buffer, p);
             }
       float g = _gain * _boost;
       for (unsigned i = 0; i < n * 2; ++i)
             *p++ *= g;
-      lock1 = false;
+      }
+
+//---------------------------------------------------------
+//   voiceCount
+//    realtime
+//---------------------------------------------------------
+
+int MasterSynthesizer::voiceCount() const
+      {
+      int n = 0;
+      for (Synthesizer* s : _synthesizer) {
+            if (s->active())
+                  n += s->voiceCount();
+            }
+      return n;
+      }
+
+//---------------------------------------------------------
+//   droppedMessages
+//    sequencer messages lost because a synthesizer was
+//    loading sound fonts while its queue was full
+//---------------------------------------------------------
+
+unsigned MasterSynthesizer::droppedMessages() const
+      {
+      unsigned n = 0;
+      for (Synthesizer* s : _synthesizer)
+            n += s->droppedMessages();
+      return n;
+      }
+
+//---------------------------------------------------------
+//   renderMisses
+//    blocks whose parallel voice rendering missed its
+//    deadline
+//---------------------------------------------------------
+
+unsigned MasterSynthesizer::renderMisses() const
+      {
+      unsigned n = 0;
+      for (Synthesizer* s : _synthesizer)
+            n += s->renderMisses();
+      return n;
+      }
+
+//---------------------------------------------------------
+//   streamUnderruns
+//---------------------------------------------------------
+
+unsigned MasterSynthesizer::streamUnderruns() const
+      {
+      unsigned n = 0;
+      for (Synthesizer* s : _synthesizer)
+            n += s->streamUnderruns();
+      return n;
+      }
+
+//---------------------------------------------------------
+//   starvedVoices
+//---------------------------------------------------------
+
+unsigned MasterSynthesizer::starvedVoices() const
+      {
+      unsigned n = 0;
+      for (Synthesizer* s : _synthesizer)
+            n += s->starvedVoices();
+      return n;
       }
 
 //---------------------------------------------------------
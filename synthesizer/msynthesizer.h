@@ -42,17 +42,38 @@ class MasterSynthesizer : public QObject {
       static const int MAX_EFFECTS = 2;
 
    private:
-      std::atomic<bool> lock1      { false };
-      std::atomic<bool> lock2      { true  };
+      //---------------------------------------------------------
+      //   Config
+      //    the part of the configuration the audio thread
+      //    reads in process(). It is triple buffered: the gui
+      //    thread fills its own slot and exchanges it with the
+      //    pending one, the audio thread picks up the pending
+      //    slot at the start of a buffer. Neither side ever
+      //    waits for the other.
+      //---------------------------------------------------------
+
+      struct Config {
+            Effect* effect[MAX_EFFECTS] { nullptr, nullptr };
+            };
+      static const int CONFIG_DIRTY = 4;  // flag in _pendingConfig: slot not yet seen by the audio thread
+
+      Config _config[3];
+      int _writeConfig { 0 };             // gui thread only
+      int _readConfig  { 1 };             // audio thread only
+      std::atomic<int> _pendingConfig { 2 };
+      std::atomic<bool> _ready { false }; // synthesizers and effects are initialized
+
       std::vector<Synthesizer*> _synthesizer;
       std::vector<Effect*> _effectList[MAX_EFFECTS];
-      Effect* _effect[MAX_EFFECTS]  { nullptr, nullptr };
+      Effect* _effect[MAX_EFFECTS]  { nullptr, nullptr };     // as seen by the gui thread
 
       float _sampleRate;
 
       float effect1Buffer[MAX_BUFFERSIZE];
       float effect2Buffer[MAX_BUFFERSIZE];
       int indexOfEffect(int ab, const QString& name);
+      void publishConfig();
+      void processChunk(const Config&, unsigned, float*);
 
    public slots:
       void sfChanged() { emit soundFontChanged(); }
@@ -71,8 +92,14 @@ class MasterSynthesizer : public QObject {
 
       float sampleRate()            { return _sampleRate; }
       void setSampleRate(float val);
+      void setRealtime(bool val);
 
       void process(unsigned, float*);
+      int voiceCount() const;
+      unsigned droppedMessages() const;
+      unsigned renderMisses() const;
+      unsigned streamUnderruns() const;
+      unsigned starvedVoices() const;
       void play(const NPlayEvent&, unsigned);
 
       void setMasterTuning(double val);
@@ -0,0 +1,78 @@
+//=============================================================================
+//  MuseScore
+//  Music Composition & Notation
+//
+//  Copyright (C) 2015 Werner Schweer
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License version 2
+//  as published by the Free Software Foundation and appearing in
+//  the file LICENCE.GPL
+//=============================================================================
+
+#include "previewqueue.h"
+#include "msynthesizer.h"
+
+namespace Ms {
+
+//---------------------------------------------------------
+//   enqueue
+//    gui thread
+//---------------------------------------------------------
+
+bool PreviewQueue::enqueue(const PreviewMsg& msg)
+      {
+      if (isFull())
+            return false;
+      messages[widx] = msg;
+      push();
+      return true;
+      }
+
+//---------------------------------------------------------
+//   play
+//    realtime
+//---------------------------------------------------------
+
+void PreviewQueue::play(MasterSynthesizer* synti, const PreviewMsg& msg, unsigned /*framePos*/)
+      {
+      if (msg.synti < 0)
+            synti->allNotesOff(msg.channel);
+      else
+            synti->play(msg.event, msg.synti);
+      }
+
+//---------------------------------------------------------
+//   drain
+//    play all queued messages at framePos of the current
+//    buffer; realtime
+//---------------------------------------------------------
+
+void PreviewQueue::drain(MasterSynthesizer* synti, unsigned framePos)
+      {
+      while (!isEmpty()) {
+            PreviewMsg msg = messages[ridx];
+            pop();
+            play(synti, msg, framePos);
+            }
+      }
+
+//---------------------------------------------------------
+//   render
+//    render n frames into p and poll the queue every
+//    BLOCK frames; realtime
+//---------------------------------------------------------
+
+void PreviewQueue::render(MasterSynthesizer* synti, unsigned n, float* p)
+      {
+      unsigned framePos = 0;
+      while (framePos < n) {
+            drain(synti, framePos);
+            unsigned frames = qMin(n - framePos, BLOCK);
+            synti->process(frames, p);
+            p        += frames * 2;
+            framePos += frames;
+            }
+      }
+
+}
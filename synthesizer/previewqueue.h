@@ -0,0 +1,70 @@
+//=============================================================================
+//  MuseScore
+//  Music Composition & Notation
+//
+//  Copyright (C) 2015 Werner Schweer
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License version 2
+//  as published by the Free Software Foundation and appearing in
+//  the file LICENCE.GPL
+//=============================================================================
+
+#ifndef __PREVIEWQUEUE_H__
+#define __PREVIEWQUEUE_H__
+
+#include "libmscore/fifo.h"
+#include "synthesizer/event.h"
+
+namespace Ms {
+
+class MasterSynthesizer;
+
+//---------------------------------------------------------
+//   PreviewMsg
+//---------------------------------------------------------
+
+struct PreviewMsg {
+      int synti;              // index in the MasterSynthesizer, -1: all notes off
+      int channel;            // all notes off: channel, -1 for all channels
+      NPlayEvent event;
+
+      PreviewMsg() {}
+      PreviewMsg(int s, const NPlayEvent& e) : synti(s), channel(e.channel()), event(e) {}
+      PreviewMsg(int ch) : synti(-1), channel(ch) {}
+      };
+
+//---------------------------------------------------------
+//   PreviewQueue
+//    notes played while editing (note entry, palette)
+//    bypass the sequencer message fifo. render() splits
+//    the buffer into blocks of BLOCK frames and polls the
+//    queue before every block: a note queued while the
+//    audio thread renders a buffer is played in the same
+//    buffer instead of waiting for the next one.
+//    wait-free; the gui thread is the only writer and the
+//    audio thread the only reader
+//---------------------------------------------------------
+
+static const int PREVIEW_QUEUE_SIZE = 256;
+
+class PreviewQueue : public FifoBase {
+      PreviewMsg messages[PREVIEW_QUEUE_SIZE];
+
+   protected:
+      virtual void play(MasterSynthesizer*, const PreviewMsg&, unsigned framePos);
+
+   public:
+      static const unsigned BLOCK = 64;     // frames rendered between two polls
+
+      PreviewQueue()            { maxCount = PREVIEW_QUEUE_SIZE; clear(); }
+      virtual ~PreviewQueue()   {}
+
+      // returns false and drops the message if the queue is full
+      bool enqueue(const PreviewMsg&);
+      void drain(MasterSynthesizer*, unsigned framePos);
+      void render(MasterSynthesizer*, unsigned n, float* p);
+      };
+
+}
+#endif
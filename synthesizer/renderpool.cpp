@@ -0,0 +1,262 @@
+//=============================================================================
+//  MuseScore
+//  Music Composition & Notation
+//
+//  Copyright (C) 2015 Werner Schweer
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License version 2
+//  as published by the Free Software Foundation and appearing in
+//  the file LICENCE.GPL
+//=============================================================================
+
+#include <chrono>
+#include <cstring>
+#if defined(Q_OS_WIN)
+#include <windows.h>
+#else
+#include <pthread.h>
+#if defined(Q_OS_MAC)
+#include <dispatch/dispatch.h>
+#else
+#include <semaphore.h>
+#endif
+#endif
+#include "renderpool.h"
+
+namespace Ms {
+
+//---------------------------------------------------------
+//   Semaphore
+//---------------------------------------------------------
+
+Semaphore::Semaphore()
+      {
+#if defined(Q_OS_WIN)
+      _handle = CreateSemaphore(NULL, 0, LONG_MAX, NULL);
+#elif defined(Q_OS_MAC)
+      _handle = dispatch_semaphore_create(0);
+#else
+      sem_t* s = new sem_t;
+      sem_init(s, 0, 0);
+      _handle = s;
+#endif
+      }
+
+Semaphore::~Semaphore()
+      {
+#if defined(Q_OS_WIN)
+      CloseHandle(_handle);
+#elif defined(Q_OS_MAC)
+      dispatch_release(static_cast<dispatch_semaphore_t>(_handle));
+#else
+      sem_t* s = static_cast<sem_t*>(_handle);
+      sem_destroy(s);
+      delete s;
+#endif
+      }
+
+//---------------------------------------------------------
+//   post
+//    realtime
+//---------------------------------------------------------
+
+void Semaphore::post(int n)
+      {
+#if defined(Q_OS_WIN)
+      ReleaseSemaphore(_handle, n, NULL);
+#elif defined(Q_OS_MAC)
+      for (int i = 0; i < n; ++i)
+            dispatch_semaphore_signal(static_cast<dispatch_semaphore_t>(_handle));
+#else
+      for (int i = 0; i < n; ++i)
+            sem_post(static_cast<sem_t*>(_handle));
+#endif
+      }
+
+//---------------------------------------------------------
+//   wait
+//---------------------------------------------------------
+
+void Semaphore::wait()
+      {
+#if defined(Q_OS_WIN)
+      WaitForSingleObject(_handle, INFINITE);
+#elif defined(Q_OS_MAC)
+      dispatch_semaphore_wait(static_cast<dispatch_semaphore_t>(_handle), DISPATCH_TIME_FOREVER);
+#else
+      while (sem_wait(static_cast<sem_t*>(_handle)) != 0)
+            ;     // interrupted by a signal
+#endif
+      }
+
+//---------------------------------------------------------
+//   ~RenderPool
+//---------------------------------------------------------
+
+RenderPool::~RenderPool()
+      {
+      stop();
+      }
+
+//---------------------------------------------------------
+//   start
+//    threads is the total number of render threads
+//    including the audio thread; values < 2 disable
+//    parallel rendering
+//    not realtime
+//---------------------------------------------------------
+
+void RenderPool::start(int threads)
+      {
+      stop();
+      _quit          = false;
+      _next          = NO_BLOCK;      // a worker woken by an old post claims nothing
+      _fallback      = 0;
+      _priorityValid = false;
+      for (int i = 1; i < threads; ++i)
+            _workers.push_back(std::thread(&RenderPool::workerLoop, this, i));
+      }
+
+//---------------------------------------------------------
+//   stop
+//    not realtime
+//---------------------------------------------------------
+
+void RenderPool::stop()
+      {
+      if (_workers.empty())
+            return;
+      _quit = true;
+      _wake.post(int(_workers.size()));
+      for (std::thread& t : _workers)
+            t.join();
+      _workers.clear();
+      }
+
+//---------------------------------------------------------
+//   capturePriority
+//    remember the scheduling of the calling audio thread
+//    realtime
+//---------------------------------------------------------
+
+void RenderPool::capturePriority()
+      {
+#if defined(Q_OS_WIN)
+      _policy   = 0;
+      _priority = GetThreadPriority(GetCurrentThread());
+#else
+      sched_param param;
+      if (pthread_getschedparam(pthread_self(), &_policy, &param) != 0) {
+            _policy = SCHED_OTHER;
+            param.sched_priority = 0;
+            }
+      _priority = param.sched_priority;
+#endif
+      _priorityValid = true;
+      }
+
+//---------------------------------------------------------
+//   applyPriority
+//    give the calling worker the scheduling of the audio
+//    thread; a worker running at normal priority would be
+//    preempted by everything else on the machine
+//---------------------------------------------------------
+
+void RenderPool::applyPriority()
+      {
+#if defined(Q_OS_WIN)
+      if (!SetThreadPriority(GetCurrentThread(), _priority))
+            qDebug("RenderPool: cannot set worker thread priority");
+#else
+      sched_param param;
+      param.sched_priority = _priority;
+      int rv = pthread_setschedparam(pthread_self(), _policy, &param);
+      if (rv)
+            qDebug("RenderPool: cannot set worker scheduling: %s", strerror(rv));
+#endif
+      }
+
+//---------------------------------------------------------
+//   workerLoop
+//---------------------------------------------------------
+
+void RenderPool::workerLoop(int worker)
+      {
+      bool prioritySet = false;
+      for (;;) {
+            _wake.wait();
+            if (_quit)
+                  return;
+            if (!prioritySet && _priorityValid) {
+                  applyPriority();
+                  prioritySet = true;
+                  }
+            // _busy is raised before claiming so that run() waits
+            // for every partition handed out here; a worker
+            // waking up late finds no partition left or claims
+            // one of the next block, both are fine. So does a
+            // worker woken by the post of an earlier block.
+            int n = partitions();
+            ++_busy;
+            for (int partition = _next++; partition < n; partition = _next++)
+                  _job(_data, worker, partition);
+            --_busy;
+            }
+      }
+
+//---------------------------------------------------------
+//   parallel
+//    return true if the next block should be rendered
+//    with run(); call once per block
+//    realtime
+//---------------------------------------------------------
+
+bool RenderPool::parallel()
+      {
+      if (_workers.empty())
+            return false;
+      if (_fallback) {
+            --_fallback;
+            return false;
+            }
+      return true;
+      }
+
+//---------------------------------------------------------
+//   run
+//    execute job for all partitions of the block; the
+//    calling thread renders every partition no worker has
+//    claimed and then waits for the claimed ones.
+//    Returns false if the block missed its slot, in this
+//    case the following blocks are rendered single
+//    threaded.
+//    realtime
+//---------------------------------------------------------
+
+bool RenderPool::run(Job job, void* data, unsigned frames, float sampleRate)
+      {
+      auto startTime = std::chrono::steady_clock::now();
+      if (!_priorityValid)
+            capturePriority();
+      _job        = job;
+      _data       = data;
+      _next       = 0;
+      _wake.post(int(_workers.size()));
+
+      int n = partitions();
+      for (int partition = _next++; partition < n; partition = _next++)
+            job(data, 0, partition);
+      while (_busy)
+            std::this_thread::yield();
+
+      std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - startTime;
+      if (elapsed.count() > SLOT * frames / sampleRate) {
+            ++_misses;
+            _fallback = FALLBACK_BLOCKS;
+            return false;
+            }
+      return true;
+      }
+
+}
@@ -0,0 +1,102 @@
+//=============================================================================
+//  MuseScore
+//  Music Composition & Notation
+//
+//  Copyright (C) 2015 Werner Schweer
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License version 2
+//  as published by the Free Software Foundation and appearing in
+//  the file LICENCE.GPL
+//=============================================================================
+
+#ifndef __RENDERPOOL_H__
+#define __RENDERPOOL_H__
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace Ms {
+
+//---------------------------------------------------------
+//   Semaphore
+//    counting semaphore of the operating system; post()
+//    never blocks
+//---------------------------------------------------------
+
+class Semaphore {
+      void* _handle;
+
+   public:
+      Semaphore();
+      ~Semaphore();
+      void post(int n = 1);
+      void wait();
+      };
+
+//---------------------------------------------------------
+//   RenderPool
+//    a small pool of worker threads used by a synthesizer
+//    to render its voices in parallel.
+//
+//    A block is split into partitions() partitions. run()
+//    is called from the audio thread (worker 0) and wakes
+//    the workers by posting a semaphore, it takes no lock;
+//    every thread claims partitions until none are left. The audio thread never waits for a worker
+//    which has not started yet: it renders all unclaimed
+//    partitions itself and then only waits for partitions
+//    already being rendered. If a block takes longer than
+//    its slot the pool falls back to single threaded
+//    rendering for a while.
+//
+//    The workers take over the scheduling policy and
+//    priority of the audio thread on the first block.
+//---------------------------------------------------------
+
+class RenderPool {
+   public:
+      typedef void (*Job)(void* data, int worker, int partition);
+
+   private:
+      static const int FALLBACK_BLOCKS = 2000;  // blocks to stay single threaded after a miss
+      static const int PARTITIONS      = 2;     // partitions per thread
+      static constexpr double SLOT     = 0.75;  // part of the buffer period available for rendering
+      static const int NO_BLOCK        = 1 << 30;  // _next before the first block
+
+      std::vector<std::thread> _workers;
+      Semaphore _wake;                          // posted once per worker and block
+      std::atomic<bool> _quit { false };
+
+      Job _job             { nullptr };
+      void* _data          { nullptr };
+      std::atomic<int> _next { NO_BLOCK };      // next unclaimed partition of the current block
+      std::atomic<int> _busy { 0 };             // workers currently claiming or rendering partitions
+
+      std::atomic<bool> _priorityValid { false };
+      int _policy          { 0 };               // scheduling of the audio thread, valid
+      int _priority        { 0 };               // if _priorityValid is set
+
+      int _fallback        { 0 };               // blocks left in single threaded mode
+      std::atomic<int> _misses { 0 };
+
+      void workerLoop(int worker);
+      void capturePriority();
+      void applyPriority();
+
+   public:
+      RenderPool() {}
+      ~RenderPool();
+
+      void start(int threads);
+      void stop();
+
+      int threads() const       { return int(_workers.size()) + 1; }
+      int partitions() const    { return threads() * PARTITIONS; }
+      int misses() const        { return _misses; }
+      bool parallel();
+      bool run(Job job, void* data, unsigned frames, float sampleRate);
+      };
+
+}
+#endif
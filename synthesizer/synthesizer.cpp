@@ -0,0 +1,100 @@
+//=============================================================================
+//  MuseScore
+//  Music Composition & Notation
+//
+//  Copyright (C) 2015 Werner Schweer
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License version 2
+//  as published by the Free Software Foundation and appearing in
+//  the file LICENCE.GPL
+//=============================================================================
+
+#include "synthesizer.h"
+
+namespace Ms {
+
+// if no block is processed for this time, there is no
+// audio thread which could adopt a staged configuration;
+// a synthesizer which never processed a block does not wait
+static const int HANDOVER_TIMEOUT = 250;    // ms
+
+//---------------------------------------------------------
+//   beginProcess
+//    called by the audio thread at the start of process();
+//    adopts a staged configuration. Returns false if the
+//    gui thread adopts it right now because no audio thread
+//    was running; the block is skipped.
+//    realtime
+//---------------------------------------------------------
+
+bool Synthesizer::beginProcess()
+      {
+      _processing = true;
+      ++_blocks;
+      int state = _handOver;
+      if (state == HANDOVER_STAGED && _handOver.compare_exchange_strong(state, HANDOVER_ADOPTING)) {
+            adopt();
+            _handOver = HANDOVER_ADOPTED;
+            }
+      else if (state == HANDOVER_GUI) {
+            _processing = false;
+            return false;
+            }
+      return true;
+      }
+
+//---------------------------------------------------------
+//   handOver
+//    the configuration staged by the derived synthesizer
+//    is adopted by the audio thread at the start of its
+//    next block; returns after that, so everything the
+//    previous configuration used can be freed.
+//    Without a running audio thread (no driver, audio
+//    export, tests) the configuration is adopted here.
+//    not realtime, never called from the audio thread
+//---------------------------------------------------------
+
+void Synthesizer::handOver()
+      {
+      _handOver = HANDOVER_STAGED;
+      unsigned blocks = _blocks;
+      QElapsedTimer idle;
+      idle.start();
+      for (;;) {
+            int state = _handOver;
+            if (state == HANDOVER_ADOPTED)
+                  break;
+            if (state == HANDOVER_STAGED) {
+                  if (_blocks != blocks) {
+                        blocks = _blocks;
+                        idle.restart();
+                        }
+                  else if ((blocks == 0 || idle.elapsed() > HANDOVER_TIMEOUT)
+                     && _handOver.compare_exchange_strong(state, HANDOVER_GUI)) {
+                        while (_processing)
+                              QThread::yieldCurrentThread();
+                        adopt();
+                        break;
+                        }
+                  }
+            QThread::msleep(1);
+            }
+      _handOver = HANDOVER_NONE;
+      }
+
+//---------------------------------------------------------
+//   flushMessages
+//    realtime
+//---------------------------------------------------------
+
+bool Synthesizer::flushMessages()
+      {
+      if (!beginProcess())
+            return false;
+      processMessages();
+      endProcess();
+      return true;
+      }
+
+}
@@ -13,28 +13,103 @@
 #ifndef __SYNTHESIZER_H__
 #define __SYNTHESIZER_H__
 
+#include <atomic>
 #include "libmscore/synthesizerstate.h"
+#include "libmscore/fifo.h"
+#include "synthesizer/event.h"
 
 namespace Ms {
 
 struct MidiPatch;
-class PlayEvent;
 class Synth;
 class SynthesizerGui;
 
+//---------------------------------------------------------
+//   SynthMsg
+//    message format for sequencer -> synthesizer messages
+//---------------------------------------------------------
+
+enum class SynthMsgId : char {
+      PLAY,
+      ALL_NOTES_OFF,
+      ALL_SOUNDS_OFF
+      };
+
+struct SynthMsg {
+      SynthMsgId id;
+      int channel;
+      PlayEvent event;
+
+      SynthMsg() {}
+      SynthMsg(SynthMsgId _id, int ch) : id(_id), channel(ch) {}
+      SynthMsg(const PlayEvent& e) : id(SynthMsgId::PLAY), channel(e.channel()), event(e) {}
+      };
+
+//---------------------------------------------------------
+//   SynthMsgFifo
+//    wait-free; the sequencer is the only writer and
+//    the audio thread (Synthesizer::process()) the only
+//    reader. Both are the same thread while playing or
+//    exporting, see Synthesizer::send().
+//---------------------------------------------------------
+
+static const int SYNTH_MSG_FIFO_SIZE = 1024*4;
+
+class SynthMsgFifo : public FifoBase {
+      SynthMsg messages[SYNTH_MSG_FIFO_SIZE];
+
+   public:
+      SynthMsgFifo()            { maxCount = SYNTH_MSG_FIFO_SIZE; clear(); }
+      virtual ~SynthMsgFifo()   {}
+
+      // the fifo must not be full
+      void enqueue(const SynthMsg& msg) {
+            messages[widx] = msg;
+            push();
+            }
+      SynthMsg dequeue() {
+            SynthMsg msg = messages[ridx];
+            pop();
+            return msg;
+            }
+      };
+
 //---------------------------------------------------------
 //   Synthesizer
 //---------------------------------------------------------
 
 class Synthesizer {
       bool _active;
+      bool _realtime;
+      SynthMsgFifo toSynth;                     // drained by processMessages()
+      std::atomic<bool> _overflow { false };    // messages were lost
+      std::atomic<unsigned> _dropped { 0 };
+
+      enum { HANDOVER_NONE, HANDOVER_STAGED, HANDOVER_ADOPTING, HANDOVER_ADOPTED, HANDOVER_GUI };
+      std::atomic<int> _handOver { HANDOVER_NONE };
+      std::atomic<bool> _processing { false };  // audio thread is inside beginProcess()/endProcess()
+      std::atomic<unsigned> _blocks { 0 };      // counts beginProcess(), tells if an audio thread runs
+
+      void send(const SynthMsg&);
 
    protected:
       float _sampleRate;
       SynthesizerGui* _gui;
 
+      void processMessages();
+      // realtime; run the queued messages outside of process(),
+      // false if the synthesizer cannot do it right now
+      virtual bool flushMessages();
+
+      // configuration changes (soundfonts) are prepared off the
+      // audio thread and handed over as a whole, see handOver()
+      bool beginProcess();
+      void endProcess()              { _processing = false; }
+      void handOver();
+      virtual void adopt()           {}
+
    public:
-      Synthesizer() : _active(false) { _gui = 0; }
+      Synthesizer() : _active(false), _realtime(true) { _gui = 0; }
       virtual ~Synthesizer() {}
       virtual void init(float sr)    { _sampleRate = sr; }
       float sampleRate() const       { return _sampleRate; }
@@ -50,8 +125,21 @@ class Synthesizer {
 
       virtual QStringList soundFonts() const = 0;
 
+      // process(), play(), allSoundsOff() and allNotesOff() run on
+      // the audio thread. The sequencer uses sendEvent(),
+      // sendAllSoundsOff() and sendAllNotesOff() instead; the message
+      // is executed at the start of the next process().
       virtual void process(unsigned, float*, float*, float*) = 0;
       virtual void play(const PlayEvent&) = 0;
+      virtual int voiceCount() const         { return 0; }  // sounding voices, audio thread
+
+      void sendEvent(const PlayEvent& e)     { send(SynthMsg(e)); }
+      void sendAllSoundsOff(int channel)     { send(SynthMsg(SynthMsgId::ALL_SOUNDS_OFF, channel)); }
+      void sendAllNotesOff(int channel)      { send(SynthMsg(SynthMsgId::ALL_NOTES_OFF, channel)); }
+      unsigned droppedMessages() const       { return _dropped; }
+      virtual unsigned renderMisses() const  { return 0; }   // see RenderPool::run()
+      virtual unsigned streamUnderruns() const { return 0; } // streamed samples not read in time
+      virtual unsigned starvedVoices() const { return 0; }   // voices started without a free stream
 
       virtual const QList<MidiPatch*>& getPatchInfo() const = 0;
 
@@ -65,12 +153,62 @@ class Synthesizer {
       bool active() const             { return _active; }
       void setActive(bool val = true) { _active = val;  }
 
+      // offline rendering (audio export) must not skip notes whose
+      // sample data is still prepared in the background
+      void setRealtime(bool val)      { _realtime = val; }
+      bool realtime() const           { return _realtime; }
+
       virtual void allSoundsOff(int /*channel*/) {}
       virtual void allNotesOff(int /*channel*/) {}
 
       virtual SynthesizerGui* gui()  { return _gui; }
       };
 
+//---------------------------------------------------------
+//   send
+//    The sender runs on the thread which calls process(),
+//    so a full fifo is emptied here. If the gui thread
+//    adopts a configuration right now, the message is
+//    lost; all notes are stopped once the synthesizer
+//    runs again, no note off is missed.
+//---------------------------------------------------------
+
+inline void Synthesizer::send(const SynthMsg& msg)
+      {
+      if (toSynth.isFull() && !flushMessages()) {
+            ++_dropped;
+            _overflow = true;
+            return;
+            }
+      toSynth.enqueue(msg);
+      }
+
+//---------------------------------------------------------
+//   processMessages
+//    execute the queued messages
+//    realtime
+//---------------------------------------------------------
+
+inline void Synthesizer::processMessages()
+      {
+      while (!toSynth.isEmpty()) {
+            SynthMsg msg = toSynth.dequeue();
+            switch (msg.id) {
+                  case SynthMsgId::PLAY:
+                        play(msg.event);
+                        break;
+                  case SynthMsgId::ALL_NOTES_OFF:
+                        allNotesOff(msg.channel);
+                        break;
+                  case SynthMsgId::ALL_SOUNDS_OFF:
+                        allSoundsOff(msg.channel);
+                        break;
+                  }
+            }
+      if (_overflow.exchange(false))
+            allNotesOff(-1);
+      }
+
 }
 #endif
 
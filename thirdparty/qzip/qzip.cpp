@@ -46,6 +46,7 @@
 #include "qzipwriter_p.h"
 
 #include <zlib.h>
+#include <QtConcurrent/QtConcurrentRun>
 
 #if defined(Q_OS_WIN) or defined(Q_OS_ANDROID)
 #  undef S_IFREG
@@ -226,33 +227,76 @@ static int inflate(Bytef *dest, ulong *destLen, const Bytef *source, ulong sourc
     return err;
 }
 
-static int deflate (Bytef *dest, ulong *destLen, const Bytef *source, ulong sourceLen)
+// deflate \a in in chunks, so that no output buffer for the worst case
+// has to be guessed
+static bool deflateData(const QByteArray &in, int level, QByteArray *out)
 {
+    const int chunk = 256 * 1024;
     z_stream stream;
-    int err;
-
-    stream.next_in = (Bytef*)source;
-    stream.avail_in = (uInt)sourceLen;
-    stream.next_out = dest;
-    stream.avail_out = (uInt)*destLen;
-    if ((uLong)stream.avail_out != *destLen) return Z_BUF_ERROR;
-
-    stream.zalloc = (alloc_func)0;
-    stream.zfree = (free_func)0;
-    stream.opaque = (voidpf)0;
+    memset(&stream, 0, sizeof(stream));
+    if (deflateInit2(&stream, level, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+        return false;
+
+    const char *src = in.constData();
+    int left = in.length();
+    int err = Z_OK;
+    out->resize(0);
+    do {
+        int n = qMin(left, chunk);
+        stream.next_in = (Bytef *)src;
+        stream.avail_in = n;
+        src += n;
+        left -= n;
+        int flush = left ? Z_NO_FLUSH : Z_FINISH;
+        do {
+            int pos = out->size();
+            out->resize(pos + chunk);
+            stream.next_out = (Bytef *)out->data() + pos;
+            stream.avail_out = chunk;
+            err = deflate(&stream, flush);
+            out->resize(pos + chunk - stream.avail_out);
+        } while (stream.avail_out == 0 && err == Z_OK);
+    } while (left && err == Z_OK);
+    deflateEnd(&stream);
+    return err == Z_STREAM_END;
+}
 
-    err = deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY);
-    if (err != Z_OK) return err;
+// an entry as it is written to the archive
+struct CompressedEntry
+{
+    ushort method;      // 0: stored, 8: deflated
+    uint crc_32;
+    QByteArray data;
+};
 
-    err = deflate(&stream, Z_FINISH);
-    if (err != Z_STREAM_END) {
-        deflateEnd(&stream);
-        return err == Z_OK ? Z_BUF_ERROR : err;
+// thread safe; an entry is stored if deflating does not make it smaller
+static CompressedEntry compressEntry(const QByteArray &contents, bool compress, int level)
+{
+    CompressedEntry e;
+    e.crc_32 = ::crc32(::crc32(0, 0, 0), (const uchar *)contents.constData(), contents.length());
+    e.method = 0;
+    e.data = contents;
+    if (compress) {
+        QByteArray data;
+        if (!deflateData(contents, level, &data))
+            qWarning("QZip: cannot compress file, storing it");
+        else if (data.length() < contents.length()) {
+            e.method = 8;
+            e.data = data;
+        }
     }
-    *destLen = stream.total_out;
+    return e;
+}
 
-    err = deflateEnd(&stream);
-    return err;
+// formats which are compressed already
+static bool isCompressedFormat(const QString &fileName)
+{
+    static const char *suffixes[] = { ".png", ".jpg", ".jpeg", ".gif", ".ogg", ".mp3", ".zip", ".mscz" };
+    for (const char *suffix : suffixes) {
+        if (fileName.endsWith(QLatin1String(suffix), Qt::CaseInsensitive))
+            return true;
+    }
+    return false;
 }
 
 static QFile::Permissions modeToPermissions(quint32 mode)
@@ -432,19 +476,58 @@ void MQZipPrivate::fillFileInfo(int index, MQZipReader::FileInfo &fileInfo) cons
     fileInfo.lastModified = readMSDosDate(header.h.last_mod_file);
 }
 
+class MQZipEntryReader;
+
 class MQZipReaderPrivate : public MQZipPrivate
 {
 public:
     MQZipReaderPrivate(QIODevice *device, bool ownDev)
-        : MQZipPrivate(device, ownDev), status(MQZipReader::NoError)
+        : MQZipPrivate(device, ownDev), status(MQZipReader::NoError), entryReader(0)
     {
     }
 
     void scanFiles();
+    int findFile(const QString &fileName);
+    void closeEntryReader();
 
     MQZipReader::Status status;
+    MQZipEntryReader *entryReader;          // entry read by openFile()
 };
 
+// inflates an entry while it is read, so that the compressed entry
+// does not have to be kept in memory; the inflated bytes are appended
+// to data, which holds the entry read so far
+class MQZipEntryReader : public QIODevice
+{
+public:
+    MQZipEntryReader(MQZipReaderPrivate *zip, const FileHeader &header, QByteArray *data);
+    ~MQZipEntryReader();
+    bool isSequential() const override { return true; }
+    bool atEnd() const override;
+    qint64 bytesAvailable() const override;
+    void close() override;
+
+protected:
+    qint64 readData(char *data, qint64 maxlen) override;
+    qint64 writeData(const char *, qint64) override { return -1; }
+
+private:
+    bool readChunk();
+
+    MQZipReaderPrivate *d;
+    QByteArray *data;
+    QByteArray ownData;                 // data if the caller does not keep it
+    int pos;                            // read position in data
+    bool compress;
+    bool finished;
+    z_stream stream;
+    QByteArray input;                   // compressed chunk
+    qint64 offset;                      // next compressed chunk in the archive
+    qint64 remaining;                   // compressed bytes not read yet
+};
+
+class MQZipEntryDevice;
+
 class MQZipWriterPrivate : public MQZipPrivate
 {
 public:
@@ -452,17 +535,67 @@ public:
         : MQZipPrivate(device, ownDev),
         status(MQZipWriter::NoError),
         permissions(QFile::ReadOwner | QFile::WriteOwner),
-        compressionPolicy(MQZipWriter::AlwaysCompress)
+        compressionPolicy(MQZipWriter::AlwaysCompress),
+        compressionLevel(Z_DEFAULT_COMPRESSION),
+        closed(false),
+        entryDevice(0)
     {
     }
 
     MQZipWriter::Status status;
     QFile::Permissions permissions;
     MQZipWriter::CompressionPolicy compressionPolicy;
+    int compressionLevel;
+    bool closed;
+    MQZipEntryDevice *entryDevice;          // entry written by openFile()
 
     enum EntryType { Directory, File, Symlink };
 
+    // entries are compressed in parallel and written in the order
+    // they were added
+    struct PendingEntry {
+        EntryType type;
+        QString fileName;
+        QDateTime lastModified;
+        bool async;                         // compressed by future
+        QFuture<CompressedEntry> future;
+        CompressedEntry entry;
+        uint size;
+    };
+    QList<PendingEntry> pending;
+
     void addEntry(EntryType type, const QString &fileName, const QByteArray &contents);
+    void writePending(bool wait);
+    void writeEntry(const PendingEntry &p, const CompressedEntry &e);
+    FileHeader fileHeader(const PendingEntry &p, ushort method, uint crc_32, uint compressedSize) const;
+    void closeEntryDevice();
+};
+
+// writes an entry directly into the archive, so that its contents
+// do not have to be kept in memory; the local header is written
+// first and updated with the sizes and the crc on close()
+class MQZipEntryDevice : public QIODevice
+{
+public:
+    MQZipEntryDevice(MQZipWriterPrivate *zip, const QString &fileName, bool deflated);
+    ~MQZipEntryDevice();
+    void close() override;
+
+protected:
+    qint64 readData(char *, qint64) override { return -1; }
+    qint64 writeData(const char *data, qint64 len) override;
+
+private:
+    bool deflateChunk(const char *data, uint len, int flush);
+
+    MQZipWriterPrivate *d;
+    MQZipWriterPrivate::PendingEntry p;
+    bool compress;
+    z_stream stream;
+    QByteArray buffer;                  // deflate output
+    uint crc_32;
+    uint compressedSize;
+    qint64 offset;                      // of the local header
 };
 
 LocalFileHeader MCentralFileHeader::toLocalHeader() const
@@ -579,62 +712,83 @@ void MQZipWriterPrivate::addEntry(EntryType type, const QString &fileName, const
         "symlink  " };
     ZDEBUG() << "adding" << entryTypes[type] <<":" << fileName.toUtf8().data() << (type == 2 ? QByteArray(" -> " + contents).constData() : "");
 #endif
+    closeEntryDevice();
 
-    if (! (device->isOpen() || device->open(QIODevice::WriteOnly))) {
-        status = MQZipWriter::FileOpenError;
-        return;
-    }
-    device->seek(start_of_directory);
-
-    // don't compress small files
+    // don't compress small files and files which are compressed already
     MQZipWriter::CompressionPolicy compression = compressionPolicy;
     if (compressionPolicy == MQZipWriter::AutoCompress) {
-        if (contents.length() < 64)
+        if (contents.length() < 64 || isCompressedFormat(fileName))
             compression = MQZipWriter::NeverCompress;
         else
             compression = MQZipWriter::AlwaysCompress;
     }
+    bool compress = compression == MQZipWriter::AlwaysCompress;
+
+    PendingEntry p;
+    p.type = type;
+    p.fileName = fileName;
+    p.lastModified = QDateTime::currentDateTime();
+    p.size = contents.length();
+    p.async = compress && contents.length() >= 4096;
+    if (p.async)
+        p.future = QtConcurrent::run(compressEntry, contents, compress, compressionLevel);
+    else
+        p.entry = compressEntry(contents, compress, compressionLevel);
+    pending.append(p);
+    writePending(false);
+}
 
+// write the pending entries which are compressed; with \a wait
+// wait for all of them
+void MQZipWriterPrivate::writePending(bool wait)
+{
+    while (!pending.isEmpty()) {
+        const PendingEntry &p = pending.first();
+        if (p.async) {
+            if (!wait && !p.future.isFinished())
+                break;
+            writeEntry(p, p.future.result());
+        }
+        else
+            writeEntry(p, p.entry);
+        pending.removeFirst();
+    }
+}
+
+void MQZipWriterPrivate::writeEntry(const PendingEntry &p, const CompressedEntry &e)
+{
+    if (! (device->isOpen() || device->open(QIODevice::WriteOnly))) {
+        status = MQZipWriter::FileOpenError;
+        return;
+    }
+    device->seek(start_of_directory);
+
+    FileHeader header = fileHeader(p, e.method, e.crc_32, e.data.length());
+    writeUInt(header.h.offset_local_header, start_of_directory);
+    fileHeaders.append(header);
+
+    LocalFileHeader h = header.h.toLocalHeader();
+    device->write((const char *)&h, sizeof(LocalFileHeader));
+    device->write(header.file_name);
+    device->write(e.data);
+    start_of_directory = device->pos();
+    dirtyFileTree = true;
+}
+
+FileHeader MQZipWriterPrivate::fileHeader(const PendingEntry &p, ushort method, uint crc_32, uint compressedSize) const
+{
     FileHeader header;
     memset(&header.h, 0, sizeof(MCentralFileHeader));
     writeUInt(header.h.signature, 0x02014b50);
 
     writeUShort(header.h.version_needed, 0x14);
-    writeUInt(header.h.uncompressed_size, contents.length());
-    writeMSDosDate(header.h.last_mod_file, QDateTime::currentDateTime());
-    QByteArray data = contents;
-    if (compression == MQZipWriter::AlwaysCompress) {
-        writeUShort(header.h.compression_method, 8);
-
-       ulong len = contents.length();
-        // shamelessly copied form zlib
-        len += (len >> 12) + (len >> 14) + 11;
-        int res;
-        do {
-            data.resize(len);
-            res = deflate((uchar*)data.data(), &len, (const uchar*)contents.constData(), contents.length());
-
-            switch (res) {
-            case Z_OK:
-                data.resize(len);
-                break;
-            case Z_MEM_ERROR:
-                qWarning("QZip: Z_MEM_ERROR: Not enough memory to compress file, skipping");
-                data.resize(0);
-                break;
-            case Z_BUF_ERROR:
-                len *= 2;
-                break;
-            }
-        } while (res == Z_BUF_ERROR);
-    }
-// TODO add a check if data.length() > contents.length().  Then try to store the original and revert the compression method to be uncompressed
-    writeUInt(header.h.compressed_size, data.length());
-    uint crc_32 = ::crc32(0, 0, 0);
-    crc_32 = ::crc32(crc_32, (const uchar *)contents.constData(), contents.length());
+    writeUInt(header.h.uncompressed_size, p.size);
+    writeMSDosDate(header.h.last_mod_file, p.lastModified);
+    writeUShort(header.h.compression_method, method);
+    writeUInt(header.h.compressed_size, compressedSize);
     writeUInt(header.h.crc_32, crc_32);
 
-    header.file_name = fileName.toUtf8();
+    header.file_name = p.fileName.toUtf8();
     if (header.file_name.size() > 0xffff) {
         qWarning("QZip: Filename too long, chopping it to 65535 characters");
         header.file_name = header.file_name.left(0xffff);
@@ -646,23 +800,118 @@ void MQZipWriterPrivate::addEntry(EntryType type, const QString &fileName, const
     //uchar internal_file_attributes[2];
     //uchar external_file_attributes[4];
     quint32 mode = permissionsToMode(permissions);
-    switch (type) {
+    switch (p.type) {
         case File: mode |= S_IFREG; break;
         case Directory: mode |= S_IFDIR; break;
         case Symlink: mode |= S_IFLNK; break;
     }
     writeUInt(header.h.external_file_attributes, mode << 16);
-    writeUInt(header.h.offset_local_header, start_of_directory);
+    return header;
+}
 
+void MQZipWriterPrivate::closeEntryDevice()
+{
+    if (!entryDevice)
+        return;
+    entryDevice->close();
+    delete entryDevice;
+    entryDevice = 0;
+}
 
-    fileHeaders.append(header);
+MQZipEntryDevice::MQZipEntryDevice(MQZipWriterPrivate *zip, const QString &fileName, bool deflated)
+    : d(zip), compress(deflated), crc_32(::crc32(0, 0, 0)), compressedSize(0), offset(-1)
+{
+    p.type = MQZipWriterPrivate::File;
+    p.fileName = fileName;
+    p.lastModified = QDateTime::currentDateTime();
+    p.size = 0;
+    p.async = false;
+
+    memset(&stream, 0, sizeof(stream));
+    // check the device first: the stream is only released by close(),
+    // which does nothing unless this device was opened
+    if (! (d->device->isOpen() || d->device->open(QIODevice::WriteOnly))) {
+        d->status = MQZipWriter::FileOpenError;
+        compress = false;
+        return;
+    }
+    if (compress && deflateInit2(&stream, d->compressionLevel, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        qWarning("QZip: cannot compress file, storing it");
+        compress = false;
+    }
+    if (compress)
+        buffer.resize(64 * 1024);
 
+    offset = d->start_of_directory;
+    d->device->seek(offset);
+    // placeholder, rewritten by close()
+    FileHeader header = d->fileHeader(p, compress ? 8 : 0, 0, 0);
     LocalFileHeader h = header.h.toLocalHeader();
-    device->write((const char *)&h, sizeof(LocalFileHeader));
-    device->write(header.file_name);
-    device->write(data);
-    start_of_directory = device->pos();
-    dirtyFileTree = true;
+    d->device->write((const char *)&h, sizeof(LocalFileHeader));
+    d->device->write(header.file_name);
+    open(QIODevice::WriteOnly);
+}
+
+MQZipEntryDevice::~MQZipEntryDevice()
+{
+    close();
+}
+
+qint64 MQZipEntryDevice::writeData(const char *data, qint64 len)
+{
+    crc_32 = ::crc32(crc_32, (const uchar *)data, len);
+    p.size += len;
+    if (compress) {
+        if (!deflateChunk(data, len, Z_NO_FLUSH))
+            return -1;
+    }
+    else {
+        if (d->device->write(data, len) != len)
+            return -1;
+        compressedSize += len;
+    }
+    return len;
+}
+
+bool MQZipEntryDevice::deflateChunk(const char *data, uint len, int flush)
+{
+    stream.next_in = (Bytef *)data;
+    stream.avail_in = len;
+    do {
+        stream.next_out = (Bytef *)buffer.data();
+        stream.avail_out = buffer.size();
+        int err = deflate(&stream, flush);
+        int n = buffer.size() - stream.avail_out;
+        if (err == Z_STREAM_ERROR || d->device->write(buffer.constData(), n) != n) {
+            d->status = MQZipWriter::FileWriteError;
+            return false;
+        }
+        compressedSize += n;
+    } while (stream.avail_out == 0);
+    return true;
+}
+
+void MQZipEntryDevice::close()
+{
+    if (!isOpen())
+        return;
+    QIODevice::close();
+    if (compress) {
+        deflateChunk(0, 0, Z_FINISH);
+        deflateEnd(&stream);
+    }
+
+    FileHeader header = d->fileHeader(p, compress ? 8 : 0, crc_32, compressedSize);
+    writeUInt(header.h.offset_local_header, offset);
+    d->fileHeaders.append(header);
+
+    qint64 end = d->device->pos();
+    LocalFileHeader h = header.h.toLocalHeader();
+    d->device->seek(offset);
+    d->device->write((const char *)&h, sizeof(LocalFileHeader));
+    d->device->seek(end);
+    d->start_of_directory = end;
+    d->dirtyFileTree = true;
 }
 
 //////////////////////////////  Reader
@@ -849,13 +1098,8 @@ MQZipReader::FileInfo MQZipReader::entryInfoAt(int index) const
 */
 QByteArray MQZipReader::fileData(const QString &fileName) const
 {
-    d->scanFiles();
-    int i;
-    for (i = 0; i < d->fileHeaders.size(); ++i) {
-        if (QString::fromUtf8(d->fileHeaders.at(i).file_name) == fileName)
-            break;
-    }
-    if (i == d->fileHeaders.size())
+    int i = d->findFile(fileName);
+    if (i == -1)
         return QByteArray();
 
     FileHeader header = d->fileHeaders.at(i);
@@ -914,6 +1158,153 @@ QByteArray MQZipReader::fileData(const QString &fileName) const
     return QByteArray();
 }
 
+/*!
+    Return a device which reads the contents of \a fileName, inflating
+    them while they are read, or 0 if there is no such file. If \a data
+    is given, the contents read so far are appended to it. The device is
+    owned by the reader and deleted by the next openFile() or close().
+*/
+QIODevice *MQZipReader::openFile(const QString &fileName, QByteArray *data)
+{
+    d->closeEntryReader();
+    int i = d->findFile(fileName);
+    if (i == -1)
+        return 0;
+    d->entryReader = new MQZipEntryReader(d, d->fileHeaders.at(i), data);
+    return d->entryReader;
+}
+
+int MQZipReaderPrivate::findFile(const QString &fileName)
+{
+    scanFiles();
+    for (int i = 0; i < fileHeaders.size(); ++i) {
+        if (QString::fromUtf8(fileHeaders.at(i).file_name) == fileName)
+            return i;
+    }
+    return -1;
+}
+
+void MQZipReaderPrivate::closeEntryReader()
+{
+    delete entryReader;
+    entryReader = 0;
+}
+
+MQZipEntryReader::MQZipEntryReader(MQZipReaderPrivate *zip, const FileHeader &header, QByteArray *d_)
+    : d(zip), data(d_ ? d_ : &ownData), pos(0), compress(false), finished(true), offset(0), remaining(0)
+{
+    memset(&stream, 0, sizeof(stream));
+    d->device->seek(readUInt(header.h.offset_local_header));
+    LocalFileHeader lh;
+    if (d->device->read((char *)&lh, sizeof(LocalFileHeader)) != sizeof(LocalFileHeader)) {
+        d->status = MQZipReader::FileReadError;
+        return;
+    }
+    uint skip = readUShort(lh.file_name_length) + readUShort(lh.extra_field_length);
+    offset = d->device->pos() + skip;
+    remaining = readUInt(header.h.compressed_size);
+
+    int compression_method = readUShort(lh.compression_method);
+    compress = compression_method == 8;
+    if (compression_method != 0 && !compress) {
+        qWarning() << "QZip: Unknown compression method";
+        return;
+    }
+    if (compress && inflateInit2(&stream, -MAX_WBITS) != Z_OK) {
+        qWarning("QZip: cannot inflate file");
+        return;
+    }
+    uint size = readUInt(header.h.uncompressed_size);
+    if (data != &ownData)
+        data->reserve(data->size() + size);
+    finished = size == 0;
+    open(QIODevice::ReadOnly | QIODevice::Unbuffered);
+}
+
+MQZipEntryReader::~MQZipEntryReader()
+{
+    close();
+}
+
+bool MQZipEntryReader::atEnd() const
+{
+    return finished && pos == data->size();
+}
+
+qint64 MQZipEntryReader::bytesAvailable() const
+{
+    return data->size() - pos + QIODevice::bytesAvailable();
+}
+
+void MQZipEntryReader::close()
+{
+    if (!isOpen())
+        return;
+    QIODevice::close();
+    if (compress)
+        inflateEnd(&stream);
+}
+
+qint64 MQZipEntryReader::readData(char *buffer, qint64 maxlen)
+{
+    while (pos == data->size()) {
+        if (finished || !readChunk())
+            return -1;
+    }
+    int n = qMin(qint64(data->size() - pos), maxlen);
+    memcpy(buffer, data->constData() + pos, n);
+    pos += n;
+    if (data == &ownData && pos == data->size()) {
+        ownData.resize(0);
+        pos = 0;
+    }
+    return n;
+}
+
+// append the next chunk of the entry to data; the archive may be
+// read by someone else between two chunks
+bool MQZipEntryReader::readChunk()
+{
+    static const int CHUNK_SIZE = 64 * 1024;
+    if (!compress || stream.avail_in == 0) {
+        if (remaining == 0) {
+            qWarning("QZip: Z_DATA_ERROR: Input data is corrupted");
+            finished = true;
+            return false;
+        }
+        d->device->seek(offset);
+        input = d->device->read(qMin(remaining, qint64(CHUNK_SIZE)));
+        if (input.isEmpty()) {
+            d->status = MQZipReader::FileReadError;
+            finished = true;
+            return false;
+        }
+        offset += input.size();
+        remaining -= input.size();
+        if (!compress) {
+            data->append(input);
+            finished = remaining == 0;
+            return true;
+        }
+        stream.next_in = (Bytef *)input.constData();
+        stream.avail_in = input.size();
+    }
+    int n = data->size();
+    data->resize(n + CHUNK_SIZE);
+    stream.next_out = (Bytef *)data->data() + n;
+    stream.avail_out = CHUNK_SIZE;
+    int err = inflate(&stream, Z_NO_FLUSH);
+    data->resize(n + CHUNK_SIZE - stream.avail_out);
+    if (err == Z_STREAM_END)
+        finished = true;
+    else if (err != Z_OK && err != Z_BUF_ERROR) {
+        qWarning("QZip: Z_DATA_ERROR: Input data is corrupted");
+        finished = true;
+        return false;
+    }
+    return true;
+}
+
 /*!
     Extracts the full contents of the zip file into \a destinationDir on
     the local filesystem.
@@ -995,6 +1386,7 @@ MQZipReader::Status MQZipReader::status() const
 */
 void MQZipReader::close()
 {
+    d->closeEntryReader();
     d->device->close();
 }
 
@@ -1111,7 +1503,10 @@ MQZipWriter::Status MQZipWriter::status() const
 
     \value AlwaysCompress   A file that is added is compressed.
     \value NeverCompress    A file that is added will be stored without changes.
-    \value AutoCompress     A file that is added will be compressed only if that will give a smaller file.
+    \value AutoCompress     A file that is added will be compressed unless it is small or in a
+                            compressed format like png or ogg.
+
+    A file which does not get smaller by compression is always stored.
 */
 
 /*!
@@ -1137,6 +1532,28 @@ MQZipWriter::CompressionPolicy MQZipWriter::compressionPolicy() const
     return d->compressionPolicy;
 }
 
+/*!
+    Sets the zlib compression \a level (0-9) used for newly added files,
+    lower levels are faster, higher ones give smaller files.
+
+    \note the default level is Z_DEFAULT_COMPRESSION (6)
+
+    \sa compressionLevel()
+*/
+void MQZipWriter::setCompressionLevel(int level)
+{
+    d->compressionLevel = level;
+}
+
+/*!
+     Returns the currently set compression level.
+    \sa setCompressionLevel()
+*/
+int MQZipWriter::compressionLevel() const
+{
+    return d->compressionLevel;
+}
+
 /*!
     Sets the permissions that will be used for newly added files.
 
@@ -1187,6 +1604,7 @@ void MQZipWriter::addFile(const QString &fileName, const QByteArray &data)
 */
 void MQZipWriter::addFile(const QString &fileName, QIODevice *device)
 {
+    d->closeEntryDevice();
     Q_ASSERT(device);
     QIODevice::OpenMode mode = device->openMode();
     bool opened = false;
@@ -1202,6 +1620,25 @@ void MQZipWriter::addFile(const QString &fileName, QIODevice *device)
         device->close();
 }
 
+/*!
+    Add a file to the archive and return a device which writes its contents
+    directly into the archive, so that they need not be kept in memory.
+    The entry is finished when the device is closed, when the next entry
+    is added or when the archive is closed. The device is owned by the writer
+    and deleted at that point.
+    An entry is compressed unless the policy is NeverCompress or, with
+    AutoCompress, its file name shows a compressed format.
+*/
+QIODevice *MQZipWriter::openFile(const QString &fileName)
+{
+    d->closeEntryDevice();
+    d->writePending(true);
+    bool compress = d->compressionPolicy == AlwaysCompress
+                    || (d->compressionPolicy == AutoCompress && !isCompressedFormat(fileName));
+    d->entryDevice = new MQZipEntryDevice(d, fileName, compress);
+    return d->entryDevice;
+}
+
 /*!
     Create a new directory in the archive with the specified \a dirName and
     the \a permissions;
@@ -1226,12 +1663,19 @@ void MQZipWriter::addSymLink(const QString &fileName, const QString &destination
 }
 
 /*!
-   Closes the zip file.
+   Closes the zip file. A device passed to the constructor is left open,
+   it may be a QSaveFile which must not be closed.
 */
 void MQZipWriter::close()
 {
+    if (d->closed)
+        return;
+    d->closed = true;
+    d->closeEntryDevice();
+    d->writePending(true);
     if (!(d->device->openMode() & QIODevice::WriteOnly)) {
-        d->device->close();
+        if (d->ownDevice)
+            d->device->close();
         return;
     }
 
@@ -1260,7 +1704,8 @@ void MQZipWriter::close()
 
     d->device->write((const char *)&eod, sizeof(EndOfDirectory));
     d->device->write(d->comment);
-    d->device->close();
+    if (d->ownDevice)
+        d->device->close();
 }
 
 QT_END_NAMESPACE
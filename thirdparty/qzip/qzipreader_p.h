@@ -99,6 +99,7 @@ public:
 
     FileInfo entryInfoAt(int index) const;
     QByteArray fileData(const QString &fileName) const;
+    QIODevice *openFile(const QString &fileName, QByteArray *data = 0);
     bool extractAll(const QString &destinationDir) const;
 
     enum Status {
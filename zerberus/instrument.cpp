@@ -21,11 +21,10 @@
 #include "thirdparty/qzip/qzipreader_p.h"
 
 #include "instrument.h"
+#include "zerberus.h"
 #include "zone.h"
 #include "sample.h"
-
-QByteArray ZInstrument::buf;
-int ZInstrument::idx;
+#include "streamer.h"
 
 //---------------------------------------------------------
 //   Sample
@@ -38,50 +37,73 @@ Sample::~Sample()
 
 //---------------------------------------------------------
 //   readSample
+//    called from the loader threads, see loadSfz()
 //---------------------------------------------------------
 
 Sample* ZInstrument::readSample(const QString& s, MQZipReader* uz)
       {
-      if (uz) {
-            QList<MQZipReader::FileInfo> fi = uz->fileInfoList();
+      // in streaming mode only the first frames of samples
+      // from plain files are loaded
+      bool stream = !uz && zerberus->preload();
+      QByteArray buf;
+      AudioFile a;
 
-            buf = uz->fileData(s);
-            if (buf.isEmpty()) {
-                  printf("Sample::read: cannot read sample data <%s>\n", qPrintable(s));
+      if (stream) {
+            if (!a.open(s)) {
+                  printf("open <%s> failed: %s\n", qPrintable(s), a.error());
                   return 0;
                   }
             }
       else {
-            QFile f(s);
-            if (!f.open(QIODevice::ReadOnly)) {
-                  printf("Sample::read: open <%s> failed\n", qPrintable(s));
+            if (uz) {
+                  QList<MQZipReader::FileInfo> fi = uz->fileInfoList();
+
+                  buf = uz->fileData(s);
+                  if (buf.isEmpty()) {
+                        printf("Sample::read: cannot read sample data <%s>\n", qPrintable(s));
+                        return 0;
+                        }
+                  }
+            else {
+                  QFile f(s);
+                  if (!f.open(QIODevice::ReadOnly)) {
+                        printf("Sample::read: open <%s> failed\n", qPrintable(s));
+                        return 0;
+                        }
+                  buf = f.readAll();
+                  }
+            if (!a.open(buf)) {
+                  printf("open <%s> failed: %s\n", qPrintable(s), a.error());
                   return 0;
                   }
-            buf = f.readAll();
             }
 
-      AudioFile a;
-      if (!a.open(buf)) {
-            printf("open <%s> failed: %s\n", qPrintable(s), a.error());
-            return 0;
+      int channel  = a.channels();
+      int frames   = a.frames();
+      int sr       = a.samplerate();
+      int resident = frames;
+      if (stream) {
+            static const int MIN_RESIDENT = 64;
+            resident = qBound(qMin(MIN_RESIDENT, frames), int(qint64(zerberus->preload()) * sr / 1000), frames);
             }
 
-      int channel = a.channels();
-      int frames  = a.frames();
-      int sr      = a.samplerate();
-
-      short* data = new short[(frames + 3) * channel];
+      short* data = new short[(resident + 3) * channel];
       Sample* sa  = new Sample(channel, data, frames, sr);
 
-      if (frames != a.read(data + channel, frames)) {
+      if (resident != a.read(data + channel, resident)) {
             qDebug("Sample read failed: %s\n", a.error());
             delete sa;
-            sa = 0;
+            return 0;
             }
-      for (int i = 0; i < channel; ++i) {
-            data[i]                        = data[channel + i];
-            data[(frames-1) * channel + i] = data[(frames-3) * channel + i];
-            data[(frames-2) * channel + i] = data[(frames-3) * channel + i];
+      for (int i = 0; i < channel; ++i)
+            data[i] = data[channel + i];
+      if (resident < frames)
+            sa->setStreamed(Streamer::registerPath(s), resident);
+      else {
+            for (int i = 0; i < channel; ++i) {
+                  data[(frames-1) * channel + i] = data[(frames-3) * channel + i];
+                  data[(frames-2) * channel + i] = data[(frames-3) * channel + i];
+                  }
             }
       return sa;
       }
@@ -54,10 +54,6 @@ class ZInstrument {
       std::list<Zone*>& zones()             { return _zones;  }
       Sample* readSample(const QString& s, MQZipReader* uz);
       void addZone(Zone* z)                 { _zones.push_back(z); }
-      void addRegion(SfzRegion&);
-
-      static QByteArray buf;  // used during read of Sample
-      static int idx;
       };
 
 #endif
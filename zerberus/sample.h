@@ -22,16 +22,23 @@ class Sample {
       short* _data;
       int _frames;
       int _sampleRate;
+      int _residentFrames;    // frames in _data
+      int _pathId;            // file the other frames are streamed from, see Streamer
 
    public:
       Sample(int ch, short* val, int f, int sr)
-         : _channel(ch), _data(val), _frames(f), _sampleRate(sr) {}
+         : _channel(ch), _data(val), _frames(f), _sampleRate(sr), _residentFrames(f), _pathId(-1) {}
       ~Sample();
       bool read(const QString&);
       int frames() const     { return _frames;          }
       short* data() const    { return _data + _channel; }
       int channel() const    { return _channel;         }
       int sampleRate() const { return _sampleRate;      }
+
+      void setStreamed(int pathId, int resident) { _pathId = pathId; _residentFrames = resident; }
+      bool streamed() const        { return _residentFrames < _frames; }
+      int residentFrames() const   { return _residentFrames; }
+      int pathId() const           { return _pathId;         }
       };
 
 #endif
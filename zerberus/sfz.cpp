@@ -12,6 +12,8 @@
 
 #include <stdio.h>
 #include <math.h>
+#include <atomic>
+#include <vector>
 #include <QFile>
 #include <QFileInfo>
 #include <QStringList>
@@ -175,11 +177,21 @@ int SfzRegion::readKey(const QString& s) const
       return i;
       }
 
+//---------------------------------------------------------
+//   SampleJob
+//    a zone waiting for its sample
+//---------------------------------------------------------
+
+struct SampleJob {
+      Zone* zone;
+      QString sample;
+      };
+
 //---------------------------------------------------------
 //   addRegion
 //---------------------------------------------------------
 
-void ZInstrument::addRegion(SfzRegion& r)
+static void addRegion(SfzRegion& r, std::vector<SampleJob>& jobs)
       {
       for (int i = 0; i < 128; ++i) {
             if (r.on_locc[i] != -1 || r.on_hicc[i] != -1) {
@@ -189,11 +201,36 @@ void ZInstrument::addRegion(SfzRegion& r)
             }
       Zone* z = new Zone;
       r.setZone(z);
-      z->sample = readSample(r.sample, 0);
-      if (z->sample)
-            addZone(z);
+      jobs.push_back(SampleJob { z, r.sample });
       }
 
+//---------------------------------------------------------
+//   SampleLoader
+//    reads the samples of jobs until all are done or
+//    loading is canceled; several loaders run in parallel
+//---------------------------------------------------------
+
+class SampleLoader : public QRunnable {
+      ZInstrument* instrument;
+      Zerberus* zerberus;
+      std::vector<SampleJob>& jobs;
+      std::atomic<int>& next;
+      std::atomic<int>& done;
+
+   public:
+      SampleLoader(ZInstrument* i, Zerberus* z, std::vector<SampleJob>& j, std::atomic<int>& n, std::atomic<int>& d)
+         : instrument(i), zerberus(z), jobs(j), next(n), done(d) {}
+      virtual void run() {
+            for (;;) {
+                  int idx = next++;
+                  if (idx >= int(jobs.size()) || zerberus->loadWasCanceled())
+                        break;
+                  jobs[idx].zone->sample = instrument->readSample(jobs[idx].sample, 0);
+                  ++done;
+                  }
+            }
+      };
+
 //---------------------------------------------------------
 //   readDouble
 //---------------------------------------------------------
@@ -347,18 +384,26 @@ bool ZInstrument::loadSfz(const QString& s)
       bool groupMode = false;
       zerberus->setLoadProgress(0);
 
+      //
+      // pass 1: parse all regions, takes the first
+      //    PARSE_PROGRESS percent of the progress
+      //
+      static const int PARSE_PROGRESS = 10;
+      std::vector<SampleJob> jobs;
+      QRegularExpression re("\\s?(\\w+)=");
+
       while (!f.atEnd()) {
             QByteArray ba = f.readLine();
-            zerberus->setLoadProgress(((qreal)f.pos() * 100) / total);
+            zerberus->setLoadProgress(((qreal)f.pos() * PARSE_PROGRESS) / total);
             ba = ba.simplified();
 
             if (ba.isEmpty() || ba.startsWith("//"))
                   continue;
             if (zerberus->loadWasCanceled())
-                  return false;
+                  break;
             if (ba.startsWith("<group>")) {
                   if (!groupMode && !r.isEmpty())
-                        addRegion(r);
+                        addRegion(r, jobs);
                   g.init(path);
                   r.init(path);
                   groupMode = true;
@@ -371,12 +416,11 @@ bool ZInstrument::loadSfz(const QString& s)
                         }
                   else {
                         if (!r.isEmpty())
-                              addRegion(r);
+                              addRegion(r, jobs);
                         r = g;  // initialize next region with group values
                         }
                   ba = ba.mid(8);
                   }
-            QRegularExpression re("\\s?(\\w+)=");
             QRegularExpressionMatchIterator i = re.globalMatch(ba);
 
             while (i.hasNext()) {
@@ -393,9 +437,30 @@ bool ZInstrument::loadSfz(const QString& s)
                   r.readOp(match.captured(1), s);
                   }
             }
+      if (!groupMode && !r.isEmpty() && !zerberus->loadWasCanceled())
+            addRegion(r, jobs);
+
+      //
+      // pass 2: read the samples in parallel
+      //
+      std::atomic<int> next(0);
+      std::atomic<int> done(0);
+      QThreadPool pool;
+      int threads = qMin(pool.maxThreadCount(), int(jobs.size()));
+      for (int i = 0; i < threads; ++i)
+            pool.start(new SampleLoader(this, zerberus, jobs, next, done));
+      while (!pool.waitForDone(50)) {
+            if (!jobs.empty())
+                  zerberus->setLoadProgress(PARSE_PROGRESS + (done * (100 - PARSE_PROGRESS)) / int(jobs.size()));
+            }
+
+      bool canceled = zerberus->loadWasCanceled();
+      for (const SampleJob& j : jobs) {
+            if (!canceled && j.zone->sample)
+                  addZone(j.zone);
+            else
+                  delete j.zone;
+            }
       zerberus->setLoadProgress(100);
-      if (!groupMode && !r.isEmpty())
-            addRegion(r);
-      return true;
+      return !canceled;
       }
-
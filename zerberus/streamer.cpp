@@ -0,0 +1,276 @@
+//=============================================================================
+//  Zerberus
+//  Zample player
+//
+//  Copyright (C) 2015 Werner Schweer
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License version 2
+//  as published by the Free Software Foundation and appearing in
+//  the file LICENCE.GPL
+//=============================================================================
+
+#include <algorithm>
+#include <QHash>
+#include <QStringList>
+#include "streamer.h"
+#include "sample.h"
+#include "audiofile/audiofile.h"
+
+// paths of all streamed samples; an entry is never removed
+// so the audio thread can hand out ids without copying strings
+
+static std::mutex pathMutex;
+static QStringList paths;
+static QHash<QString, int> pathIds;
+
+//---------------------------------------------------------
+//   registerPath
+//    return the id for path, called when a sample is loaded
+//    not realtime
+//---------------------------------------------------------
+
+int Streamer::registerPath(const QString& path)
+      {
+      std::lock_guard<std::mutex> lock(pathMutex);
+      auto i = pathIds.constFind(path);
+      if (i != pathIds.constEnd())
+            return i.value();
+      int id = paths.size();
+      paths.append(path);
+      pathIds.insert(path, id);
+      return id;
+      }
+
+//---------------------------------------------------------
+//   path
+//    reader thread
+//---------------------------------------------------------
+
+QString Streamer::path(int id)
+      {
+      std::lock_guard<std::mutex> lock(pathMutex);
+      return paths.value(id);
+      }
+
+//---------------------------------------------------------
+//   ~Streamer
+//---------------------------------------------------------
+
+Streamer::~Streamer()
+      {
+      stop();
+      }
+
+//---------------------------------------------------------
+//   start
+//    not realtime
+//---------------------------------------------------------
+
+void Streamer::start()
+      {
+      stop();
+      streams = new Stream[MAX_STREAMS];
+      for (int i = 0; i < MAX_STREAMS; ++i) {
+            streams[i].ring.assign(STREAM_FRAMES * 2, 0);
+            streams[i].window.assign((WINDOW_FRAMES + 8) * 2, 0);
+            }
+      _quit    = false;
+      _request = false;
+      reader   = std::thread(&Streamer::readerLoop, this);
+      }
+
+//---------------------------------------------------------
+//   stop
+//    not realtime
+//---------------------------------------------------------
+
+void Streamer::stop()
+      {
+      if (!streams)
+            return;
+      {
+      std::lock_guard<std::mutex> lock(mutex);
+      _quit = true;
+      }
+      request.notify_all();
+      filled.notify_all();
+      reader.join();
+      for (int i = 0; i < MAX_STREAMS; ++i)
+            delete streams[i].file;
+      delete[] streams;
+      streams = 0;
+      }
+
+//---------------------------------------------------------
+//   open
+//    return a stream for sample or 0 if all are in use;
+//    the first frames are read by the voice from the
+//    resident part of the sample
+//    realtime
+//---------------------------------------------------------
+
+Stream* Streamer::open(const Sample* sample)
+      {
+      if (!streams)
+            return 0;
+      for (int i = 0; i < MAX_STREAMS; ++i) {
+            Stream* s = &streams[i];
+            if (s->state != Stream::State::FREE)
+                  continue;
+            s->pathId   = sample->pathId();
+            s->channels = sample->channel();
+            s->frames   = sample->frames();
+            s->resident = sample->residentFrames();
+            s->written  = s->resident;
+            s->consumed = 0;
+            s->state    = Stream::State::OPEN;
+            wake();
+            return s;
+            }
+      ++_starved;
+      return 0;
+      }
+
+//---------------------------------------------------------
+//   close
+//    the reader thread frees the stream
+//    realtime
+//---------------------------------------------------------
+
+void Streamer::close(Stream* s)
+      {
+      s->state = Stream::State::CLOSING;
+      wake();
+      }
+
+//---------------------------------------------------------
+//   consumed
+//    the voice does not need the frames before frame
+//    anymore; wake the reader once a chunk fits into the
+//    ring buffer
+//    realtime
+//---------------------------------------------------------
+
+void Streamer::consumed(Stream* s, int frame)
+      {
+      s->consumed = frame;
+      int w = s->written;
+      if (w < s->frames && qMax(frame, s->resident) + STREAM_FRAMES - w >= CHUNK_FRAMES)
+            wake();
+      }
+
+//---------------------------------------------------------
+//   wait
+//    block until the first frames of the stream are read
+//    not realtime, used for offline rendering
+//---------------------------------------------------------
+
+void Streamer::wait(Stream* s, int frames)
+      {
+      ++_waiting;
+      wake();
+      std::unique_lock<std::mutex> lock(mutex);
+      filled.wait(lock, [&] { return _quit || s->written >= frames; });
+      --_waiting;
+      }
+
+//---------------------------------------------------------
+//   wake
+//    tell the reader there is something to do; the mutex
+//    is only taken for the first request after the reader
+//    looked at the streams and is never held for long
+//    (as in RenderPool::run())
+//    realtime
+//---------------------------------------------------------
+
+void Streamer::wake()
+      {
+      if (_request.exchange(true))
+            return;
+      std::lock_guard<std::mutex> lock(mutex);
+      request.notify_one();
+      }
+
+//---------------------------------------------------------
+//   published
+//    new frames were written, wake voices in wait()
+//---------------------------------------------------------
+
+void Streamer::published()
+      {
+      if (_waiting == 0)
+            return;
+      std::lock_guard<std::mutex> lock(mutex);
+      filled.notify_all();
+      }
+
+//---------------------------------------------------------
+//   readerLoop
+//---------------------------------------------------------
+
+void Streamer::readerLoop()
+      {
+      while (!_quit) {
+            _request = false;       // requests from now on are seen by the next pass
+            bool busy = false;
+            for (int i = 0; i < MAX_STREAMS; ++i) {
+                  Stream* s = &streams[i];
+                  Stream::State state = s->state;
+                  if (state == Stream::State::CLOSING) {
+                        delete s->file;
+                        s->file  = 0;
+                        s->state = Stream::State::FREE;
+                        }
+                  else if (state == Stream::State::OPEN)
+                        busy |= fill(s);
+                  }
+            if (busy)
+                  continue;
+            std::unique_lock<std::mutex> lock(mutex);
+            request.wait(lock, [this] { return _quit || _request; });
+            }
+      }
+
+//---------------------------------------------------------
+//   fill
+//    read the next chunk of a stream if there is space
+//    for it in the ring buffer (or the rest of the sample
+//    fits); return true if something was read
+//---------------------------------------------------------
+
+bool Streamer::fill(Stream* s)
+      {
+      int w        = s->written;
+      int frames   = s->frames;
+      if (w >= frames)
+            return false;
+      int resident = s->resident;
+      int consumed = qMax(int(s->consumed), resident);
+      int n        = qMin(qMin(consumed + STREAM_FRAMES - w, CHUNK_FRAMES), frames - w);
+      if (n < CHUNK_FRAMES && n < frames - w)
+            return false;           // Streamer::consumed() wakes us when there is space
+
+      if (!s->file) {
+            s->file = new AudioFile;
+            if (!s->file->open(path(s->pathId)) || !s->file->seekFrame(w)) {
+                  qDebug("Streamer: cannot read <%s>", qPrintable(path(s->pathId)));
+                  std::fill(s->ring.begin(), s->ring.end(), 0);
+                  s->written = frames;    // the voice plays silence
+                  published();
+                  return false;
+                  }
+            }
+      int ch   = s->channels;
+      int pos  = (w - resident) % STREAM_FRAMES;
+      int n1   = qMin(n, STREAM_FRAMES - pos);
+      short* p = s->ring.data();
+      int r    = s->file->read(p + pos * ch, n1);
+      if (r == n1 && n > n1)
+            r += s->file->read(p, n - n1);
+      if (r != n)
+            qDebug("Streamer: short read <%s>", qPrintable(path(s->pathId)));
+      s->written = w + n;
+      published();
+      return true;
+      }
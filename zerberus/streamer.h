@@ -0,0 +1,100 @@
+//=============================================================================
+//  Zerberus
+//  Zample player
+//
+//  Copyright (C) 2015 Werner Schweer
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License version 2
+//  as published by the Free Software Foundation and appearing in
+//  the file LICENCE.GPL
+//=============================================================================
+
+#ifndef __STREAMER_H__
+#define __STREAMER_H__
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <QString>
+
+class Sample;
+class AudioFile;
+
+static const int STREAM_FRAMES = 1 << 16;       // ring buffer size of a stream
+static const int WINDOW_FRAMES = 4096;          // frames a voice copies for one pass
+static const int MAX_STREAMS   = 128;
+
+//---------------------------------------------------------
+//   Stream
+//    ring buffer for the part of a sample which is not
+//    resident. The disk reader thread is the only writer,
+//    one voice the only reader.
+//---------------------------------------------------------
+
+struct Stream {
+      enum class State : char { FREE, OPEN, CLOSING };
+
+      std::atomic<State> state { State::FREE };
+      // a copy of the sample parameters, the reader thread
+      // does not access the Sample
+      int pathId   = -1;                  // see Streamer::registerPath()
+      int channels = 0;
+      int frames   = 0;
+      int resident = 0;
+      std::atomic<int> written  { 0 };    // frames [0, written) of the sample are available
+      std::atomic<int> consumed { 0 };    // frames [0, consumed) are not needed anymore,
+                                          // set with Streamer::consumed()
+      std::vector<short> ring;            // frame f is at (f - resident) % STREAM_FRAMES
+      std::vector<short> window;          // used by the voice, see Voice::process()
+      AudioFile* file = 0;                // reader thread only
+      };
+
+//---------------------------------------------------------
+//   Streamer
+//    disk reader thread feeding the streams of voices
+//    playing samples which are only partially loaded
+//---------------------------------------------------------
+
+class Streamer {
+      static const int CHUNK_FRAMES = 8192;     // frames read in one go
+
+      Stream* streams = 0;
+      std::thread reader;
+      std::mutex mutex;                         // for the two conditions only
+      std::condition_variable request;          // reader waits for work
+      std::condition_variable filled;           // offline voices wait for the reader
+      std::atomic<bool> _request   { false };   // something changed since the reader looked
+      std::atomic<int> _waiting    { 0 };       // voices in wait()
+      std::atomic<bool> _quit      { false };
+      std::atomic<int> _underruns  { 0 };
+      std::atomic<int> _starved    { 0 };     // voices started without a free stream
+
+      void readerLoop();
+      bool fill(Stream*);
+      void wake();
+      void published();
+
+   public:
+      Streamer() {}
+      ~Streamer();
+
+      void start();
+      void stop();
+      bool active() const           { return streams != 0; }
+
+      Stream* open(const Sample*);
+      void close(Stream*);
+      void consumed(Stream*, int frame);
+      void wait(Stream*, int frames);
+      void underrun()               { ++_underruns; }
+      int underruns() const         { return _underruns; }
+      int starved() const           { return _starved;   }
+
+      static int registerPath(const QString&);
+      static QString path(int id);
+      };
+
+#endif
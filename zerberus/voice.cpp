@@ -11,6 +11,10 @@
 //=============================================================================
 
 #include <stdio.h>
+#include "config.h"
+#if defined(USE_SSE) && defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 #include "voice.h"
 #include "instrument.h"
@@ -18,6 +22,7 @@
 #include "zerberus.h"
 #include "zone.h"
 #include "sample.h"
+#include "streamer.h"
 #include "synthesizer/msynthesizer.h"
 
 float Voice::interpCoeff[INTERP_MAX][4];
@@ -101,6 +106,13 @@ void Voice::start(Channel* c, int key, int v, const Zone* z)
       audioChan = s->channel();
       data      = s->data() + z->offset * audioChan;
       eidx      = s->frames() * audioChan;
+      sample    = s;
+      startFrame = z->offset;
+      if (s->streamed()) {
+            stream = _zerberus->streamer()->open(s);
+            if (!stream)      // no free stream, play the resident part only
+                  eidx = qMax(0, s->residentFrames() - startFrame - 3) * audioChan;
+            }
       _loopMode = z->loopMode;
 
       _offMode  = z->offMode;
@@ -232,111 +244,342 @@ void Voice::process(int frames, float* p)
             last_fres = _fres;
             }
 
-      if (audioChan == 1) {
-            while (frames--) {
-                  int idx = phase.index();
-                  if (idx >= eidx) {
-                        off();
-                        break;
-                        }
-                  const float* coeffs = interpCoeff[phase.fract()];
-                  float f;
-                  f =  (coeffs[0] * data[idx-1]
-                      + coeffs[1] * data[idx+0]
-                      + coeffs[2] * data[idx+1]
-                      + coeffs[3] * data[idx+2]) * gain
-                      - a1 * hist1l
-                      - a2 * hist2l;
-                  float v = b02 * (f + hist2l) + b1 * hist1l;
-                  hist2l  = hist1l;
-                  hist1l  = f;
-
-                  if (filter_coeff_incr_count) {
-                        --filter_coeff_incr_count;
-                        a1  += a1_incr;
-                        a2  += a2_incr;
-                        b02 += b02_incr;
-                        b1  += b1_incr;
-                        }
+      if (!stream) {
+            render(frames, p);
+            return;
+            }
+      //
+      // streamed sample: copy the frames needed for the next
+      // part of the block into a window and render from there
+      //
+      while (frames > 0) {
+            int first = phase.index() - 1;
+            int n     = fillWindow(frames);
+            int e     = eidx;
+            data      = stream->window.data();
+            eidx      = e - first * audioChan;
+            phase.data -= int64_t(first) << 8;
+            render(n, p);
+            phase.data += int64_t(first) << 8;
+            eidx      = e;
+            if (!stream)            // voice was turned off
+                  break;
+            _zerberus->streamer()->consumed(stream, startFrame + phase.index() - 1);
+            p      += n * 2;
+            frames -= n;
+            }
+      }
+
+//---------------------------------------------------------
+//   fillWindow
+//    copy the sample frames needed to render the next
+//    frames (at most) to the window of the stream;
+//    returns the number of frames which can be rendered
+//    realtime
+//---------------------------------------------------------
+
+int Voice::fillWindow(int frames)
+      {
+      int64_t incr = qMax(phaseIncr.data, int64_t(1));
+      int n        = int(qMin(int64_t(frames), (int64_t(WINDOW_FRAMES - 8) << 8) / incr));
+      n            = qMax(n, 1);
+      int first    = phase.index() - 1;
+      int last     = int((phase.data + n * incr) >> 8) + 3;
+
+      int ch          = audioChan;
+      int resident    = sample->residentFrames();
+      int sampleEnd   = sample->frames();
+      const short* head = sample->data();       // frame -1 is a copy of frame 0
+      const short* ring = stream->ring.data();
+      short* dst        = stream->window.data();
+
+      int needed = qMin(startFrame + last, sampleEnd);
+      if (!_zerberus->realtime() && stream->written < needed)
+            _zerberus->streamer()->wait(stream, needed);    // offline rendering waits for the disk
+      int written = stream->written;
+      if (written < needed)
+            _zerberus->streamer()->underrun();
+
+      for (int i = first; i < last; ++i) {
+            int f = startFrame + i;
+            const short* src;
+            if (f < resident)
+                  src = head + f * ch;
+            else if (f < written)
+                  src = ring + ((f - resident) % STREAM_FRAMES) * ch;
+            else {
+                  // end of sample or underrun
+                  for (int c = 0; c < ch; ++c)
+                        *dst++ = 0;
+                  continue;
+                  }
+            for (int c = 0; c < ch; ++c)
+                  *dst++ = src[c];
+            }
+      return n;
+      }
+
+//---------------------------------------------------------
+//   interpolate
+//    4 point interpolation of the next frames into l (and
+//    r for stereo samples); returns the number of frames
+//    before the end of the sample
+//    realtime
+//---------------------------------------------------------
 
-                  if (_state == VoiceState::STOP) {
-                        if (stopEnv.step()) {
-                              off();
-                              break;
-                              }
-                        v *= stopEnv.val;
+int Voice::interpolate(int frames, float* l, float* r) const
+      {
+      const int ch       = audioChan;
+      const int64_t p0   = phase.data;
+      const int64_t incr = phaseIncr.data;
+
+      // frames before the phase reaches the end of the sample
+      int64_t left = (int64_t((eidx + ch - 1) / ch) << 8) - p0;
+      int n;
+      if (left <= 0)
+            n = 0;
+      else if (incr <= 0)
+            n = frames;
+      else
+            n = int(qMin(int64_t(frames), (left + incr - 1) / incr));
+
+      int i = 0;
+#if defined(USE_SSE) && defined(__SSE2__)
+      //
+      // four frames at a time: multiply the taps of every frame
+      // with its coefficients, then transpose and add the products
+      // in the same order as the scalar code below
+      //
+      if (ch == 1) {
+            for (; i + 4 <= n; i += 4) {
+                  __m128 s[4];
+                  for (int k = 0; k < 4; ++k) {
+                        Phase ph(p0 + (i + k) * incr);
+                        __m128i t = _mm_loadl_epi64((const __m128i*)(data + ph.index() - 1));
+                        t = _mm_srai_epi32(_mm_unpacklo_epi16(t, t), 16);
+                        s[k] = _mm_mul_ps(_mm_loadu_ps(interpCoeff[ph.fract()]), _mm_cvtepi32_ps(t));
                         }
-                  *p++  += v * _channel->panLeftGain();
-                  *p++  += v * _channel->panRightGain();
-                  phase += phaseIncr;
+                  _MM_TRANSPOSE4_PS(s[0], s[1], s[2], s[3]);
+                  _mm_store_ps(l + i, _mm_add_ps(_mm_add_ps(_mm_add_ps(s[0], s[1]), s[2]), s[3]));
                   }
             }
       else {
-            //
-            // handle interleaved stereo samples
-            //
-            while (frames--) {
-                  int idx = phase.index() * 2;
-                  if (idx >= eidx) {
-                        off();
-                        // printf("end of sample\n");
-                        break;
+            for (; i + 4 <= n; i += 4) {
+                  __m128 sl[4], sr[4];
+                  for (int k = 0; k < 4; ++k) {
+                        Phase ph(p0 + (i + k) * incr);
+                        // frames -1 .. 2, left and right interleaved
+                        __m128i t  = _mm_loadu_si128((const __m128i*)(data + ph.index() * 2 - 2));
+                        __m128 lo  = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(t, t), 16));
+                        __m128 hi  = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(t, t), 16));
+                        __m128 c   = _mm_loadu_ps(interpCoeff[ph.fract()]);
+                        sl[k] = _mm_mul_ps(c, _mm_shuffle_ps(lo, hi, _MM_SHUFFLE(2, 0, 2, 0)));
+                        sr[k] = _mm_mul_ps(c, _mm_shuffle_ps(lo, hi, _MM_SHUFFLE(3, 1, 3, 1)));
                         }
+                  _MM_TRANSPOSE4_PS(sl[0], sl[1], sl[2], sl[3]);
+                  _MM_TRANSPOSE4_PS(sr[0], sr[1], sr[2], sr[3]);
+                  _mm_store_ps(l + i, _mm_add_ps(_mm_add_ps(_mm_add_ps(sl[0], sl[1]), sl[2]), sl[3]));
+                  _mm_store_ps(r + i, _mm_add_ps(_mm_add_ps(_mm_add_ps(sr[0], sr[1]), sr[2]), sr[3]));
+                  }
+            }
+#endif
+      for (; i < n; ++i) {
+            Phase ph(p0 + i * incr);
+            const float* c = interpCoeff[ph.fract()];
+            if (ch == 1) {
+                  const short* d = data + ph.index();
+                  l[i] = c[0] * d[-1] + c[1] * d[0] + c[2] * d[1] + c[3] * d[2];
+                  }
+            else {
+                  const short* d = data + ph.index() * 2;
+                  l[i] = c[0] * d[-2] + c[1] * d[0] + c[2] * d[2] + c[3] * d[4];
+                  r[i] = c[0] * d[-1] + c[1] * d[1] + c[2] * d[3] + c[3] * d[5];
+                  }
+            }
+      return n;
+      }
+
+//---------------------------------------------------------
+//   envelope
+//    step the attack and release envelopes for the next
+//    frames; returns the number of frames before the
+//    release has ended
+//    realtime
+//---------------------------------------------------------
+
+int Voice::envelope(int frames, float* env)
+      {
+      for (int i = 0; i < frames; ++i) {
+            float g = 1.0f;
+            // mono samples are played without attack ramp
+            if (_state == VoiceState::ATTACK && audioChan == 2) {
+                  if (attackEnv.step())
+                        _state = VoiceState::PLAYING;
+                  else
+                        g = attackEnv.val;
+                  }
+            else if (_state == VoiceState::STOP) {
+                  if (stopEnv.step())
+                        return i;
+                  g = stopEnv.val;
+                  }
+            env[i] = g;
+            }
+      return frames;
+      }
 
-                  const float* coeffs = interpCoeff[phase.fract()];
-                  float f1, f2;
-
-                  f1 = (coeffs[0] * data[idx-2]
-                      + coeffs[1] * data[idx]
-                      + coeffs[2] * data[idx+2]
-                      + coeffs[3] * data[idx+4])
-                      * gain * _channel->panLeftGain();
-
-                  f2 = (coeffs[0] * data[idx-1]
-                      + coeffs[1] * data[idx+1]
-                      + coeffs[2] * data[idx+3]
-                      + coeffs[3] * data[idx+5])
-                      * gain * _channel->panRightGain();
-
-                  if (_state == VoiceState::ATTACK) {
-                        if (attackEnv.step())
-                              _state = VoiceState::PLAYING;
-                        else {
-                              f1 *= attackEnv.val;
-                              f2 *= attackEnv.val;
-                              }
+//---------------------------------------------------------
+//   filter
+//    run the biquad over the next frames of l (and r for
+//    stereo samples) in place. The term of the older history
+//    value is subtracted first which shortens the dependency
+//    chain from one frame to the next.
+//    realtime
+//---------------------------------------------------------
+
+void Voice::filter(int frames, float* l, float* r)
+      {
+      float l1 = hist1l;
+      float l2 = hist2l;
+      float r1 = hist1r;
+      float r2 = hist2r;
+
+      int i = 0;
+      while (i < frames) {
+            // while the coefficients are ramped, one frame at a time
+            int n = filter_coeff_incr_count ? i + 1 : frames;
+            const float _a1  = a1;
+            const float _a2  = a2;
+            const float _b02 = b02;
+            const float _b1  = b1;
+            if (r) {
+                  for (; i < n; ++i) {
+                        float fl = (l[i] - _a2 * l2) - _a1 * l1;
+                        float fr = (r[i] - _a2 * r2) - _a1 * r1;
+                        l[i] = _b02 * (fl + l2) + _b1 * l1;
+                        r[i] = _b02 * (fr + r2) + _b1 * r1;
+                        l2   = l1;
+                        l1   = fl;
+                        r2   = r1;
+                        r1   = fr;
                         }
-                  else if (_state == VoiceState::STOP) {
-                        if (stopEnv.step()) {
-                              off();
-                              break;
-                              }
-                        f1 *= stopEnv.val;
-                        f2 *= stopEnv.val;
+                  }
+            else {
+                  for (; i < n; ++i) {
+                        float f = (l[i] - _a2 * l2) - _a1 * l1;
+                        l[i]    = _b02 * (f + l2) + _b1 * l1;
+                        l2      = l1;
+                        l1      = f;
                         }
+                  }
+            if (filter_coeff_incr_count) {
+                  --filter_coeff_incr_count;
+                  a1  += a1_incr;
+                  a2  += a2_incr;
+                  b02 += b02_incr;
+                  b1  += b1_incr;
+                  }
+            }
+      hist1l = l1;
+      hist2l = l2;
+      hist1r = r1;
+      hist2r = r2;
+      }
 
-                  f1      += -a1 * hist1l - a2 * hist2l;
-                  float vl = b02 * (f1 + hist2l) + b1 * hist1l;
-                  hist2l   = hist1l;
-                  hist1l   = f1;
-
-                  f2      +=  -a1 * hist1r - a2 * hist2r;
-                  float vr = b02 * (f2 + hist2r) + b1 * hist1r;
-                  hist2r   = hist1r;
-                  hist1r   = f2;
-
-                  if (filter_coeff_incr_count) {
-                        --filter_coeff_incr_count;
-                        a1  += a1_incr;
-                        a2  += a2_incr;
-                        b02 += b02_incr;
-                        b1  += b1_incr;
-                        }
+//---------------------------------------------------------
+//   applyEnvelope
+//---------------------------------------------------------
+
+static void applyEnvelope(int frames, float* x, const float* env)
+      {
+      int i = 0;
+#if defined(USE_SSE) && defined(__SSE2__)
+      for (; i + 4 <= frames; i += 4)
+            _mm_store_ps(x + i, _mm_mul_ps(_mm_load_ps(x + i), _mm_load_ps(env + i)));
+#endif
+      for (; i < frames; ++i)
+            x[i] *= env[i];
+      }
+
+//---------------------------------------------------------
+//   mix
+//    apply gain and pan and add to the interleaved
+//    stereo output
+//---------------------------------------------------------
 
-                  *p++  += vl;
-                  *p++  += vr;
-                  phase += phaseIncr;
+static void mix(int frames, float* p, const float* l, const float* r, float gl, float gr)
+      {
+      int i = 0;
+#if defined(USE_SSE) && defined(__SSE2__)
+      __m128 vgl = _mm_set1_ps(gl);
+      __m128 vgr = _mm_set1_ps(gr);
+      for (; i + 4 <= frames; i += 4) {
+            __m128 a = _mm_mul_ps(_mm_load_ps(l + i), vgl);
+            __m128 b = _mm_mul_ps(_mm_load_ps(r + i), vgr);
+            float* d = p + i * 2;
+            _mm_storeu_ps(d,     _mm_add_ps(_mm_loadu_ps(d),     _mm_unpacklo_ps(a, b)));
+            _mm_storeu_ps(d + 4, _mm_add_ps(_mm_loadu_ps(d + 4), _mm_unpackhi_ps(a, b)));
+            }
+#endif
+      for (; i < frames; ++i) {
+            p[i * 2]     += l[i] * gl;
+            p[i * 2 + 1] += r[i] * gr;
+            }
+      }
+
+//---------------------------------------------------------
+//   render
+//    render blocks of at most BLOCK_FRAMES: interpolate the
+//    block, filter it, then apply gain and pan. Stereo
+//    samples get the envelope before the filter, mono
+//    samples after it.
+//    realtime
+//---------------------------------------------------------
+
+void Voice::render(int frames, float* p)
+      {
+      alignas(16) float l[BLOCK_FRAMES];
+      alignas(16) float r[BLOCK_FRAMES];
+      alignas(16) float env[BLOCK_FRAMES];
+
+      const bool stereo = audioChan == 2;
+      const float gl    = gain * _channel->panLeftGain();
+      const float gr    = gain * _channel->panRightGain();
+
+      while (frames > 0) {
+            int n = qMin(frames, BLOCK_FRAMES);
+            int k = envelope(interpolate(n, l, r), env);
+            if (stereo) {
+                  applyEnvelope(k, l, env);
+                  applyEnvelope(k, r, env);
+                  filter(k, l, r);
+                  mix(k, p, l, r, gl, gr);
                   }
+            else {
+                  filter(k, l, 0);
+                  applyEnvelope(k, l, env);
+                  mix(k, p, l, l, gl, gr);
+                  }
+            phase.data += k * phaseIncr.data;
+            if (k < n) {      // end of sample or end of release
+                  off();
+                  break;
+                  }
+            p      += n * 2;
+            frames -= n;
+            }
+      }
+
+//---------------------------------------------------------
+//   off
+//---------------------------------------------------------
+
+void Voice::off()
+      {
+      _state = VoiceState::OFF;
+      if (stream) {
+            _zerberus->streamer()->close(stream);
+            stream = 0;
             }
       }
 
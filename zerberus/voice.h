@@ -18,14 +18,16 @@
 
 class Channel;
 struct Zone;
+struct Stream;
 class Sample;
 class Zerberus;
 
 enum class LoopMode : char;
 enum class OffMode : char;
 
-static const int INTERP_MAX = 256;
-static const int EG_SIZE    = 256;
+static const int INTERP_MAX   = 256;
+static const int EG_SIZE      = 256;
+static const int BLOCK_FRAMES = 64;    // frames rendered by one pass of the kernels
 
 //---------------------------------------------------------
 //   Envelope
@@ -104,6 +106,9 @@ class Voice {
 
       short* data;
       int eidx;
+      const Sample* sample;
+      Stream* stream = 0;      // rest of a partially loaded sample
+      int startFrame;          // zone offset
       LoopMode _loopMode;
       OffMode _offMode;
       int _offBy;
@@ -147,6 +152,13 @@ class Voice {
       static float interpCoeff[INTERP_MAX][4];
 
       void updateFilter(float fres);
+      void render(int frames, float*);
+      int interpolate(int frames, float* l, float* r) const;
+      int envelope(int frames, float* env);
+      void filter(int frames, float* l, float* r);
+      int fillWindow(int frames);
+
+      friend class TestVoice;       // mtest/zerberus/tst_voice.cpp renders the per-frame reference
 
    public:
       Voice(Zerberus*);
@@ -167,7 +179,7 @@ class Voice {
       void stop()                 { _state = VoiceState::STOP;      }
       void stop(float time);
       void sustained()            { _state = VoiceState::SUSTAINED; }
-      void off()                  { _state = VoiceState::OFF;       }
+      void off();
       const char* state() const;
       LoopMode loopMode() const   { return _loopMode; }
 
@@ -12,6 +12,7 @@
 
 #include "mscore/preferences.h"
 #include "synthesizer/event.h"
+#include "synthesizer/msynthesizer.h"
 #include "synthesizer/midipatch.h"
 
 #include "zerberus.h"
@@ -26,6 +27,7 @@
 bool Zerberus::initialized = false;
 // instruments can be shared between several zerberus instances
 std::list<ZInstrument*> Zerberus::globalInstruments;
+QMutex Zerberus::globalMutex;
 
 //---------------------------------------------------------
 //   createZerberus
@@ -51,7 +53,15 @@ Zerberus::Zerberus()
             freeVoices.push(new Voice(this));
       for (int i = 0; i < MAX_CHANNEL; ++i)
             _channel[i] = new Channel(this, i);
-      busy = true;      // no sf loaded yet
+
+      int threads = qMax(1, Ms::preferences.synthesizerThreads);
+      renderList.reserve(MAX_VOICES);
+      workerBuffers.assign((threads - 1) * Ms::MasterSynthesizer::MAX_BUFFERSIZE, 0.0f);
+      renderPool.start(threads);
+
+      _preload = qMax(0, Ms::preferences.zerberusPreload);
+      if (_preload)
+            _streamer.start();
       }
 
 //---------------------------------------------------------
@@ -60,7 +70,7 @@ Zerberus::Zerberus()
 
 Zerberus::~Zerberus()
       {
-      busy = true;
+      QMutexLocker locker(&globalMutex);
       while (!instruments.empty()) {
             auto i  = instruments.front();
             auto it = instruments.begin();
@@ -166,13 +176,12 @@ void Zerberus::processNoteOn(Channel* cp, int key, int velo)
       }
 
 //---------------------------------------------------------
-//   process
+//   play
+//    realtime
 //---------------------------------------------------------
 
 void Zerberus::play(const Ms::PlayEvent& event)
       {
-      if (busy)
-            return;
       Channel* cp = _channel[int(event.channel())];
       if (cp->instrument() == 0) {
             // qDebug("Zerberus::play(): no instrument for channel %d", event.channel());
@@ -211,12 +220,35 @@ void Zerberus::play(const Ms::PlayEvent& event)
 
 void Zerberus::process(unsigned frames, float* p, float*, float*)
       {
-      if (busy)
-            return;
+      if (!beginProcess())
+            return;     // queued messages are kept until the next call
+      processMessages();
+
+      if (activeVoices && activeVoices->next() && renderPool.parallel()) {
+            renderList.clear();
+            for (Voice* v = activeVoices; v; v = v->next())
+                  renderList.push_back(v);
+            int threads = renderPool.threads();
+            for (int w = 1; w < threads; ++w)
+                  memset(&workerBuffers[(w - 1) * Ms::MasterSynthesizer::MAX_BUFFERSIZE], 0, frames * 2 * sizeof(float));
+            renderFrames = frames;
+            renderOut    = p;
+            renderPool.run(renderVoices, this, frames, sampleRate());  // a miss is counted for AudioStats
+            for (int w = 1; w < threads; ++w) {
+                  const float* src = &workerBuffers[(w - 1) * Ms::MasterSynthesizer::MAX_BUFFERSIZE];
+                  for (unsigned i = 0; i < frames * 2; ++i)
+                        p[i] += src[i];
+                  }
+            }
+      else {
+            for (Voice* v = activeVoices; v; v = v->next())
+                  v->process(frames, p);
+            }
+
+      // free voices which have finished
       Voice* v = activeVoices;
       Voice* pv = 0;
       while (v) {
-            v->process(frames, p);
             if (v->isOff()) {
                   if (pv)
                         pv->setNext(v->next());
@@ -228,6 +260,24 @@ void Zerberus::process(unsigned frames, float* p, float*, float*)
                   pv = v;
             v = v->next();
             }
+      endProcess();
+      }
+
+//---------------------------------------------------------
+//   renderVoices
+//    render every n-th voice of renderList, starting at
+//    partition, into the buffer of worker
+//    called from RenderPool, realtime
+//---------------------------------------------------------
+
+void Zerberus::renderVoices(void* data, int worker, int partition)
+      {
+      Zerberus* z    = static_cast<Zerberus*>(data);
+      float* p       = worker == 0 ? z->renderOut : &z->workerBuffers[(worker - 1) * Ms::MasterSynthesizer::MAX_BUFFERSIZE];
+      int partitions = z->renderPool.partitions();
+      int n          = int(z->renderList.size());
+      for (int i = partition; i < n; i += partitions)
+            z->renderList[i]->process(z->renderFrames, p);
       }
 
 //---------------------------------------------------------
@@ -259,6 +309,7 @@ const QList<Ms::MidiPatch*>& Zerberus::getPatchInfo() const
 
 //---------------------------------------------------------
 //   allSoundsOff
+//    realtime
 //---------------------------------------------------------
 
 void Zerberus::allSoundsOff(int channel)
@@ -268,16 +319,71 @@ void Zerberus::allSoundsOff(int channel)
 
 //---------------------------------------------------------
 //   allNotesOff
+//    realtime
 //---------------------------------------------------------
 
 void Zerberus::allNotesOff(int channel)
       {
-      busy = true;
       for (Voice* v = activeVoices; v; v = v->next()) {
             if (channel == -1 || (v->channel()->idx() == channel))
                   v->stop();
             }
-      busy = false;
+      }
+
+//---------------------------------------------------------
+//   adopt
+//    switch to the staged instruments; stagedInstruments
+//    gets the previous list. Channels without instrument
+//    get the first one.
+//    realtime
+//---------------------------------------------------------
+
+void Zerberus::adopt()
+      {
+      if (stagedStop) {
+            while (activeVoices) {
+                  Voice* v     = activeVoices;
+                  activeVoices = v->next();
+                  v->off();
+                  freeVoices.push(v);
+                  }
+            }
+      instruments.swap(stagedInstruments);
+      for (int i = 0; i < MAX_CHANNEL; ++i) {
+            ZInstrument* zi = _channel[i]->instrument();
+            if (zi && find(instruments.begin(), instruments.end(), zi) == instruments.end())
+                  zi = 0;
+            if (!zi && !instruments.empty())
+                  zi = instruments.front();
+            _channel[i]->setInstrument(zi);
+            }
+      }
+
+//---------------------------------------------------------
+//   setInstruments
+//    hand l over to the audio thread and release the
+//    instruments which are not played anymore. Voices
+//    must be stopped if an instrument is removed.
+//    not realtime
+//---------------------------------------------------------
+
+void Zerberus::setInstruments(const std::list<ZInstrument*>& l, bool stopVoices)
+      {
+      stagedInstruments = l;
+      stagedStop        = stopVoices;
+      handOver();
+
+      QMutexLocker locker(&globalMutex);
+      for (ZInstrument* i : stagedInstruments) {
+            if (find(instruments.begin(), instruments.end(), i) != instruments.end())
+                  continue;
+            i->setRefCount(i->refCount() - 1);
+            if (i->refCount() <= 0) {
+                  globalInstruments.remove(i);
+                  delete i;
+                  }
+            }
+      stagedInstruments.clear();
       }
 
 //---------------------------------------------------------
@@ -322,28 +428,9 @@ bool Zerberus::removeSoundFont(const QString& s)
       {
       for (ZInstrument* i : instruments) {
             if (i->path() == s) {
-                  auto it = find(instruments.begin(), instruments.end(), i);
-                  if (it == instruments.end())
-                        return false;
-                  instruments.erase(it);
-                  for (int k = 0; k < MAX_CHANNEL; ++k) {
-                        if (_channel[k]->instrument() == i)
-                              _channel[k]->setInstrument(0);
-                        }
-                  if (!instruments.empty()) {
-                        for (int i = 0; i < MAX_CHANNEL; ++i) {
-                              if (_channel[i]->instrument() == 0)
-                                    _channel[i]->setInstrument(instruments.front());
-                              }
-                        }
-                  i->setRefCount(i->refCount() - 1);
-                  if (i->refCount() <= 0) {
-                        auto it = find(globalInstruments.begin(), globalInstruments.end(), i);
-                        if (it == globalInstruments.end())
-                              return false;
-                        globalInstruments.erase(it);
-                        delete i;
-                        }
+                  std::list<ZInstrument*> l = instruments;
+                  l.remove(i);
+                  setInstruments(l, true);
                   return true;
                   }
             }
@@ -408,15 +495,14 @@ bool Zerberus::loadInstrument(const QString& s)
                   return true;
                   }
             }
+      QMutexLocker locker(&globalMutex);
       for (ZInstrument* instr : globalInstruments) {
             if (QFileInfo(instr->path()).fileName() == fileName) {
-                  instruments.push_back(instr);
                   instr->setRefCount(instr->refCount() + 1);
-                  if (instruments.size() == 1) {
-                        for (int i = 0; i < MAX_CHANNEL; ++i)
-                              _channel[i]->setInstrument(instr);
-                        }
-                  busy = false;
+                  locker.unlock();
+                  std::list<ZInstrument*> il = instruments;
+                  il.push_back(instr);
+                  setInstruments(il, false);
                   return true;
                   }
             }
@@ -429,22 +515,16 @@ bool Zerberus::loadInstrument(const QString& s)
                   break;
                   }
             }
-      busy = true;
       ZInstrument* instr = new ZInstrument(this);
 
       try {
             if (instr->load(path)) {
                   globalInstruments.push_back(instr);
-                  instruments.push_back(instr);
                   instr->setRefCount(1);
-                  //
-                  // set default instrument for all channels:
-                  //
-                  if (instruments.size() == 1) {
-                        for (int i = 0; i < MAX_CHANNEL; ++i)
-                              _channel[i]->setInstrument(instr);
-                        }
-                  busy = false;
+                  locker.unlock();
+                  std::list<ZInstrument*> il = instruments;
+                  il.push_back(instr);
+                  setInstruments(il, false);
                   return true;
                   }
             }
@@ -454,7 +534,6 @@ bool Zerberus::loadInstrument(const QString& s)
       catch (...) {
             }
       qDebug("Zerberus::loadInstrument failed");
-      busy = false;
       delete instr;
       return false;
       }
@@ -20,6 +20,8 @@
 
 #include "synthesizer/synthesizer.h"
 #include "synthesizer/event.h"
+#include "synthesizer/renderpool.h"
+#include "streamer.h"
 
 class Voice;
 class Channel;
@@ -57,6 +59,7 @@ class VoiceFifo {
             return v;
             }
       bool empty() const { return n == 0; }
+      int count() const  { return n; }
       };
 
 //---------------------------------------------------------
@@ -66,11 +69,14 @@ class VoiceFifo {
 class Zerberus : public Ms::Synthesizer {
       static bool initialized;
       static std::list<ZInstrument*> globalInstruments;
+      static QMutex globalMutex;          // instruments are shared by all instances, which
+                                          // may load on different threads
 
       double _masterTuning = 440.0;
-      std::atomic<bool> busy;
 
-      std::list<ZInstrument*> instruments;
+      std::list<ZInstrument*> instruments;      // played by the audio thread
+      std::list<ZInstrument*> stagedInstruments;  // next instruments, see setInstruments()
+      bool stagedStop = false;                  // stop all voices when adopting
       Channel* _channel[MAX_CHANNEL];
 
       int allocatedVoices = 0;
@@ -79,10 +85,25 @@ class Zerberus : public Ms::Synthesizer {
       int _loadProgress = 0;
       bool _loadWasCanceled = false;
 
+      Ms::RenderPool renderPool;          // parallel voice rendering
+      std::vector<Voice*> renderList;     // voices of the block rendered in parallel
+      std::vector<float> workerBuffers;   // one stereo buffer for every worker > 0
+      unsigned renderFrames = 0;
+      float* renderOut = 0;
+
+      int _preload = 0;                   // ms of every sample kept in memory, 0: whole sample
+      Streamer _streamer;                 // reads the rest of partially loaded samples
+
+      static void renderVoices(void* zerberus, int worker, int partition);
+
       void programChange(int channel, int program);
       void trigger(Channel*, int key, int velo, Trigger);
       void processNoteOff(Channel*, int pitch);
       void processNoteOn(Channel* cp, int key, int velo);
+      void setInstruments(const std::list<ZInstrument*>&, bool stopVoices);
+
+   protected:
+      virtual void adopt();
 
    public:
       Zerberus();
@@ -90,6 +111,10 @@ class Zerberus : public Ms::Synthesizer {
 
       virtual void process(unsigned frames, float*, float*, float*);
       virtual void play(const Ms::PlayEvent& event);
+      virtual int voiceCount() const    { return MAX_VOICES - freeVoices.count(); }
+      virtual unsigned renderMisses() const { return renderPool.misses(); }
+      virtual unsigned streamUnderruns() const { return _streamer.underruns(); }
+      virtual unsigned starvedVoices() const { return _streamer.starved(); }
 
       bool loadInstrument(const QString&);
 
@@ -99,6 +124,8 @@ class Zerberus : public Ms::Synthesizer {
       int loadProgress()            { return _loadProgress; }
       void setLoadProgress(int val) { _loadProgress = val; }
       bool loadWasCanceled()        { return _loadWasCanceled; }
+      int preload() const           { return _preload; }
+      Streamer* streamer()          { return &_streamer; }
       void setLoadWasCanceled(bool status)     { _loadWasCanceled = status; }
 
       virtual void setMasterTuning(double val) { _masterTuning = val;  }